@@ -0,0 +1,171 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  AIS target table and track history
+ * Author:   The OpenCPN developers
+ *
+ ***************************************************************************
+ *   Copyright (C) 2026 by the OpenCPN developers                          *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ *
+ */
+
+#ifndef __AISTARGETSTORE_H__
+#define __AISTARGETSTORE_H__
+
+#include <cstddef>
+#include <ctime>
+#include <utility>
+#include <vector>
+
+class AIS_Target_Data;
+
+class AISTargetTrackPoint
+{
+      public:
+            double      m_lat;
+            double      m_lon;
+            time_t      m_time;
+};
+
+//  The recent positions of one target, oldest first.
+//  Points are held by value in a ring, so the steady state of appending a
+//  new report and expiring the oldest one neither allocates nor frees.
+//  The ring grows on demand; its length is bounded by the caller expiring
+//  points older than the track length set in the options.
+
+class AISTargetTrack
+{
+public:
+    AISTargetTrack();
+
+    size_t GetCount() const { return m_count; }
+    bool IsEmpty() const { return m_count == 0; }
+    const AISTargetTrackPoint &Item( size_t i ) const
+        { return m_points[( m_first + i ) & ( m_points.size() - 1 )]; }
+
+    void Append( double lat, double lon, time_t time );
+    void RemoveOlderThan( time_t time );
+    void Clear();
+
+private:
+    void Grow();
+
+    std::vector<AISTargetTrackPoint> m_points;  // capacity, zero or a power of two
+    size_t m_first;
+    size_t m_count;
+};
+
+//  Flags of the hot target fields
+enum {
+    AIS_HOT_POSITION_VALID  = 1 << 0,   // b_positionOnceValid
+    AIS_HOT_OWNSHIP         = 1 << 1,   // b_OwnShip
+    AIS_HOT_ACTIVE          = 1 << 2,   // b_active
+    AIS_HOT_LOST            = 1 << 3,   // b_lost
+    AIS_HOT_PERSIST_TRACK   = 1 << 4,   // b_PersistTrack
+    AIS_HOT_CPA_VALID       = 1 << 5    // bCPA_Valid
+};
+
+//  The fields the periodic sweeps read for every target, as parallel arrays
+//  indexed by table slot, so a sweep reads them in order without visiting the
+//  targets themselves.  Slots that are not in use hold stale values.
+struct AIS_Target_Hot
+{
+    std::vector<double> lat, lon;
+    std::vector<double> sog, cog;
+    std::vector<double> range, brg;
+    std::vector<double> cpa, tcpa;
+    std::vector<time_t> posn_ticks;                 // PositionReportTicks
+    std::vector<int>    cls;                        // Class
+    std::vector<unsigned char> flags;               // AIS_HOT_ values
+    std::vector<AISTargetTrack *> track;            // m_ptrack
+};
+
+//  The target list, keyed by MMSI.
+//  An open addressed table with linear probing: all entries live in one
+//  contiguous array, so the periodic sweeps over every target walk memory
+//  in order instead of chasing hash map nodes.
+//  Erasing leaves iterators to other entries valid, so a sweep may erase
+//  the entry it is standing on.  Inserting a new key may move entries.
+//
+//  The targets stay on the heap, since the rest of the program holds
+//  pointers to them.  Their hot fields are mirrored in GetHot(), which the
+//  mutators below bring up to date: a target whose hot fields are changed
+//  in place is stored again with Set(), or changed through the table.
+
+class AIS_Target_Hash
+{
+public:
+    typedef std::pair<int, AIS_Target_Data *> value_type;
+
+    class iterator
+    {
+    public:
+        iterator() : m_hash( NULL ), m_index( 0 ) {}
+        iterator( AIS_Target_Hash *hash, size_t index ) : m_hash( hash ), m_index( index ) {}
+
+        value_type &operator*() const { return m_hash->m_slots[m_index]; }
+        value_type *operator->() const { return &m_hash->m_slots[m_index]; }
+        iterator &operator++() { m_index = m_hash->NextUsed( m_index + 1 ); return *this; }
+        iterator operator++( int ) { iterator it = *this; ++*this; return it; }
+        bool operator==( const iterator &it ) const { return m_index == it.m_index; }
+        bool operator!=( const iterator &it ) const { return m_index != it.m_index; }
+        size_t GetSlot() const { return m_index; }          // index into the hot arrays
+
+    private:
+        friend class AIS_Target_Hash;
+        AIS_Target_Hash *m_hash;
+        size_t m_index;
+    };
+
+    AIS_Target_Hash();
+
+    iterator begin() { return iterator( this, NextUsed( 0 ) ); }
+    iterator end() { return iterator( this, m_slots.size() ); }
+    size_t size() const { return m_count; }
+    bool empty() const { return m_count == 0; }
+
+    iterator find( int mmsi );
+    AIS_Target_Data *Get( int mmsi );           // NULL for an unknown key
+    void Set( int mmsi, AIS_Target_Data *td );  // insert or replace, then mirror
+    void erase( iterator it );
+    size_t erase( int mmsi );
+    void clear();
+
+    //  Hot field changes, mirrored as they are made
+    void SetActive( iterator it, bool b_active );
+    void SetLost( iterator it );                // lost, with unknown position
+    void SetPersistTrack( iterator it, bool b_persist );
+
+    AIS_Target_Hot &GetHot() { return m_hot; }
+
+private:
+    void Refresh( size_t i );           // copy the hot fields from the target
+    size_t Slot( int mmsi ) const;      // home slot of a key
+    size_t Lookup( int mmsi ) const;    // slot holding a key, or m_slots.size()
+    size_t NextUsed( size_t index ) const;
+    void Rehash( size_t capacity );
+
+    std::vector<value_type> m_slots;    // capacity, zero or a power of two
+    std::vector<unsigned char> m_state; // one of the AIS_SLOT_ values per slot
+    size_t m_count;                     // used slots
+    size_t m_nerased;                   // tombstones
+    AIS_Target_Hot m_hot;               // parallel to m_slots
+};
+
+#endif
@@ -31,6 +31,7 @@ class AIS_Bitstring
 public:
 
     AIS_Bitstring(const char *str);
+    AIS_Bitstring(const char *str, int len);
     unsigned char to_6bit(const char c);
 
     /// sp is starting bit, 1-based
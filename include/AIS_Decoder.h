@@ -26,12 +26,25 @@
 #define __AIS_DECODER_H__
 
 #include "ais.h"
+#include "cpa/cpa.h"
 #include <map>
 
 #define TRACKTYPE_DEFAULT       0
 #define TRACKTYPE_ALWAYS        1
 #define TRACKTYPE_NEVER         2
 
+//  Multipart VDM/VDO messages are reassembled per sequential message id and channel
+#define AIS_MULTIPART_SEQUENCES 11          // ids 0..9, and none
+#define AIS_MULTIPART_CHANNELS  3           // A, B, and none or other
+
+struct AIS_Multipart
+{
+    int         nsentences;                 // 0 if idle
+    int         next_sentence;
+    int         length;
+    char        payload[AIS_MAX_MESSAGE_LEN];
+};
+
 class MMSIProperties
 {
 public:
@@ -85,9 +98,18 @@ private:
     void OnTimerDSC( wxTimerEvent& event );
     
     bool NMEACheckSumOK(const wxString& str);
+    bool NMEACheckSumOK(const char *str, size_t len);
+    AIS_Error DecodeVDx(const char *str, size_t len);
+    AIS_Target_Data *PrepareTarget(int mmsi, bool *pbnewtarget, int *plast_report_ticks);
+    void CommitTarget(AIS_Target_Data *pTargetData, int mmsi, bool bnewtarget, bool bdecode_result, bool b_vdo);
+    void UpdateSelectableTarget(AIS_Target_Data *pTargetData);
     bool Parse_VDXBitstring(AIS_Bitstring *bstr, AIS_Target_Data *ptd);
     void UpdateAllCPA(void);
     void UpdateOneCPA(AIS_Target_Data *ptarget);
+    bool BeginCPA(void);
+    void GatherOneCPA(size_t slot, bool b_ownship_valid);
+    void SolveCPA(void);
+    void PublishCPA(AIS_Target_Hash::iterator it);
     void UpdateAllAlarms(void);
     void UpdateAllTracks(void);
     void UpdateOneTrack(AIS_Target_Data *ptarget);
@@ -103,9 +125,7 @@ private:
     wxTimer           TimerAIS;
     wxFrame           *m_parent_frame;
 
-    int               nsentences;
-    int               isentence;
-    wxString          sentence_accumulator;
+    AIS_Multipart     m_multipart[AIS_MULTIPART_SEQUENCES][AIS_MULTIPART_CHANNELS];
     bool              m_OK;
 
     AIS_Target_Data   *m_pLatestTargetData;
@@ -120,6 +140,12 @@ private:
     wxTimer          m_dsc_timer;
     wxString         m_dsc_last_string;
     std::vector<int> m_MMSI_MismatchVec;
+
+    //  Packed inputs and results of the batch CPA computation
+    CPA_Ownship      m_cpa_own;
+    std::vector<size_t> m_cpa_slots;                  // target list slots being solved
+    std::vector<double> m_cpa_lat, m_cpa_lon, m_cpa_ve, m_cpa_vn;
+    std::vector<double> m_cpa_tcpa, m_cpa_cpa;
     
 DECLARE_EVENT_TABLE()
 };
@@ -0,0 +1,62 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Per-chart bump allocator
+ * Author:   The OpenCPN developers
+ *
+ ***************************************************************************
+ *   Copyright (C) 2026 by the OpenCPN developers                          *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ *
+ */
+
+#ifndef __CHARTARENA_H__
+#define __CHARTARENA_H__
+
+#include <cstddef>
+#include <vector>
+
+//  A bump allocator for the many small records a chart holds for its whole life.
+//  Memory is carved from large blocks, and only released all at once by Clear()
+//  or the destructor; single allocations are never freed.
+
+class ChartArena
+{
+public:
+    ChartArena( size_t block_size = 64 * 1024 );
+    ~ChartArena();
+
+    void *Alloc( size_t size );
+    void Clear();
+
+    size_t GetReservedBytes() const { return m_reserved; }     // taken from the heap
+    size_t GetUsedBytes() const { return m_used; }             // handed out by Alloc()
+
+private:
+    ChartArena( const ChartArena & );                          // not copyable
+    ChartArena &operator=( const ChartArena & );
+
+    std::vector<char *> m_blocks;
+    size_t m_block_size;
+    char  *m_next;
+    size_t m_left;
+    size_t m_reserved;
+    size_t m_used;
+};
+
+#endif
@@ -0,0 +1,71 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Read-only memory mapped file
+ * Author:   The OpenCPN developers
+ *
+ ***************************************************************************
+ *   Copyright (C) 2026 by the OpenCPN developers                          *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ *
+ */
+
+#ifndef __MAPPEDFILE_H__
+#define __MAPPEDFILE_H__
+
+#include <wx/string.h>
+
+//  A whole file mapped read-only into memory.
+//  Where the platform offers no mapping, the file is read into a heap buffer
+//  instead, so callers can always treat GetData() as the complete file image.
+//  The image stays valid until Close() or destruction.  Writers must not
+//  truncate or rewrite a file in place while it is mapped; write a new file
+//  and rename it over the old one instead.
+//  A file that is only ever appended to may stay open for writing elsewhere
+//  if it is opened with b_append_shared; Open() it again to see what was appended.
+
+class MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile();
+
+    bool Open( const wxString &path, bool b_append_shared = false );
+    void Close();
+
+    bool IsOk() const { return m_data != NULL; }
+    const unsigned char *GetData() const { return m_data; }
+    size_t GetSize() const { return m_size; }
+    const wxString &GetPath() const { return m_path; }
+
+private:
+    MappedFile( const MappedFile & );               // not copyable
+    MappedFile &operator=( const MappedFile & );
+
+    unsigned char *m_data;
+    size_t m_size;
+    bool m_bheap;
+    wxString m_path;
+
+#ifdef __WXMSW__
+    void *m_hFile;
+    void *m_hMapping;
+#endif
+};
+
+#endif
@@ -37,9 +37,9 @@ public:
     ~OCPN_DataStreamEvent( );
 
     // accessors
-    void SetNMEAString(std::string string) { m_NMEAstring = string; }
+    void SetNMEAString(const std::string &string) { m_NMEAstring = string; }
     void SetStream( DataStream *pDS ) { m_pDataStream = pDS; }
-    std::string GetNMEAString() { return m_NMEAstring; }
+    const std::string &GetNMEAString() const { return m_NMEAstring; }
     DataStream *GetStream() { return m_pDataStream; }
     
     // required for sending with wxPostEvent()
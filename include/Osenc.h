@@ -36,10 +36,12 @@
 #include "mygdal/ogr_s57.h"
 #include "mygdal/cpl_csv.h"
 #include "chartbase.h"
+#include "MappedFile.h"
 
 #include <string.h>
 #include <stdint.h>
 #include <vector>
+#include <set>
 
 WX_DECLARE_OBJARRAY(float *,   SENCFloatPtrArray);
 
@@ -67,6 +69,7 @@ WX_DECLARE_OBJARRAY(float *,   SENCFloatPtrArray);
 
 #define FEATURE_ID_RECORD               64
 #define FEATURE_ATTRIBUTE_RECORD        65
+#define FEATURE_RCID_RECORD             66
 
 #define FEATURE_GEOMETRY_RECORD_POINT           80
 #define FEATURE_GEOMETRY_RECORD_LINE            81
@@ -327,6 +330,7 @@ class VE_Element;
 class VC_Element;
 class PolyTessGeo;
 class LineGeometryDescriptor;
+class ChartArena;
 
 typedef std::vector<S57Obj *> S57ObjVector;
 typedef std::vector<VE_Element *> VE_ElementVector;
@@ -334,6 +338,14 @@ typedef std::vector<VC_Element *> VC_ElementVector;
 
 WX_DECLARE_HASH_MAP( int, int, wxIntegerHash, wxIntegerEqual, VectorHelperHash );
 
+//  Where the records of one feature lie in an earlier SENC of the same cell
+typedef struct{
+    size_t          offset;
+    size_t          length;
+}PriorFeatureRecords;
+
+WX_DECLARE_HASH_MAP( int, PriorFeatureRecords, wxIntegerHash, wxIntegerEqual, PriorFeatureHash );
+
 //--------------------------------------------------------------------------
 //      Osenc_instream definition
 //--------------------------------------------------------------------------
@@ -350,6 +362,11 @@ public:
     virtual bool IsOk() = 0;
     virtual bool isAvailable() = 0;
     virtual void Shutdown() = 0;
+
+    //  Streams backed by an in-memory image of the file may return the next size bytes
+    //  in place, valid until the stream is closed, instead of copying them.
+    //  Returns NULL if the stream cannot do so, or on a short read (IsOk() is then false).
+    virtual const unsigned char *ReadInPlace(size_t size){ return NULL; }
     
 };
 
@@ -382,6 +399,33 @@ private:
 };
 
 
+//--------------------------------------------------------------------------
+//      Osenc_instreamMapped definition
+//      A stream over a memory mapped SENC file, which can read records in place
+//--------------------------------------------------------------------------
+class Osenc_instreamMapped : public Osenc_instream
+{
+public:
+    Osenc_instreamMapped();
+    ~Osenc_instreamMapped();
+    
+    bool Open( const wxString &senc_file_name );
+    void Close();
+    
+    Osenc_instream &Read(void *buffer, size_t size);
+    const unsigned char *ReadInPlace(size_t size);
+    bool IsOk();
+    bool isAvailable();
+    void Shutdown();
+
+private:
+    MappedFile          m_file;
+    size_t              m_pos;
+    bool                m_ok;
+    
+};
+
+
 
 //--------------------------------------------------------------------------
 //      Osenc_outstream definition
@@ -462,12 +506,23 @@ public:
     void setOutstream(Osenc_outstream *stream){ m_pauxOutstream = stream; }
     void setInstream(Osenc_instream *stream){ m_pauxInstream = stream; }
     
+    //  If set, ingested objects, their attribute records and area tessellations are placed in this arena
+    void setObjectArena( ChartArena *arena ){ m_pObjectArena = arena; }
+    
+    //  An existing SENC of the same cell edition, built with fewer updates applied.
+    //  createSenc200() copies from it the features the newer updates leave alone.
+    void setPriorSENC( const wxString &senc_file_name ){ m_PriorSENC = senc_file_name; }
+    
     wxString getUpdateDate(){ return m_LastUpdateDate; }
     wxString getBaseDate(){ return m_sdate000; }
     
     wxString getSENCFileCreateDate(){ return m_readFileCreateDate; }
 
     int getSencReadVersion(){ return m_senc_file_read_version; }
+    
+    //  True if the edge vertices from ingest200() point into the SENC image,
+    //  in which case they live exactly as long as this Osenc and must not be freed.
+    bool isPayloadInPlace(){ return m_bPayloadInPlace; }
     wxString getSENCReadBaseEdition(){ return m_read_base_edtn; }
     int getSENCReadLastUpdate(){ return m_read_last_applied_update; }
     int getSENCReadScale(){ return m_Chart_Scale; }
@@ -487,6 +542,7 @@ public:
     
     void InitializePersistentBuffer( void );
     unsigned char *getBuffer( size_t length);
+    unsigned char *readPayload( Osenc_instream &stream, size_t length );
     
     int getNativeScale(){ return m_native_scale; }
     int GetBaseFileInfo(const wxString& FullPath000, const wxString& SENCFileName);
@@ -495,6 +551,11 @@ private:
     void init();
     
     int ingestCell( OGRS57DataSource *poS57DS, const wxString &FullPath000, const wxString &working_dir );
+    int abandonSenc200( const wxString &tmp_file, OGRS57DataSource *poS57DS, int ret_code );
+    bool preparePriorSENC( S57Reader *poReader );
+    bool indexPriorSENC( int &prior_update );
+    bool collectUpdatedRecords( S57Reader *poReader, int first_update );
+    bool copyPriorFeature( OGRFeature *pFeature, Osenc_outstream *stream );
     int ValidateAndCountUpdates( const wxFileName file000, const wxString CopyDir,
                                  wxString &LastUpdateDate, bool b_copyfiles);
     int GetUpdateFileArray(const wxFileName file000, wxArrayString *UpFiles);
@@ -557,6 +618,13 @@ private:
     S57ClassRegistrar   *m_poRegistrar;
     wxArrayString       m_tmpup_array;
     
+    wxString            m_PriorSENC;
+    MappedFile          m_PriorImage;
+    PriorFeatureHash    m_prior_features;               // keyed by feature record RCID
+    std::set<int>       m_updated_features;             // FRID RCIDs touched by the new updates
+    std::set< std::pair<int, int> > m_updated_vectors;  // (RCNM, RCID) of touched spatial records
+    int                 m_nPriorFeaturesCopied;
+    
     wxGenericProgressDialog    *m_ProgDialog;
     
     
@@ -589,6 +657,8 @@ private:
     
     Osenc_outstream       *m_pOutstream;
     Osenc_instream        *m_pInstream;
+    bool                  m_bPayloadInPlace;
+    ChartArena            *m_pObjectArena;
 
     bool                  m_bVerbose;
     
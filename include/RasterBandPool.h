@@ -0,0 +1,80 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Thread pool for banded raster scaling
+ * Author:   The OpenCPN developers
+ *
+ ***************************************************************************
+ *   Copyright (C) 2026 by the OpenCPN developers                          *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ *
+ */
+
+#ifndef __RASTERBANDPOOL_H__
+#define __RASTERBANDPOOL_H__
+
+#include <vector>
+
+#include <wx/thread.h>
+
+//  A piece of work that can be cut into independent bands
+class RasterBandJob
+{
+public:
+    virtual ~RasterBandJob() {}
+    virtual void DoBand( int band ) = 0;
+};
+
+class RasterBandThread;
+
+//  Worker threads that run the bands of one job at a time.
+//  The thread calling Run() works on bands too, and Run() returns once all
+//  bands are done.  A Run() that finds the pool busy with another caller's
+//  job does its own bands alone rather than wait.
+
+class RasterBandPool
+{
+public:
+    RasterBandPool( int nthreads );
+    ~RasterBandPool();
+
+    int GetThreadCount() { return m_threads.size(); }
+    void Run( RasterBandJob *job, int nbands );
+
+private:
+    friend class RasterBandThread;
+
+    bool DoNextBand();
+    void WorkerLoop();
+
+    wxMutex m_run_mutex;                // one job at a time
+    wxCriticalSection m_lock;           // guards the members below
+    RasterBandJob *m_job;
+    int m_nbands;
+    int m_next_band;
+    int m_ndone;
+    bool m_bquit;
+
+    wxSemaphore m_work;
+    wxSemaphore m_done;
+    std::vector<RasterBandThread *> m_threads;
+};
+
+extern RasterBandPool *g_pRasterBandPool;
+
+#endif
@@ -0,0 +1,108 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Shared, size bounded cache of decoded raster chart tiles
+ * Author:   The OpenCPN developers
+ *
+ ***************************************************************************
+ *   Copyright (C) 2026 by the OpenCPN developers                          *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ *
+ */
+
+#ifndef __RASTERTILECACHE_H__
+#define __RASTERTILECACHE_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <map>
+
+#include <wx/thread.h>
+
+#define RASTER_TILE_SIZE        256     // tiles are square, in chart pixels
+
+//  One tile of decoded chart pixels, stored as palette indices, one byte per
+//  pixel in rows of RASTER_TILE_SIZE.  Tiles at the right and bottom edges
+//  of a chart keep the full size, only part of it is meaningful.
+struct RasterTile
+{
+    uint64_t key;
+    unsigned char *data;
+    int refs;
+    bool b_removed;                     // freed on the last Release()
+    RasterTile *prev, *next;            // LRU list, most recently used first
+};
+
+struct RasterTileCacheStats
+{
+    unsigned long hits;
+    unsigned long misses;
+    unsigned long evictions;
+    size_t bytes;
+    size_t budget;
+    int ntiles;
+};
+
+//  Decoded tiles of all open raster charts, dropped least recently used first
+//  once the byte budget is exceeded.  Each chart takes an owner id from
+//  NewOwner() and removes its tiles when it closes.
+//  Tiles handed out by Acquire() or Add() stay valid until Release(), so that
+//  pixels may be read without holding the cache lock.
+//  All members may be called from any thread.
+
+class RasterTileCache
+{
+public:
+    RasterTileCache( size_t budget );
+    ~RasterTileCache();
+
+    void SetBudget( size_t budget );
+    size_t GetBudget();
+    void GetStats( RasterTileCacheStats &stats );
+    void ResetStats();
+
+    int NewOwner();
+
+    RasterTile *Acquire( int owner, int tx, int ty );           // NULL on a miss
+    RasterTile *Add( int owner, int tx, int ty, unsigned char *data );   // takes data, malloc'ed
+    void Release( RasterTile *tile );
+    bool Contains( int owner, int tx, int ty );
+
+    void Remove( int owner, int ty_first = 0, int ty_last = -1 );
+
+    static size_t TileBytes() { return RASTER_TILE_SIZE * RASTER_TILE_SIZE; }
+
+private:
+    static uint64_t Key( int owner, int tx, int ty );
+    void Unlink( RasterTile *tile );
+    void PushFront( RasterTile *tile );
+    void Drop( RasterTile *tile );
+    void Trim();
+
+    wxCriticalSection m_lock;
+    std::map<uint64_t, RasterTile *> m_tiles;
+    RasterTile *m_head, *m_tail;
+    size_t m_bytes;
+    size_t m_budget;
+    int m_next_owner;
+    unsigned long m_hits, m_misses, m_evictions;
+};
+
+extern RasterTileCache *g_pRasterTileCache;
+
+#endif
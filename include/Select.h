@@ -24,6 +24,9 @@
 #ifndef __SELECT_H__
 #define __SELECT_H__
 
+#include <map>
+#include <vector>
+
 #include "SelectItem.h"
 #include "Route.h"
 
@@ -37,6 +40,17 @@
 #define SELTYPE_MARKPOINT            0x0080
 #define SELTYPE_TRACKSEGMENT         0x0100
 
+#define N_SELTYPES                   9          // bit positions above
+
+//  Selectable items are indexed by seltype in a few lat/lon grids of increasing cell size.
+//  Each item lives in the finest grid in which it spans at most two cells in each direction.
+//  Items larger than that, and segments crossing the dateline, are kept in a plain list.
+#define SELECT_GRID_LEVELS           4
+#define SELECT_GRID_LEVEL_OVERSIZE   SELECT_GRID_LEVELS
+
+typedef std::vector<SelectItem *> SelectItemArray;
+typedef std::map<wxInt64, SelectItemArray> SelectGrid;
+
 class TrackPoint;
 class Track;
 
@@ -76,6 +90,7 @@ public:
     bool DeleteAllPoints( void );
     bool DeleteSelectablePoint( void *data, int SeltypeToDelete );
     bool ModifySelectablePoint( float slat, float slon, void *data, int fseltype );
+    void ModifySelectableItem( SelectItem *pitem, float slat, float slon );
 
     //    Delete all selectable points in list by type
     bool DeleteAllSelectableTypePoints( int SeltypeToDelete );
@@ -92,9 +107,19 @@ public:
 private:
     void CalcSelectRadius();
 
+    void AddToIndex( SelectItem *pitem, bool b_append );
+    void IndexItem( SelectItem *pitem );
+    void UnindexItem( SelectItem *pitem );
+    void GetIndexCandidates( float slat, float slon, int fseltype, SelectItemArray &candidates );
+
     SelectableItemList *pSelectList;
     int pixelRadius;
     float selectRadius;
+
+    SelectGrid m_grid[N_SELTYPES][SELECT_GRID_LEVELS];
+    SelectItemArray m_oversize[N_SELTYPES];
+    wxInt64 m_head_order;
+    wxInt64 m_tail_order;
 };
 
 #endif
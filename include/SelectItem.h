@@ -46,6 +46,11 @@ public:
       void  *m_pData2;
       void  *m_pData3;
       int   m_Data4;
+
+      //  Spatial index bookkeeping, maintained by Select
+      int   m_index_level;                // -1 if not indexed
+      int   m_cell_x0, m_cell_y0, m_cell_x1, m_cell_y1;
+      wxInt64 m_order;                    // position in the select list, ascending
 };
 
 WX_DECLARE_LIST(SelectItem, SelectableItemList);// establish class as list member
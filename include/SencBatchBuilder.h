@@ -0,0 +1,103 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Batch creation of S57 SENC files on worker threads
+ * Author:   The OpenCPN developers
+ *
+ ***************************************************************************
+ *   Copyright (C) 2026 by the OpenCPN developers                          *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ *
+ */
+
+#ifndef __SENCBATCHBUILDER_H__
+#define __SENCBATCHBUILDER_H__
+
+#include <vector>
+
+#include <wx/string.h>
+#include <wx/thread.h>
+
+#include "chartbase.h"
+
+class S57ClassRegistrar;
+class SencBatchThread;
+
+#define SENC_BATCH_PENDING      -1      // SencBatchCell::result until the cell is done
+
+//  One cell to bring up to date, as known to the chart database
+struct SencBatchCell
+{
+    wxString path;
+    int scale;
+    Extent ext;
+    int result;                         // InitReturn of s57chart::FindOrCreateSenc()
+};
+
+//  Brings the SENCs of a list of cells up to date on worker threads.
+//  Each cell goes through s57chart::FindOrCreateSenc() on its own chart object,
+//  so a missing or stale SENC is built into a temporary file and renamed into
+//  place, an up to date one is left alone, and a failed cell costs only itself.
+//  Cells are taken in the order they were added; a cell that the main thread
+//  (or another builder) holds is passed over and taken up again later.
+//  Start() and the methods below are for the main thread; the counts may be
+//  polled while the build runs.
+
+class SencBatchBuilder
+{
+public:
+    SencBatchBuilder();
+    ~SencBatchBuilder();                // cancels and waits
+
+    void Add( const wxString &path, int scale, const Extent &ext );
+    bool Start( int nthreads );
+    void Cancel();                      // cells being built are finished, no new ones start
+    void Wait();
+    bool IsRunning();
+
+    int GetCount() { return m_cells.size(); }
+    int GetDoneCount();
+    int GetFailedCount();
+    wxString GetLastDone();             // path of the most recently finished cell
+    const SencBatchCell &GetCell( int i ) { return m_cells[i]; }    // after Wait()
+
+    static int GetDefaultThreadCount();
+
+private:
+    friend class SencBatchThread;
+
+    int NextCell();                     // -1: nothing left, -2: only cells held elsewhere
+    void CellDone( int i, int result );
+
+    std::vector<SencBatchCell> m_cells;
+    std::vector<char> m_taken;
+    size_t m_first_open;                // all cells before this one are taken
+
+    std::vector<SencBatchThread *> m_threads;
+    std::vector<S57ClassRegistrar *> m_registrars;     // one per thread
+
+    wxCriticalSection m_lock;
+    int m_nactive;                      // threads still taking cells
+    int m_ndone;
+    int m_nfailed;
+    int m_last_done;
+    bool m_bcancel;
+    bool m_bstarted;
+};
+
+#endif
@@ -0,0 +1,78 @@
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Queue of NMEA sentences from a driver thread to the main thread
+ * Author:   The OpenCPN developers
+ *
+ ***************************************************************************
+ *   Copyright (C) 2026 by the OpenCPN developers                          *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ **************************************************************************/
+
+
+#ifndef __SENTENCERING_H__
+#define __SENTENCERING_H__
+
+#include <wx/thread.h>
+
+#include <string>
+#include <vector>
+
+#define SENTENCE_RING_SLOTS         1024
+#define SENTENCE_RING_SLOT_SIZE     256         // longest sentence carried, including terminator
+
+/**
+ * A fixed size queue of NMEA sentences from one producer thread to the main thread.
+ *
+ * Sentences are copied into preallocated slots, so queueing does not allocate.
+ * The consumer takes sentences in batches, and is only signalled when the queue
+ * goes from idle to busy, so a stream costs one pending event at a time
+ * rather than one per sentence.
+ */
+class SentenceRing
+{
+public:
+    SentenceRing();
+    ~SentenceRing();
+
+    //  Producer side.
+    //  Returns false if the sentence could not be queued, either because it does not
+    //  fit in a slot, or because the ring is full, in which case it is counted as dropped.
+    //  On success, *pb_signal is set if the consumer must be notified.
+    bool Put( const char *sentence, bool *pb_signal );
+
+    //  Consumer side.
+    //  Moves up to max_count sentences into batch, reusing its strings.
+    //  Returns the number of sentences taken.  *pb_more is set if the ring is still
+    //  not empty, in which case the consumer remains signalled and must come back.
+    size_t GetBatch( std::vector<std::string> &batch, size_t max_count, bool *pb_more );
+
+    //  Number of sentences dropped since the last call
+    unsigned long TakeDropCount();
+
+private:
+    char                *m_slots;
+    size_t              m_put;
+    size_t              m_take;
+    size_t              m_count;
+    bool                m_bsignalled;
+    unsigned long       m_drops;
+
+    wxCriticalSection   m_critical;
+};
+
+#endif
@@ -0,0 +1,80 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Packed R-tree of bounding boxes
+ * Author:   The OpenCPN developers
+ *
+ ***************************************************************************
+ *   Copyright (C) 2026 by the OpenCPN developers                          *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ *
+ */
+
+#ifndef __SPATIALINDEX_H__
+#define __SPATIALINDEX_H__
+
+#include <cstddef>
+#include <vector>
+
+//  One indexed box.  At leaf level "id" is the caller's item id,
+//  at upper levels it is the index of the first child in the level below.
+struct SpatialIndexEntry
+{
+    float minx, miny, maxx, maxy;
+    int   id;
+};
+
+//  A Sort-Tile-Recursive packed R-tree over axis aligned boxes.
+//  Items are identified by an integer id supplied by the caller.
+//  Insertions go to a small linear overflow list which is merged into
+//  the packed tree when it grows too large, so that incremental updates
+//  stay cheap while queries remain O(log n + k).
+//  Coordinates are arbitrary; lat/lon users pass x = lon, y = lat.
+
+class SpatialIndex
+{
+public:
+    SpatialIndex();
+
+    void Clear();
+    void Reserve( size_t n );
+    bool IsEmpty() const { return GetCount() == 0; }
+    size_t GetCount() const;
+
+    //  Bulk loading: Add() any number of items, then Build()
+    void Add( int id, float minx, float miny, float maxx, float maxy );
+    void Build();
+
+    //  Incremental maintenance, usable at any time
+    void Insert( int id, float minx, float miny, float maxx, float maxy );
+    bool Remove( int id );
+    void Renumber( int first_id, int delta );   // id += delta for all id >= first_id
+
+    //  Queries append matching ids to "ids", in no particular order
+    void Query( float x, float y, std::vector<int> &ids ) const;
+    void Query( float minx, float miny, float maxx, float maxy, std::vector<int> &ids ) const;
+
+private:
+    void Pack( std::vector<SpatialIndexEntry> &level, std::vector<SpatialIndexEntry> &parent );
+
+    std::vector< std::vector<SpatialIndexEntry> > m_levels;    // [0] are the leaves
+    std::vector<SpatialIndexEntry> m_pending;                  // not yet packed
+    size_t m_nremoved;
+};
+
+#endif
@@ -49,6 +49,7 @@
 #include "navutil.h"
 #include "OCPN_Sound.h"
 #include "AIS_Bitstring.h"
+#include "AISTargetStore.h"
 #include "AISTargetListDialog.h"
 
 //    Constants
@@ -142,18 +143,6 @@ typedef enum ais_alert_type
 
 }_ais_alarm_type;
 
-class AISTargetTrackPoint
-{
-      public:
-            double      m_lat;
-            double      m_lon;
-            time_t      m_time;
-};
-
-
-WX_DECLARE_LIST(AISTargetTrackPoint, AISTargetTrackList);
-
-
 
 // IMO Circ. 289 Area Notices, based on libais
 const size_t AIS8_001_22_NUM_NAMES=128;
@@ -218,11 +207,6 @@ WX_DECLARE_HASH_MAP( int, Ais8_001_22, wxIntegerHash, wxIntegerEqual, AIS_Area_N
 //---------------------------------------------------------------------------------
 WX_DEFINE_SORTED_ARRAY(AIS_Target_Data *, ArrayOfAISTarget);
 
-
-//      Implement the AISTargetList as a wxHashMap
-
-WX_DECLARE_HASH_MAP( int, AIS_Target_Data*, wxIntegerHash, wxIntegerEqual, AIS_Target_Hash );
-
 wxString trimAISField( char *data );
 wxString ais_get_status(int index);
 wxString ais_get_type(int index);
@@ -157,6 +157,8 @@ public:
 
       virtual wxString GetPubDate(){ return m_PubYear;}
       virtual int GetNativeScale(){ return m_Chart_Scale;}
+      //  Memory held by this chart that it can account for, in KB, or 0 if unknown
+      virtual int GetMemoryUsageKB(void){ return 0; }
       wxString GetFullPath() const { return m_FullPath;}
       wxString GetName(){ return m_Name;}
       wxString GetDescription() { return m_Description;}
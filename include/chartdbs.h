@@ -27,10 +27,12 @@
 #define __CHARTDBS_H__
 
 #include <map>
+#include <vector>
 
 #include "ocpn_types.h"
 #include "bbox.h"
 #include "LLRegion.h"
+#include "SpatialIndex.h"
 
 class wxGenericProgressDialog;
 class ChartBase;
@@ -47,11 +49,64 @@ WX_DECLARE_OBJARRAY(ChartDirInfo, ArrayOfCDI);
 
 ///////////////////////////////////////////////////////////////////////
 
-static const int DB_VERSION_PREVIOUS = 17;
-static const int DB_VERSION_CURRENT = 18;
+static const int DB_VERSION_OLDEST = 17;          // oldest version still read and migrated
+static const int DB_VERSION_PREVIOUS = 18;
+static const int DB_VERSION_CURRENT = 19;
 
 class ChartDatabase;
 class ChartGroupArray;
+class MappedFile;
+
+//  Version 19 databases are laid out to be memory mapped and used in place:
+//
+//      ChartTableHeader
+//      ChartTableLayout_19
+//      int       [nDirEntries]     string pool offsets of the chart directories
+//      ChartTableEntry_onDisk_19 [nTableEntries]
+//      string pool                 NUL terminated UTF-8 paths
+//      ply pool                    4 byte aligned ply counts and lat/lon float pairs
+//
+//  All offsets are in bytes.  Table and pool offsets are from the start of the file,
+//  entry offsets are relative to the start of their pool.
+//  Checksum covers everything following the ChartTableLayout_19.
+
+struct ChartTableLayout_19
+{
+    int         EntrySize;
+    int         DirTableOffset;
+    int         EntryTableOffset;
+    int         StringPoolOffset;
+    int         StringPoolSize;
+    int         PlyPoolOffset;
+    int         PlyPoolSize;
+    unsigned int Checksum;
+};
+
+struct ChartTableEntry_onDisk_19
+{
+    int         PathOffset;
+    int         ChartType;
+    int         ChartFamily;
+    float       LatMax;
+    float       LatMin;
+    float       LonMax;
+    float       LonMin;
+
+    int         Scale;
+    int         edition_date;
+    int         file_date;
+
+    float       skew;
+    int         ProjectionType;
+    int         bValid;
+
+    int         nPlyEntries;
+    int         PlyOffset;                  // float pairs
+    int         nAuxPlyEntries;
+    int         AuxPlyOffset;               // counts, followed by the float pairs of each table
+    int         nNoCovrPlyEntries;
+    int         NoCovrPlyOffset;            // as above
+};
 
 struct ChartTableEntry_onDisk_18
 {
@@ -192,7 +247,11 @@ struct ChartTableEntry
     bool IsEqualTo(const ChartTableEntry &cte) const;
     bool IsEarlierThan(const ChartTableEntry &cte) const;
     bool Read(const ChartDatabase *pDb, wxInputStream &is);
-    bool Write(const ChartDatabase *pDb, wxOutputStream &os);
+    bool ReadFromPools(const ChartTableEntry_onDisk_19 &cte, const char *string_pool, size_t string_pool_size,
+                       const unsigned char *ply_pool, size_t ply_pool_size);
+    void WriteToPools(ChartTableEntry_onDisk_19 &cte, std::vector<unsigned char> &string_pool,
+                      std::vector<unsigned char> &ply_pool) const;
+    void DetachFromPools();
     void Clear();
     void Disable();
     void ReEnable();
@@ -213,7 +272,7 @@ struct ChartTableEntry
     
     const LLBBox &GetBBox() const { return m_bbox; } 
     
-    char *GetpFullPath() const { return pFullPath; }
+    const char *GetpFullPath() const { return pFullPath; }
     float GetLonMax() const { return LonMax; }
     float GetLonMin() const { return LonMin; }
     float GetLatMax() const { return LatMax; }
@@ -226,8 +285,8 @@ struct ChartTableEntry
 
     bool GetbValid(){ return bValid;}
     void SetEntryOffset(int n) { EntryOffset = n;}
-    const wxString *GetpFileName(void) const { return m_pfilename; }
-    wxString *GetpsFullPath(void){ return m_psFullPath; }
+    const wxString *GetpFileName(void) const;
+    wxString *GetpsFullPath(void);
     
     const ArrayOfInts &GetGroupArray(void) const { return m_GroupArray; }
     void ClearGroupArray(void) { m_GroupArray.Clear(); }
@@ -259,11 +318,14 @@ struct ChartTableEntry
     int         *pNoCovrCntTable;
     float       **pNoCovrPlyTable;
     
+    void MakeHelperStrings(void) const;
+
     ArrayOfInts m_GroupArray;
-    wxString    *m_pfilename;             // a helper member, not on disk
-    wxString    *m_psFullPath;
+    mutable wxString *m_pfilename;        // helper members, not on disk, created on first use
+    mutable wxString *m_psFullPath;
     LLBBox m_bbox;
     bool        m_bavail;
+    bool        m_bPoolBacked;            // path and ply tables point into a mapped database file
 };
 
 enum
@@ -296,9 +358,11 @@ WX_DECLARE_OBJARRAY(ChartClassDescriptor, ArrayOfChartClassDescriptor);
 
 class ChartDatabase
 {
+    friend class ChartTableEntryWorker;
+
 public:
     ChartDatabase();
-    virtual ~ChartDatabase(){};
+    virtual ~ChartDatabase();
 
     bool Create(ArrayOfCDI& dir_array, wxGenericProgressDialog *pprog);
     bool Update(ArrayOfCDI& dir_array, bool bForce, wxGenericProgressDialog *pprog);
@@ -344,13 +408,16 @@ public:
     wxString GetDBChartFileName(int dbIndex);
     void ApplyGroupArray(ChartGroupArray *pGroupArray);
     bool IsChartAvailable( int dbIndex );
+    void GetChartsAtPosition(float lat, float lon, std::vector<int> &db_indices) const;
     ChartTable    active_chartTable;
-    std::map <wxString, int> active_chartTable_pathindex;
+    std::map <wxString, int> active_chartTable_pathindex;     // built on demand, see FinddbIndex()
     
 protected:
     virtual ChartBase *GetChart(const wxChar *theFilePath, ChartClassDescriptor &chart_desc) const;
     int AddChartDirectory(const wxString &theDir, bool bshow_prog);
     void SetValid(bool valid) { bValid = valid; }
+    void BuildSpatialIndex(void);
+    void InvalidatePathIndex(void);
     ChartTableEntry *CreateChartTableEntry(const wxString &filePath, ChartClassDescriptor &chart_desc);
 
     ArrayOfChartClassDescriptor    m_ChartClassDescriptorArray;
@@ -358,8 +425,14 @@ protected:
 
 private:
     bool IsChartDirUsed(const wxString &theDir);
+    bool ReadMapped(MappedFile *pmap);
+    bool ReadStream(const wxString &filePath);
+    void ReleaseMappedDB(void);
 
     int SearchDirAndAddCharts(wxString& dir_name_base, ChartClassDescriptor &chart_desc, wxGenericProgressDialog *pprog);
+    int BuildChartTableEntries(const wxArrayString &FileList, const std::vector<char> &needed,
+                               ChartClassDescriptor &chart_desc, wxGenericProgressDialog *pprog,
+                               std::vector<ChartTableEntry *> &entries, std::vector<char> &built);
 
     int TraverseDirAndAddCharts(ChartDirInfo& dir_info, wxGenericProgressDialog *pprog, wxString& dir_magic, bool bForce);
     bool DetectDirChange(const wxString & dir_path, const wxString & magic, wxString &new_magic, wxGenericProgressDialog *pprog);
@@ -382,6 +455,10 @@ private:
     int         m_nentries;
 
     LLBBox m_dummy_bbox;
+
+    SpatialIndex m_chart_index;         // entry bounding boxes, keyed by dbIndex
+    MappedFile    *m_pMappedDB;         // backing store of pool backed entries
+    bool          m_bPathIndexValid;
 };
 
 
@@ -78,6 +78,7 @@ class ChartKAP;
 class ViewPort;
 class PixelCache;
 class ocpnBitmap;
+struct RasterTile;
 
 class wxFFileInputStream;
 
@@ -103,21 +104,6 @@ public:
 
 
 
-struct TileOffsetCache
-{
-    int offset; // offset from start of line pointer
-    int pixel; // offset from current pixel
-};
-
-class CachedLine
-{
-public:
-      unsigned char    *pPix;
-      TileOffsetCache  *pTileOffset; // entries for random access
-
-      bool              bValid;
-};
-
 class opncpnPalette
 {
     public:
@@ -210,17 +196,25 @@ protected:
 
       virtual void InvalidateLineCache();
       virtual bool CreateLineIndex(void);
+      InitReturn ReadLineIndex(void);
+      bool LoadLineIndexSidecar(void);
+      void SaveLineIndexSidecar(void);
+      wxString GetBitmapFilePath(void);
 
 
       virtual wxBitmap *CreateThumbnail(int tnx, int tny, ColorScheme cs);
       virtual int BSBGetScanline( unsigned char *pLineBuf, int y, int xs, int xl, int sub_samp);
+      int ReadRawLine(int y);
+      void DecodeLineIndices(const unsigned char *lp, const unsigned char *end,
+                             unsigned char *pCL, int width);
+      RasterTile *LoadRasterTiles(int ty, int tx_first, int tx_last);
 
 
       bool GetViewUsingCache( wxRect& source, wxRect& dest, const OCPNRegion& Region, ScaleTypeEnum scale_type );
       bool GetView( wxRect& source, wxRect& dest, ScaleTypeEnum scale_type );
 
 
-      virtual int BSBScanScanline(wxInputStream *pinStream);
+      virtual int BSBScanScanline(const unsigned char *&lp, const unsigned char *end);
       virtual int ReadBSBHdrLine( wxInputStream*, char *, int );
       virtual int AnalyzeRefpoints(bool b_testSolution = true);
       virtual bool AnalyzeSkew(void);
@@ -272,7 +266,7 @@ protected:
       int         nColorSize;
       int         *pline_table;           // pointer to Line offset table
 
-      CachedLine  *pLineCache;
+      int         m_tile_owner;           // our id in the raster tile cache
 
       wxInputStream    *ifs_hdr;
       wxInputStream    *ifss_bitmap;
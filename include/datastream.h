@@ -114,14 +114,21 @@ enum {
 
 // Class declarations
 class OCP_DataStreamInput_Thread;
+class SentenceRing;
 class DataStream;
 class GarminProtocolHandler;
 
 extern  const wxEventType wxEVT_OCPN_DATASTREAM;
+extern  const wxEventType wxEVT_OCPN_DATASTREAMQUEUE;
 extern  const wxEventType wxEVT_OCPN_THREADMSG;
 
 bool CheckSumCheck(const std::string& sentence);
 
+//      The part of a sentence examined by filters and routing, characters 1..5,
+//      e.g. "GPRMC" of "$GPRMC,...".  Missing characters are set to 0.
+#define DS_SENTENCE_KEY_LENGTH  5
+void GetSentenceKey(const wxString& sentence, char *key);
+
 //----------------------------------------------------------------------------
 // DataStream
 //
@@ -153,7 +160,7 @@ public:
     void Close(void);
 
     bool IsOk(){ return m_bok; }
-    wxString GetPort(){ return m_portstring; }
+    const wxString &GetPort(){ return m_portstring; }
     dsPortType GetIoSelect(){ return m_io_select; }
     int GetPriority(){ return m_priority; }
     void *GetUserData(){ return m_user_data; }
@@ -171,11 +178,15 @@ public:
 
     void SetChecksumCheck(bool check) { m_bchecksumCheck = check; }
 
-    void SetInputFilter(wxArrayString filter) { m_input_filter = filter; }
-    void SetInputFilterType(ListType filter_type) { m_input_filter_type = filter_type; }
-    void SetOutputFilter(wxArrayString filter) { m_output_filter = filter; }
-    void SetOutputFilterType(ListType filter_type) { m_output_filter_type = filter_type; }
+    void SetInputFilter(wxArrayString filter) { m_input_filter = filter; s_filter_serial++; }
+    void SetInputFilterType(ListType filter_type) { m_input_filter_type = filter_type; s_filter_serial++; }
+    void SetOutputFilter(wxArrayString filter) { m_output_filter = filter; s_filter_serial++; }
+    void SetOutputFilterType(ListType filter_type) { m_output_filter_type = filter_type; s_filter_serial++; }
     bool SentencePassesFilter(const wxString& sentence, FilterDirection direction);
+    bool SentencePassesFilter(const char *key, FilterDirection direction);
+
+    //  Changes whenever any stream is created or destroyed, or its filters are changed
+    static int GetFilterSerial(){ return s_filter_serial; }
     bool ChecksumOK(const std::string& sentence);
     bool GetGarminMode(){ return m_bGarmin_GRMN_mode; }
 
@@ -188,6 +199,9 @@ public:
     bool GetChecksumCheck(){ return m_bchecksumCheck; }
     ConnectionType GetConnectionType(){ return m_connection_type; }
 
+    //  Queue of received sentences, for streams read by a secondary thread
+    SentenceRing *GetSentenceRing(){ return m_pSentenceRing; }
+
     int                 m_Thread_run_flag;
 private:
     void Init(void);
@@ -208,6 +222,7 @@ private:
 
 
     OCP_DataStreamInput_Thread *m_pSecondary_Thread;
+    SentenceRing        *m_pSentenceRing;
     bool                m_bsec_thread_active;
     int                 m_last_error;
 
@@ -233,6 +248,7 @@ private:
     ConnectionType      m_connection_type;
 
     bool                m_bchecksumCheck;
+    static int          s_filter_serial;
     wxArrayString       m_input_filter;
     ListType            m_input_filter_type;
     wxArrayString       m_output_filter;
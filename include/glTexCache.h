@@ -32,10 +32,12 @@
 
 #include "ocpn_types.h"
 #include "bbox.h"
+#include "MappedFile.h"
+#include "glTexCatalog.h"
 
 class glTextureDescriptor;
 
-#define COMPRESSED_CACHE_MAGIC 0xf013  // change this when the format changes
+#define COMPRESSED_CACHE_MAGIC 0xf014  // change this when the format changes
 
 #define FACTORY_TIMER                   10000
 
@@ -49,44 +51,12 @@ struct CompressedCacheHeader
     uint32_t magic;
     uint32_t format;
     uint32_t chartdate;
-    uint32_t m_nentries;
+    uint32_t stamp;                 // pairs the file with its glTexCatalog record
     uint32_t catalog_offset;
     uint32_t chartfile_date;
     uint32_t chartfile_size;
 };
 
-struct CatalogEntryKey
-{
-    int         mip_level;
-    ColorScheme tcolorscheme;
-    int         x;
-    int         y;
-};
-
-struct CatalogEntryValue
-{
-    int         texture_offset;
-    uint32_t    compressed_size;
-}; 
-
-#define CATALOG_ENTRY_SERIAL_SIZE 6 * sizeof(uint32_t)
-
-class CatalogEntry
-{
-public:
-    CatalogEntry();
-    ~CatalogEntry();
-    CatalogEntry(int level, int x0, int y0, ColorScheme colorscheme);
-    int GetSerialSize();
-    void Serialize(unsigned char *);
-    void DeSerialize(unsigned char *);
-    CatalogEntryKey k;
-    CatalogEntryValue v;
-    
-};
-
-WX_DEFINE_ARRAY(CatalogEntry*, ArrayOfCatalogEntries);
-
 class glTexTile
 {
 public:
@@ -136,32 +106,29 @@ public:
     void PrepareTiles(const ViewPort &vp, bool use_norm_vp, ChartBase *pChart);
     glTexTile** GetTiles(int &num) { num = m_ntex; return m_tiles; }
     void GetCenter(double &lat, double &lon) { lat = m_clat, lon = m_clon; }
+    bool GetTileCenter(const wxRect &rect, double &lat, double &lon, double &radius);
 
 private:
     bool LoadCatalog(void);
     bool LoadHeader(void);
-    bool WriteCatalogAndHeader();
+    bool WriteHeader();
 
     bool UpdateCachePrecomp(unsigned char *data, int data_size, const wxRect &rect, int level,
-                                          ColorScheme color_scheme, bool write_catalog = true);
+                                          ColorScheme color_scheme, bool write_header = true);
     bool UpdateCacheLevel( const wxRect &rect, int level, ColorScheme color_scheme, unsigned char *data, int size);
     
     void DeleteSingleTexture( glTextureDescriptor *ptd );
 
-    CatalogEntryValue *GetCacheEntryValue(int level, int x, int y, ColorScheme color_scheme);
-    bool AddCacheEntryValue(const CatalogEntry &p);
+    bool GetCacheEntryValue(int level, int x, int y, ColorScheme color_scheme, glTexCatalogTile &v);
+    bool CacheTileKey(int level, int x, int y, ColorScheme color_scheme, uint32_t &key) const;
+    const unsigned char *MapCacheData(const glTexCatalogTile &v);
     int  ArrayIndex(int x, int y) const { return ((y / m_tex_dim) * m_stride) + (x / m_tex_dim); } 
-    void  ArrayXY(wxRect *r, int index) const;
-
-    int         n_catalog_entries;
-
-    CatalogEntryValue *m_cache[N_COLOR_SCHEMES][MAX_TEX_LEVEL];
-
-
 
     wxString    m_ChartPath;
     wxString    m_HashKey;
     wxString    m_CompressedCacheFilePath;
+    uint64_t    m_catalog_key;      // this chart in g_glTexCatalog
+    uint32_t    m_stamp;
     
     int         m_catalog_offset;
     bool        m_hdrOK;
@@ -170,7 +137,8 @@ private:
 
     bool	m_catalogCorrupted;
     
-    wxFFile     *m_fs;
+    wxFFile     *m_fs;              // appends, catalog and header writes
+    MappedFile  m_map;              // tile reads
     uint32_t    m_chart_date_binary;
     uint32_t    m_chartfile_date_binary;
     uint32_t    m_chartfile_size;
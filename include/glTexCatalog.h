@@ -0,0 +1,110 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Global catalog of compressed raster texture cache tiles
+ * Author:   The OpenCPN developers
+ *
+ ***************************************************************************
+ *   Copyright (C) 2026 by the OpenCPN developers                          *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ *
+ */
+
+#ifndef __GLTEXCATALOG_H__
+#define __GLTEXCATALOG_H__
+
+#include <stdint.h>
+#include <map>
+#include <set>
+
+#include <wx/string.h>
+#include <wx/hashmap.h>
+#include <wx/thread.h>
+
+#include "MappedFile.h"
+
+//  Where one cached tile lives in its chart's cache file
+struct glTexCatalogTile
+{
+    uint32_t offset;
+    uint32_t size;
+};
+
+//  What the catalog knows about one chart's cache file.
+//  "stamp" identifies the incarnation of the file the tiles were written to,
+//  "data_end" is the end of the tile data that the catalog covers.
+struct glTexCatalogChart
+{
+    uint32_t stamp;
+    uint32_t data_end;
+};
+
+WX_DECLARE_HASH_MAP( int, glTexCatalogTile, wxIntegerHash, wxIntegerEqual, glTexCatalogTileHash );
+
+//  One catalog for the tiles of all raster charts in the texture cache.
+//  The catalog file holds two open addressed tables, one of charts and one of
+//  tiles, and is mapped read-only so that a lookup costs a hash probe and no
+//  parsing.  Changes collect in memory and are merged into a new file by Save().
+//  All members may be called from the compression worker threads.
+
+class glTexCatalog
+{
+public:
+    glTexCatalog();
+    ~glTexCatalog();
+
+    bool Open( const wxString &path );
+    bool Save();
+    bool IsDirty();
+    void Clear();                       // forget everything, before the cache files are removed
+
+    static uint64_t ChartKey( const wxString &chart_path );
+    static bool TileKey( int level, int scheme, int tx, int ty, uint32_t &key );
+
+    bool FindChart( uint64_t chart, glTexCatalogChart &rec );
+    void SetChart( uint64_t chart, const glTexCatalogChart &rec );
+    void ResetChart( uint64_t chart, const glTexCatalogChart &rec );   // also forgets its tiles
+
+    bool FindTile( uint64_t chart, uint32_t tile, glTexCatalogTile &value );
+    void AddTile( uint64_t chart, uint32_t tile, const glTexCatalogTile &value );
+
+private:
+    struct PendingChart
+    {
+        PendingChart() : b_rec( false ), b_reset( false ) {}
+
+        glTexCatalogChart rec;
+        bool b_rec;
+        bool b_reset;                   // the tiles in the file no longer count
+        glTexCatalogTileHash tiles;
+    };
+
+    bool FindMappedChart( uint64_t chart, glTexCatalogChart &rec ) const;
+    bool FindMappedTile( uint64_t chart, uint32_t tile, glTexCatalogTile &value ) const;
+    void GatherLiveCharts( std::set<uint64_t> &live ) const;
+
+    wxCriticalSection m_lock;
+    wxString m_path;
+    MappedFile m_map;
+    std::map<uint64_t, PendingChart> m_pending;
+    bool m_bdirty;
+};
+
+extern glTexCatalog *g_glTexCatalog;
+
+#endif
@@ -27,9 +27,16 @@
 #ifndef __GLTEXTUREMANAGER_H__
 #define __GLTEXTUREMANAGER_H__
 
+#include <deque>
+#include <set>
+#include <vector>
+
+#include <wx/stopwatch.h>
+
 const wxEventType wxEVT_OCPN_COMPRESSIONTHREAD = wxNewEventType();
 
 class JobTicket;
+class glTextureManager;
 class wxGenericProgressDialog;
 
 WX_DECLARE_LIST(JobTicket, JobList);
@@ -49,14 +56,20 @@ public:
 
 
 
+//  A persistent worker, which runs tickets queued by glTextureManager until it is shut down
 class CompressionPoolThread : public wxThread
 {
 public:
-    CompressionPoolThread(JobTicket *ticket, wxEvtHandler *message_target);
+    CompressionPoolThread(glTextureManager *manager, wxEvtHandler *message_target);
     void *Entry();
     
     wxEvtHandler        *m_pMessageTarget;
     JobTicket           *m_ticket;
+
+private:
+    void RunJob();
+
+    glTextureManager    *m_pManager;
 };
 
 
@@ -107,6 +120,23 @@ public:
     bool        binplace;
     unsigned char *compcomp_bits_array[10];
     int         compcomp_size_array[10];
+
+    bool        b_located;              // tile position known, so the job may be ranked and cancelled
+    double      m_lat, m_lon;           // tile centre
+    double      m_radius;               // see glTexFactory::GetTileCenter()
+    double      m_priority;             // lower runs first
+
+    bool        b_prebuild;             // whole chart job of the background cache prebuild
+    double      m_progress;             // fraction of the chart done, for prebuild jobs
+};
+
+//  A snapshot of the background cache prebuild, for polling by the GUI
+struct PrebuildProgress
+{
+    bool        b_running;
+    int         charts_total;           // charts in this build, including those done before a restart
+    int         charts_done;
+    double      fraction;               // 0..1, counting partly built charts
 };
 
 
@@ -126,15 +156,27 @@ public:
                       bool b_throttle_thread, bool b_nolimit, bool b_postZip, bool b_inplace);
 
     int GetRunningJobCount(){ return running_list.GetCount(); }
-    int GetJobCount(){ return GetRunningJobCount() + todo_list.GetCount(); }
+    int GetJobCount(){ return GetRunningJobCount() + todo_list.size(); }
     bool AsJob( wxString const &chart_path ) const;
     void PurgeJobList( wxString chart_path = wxEmptyString );
     void ClearJobList();
+    void AbortAllJobs();
     void ClearAllRasterTextures(void);
     bool PurgeChartTextures(ChartBase *pc, bool b_purge_factory = false);
     bool TextureCrunch(double factor);
     bool FactoryCrunch(double factor);
     void BuildCompressedCache();
+
+    //  Background prebuild of the compressed cache for all raster charts.
+    //  Progress is kept on disk, so a stopped or interrupted build resumes.
+    void StartPrebuild();
+    void StopPrebuild();
+    bool IsPrebuilding() const { return m_bprebuild; }
+    PrebuildProgress GetPrebuildProgress() const;
+    bool ReleasePrebuildChart( const wxString &chart_path );
+
+    //  Called by the worker threads, returns NULL when the pool is shutting down
+    JobTicket *WaitForJob();
     
     //    This is a hash table
     //    key is Chart full path
@@ -145,11 +187,37 @@ private:
     bool DoJob( JobTicket *pticket );
     bool DoThreadJob(JobTicket* pticket);
     bool StartTopJob();
+    void PrioritizeJobs();
+    void StartWorkers();
+    void StopWorkers();
+
+    void PrebuildStep();
+    bool StartPrebuildJob( const wxString &chart_path );
+    void FinishPrebuildJob( JobTicket *ticket );
+    void WritePrebuildState();
+    void ThrottlePrebuild();
     
     JobList             running_list;
-    JobList             todo_list;
+    std::vector<JobTicket *> todo_list;     // most urgent first after PrioritizeJobs()
     int                 m_max_jobs;
 
+    //  The worker pool, and the tickets handed to it but not yet picked up
+    std::vector<CompressionPoolThread *> m_workers;
+    std::deque<JobTicket *> m_ready_list;
+    wxCriticalSection   m_ready_lock;
+    wxSemaphore         m_ready_semaphore;
+    bool                m_bstop_workers;
+
+    //  Background prebuild state
+    bool                m_bprebuild;
+    std::vector<wxString> m_prebuild_todo;      // nearest to ownship last
+    std::set<wxString>  m_prebuild_done;
+    std::vector<JobTicket *> m_prebuild_jobs;
+    int                 m_prebuild_total;
+    int                 m_prebuild_slots;       // jobs allowed to run now
+    int                 m_prebuild_calm_ticks;  // timer ticks without main thread lag
+    wxStopWatch         m_tick_watch;
+
     int		m_prevMemUsed;
 
     wxTimer     m_timer;
@@ -32,11 +32,32 @@
 #include "wx/wx.h"
 #endif //precompiled headers
 
+#include <map>
+#include <string>
+#include <vector>
+
 #include "pluginmanager.h"  // for PlugInManager
 #include "datastream.h"
 
 WX_DEFINE_ARRAY(DataStream *, wxArrayOfDataStreams);
 
+//      Routing of one kind of sentence, as identified by its sentence key.
+//      Filter results are kept as bitmasks over the first MUX_ROUTE_STREAMS
+//      entries of the stream array.  The checksum result belongs to the
+//      message being routed, and is set on the copy taken for it.
+#define MUX_ROUTE_STREAMS       32
+
+struct MuxRoute
+{
+    bool        b_ais;              // for the AIS consumer rather than the GPS consumer
+    bool        b_wpl;              // WPL, for the AIS consumer if g_bWplIsAprsPosition
+    wxUint32    input_pass;         // bit i set if stream i input filter passes the sentence
+    wxUint32    output_pass;        // bit i set if stream i output filter passes the sentence
+    bool        b_checksum_ok;      // the message passes the source's checksum check
+};
+
+typedef std::map<wxUint64, MuxRoute> MuxRouteTable;
+
 //      Garmin interface private error codes
 #define ERR_GARMIN_INITIALIZE           -1
 #define ERR_GARMIN_GENERAL              -2
@@ -64,17 +85,27 @@ class Multiplexer : public wxEvtHandler
         int SendWaypointToGPS(RoutePoint *prp, const wxString &com_name, wxGauge *pProgress);
 
         void OnEvtStream(OCPN_DataStreamEvent& event);
+        void OnEvtStreamQueue(OCPN_DataStreamEvent& event);
         
         void LogOutputMessage(const wxString &msg, wxString stream_name, bool b_filter);
         void LogOutputMessageColor(const wxString &msg, const wxString & stream_name, const wxString & color);
         void LogInputMessage(const wxString &msg, const wxString & stream_name, bool b_filter, bool b_error = false);
 
     private:
+        MuxRoute GetRoute(const char *key);
+        bool StreamPassesFilter(const MuxRoute &route, size_t index, DataStream *stream,
+                                const char *key, FilterDirection direction);
+
         wxArrayOfDataStreams *m_pdatastreams;
 
+        MuxRouteTable       m_routes;
+        int                 m_routes_serial;
+
         wxEvtHandler        *m_aisconsumer;
         wxEvtHandler        *m_gpsconsumer;
 
+        std::vector<std::string> m_sentence_batch;
+
         //      A set of temporarily saved parameters for a DataStream
         ConnectionType type_save;
         wxString port_save;
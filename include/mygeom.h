@@ -151,6 +151,7 @@ public:
         TriPrim         *tri_prim_head;         // head of linked list of TriPrims
         bool            m_bSMSENC;
         bool            bsingle_alloc;
+        bool            barena_alloc;           // pn_vertex, single_buffer and the TriPrims are in a chart arena
         unsigned char   *single_buffer;
         int             single_buffer_size;
         int             data_type;              //  p_vertex in TriPrim chain is FLOAT or DOUBLE
@@ -198,7 +198,6 @@ enum {
 #define STYLE_CHANGED 1024
 #define TIDES_CHANGED 2048
 #define GL_CHANGED 4096
-#define REBUILD_RASTER_CACHE 8192
 
 #ifndef wxCLOSE_BOX
 #define wxCLOSE_BOX 0x1000
@@ -777,21 +776,22 @@ class OpenGLOptionsDlg : private Uncopyable, public wxDialog {
   const bool GetShowFPS(void) const;
   const bool GetSoftwareGL(void) const;
   const bool GetTextureCompressionCaching(void) const;
-  const bool GetRebuildCache(void) const;
   const int GetTextureMemorySize(void) const;
 
  private:
   void Populate(void);
   void OnButtonRebuild(wxCommandEvent &event);
   void OnButtonClear(wxCommandEvent &event);
+  void OnRefreshTimer(wxTimerEvent &event);
+  void UpdatePrebuildStatus(void);
   const wxString GetTextureCacheSize(void);
 
   wxCheckBox *m_cbUseAcceleratedPanning, *m_cbTextureCompression;
   wxCheckBox *m_cbTextureCompressionCaching, *m_cbShowFPS, *m_cbSoftwareGL;
   wxSpinCtrl *m_sTextureDimension, *m_sTextureMemorySize;
-  wxStaticText *m_cacheSize, *m_memorySize;
-
-  bool m_brebuild_cache;
+  wxStaticText *m_cacheSize, *m_memorySize, *m_prebuildStatus;
+  wxButton *m_btnRebuild;
+  wxTimer m_refreshTimer;
 
   DECLARE_EVENT_TABLE()
 };
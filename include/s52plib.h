@@ -48,6 +48,11 @@ WX_DEFINE_SORTED_ARRAY( LUPrec *, wxArrayOfLUPrec );
 
 WX_DECLARE_LIST( S52_TextC, TextObjList );
 
+//    Screen space bucket grid over the placed (decluttered) text rectangles
+typedef std::vector<S52_TextC *> TextCellArray;
+WX_DECLARE_HASH_MAP( int, TextCellArray, wxIntegerHash, wxIntegerEqual, TextCellHash );
+WX_DECLARE_VOIDPTR_HASH_MAP( int, TextObjHash );
+
 struct CARC_Buffer {
     unsigned char color[3][4];
     float line_width[3];
@@ -314,6 +319,8 @@ private:
         wxRect *pRectDrawn, S57Obj *pobj, bool bCheckOverlap, ViewPort *vp );
 
     bool CheckTextRectList( const wxRect &test_rect, S52_TextC *ptext );
+    void AddTextRectCells( S52_TextC *ptext );
+    void ClearTextRectCells( void );
     int RenderT_All( ObjRazRules *rzRules, Rules *rules, ViewPort *vp,	bool bTX );
 
     int PrioritizeLineFeature( ObjRazRules *rzRules, int npriority );
@@ -364,6 +371,8 @@ private:
     int m_colortable_index_save;
 
     TextObjList m_textObjList;
+    TextCellHash m_textCells;           // cell key -> texts whose rText touches the cell
+    TextObjHash m_textObjMember;        // texts currently in m_textObjList
 
     wxString m_ColorScheme;
 
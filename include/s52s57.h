@@ -34,10 +34,11 @@
 
 #include <vector>
 
-#define CURRENT_SENC_FORMAT_VERSION  200
+#define CURRENT_SENC_FORMAT_VERSION  201           // 201 adds FEATURE_RCID_RECORD
 
 //    Fwd Defns
 class wxArrayOfS57attVal;
+class ChartArena;
 class OGREnvelope;
 class OGRGeometry;
 
@@ -182,6 +183,15 @@ typedef struct _Rules{
 
 // LOOKUP MODULE CLASS
 
+//  A LUP attribute test, pre-parsed from ATTCArray for s52plib::FindBestLUP
+typedef struct _LUPAttrMatch{
+   wxUint64       code;             // 6 char attribute acronym, packed as an integer
+   char          *value;            // attribute value string, following the acronym
+   int            ival;             // value as integer, for OGR_INT
+   float          fval;             // value as float, for OGR_REAL
+   bool           bvalid;           // false if the LUP attribute string is unusable
+}LUPAttrMatch;
+
 class LUPrec{
 public:
    int            RCID;             // record identifier
@@ -191,6 +201,7 @@ public:
    RadPrio        RPRI;             // 'O' or 'S', Radar Priority
    LUPname        TNAM;             // FTYP:  areas, points, lines
    wxArrayString *ATTCArray;        // ArrayString of LUP Attributes
+   LUPAttrMatch  *ATTCMatch;        // ATTCArray pre-parsed, built on first lookup
    wxString       *INST;            // Instruction Field (rules)
    DisCat         DISC;             // Display Categorie: D/S/O, DisplayBase, Standard, Other
    int            LUCM;             // Look-Up Comment (PLib3.x put 'groupes' here,
@@ -350,11 +361,14 @@ public:
       bool SetAreaGeometry( PolyTessGeo *ppg, double ref_lat, double ref_lon);
       bool SetMultipointGeometry( MultipointGeometryDescriptor *pGeo, double ref_lat, double ref_lon);
       
-      
+      //  Use instead of delete, for objects which may have been placed in a chart arena
+      static void Destroy( S57Obj *obj );
           
       // Private Methods
 private:
       void Init();
+      void *AllocAttr( size_t size );
+      S57attVal *NewAttVal( void );
     
 public:
       // Instance Data
@@ -386,6 +400,7 @@ public:
 
       Rules                   *CSrules;               // per object conditional symbology
       int                     bCS_Added;
+      unsigned int            CSdeps;                 // mariner parameters read by the CS, one bit per S52_MAR_param_t
 
       S52_TextC               *FText;
       int                     bFText_Added;
@@ -417,6 +432,7 @@ public:
       double                  y_origin;
       
       chart_context           *m_chart_context;       // per-chart constants, carried in each object for convenience
+      ChartArena              *m_arena;               // if set, holds this object, its attribute records and geometry buffers
       int auxParm0;                                   // some per-object auxiliary parameters, used for OpenGL
       int auxParm1;
       int auxParm2;
@@ -67,4 +67,8 @@ typedef enum _S52_MAR_param_t {
 
 extern double S52_getMarinerParam(S52_MAR_param_t param);
 extern int    S52_setMarinerParam(S52_MAR_param_t param, double val);
+
+//  Bit set, one bit per S52_MAR_param_t, of the parameters read since the last clear
+extern unsigned int S52_getMarinerParamUsage(void);
+extern void   S52_clearMarinerParamUsage(void);
 #endif
@@ -27,6 +27,8 @@
 
 #include <wx/string.h>
 
+class S57ClassRegistrar;
+
 WX_DECLARE_STRING_HASH_MAP( int, CSVHash1 );
 
 WX_DECLARE_HASH_MAP( int,
@@ -49,12 +51,18 @@ public:
     int getAttributeID(const char *pAttrName);
     std::string getAttributeAcronym(int nID);
     std::string getFeatureAcronym(int nID);
+
+    //  A private registrar for a thread that ingests cells besides the main thread,
+    //  since a registrar holds the currently selected class.  Caller deletes.
+    S57ClassRegistrar *CreateRegistrar();
     
 private:
     
     bool s57_attr_init( const wxString& csv_dir );
     bool s57_feature_init( const wxString& csv_dir );
     
+    wxString       m_csv_dir;
+
     CSVHash1       m_attrHash1;
     CSVHash2       m_attrHash2;
 
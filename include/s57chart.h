@@ -48,6 +48,9 @@
 #include "OCPNRegion.h"
 #include "ocpndc.h"
 #include "viewport.h"
+#include "SpatialIndex.h"
+#include "ChartArena.h"
+#include "s52utils.h"
 
 // ----------------------------------------------------------------------------
 // Useful Prototypes
@@ -122,6 +125,7 @@ public:
       bool UpdateThumbData(double lat, double lon);
 
       virtual int GetNativeScale(){return m_Chart_Scale;}
+      virtual int GetMemoryUsageKB(void);
       virtual double GetNormalScaleMin(double canvas_scale_factor, bool b_allow_overzoom);
       virtual double GetNormalScaleMax(double canvas_scale_factor, int canvas_width);
 
@@ -226,7 +230,7 @@ public:
       wxString GetISDT(void);
 
       char GetUsageChar(void){ return m_usage_char; }
-      static bool IsCellOverlayType(char *pFullPath);
+      static bool IsCellOverlayType(const char *pFullPath);
 
       bool        m_b2pointLUPS;
       bool        m_b2lineLUPS;
@@ -234,6 +238,13 @@ public:
       struct _chart_context     *m_this_chart_context;
 
       InitReturn FindOrCreateSenc( const wxString& name, bool b_progress = true );
+      void SetSENCRegistrar( S57ClassRegistrar *poRegistrar ){ m_pSENCRegistrar = poRegistrar; }
+
+      //  SENC creation copies a cell and its updates into the SENC directory by cell name,
+      //  so cells of the same name are built (and their SENC read) by one thread at a time
+      static bool TryLockSENCCell( const wxString& name );
+      static void LockSENCCell( const wxString& name );
+      static void UnlockSENCCell( const wxString& name );
       
 protected:
     void AssembleLineGeometry( void );
@@ -252,7 +263,8 @@ private:
       
 
       InitReturn PostInit( ChartInitFlag flags, ColorScheme cs );
-      int BuildSENCFile(const wxString& FullPath000, const wxString& SENCFileName, bool b_progress = true);
+      int BuildSENCFile(const wxString& FullPath000, const wxString& SENCFileName, bool b_progress = true,
+                        bool b_updates_only = false);
       
       void SetLinePriorities(void);
 
@@ -273,6 +285,10 @@ private:
       void FreeObjectsAndRules();
       const char *getName(OGRFeature *feature);
 
+      void BuildPickIndex( void );
+      void BuildRenderIndex( void );
+      void PrepareRenderLists( ViewPort &vp );
+
       bool DoRenderOnGL(const wxGLContext &glc, const ViewPort& VPoint);
       bool DoRenderOnGLText(const wxGLContext &glc, const ViewPort& VPoint);
       bool DoRenderRegionViewOnGL(const wxGLContext &glc, const ViewPort& VPoint,
@@ -287,6 +303,53 @@ private:
       wxString    m_SENCFileName;
       ObjRazRules *razRules[PRIO_NUM][LUPNAME_NUM];
 
+      //  Area and line rules for GetObjRuleListAtLatLon(), indexed by object bounding box.
+      //  Ids follow the order of the razRules lists, so sorting them restores pick order.
+      struct PickIndexItem{
+          ObjRazRules *rules;
+          int         prio;
+          int         lup_type;
+      };
+      std::vector<PickIndexItem> m_pick_items;
+      SpatialIndex m_pick_index;
+      bool        m_bPickIndexValid;
+
+      //  Rules indexed for culling the render passes.  Line, area and multipoint rules
+      //  are indexed by object bounding box.  Rendering may change an object's box
+      //  (symbol and text extents), so the box indexed is kept, and objects whose box
+      //  has since changed are "loose", i.e. always offered to the renderer until the
+      //  next rebuild.  Single point boxes follow the display scale, so points are
+      //  indexed by their anchor, and looked for as far out as their boxes reach.
+      struct RenderIndexItem{
+          ObjRazRules *rules;
+          int         prio;
+          int         lup_type;
+          double      minlat, minlon, maxlat, maxlon;
+          bool        bloose;
+          bool        bpoint;
+      };
+      void ExtendPointReach( const RenderIndexItem &item, double view_scale_ppm );
+
+      std::vector<RenderIndexItem> m_render_items;
+      SpatialIndex m_render_index;
+      SpatialIndex m_render_point_index;
+      double      m_render_point_reach_lat;         // degrees at 1 pixel per meter
+      double      m_render_point_reach_lon;
+      std::vector<int> m_render_loose;
+      std::vector<int> m_render_visited;                // candidates of the last pass
+      std::vector<ObjRazRules *> m_render_list[PRIO_NUM][LUPNAME_NUM];
+      bool        m_bRenderIndexValid;
+
+      //  The view m_render_list was prepared for
+      bool        m_bRenderListsValid;
+      int         m_render_point_list;
+      double      m_render_vp_ppm;
+      double      m_render_vp_minlat, m_render_vp_minlon, m_render_vp_maxlat, m_render_vp_maxlon;
+
+      //  Top level rules, and the SENC objects with their attribute records,
+      //  area tessellations and line segments, released together
+      ChartArena  m_arena;
+
 
       wxArrayString *m_tmpup_array;
       PixelCache   *pDIB;
@@ -324,16 +387,25 @@ private:
       wxString    m_lastColorScheme;
       wxRect      m_last_vprect;
       long        m_plib_state_hash;
+
+      //  The CS inputs as of the last UpdateLUPs()
+      bool        m_bCSParamsValid;
+      double      m_CSMarinerParams[S52_MAR_NUM];
+      int         m_CSSymbolStyle;
+      int         m_CSBoundaryStyle;
+      int         m_CSDepthUnit;
       bool        m_btex_mem;
       char        m_usage_char;
       
       double      m_next_safe_cnt;
       double      m_LOD_meters;
+      S57ClassRegistrar *m_pSENCRegistrar;      // for BuildSENCFile(), default g_poRegistrar
 
       int         m_LineVBO_name;
       
       VE_Hash     m_ve_hash;
       VC_Hash     m_vc_hash;
+      bool        m_bVEPointsInPlace;           // edge points borrowed from the SENC image, not malloc'd
       std::vector<connector_segment *> m_pcs_vector;
       std::vector<VE_Element *> m_pve_vector;
       
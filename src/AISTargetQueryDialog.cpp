@@ -134,7 +134,8 @@ void AISTargetQueryDialog::OnIdTrkCreateClick( wxCommandEvent& event )
         {
             if ( td->b_PersistTrack ) //The target was tracked and the user wants to stop it
             {
-                td->b_PersistTrack = false;
+                AIS_Target_Hash *targets = g_pAIS->GetTargetList();
+                targets->SetPersistTrack( targets->find( td->MMSI ), false );
                 g_pAIS->m_persistent_tracks.erase(td->MMSI);
                 m_createTrkBtn->SetLabel(_("Record Track"));
             }
@@ -146,19 +147,17 @@ void AISTargetQueryDialog::OnIdTrkCreateClick( wxCommandEvent& event )
                 Track *t = new Track();
 
                 t->m_TrackNameString = wxString::Format( _T("AIS %s (%u) %s %s"), td->GetFullName().c_str(), td->MMSI, wxDateTime::Now().FormatISODate().c_str(), wxDateTime::Now().FormatISOTime().c_str() );
-                wxAISTargetTrackListNode *node = td->m_ptrack->GetFirst();
-                while( node )
+                for( size_t i = 0; i < td->m_ptrack->GetCount(); i++ )
                 {
-                    AISTargetTrackPoint *ptrack_point = node->GetData();
-                    vector2D point( ptrack_point->m_lon, ptrack_point->m_lat );
-                    tp1 = t->AddNewPoint( point, wxDateTime(ptrack_point->m_time).ToUTC() );
+                    const AISTargetTrackPoint &track_point = td->m_ptrack->Item( i );
+                    vector2D point( track_point.m_lon, track_point.m_lat );
+                    tp1 = t->AddNewPoint( point, wxDateTime(track_point.m_time).ToUTC() );
                     if( tp )
                     {
                         pSelect->AddSelectableTrackSegment( tp->m_lat, tp->m_lon, tp1->m_lat,
                             tp1->m_lon, tp, tp1, t );
                     }
                     tp = tp1;
-                    node = node->GetNext();
                 }
                 
                 pTrackList->Append( t );
@@ -173,7 +172,8 @@ void AISTargetQueryDialog::OnIdTrkCreateClick( wxCommandEvent& event )
                     _("The recently captured track of this target has been recorded.\nDo you want to continue recording until the end of the current OpenCPN session?"),
                     _("OpenCPN Info"), wxYES_NO | wxCENTER, 60 ) )
                 {
-                    td->b_PersistTrack = true;
+                    AIS_Target_Hash *targets = g_pAIS->GetTargetList();
+                    targets->SetPersistTrack( targets->find( td->MMSI ), true );
                     g_pAIS->m_persistent_tracks[td->MMSI] = t;
                 }
             }
@@ -0,0 +1,345 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  AIS target table and track history
+ * Author:   The OpenCPN developers
+ *
+ ***************************************************************************
+ *   Copyright (C) 2026 by the OpenCPN developers                          *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ *
+ */
+
+#include "AISTargetStore.h"
+#include "AIS_Target_Data.h"
+
+#define AIS_TRACK_MIN_CAPACITY 16
+#define AIS_HASH_MIN_CAPACITY 64
+
+enum {
+    AIS_SLOT_EMPTY = 0,
+    AIS_SLOT_USED,
+    AIS_SLOT_ERASED
+};
+
+//-----------------------------------------------------------------------------
+//      AISTargetTrack
+//-----------------------------------------------------------------------------
+
+AISTargetTrack::AISTargetTrack()
+{
+    m_first = 0;
+    m_count = 0;
+}
+
+void AISTargetTrack::Append( double lat, double lon, time_t time )
+{
+    if( m_count == m_points.size() )
+        Grow();
+
+    AISTargetTrackPoint &point = m_points[( m_first + m_count ) & ( m_points.size() - 1 )];
+    point.m_lat = lat;
+    point.m_lon = lon;
+    point.m_time = time;
+    m_count++;
+}
+
+//  Reports arrive in time order, so expired points are always at the front
+void AISTargetTrack::RemoveOlderThan( time_t time )
+{
+    while( m_count && m_points[m_first].m_time < time ) {
+        m_first = ( m_first + 1 ) & ( m_points.size() - 1 );
+        m_count--;
+    }
+    if( !m_count )
+        m_first = 0;
+}
+
+void AISTargetTrack::Clear()
+{
+    m_first = 0;
+    m_count = 0;
+}
+
+void AISTargetTrack::Grow()
+{
+    size_t capacity = m_points.size() ? m_points.size() * 2 : AIS_TRACK_MIN_CAPACITY;
+    std::vector<AISTargetTrackPoint> points( capacity );
+    for( size_t i = 0; i < m_count; i++ )
+        points[i] = Item( i );
+
+    m_points.swap( points );
+    m_first = 0;
+}
+
+//-----------------------------------------------------------------------------
+//      AIS_Target_Hot
+//-----------------------------------------------------------------------------
+
+static void ResizeHot( AIS_Target_Hot &hot, size_t n )
+{
+    hot.lat.resize( n );
+    hot.lon.resize( n );
+    hot.sog.resize( n );
+    hot.cog.resize( n );
+    hot.range.resize( n );
+    hot.brg.resize( n );
+    hot.cpa.resize( n );
+    hot.tcpa.resize( n );
+    hot.posn_ticks.resize( n );
+    hot.cls.resize( n );
+    hot.flags.resize( n );
+    hot.track.resize( n );
+}
+
+static void SwapHot( AIS_Target_Hot &a, AIS_Target_Hot &b )
+{
+    a.lat.swap( b.lat );
+    a.lon.swap( b.lon );
+    a.sog.swap( b.sog );
+    a.cog.swap( b.cog );
+    a.range.swap( b.range );
+    a.brg.swap( b.brg );
+    a.cpa.swap( b.cpa );
+    a.tcpa.swap( b.tcpa );
+    a.posn_ticks.swap( b.posn_ticks );
+    a.cls.swap( b.cls );
+    a.flags.swap( b.flags );
+    a.track.swap( b.track );
+}
+
+static void CopyHot( AIS_Target_Hot &to, size_t i, const AIS_Target_Hot &from, size_t j )
+{
+    to.lat[i] = from.lat[j];
+    to.lon[i] = from.lon[j];
+    to.sog[i] = from.sog[j];
+    to.cog[i] = from.cog[j];
+    to.range[i] = from.range[j];
+    to.brg[i] = from.brg[j];
+    to.cpa[i] = from.cpa[j];
+    to.tcpa[i] = from.tcpa[j];
+    to.posn_ticks[i] = from.posn_ticks[j];
+    to.cls[i] = from.cls[j];
+    to.flags[i] = from.flags[j];
+    to.track[i] = from.track[j];
+}
+
+//-----------------------------------------------------------------------------
+//      AIS_Target_Hash
+//-----------------------------------------------------------------------------
+
+AIS_Target_Hash::AIS_Target_Hash()
+{
+    m_count = 0;
+    m_nerased = 0;
+}
+
+//  MMSIs cluster by country prefix, so mix the bits before masking
+size_t AIS_Target_Hash::Slot( int mmsi ) const
+{
+    unsigned int h = (unsigned int) mmsi * 2654435761u;
+    h ^= h >> 15;
+    return h & ( m_slots.size() - 1 );
+}
+
+size_t AIS_Target_Hash::Lookup( int mmsi ) const
+{
+    size_t capacity = m_slots.size();
+    if( !capacity )
+        return capacity;
+
+    size_t mask = capacity - 1;
+    for( size_t i = Slot( mmsi ), n = 0; n < capacity; i = ( i + 1 ) & mask, n++ ) {
+        if( m_state[i] == AIS_SLOT_EMPTY )
+            break;
+        if( m_state[i] == AIS_SLOT_USED && m_slots[i].first == mmsi )
+            return i;
+    }
+    return capacity;
+}
+
+size_t AIS_Target_Hash::NextUsed( size_t index ) const
+{
+    while( index < m_slots.size() && m_state[index] != AIS_SLOT_USED )
+        index++;
+    return index;
+}
+
+AIS_Target_Hash::iterator AIS_Target_Hash::find( int mmsi )
+{
+    return iterator( this, Lookup( mmsi ) );
+}
+
+AIS_Target_Data *AIS_Target_Hash::Get( int mmsi )
+{
+    size_t i = Lookup( mmsi );
+    return ( i < m_slots.size() ) ? m_slots[i].second : NULL;
+}
+
+void AIS_Target_Hash::Set( int mmsi, AIS_Target_Data *td )
+{
+    size_t i = Lookup( mmsi );
+    if( i < m_slots.size() ) {
+        m_slots[i].second = td;
+        Refresh( i );
+        return;
+    }
+
+    //  Keep the load, tombstones included, at or below one half
+    if( ( m_count + m_nerased + 1 ) * 2 > m_slots.size() ) {
+        size_t capacity = m_slots.size() ? m_slots.size() : AIS_HASH_MIN_CAPACITY;
+        while( ( m_count + 1 ) * 2 > capacity )
+            capacity *= 2;
+        Rehash( capacity );
+    }
+
+    size_t mask = m_slots.size() - 1;
+    i = Slot( mmsi );
+    while( m_state[i] == AIS_SLOT_USED )
+        i = ( i + 1 ) & mask;
+
+    if( m_state[i] == AIS_SLOT_ERASED )
+        m_nerased--;
+    m_state[i] = AIS_SLOT_USED;
+    m_slots[i].first = mmsi;
+    m_slots[i].second = td;
+    m_count++;
+    Refresh( i );
+}
+
+void AIS_Target_Hash::erase( iterator it )
+{
+    size_t i = it.m_index;
+    if( i >= m_slots.size() || m_state[i] != AIS_SLOT_USED )
+        return;
+
+    m_state[i] = AIS_SLOT_ERASED;
+    m_slots[i].second = NULL;
+    m_hot.flags[i] = 0;
+    m_hot.track[i] = NULL;
+    m_count--;
+    m_nerased++;
+}
+
+size_t AIS_Target_Hash::erase( int mmsi )
+{
+    iterator it = find( mmsi );
+    if( it == end() )
+        return 0;
+    erase( it );
+    return 1;
+}
+
+void AIS_Target_Hash::clear()
+{
+    m_slots.clear();
+    m_state.clear();
+    ResizeHot( m_hot, 0 );
+    m_count = 0;
+    m_nerased = 0;
+}
+
+//  The mutators ignore end() and empty entries
+void AIS_Target_Hash::SetActive( iterator it, bool b_active )
+{
+    AIS_Target_Data *td = ( it.m_index < m_slots.size() ) ? it->second : NULL;
+    if( !td || td->b_active == b_active )
+        return;
+    td->b_active = b_active;
+    Refresh( it.m_index );
+}
+
+void AIS_Target_Hash::SetLost( iterator it )
+{
+    AIS_Target_Data *td = ( it.m_index < m_slots.size() ) ? it->second : NULL;
+    if( !td )
+        return;
+    td->b_lost = true;
+    td->b_positionOnceValid = false;
+    td->COG = 360.0;
+    td->SOG = 103.0;
+    td->HDG = 511.0;
+    td->ROTAIS = -128;
+    Refresh( it.m_index );
+}
+
+void AIS_Target_Hash::SetPersistTrack( iterator it, bool b_persist )
+{
+    AIS_Target_Data *td = ( it.m_index < m_slots.size() ) ? it->second : NULL;
+    if( !td )
+        return;
+    td->b_PersistTrack = b_persist;
+    Refresh( it.m_index );
+}
+
+void AIS_Target_Hash::Refresh( size_t i )
+{
+    const AIS_Target_Data *td = m_slots[i].second;
+    if( !td ) {
+        m_hot.flags[i] = 0;
+        m_hot.track[i] = NULL;
+        return;
+    }
+
+    m_hot.lat[i] = td->Lat;
+    m_hot.lon[i] = td->Lon;
+    m_hot.sog[i] = td->SOG;
+    m_hot.cog[i] = td->COG;
+    m_hot.range[i] = td->Range_NM;
+    m_hot.brg[i] = td->Brg;
+    m_hot.cpa[i] = td->CPA;
+    m_hot.tcpa[i] = td->TCPA;
+    m_hot.posn_ticks[i] = td->PositionReportTicks;
+    m_hot.cls[i] = td->Class;
+    m_hot.track[i] = td->m_ptrack;
+
+    unsigned char flags = 0;
+    if( td->b_positionOnceValid ) flags |= AIS_HOT_POSITION_VALID;
+    if( td->b_OwnShip ) flags |= AIS_HOT_OWNSHIP;
+    if( td->b_active ) flags |= AIS_HOT_ACTIVE;
+    if( td->b_lost ) flags |= AIS_HOT_LOST;
+    if( td->b_PersistTrack ) flags |= AIS_HOT_PERSIST_TRACK;
+    if( td->bCPA_Valid ) flags |= AIS_HOT_CPA_VALID;
+    m_hot.flags[i] = flags;
+}
+
+void AIS_Target_Hash::Rehash( size_t capacity )
+{
+    std::vector<value_type> slots( capacity, value_type( 0, (AIS_Target_Data *) NULL ) );
+    std::vector<unsigned char> state( capacity, (unsigned char) AIS_SLOT_EMPTY );
+
+    AIS_Target_Hot hot;
+    ResizeHot( hot, capacity );
+
+    m_slots.swap( slots );
+    m_state.swap( state );
+    SwapHot( m_hot, hot );
+    m_nerased = 0;
+
+    size_t mask = capacity - 1;
+    for( size_t j = 0; j < slots.size(); j++ ) {
+        if( state[j] != AIS_SLOT_USED )
+            continue;
+        size_t i = Slot( slots[j].first );
+        while( m_state[i] == AIS_SLOT_USED )
+            i = ( i + 1 ) & mask;
+        m_state[i] = AIS_SLOT_USED;
+        m_slots[i] = slots[j];
+        CopyHot( m_hot, i, hot, j );
+    }
+}
@@ -29,7 +29,17 @@
 
 AIS_Bitstring::AIS_Bitstring( const char *str )
 {
-    byte_length = strlen( str );
+    byte_length = wxMin( (int)strlen( str ), AIS_MAX_MESSAGE_LEN );
+
+    for( int i = 0; i < byte_length; i++ ) {
+        bitbytes[i] = to_6bit( str[i] );
+    }
+}
+
+//  Construct from a span of armoured payload, which need not be terminated
+AIS_Bitstring::AIS_Bitstring( const char *str, int len )
+{
+    byte_length = wxMin( len, AIS_MAX_MESSAGE_LEN );
 
     for( int i = 0; i < byte_length; i++ ) {
         bitbytes[i] = to_6bit( str[i] );
@@ -90,14 +100,11 @@ int AIS_Bitstring::GetInt(int sp, int len, bool signed_flag)
 
 int AIS_Bitstring::GetStr(int sp, int bit_len, char *dest, int max_len)
 {
-    //char temp_str[85];
-    char *temp_str = new char[max_len + 1];
-
     char acc = 0;
     int s0p = sp-1;                          // to zero base
 
     int k=0;
-    int cp, cx, c0, cs;
+    int cp, cx, c0;
 
     int i = 0;
     while(i < bit_len && k < max_len)
@@ -108,28 +115,20 @@ int AIS_Bitstring::GetStr(int sp, int bit_len, char *dest, int max_len)
             acc  = acc << 1;
             cp = (s0p + i) / 6;
             cx = bitbytes[cp];        // what if cp >= byte_length?
-            cs = 5 - ((s0p + i) % 6);
             c0 = (cx >> (5 - ((s0p + i) % 6))) & 1;
             acc |= c0;
 
             i++;
          }
-         temp_str[k] = (char)(acc & 0x3f);
+         dest[k] = (char)(acc & 0x3f);
 
          if(acc < 32)
-             temp_str[k] += 0x40;
+             dest[k] += 0x40;
          k++;
 
     }
 
-    temp_str[k] = 0;
-
-    int copy_len = wxMin((int)strlen(temp_str), max_len);
-    strncpy(dest, temp_str, copy_len);
     dest[k] = 0;
 
-    delete [] temp_str;
-
-    return copy_len;
+    return k;
 }
-
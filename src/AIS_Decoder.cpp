@@ -146,6 +146,10 @@ AIS_Decoder::AIS_Decoder( wxFrame *parent )
 
     m_n_targets = 0;
 
+    for( int i = 0; i < AIS_MULTIPART_SEQUENCES; i++ )
+        for( int j = 0; j < AIS_MULTIPART_CHANNELS; j++ )
+            m_multipart[i][j].nsentences = 0;
+
     m_parent_frame = parent;
 
     TimerAIS.SetOwner(this, TIMER_AIS1);
@@ -153,6 +157,8 @@ AIS_Decoder::AIS_Decoder( wxFrame *parent )
     
     m_ptentative_dsctarget = NULL;
     m_dsc_timer.SetOwner( this, TIMER_DSC );
+
+    CPA_ResolveRoutines();
     
 
     //  Create/connect a dynamic event handler slot for wxEVT_OCPN_DATASTREAM(s)
@@ -265,6 +271,26 @@ void AIS_Decoder::BuildERIShipTypeHash(void)
 //----------------------------------------------------------------------------------
 void AIS_Decoder::OnEvtAIS( OCPN_DataStreamEvent& event )
 {
+    //  VDM/VDO sentences make up nearly all of the traffic,
+    //  so decode them straight from the received bytes
+    const std::string &nmea = event.GetNMEAString();
+    const char *s = nmea.c_str();
+    size_t len = nmea.length();
+
+    if( s[0] == '\\' ) {                       // skip an NMEA V4 tag block
+        const char *tag_end = strchr( s + 1, '\\' );
+        if( tag_end ) {
+            len -= tag_end + 1 - s;
+            s = tag_end + 1;
+        }
+    }
+
+    if( ( len > 6 ) && !strchr( s, '\\' ) && !strncmp( s + 3, "VD", 2 ) && ( s[5] == 'M' || s[5] == 'O' ) ) {
+        DecodeVDx( s, len );
+        gFrame->TouchAISActive();
+        return;
+    }
+
     wxString message = event.ProcessNMEA4Tags();
 
     int nr = 0;
@@ -420,9 +446,6 @@ AIS_Error AIS_Decoder::DecodeSingleVDO( const wxString& str, GenericPosDatEx *po
 //----------------------------------------------------------------------------------------
 AIS_Error AIS_Decoder::Decode( const wxString& str )
 {
-    AIS_Error ret;
-    wxString string_to_parse;
-
     double gpsg_lat, gpsg_lon, gpsg_mins, gpsg_degs;
     double gpsg_cog, gpsg_sog, gpsg_utc_time;
     int gpsg_utc_hour = 0;
@@ -469,10 +492,16 @@ AIS_Error AIS_Decoder::Decode( const wxString& str )
     double aprs_mins, aprs_degs;
 
     AIS_Target_Data *pTargetData;
-    AIS_Target_Data *pStaleTarget = NULL;
     bool bnewtarget = false;
     int last_report_ticks;
     
+    if( str.Mid( 3, 2 ).IsSameAs( _T("VD") ) ) {
+        wxCharBuffer abuf = str.ToUTF8();
+        if( !abuf.data() )                            // badly formed sentence?
+            return AIS_GENERIC_ERROR;
+        return DecodeVDx( abuf.data(), strlen( abuf.data() ) );
+    }
+
     //  Make some simple tests for validity
 
     if( str.Len() > 100 ) return AIS_NMEAVDX_TOO_LONG;
@@ -730,354 +759,413 @@ AIS_Error AIS_Decoder::Decode( const wxString& str )
         }
         gpsg_mmsi = 199000000 + hash;  // 199 is INMARSAT-A MID, should not occur ever in AIS stream
         mmsi = gpsg_mmsi;
-    } else if( !str.Mid( 3, 2 ).IsSameAs( _T("VD") ) ) {
+    } else {
         return AIS_NMEAVDX_BAD;
     }
 
-    //  OK, looks like the sentence is OK
+    if( !mmsi )
+        return AIS_Partial;                     // nothing to report, e.g. OSD
 
-        //  Use a tokenizer to pull out the first 4 fields
-        wxString string( str );
-        wxStringTokenizer tkz( string, _T(",") );
+    pTargetData = PrepareTarget( mmsi, &bnewtarget, &last_report_ticks );
+    if( !pTargetData )
+        return AIS_NoError;                     // MMSI is ignored
 
-        wxString token;
-        token = tkz.GetNextToken();         // !xxVDx
+    wxDateTime now = wxDateTime::Now();
+    now.MakeGMT();
 
-        token = tkz.GetNextToken();
-        nsentences = atoi( token.mb_str() );
+    if( gpsg_mmsi ) {
+        pTargetData->PositionReportTicks = now.GetTicks();
+        pTargetData->StaticReportTicks = now.GetTicks();
+        pTargetData->m_utc_hour = gpsg_utc_hour;
+        pTargetData->m_utc_min = gpsg_utc_min;
+        pTargetData->m_utc_sec = gpsg_utc_sec;
+        pTargetData->m_date_string = gpsg_date;
+        pTargetData->MMSI = gpsg_mmsi;
+        pTargetData->NavStatus = 0; // underway
+        pTargetData->Lat = gpsg_lat;
+        pTargetData->Lon = gpsg_lon;
+        pTargetData->b_positionOnceValid = true;
+        pTargetData->COG = gpsg_cog;
+        pTargetData->SOG = gpsg_sog;
+        pTargetData->ShipType = 52; // buddy
+        pTargetData->Class = AIS_GPSG_BUDDY;
+        strncpy( pTargetData->ShipName, gpsg_name_str, strlen( gpsg_name_str ) + 1 );
+        pTargetData->b_nameValid = true;
+        pTargetData->b_active = true;
+        pTargetData->b_lost = false;
+
+        bdecode_result = true;
+    } else if( arpa_mmsi ) {
+        pTargetData->m_utc_hour = arpa_utc_hour;
+        pTargetData->m_utc_min = arpa_utc_min;
+        pTargetData->m_utc_sec = arpa_utc_sec;
+        pTargetData->MMSI = arpa_mmsi;
+        pTargetData->NavStatus = 15; // undefined
+        if( str.Mid( 3, 3 ).IsSameAs( _T("TLL") ) ) {
+            if( !bnewtarget ) {
+                int age_of_last = ( now.GetTicks() - pTargetData->PositionReportTicks );
+                if ( age_of_last > 0 ) {
+                    ll_gc_ll_reverse( pTargetData->Lat, pTargetData->Lon, arpa_lat, arpa_lon, &pTargetData->COG, &pTargetData->SOG );
+                    pTargetData->SOG = pTargetData->SOG * 3600 / age_of_last;
+                }
+            }
+            pTargetData->Lat = arpa_lat;
+            pTargetData->Lon = arpa_lon;
+        } else if( str.Mid( 3, 3 ).IsSameAs( _T("TTM") ) ) {
+            if( arpa_dist != 0. ) //Not a new or turned off target
+                ll_gc_ll( gLat, gLon, arpa_brg, arpa_dist, &pTargetData->Lat, &pTargetData->Lon );
+            else
+                arpa_lost = true;
+            pTargetData->COG = arpa_cog;
+            pTargetData->SOG = arpa_sog;
+        }
+        pTargetData->PositionReportTicks = now.GetTicks();
+        pTargetData->StaticReportTicks = now.GetTicks();
+        pTargetData->b_positionOnceValid = true;
+        pTargetData->ShipType = 55; // arpa
+        pTargetData->Class = AIS_ARPA;
+
+        strncpy( pTargetData->ShipName, arpa_name_str, strlen( arpa_name_str ) + 1 );
+        if( arpa_status != _T("Q") )
+            pTargetData->b_nameValid = true;
+        else
+            pTargetData->b_nameValid = false;
+        pTargetData->b_active = !arpa_lost;
+        pTargetData->b_lost = arpa_nottracked;
+
+        bdecode_result = true;
+    } else if( aprs_mmsi ) {
+        pTargetData->m_utc_hour = now.GetHour();
+        pTargetData->m_utc_min = now.GetMinute();
+        pTargetData->m_utc_sec = now.GetSecond();
+        pTargetData->MMSI = aprs_mmsi;
+        pTargetData->NavStatus = 15; // undefined
+        if( !bnewtarget ) {
+            int age_of_last = (now.GetTicks() - pTargetData->PositionReportTicks);
+            if ( age_of_last > 0 ) {
+                ll_gc_ll_reverse( pTargetData->Lat, pTargetData->Lon, aprs_lat, aprs_lon, &pTargetData->COG, &pTargetData->SOG );
+                pTargetData->SOG = pTargetData->SOG * 3600 / age_of_last;
+            }
+        }
+        pTargetData->PositionReportTicks = now.GetTicks();
+        pTargetData->StaticReportTicks = now.GetTicks();
+        pTargetData->Lat = aprs_lat;
+        pTargetData->Lon = aprs_lon;
+        pTargetData->b_positionOnceValid = true;
+        pTargetData->ShipType = 56; // aprs
+        pTargetData->Class = AIS_APRS;
+        strncpy( pTargetData->ShipName, aprs_name_str, strlen( aprs_name_str ) + 1 );
+        pTargetData->b_nameValid = true;
+        pTargetData->b_active = true;
+        pTargetData->b_lost = false;
+
+        bdecode_result = true;
+    }
 
-        token = tkz.GetNextToken();
-        isentence = atoi( token.mb_str() );
+    //     Update the most recent report period
+    pTargetData->RecentPeriod = pTargetData->PositionReportTicks - last_report_ticks;
 
-        token = tkz.GetNextToken();
-        long lsequence_id = 0;
-        token.ToLong( &lsequence_id );
+    CommitTarget( pTargetData, mmsi, bnewtarget, bdecode_result, false );
 
-        token = tkz.GetNextToken();
-        long lchannel;
-        token.ToLong( &lchannel );
+    n_msgs++;
+#ifdef AIS_DEBUG
+    if((n_msgs % 10000) == 0)
+    printf("n_msgs %10d m_n_targets: %6d  n_msg1: %10d  n_msg5+24: %10d  n_new5: %10d \n", n_msgs, m_n_targets, n_msg1, n_msg5 + n_msg24, n_newname);
+#endif
 
-        //  Now, some decisions
+    return AIS_NoError;
+}
 
-        string_to_parse.Clear();
+//----------------------------------------------------------------------------------
+//      Decode a VDM/VDO sentence, working directly on its bytes
+//----------------------------------------------------------------------------------
+AIS_Error AIS_Decoder::DecodeVDx( const char *str, size_t len )
+{
+    //  Make some simple tests for validity
+    if( len > 100 )
+        return AIS_NMEAVDX_TOO_LONG;
 
-        //  Simple case first
-        //  First and only part of a one-part sentence
-        if( ( 1 == nsentences ) && ( 1 == isentence ) ) {
-            string_to_parse = tkz.GetNextToken();         // the encapsulated data
-        }
+    if( !NMEACheckSumOK( str, len ) )
+        return AIS_NMEAVDX_CHECKSUM_BAD;
 
-        else if( nsentences > 1 ) {
-            if( 1 == isentence ) {
-                sentence_accumulator = tkz.GetNextToken();         // the encapsulated data
-            }
+    n_msgs++;
 
-            else {
-                sentence_accumulator += tkz.GetNextToken();
-            }
+    //  Locate the first six fields, !xxVDx,n,i,seq,channel,payload
+    const char *field[6];
+    int field_len[6];
+    const char *p = str;
+    const char *end = str + len;
+    for( int i = 0; i < 6; i++ ) {
+        field[i] = p;
+        while( ( p < end ) && ( *p != ',' ) )
+            p++;
+        field_len[i] = p - field[i];
+        if( p < end )
+            p++;
+    }
 
-            if( isentence == nsentences ) {
-                string_to_parse = sentence_accumulator;
-            }
+    int nsentences = atoi( field[1] );
+    int isentence = atoi( field[2] );
+
+    const char *payload = field[5];
+    int payload_len = field_len[5];
+
+    //  Multi-part sentences are collected until the last part arrives.
+    //  The first and only part of a one-part sentence is decoded as it is.
+    if( nsentences > 1 ) {
+        int iseq = AIS_MULTIPART_SEQUENCES - 1;
+        if( ( 1 == field_len[3] ) && ( field[3][0] >= '0' ) && ( field[3][0] <= '9' ) )
+            iseq = field[3][0] - '0';
+
+        int ichan = AIS_MULTIPART_CHANNELS - 1;
+        if( 1 == field_len[4] ) {
+            if( ( field[4][0] == 'A' ) || ( field[4][0] == '1' ) )
+                ichan = 0;
+            else if( ( field[4][0] == 'B' ) || ( field[4][0] == '2' ) )
+                ichan = 1;
         }
 
-        if( mmsi || ( !string_to_parse.IsEmpty() && ( string_to_parse.Len() < AIS_MAX_MESSAGE_LEN ) ) ) {
+        AIS_Multipart &part = m_multipart[iseq][ichan];
+        if( 1 == isentence ) {
+            part.nsentences = nsentences;
+            part.next_sentence = 1;
+            part.length = 0;
+        }
 
-            //  Create the bit accessible string
-            wxCharBuffer abuf = string_to_parse.ToUTF8();
-            if( !abuf.data() )                            // badly formed sentence?
-                return AIS_GENERIC_ERROR;
-            
-            AIS_Bitstring strbit( abuf.data() );
-
-            //  Extract the MMSI
-            if( !mmsi ) mmsi = strbit.GetInt( 9, 30 );
-            long mmsi_long = mmsi;
-
-            // Check to see if this MMSI has been configured to be ignored completely...
-            for(unsigned int i=0 ; i < g_MMSI_Props_Array.GetCount() ; i++){
-                MMSIProperties *props =  g_MMSI_Props_Array.Item(i);
-                if(mmsi == props->MMSI){
-                    if(props->m_bignore)
-                        return AIS_NoError;
-                    else
-                        break;
-                }
-            }
-            
-             //  Search the current AISTargetList for an MMSI match
-            AIS_Target_Hash::iterator it = AISTargetList->find( mmsi );
-            if( it == AISTargetList->end() )                  // not found
-                    {
-                pTargetData = new AIS_Target_Data;
-                bnewtarget = true;
-                m_n_targets++;
-            } else {
-                pTargetData = ( *AISTargetList )[mmsi];          // find current entry
-                pStaleTarget = pTargetData;                   // save a pointer to stale data
-            }
+        //  A part went missing, the message is lost
+        if( ( part.nsentences != nsentences ) || ( part.next_sentence != isentence )
+                || ( part.length + payload_len >= AIS_MAX_MESSAGE_LEN ) ) {
+            part.nsentences = 0;
+            return AIS_Partial;
+        }
 
-            //  Grab the stale targets's last report time
-             wxDateTime now = wxDateTime::Now();
-            now.MakeGMT();
+        memcpy( &part.payload[part.length], payload, payload_len );
+        part.length += payload_len;
+        part.next_sentence++;
 
-            if( pStaleTarget )
-                last_report_ticks = pStaleTarget->PositionReportTicks;
+        if( isentence < nsentences )
+            return AIS_Partial;                 // accumulating parts of a multi-sentence message
+
+        part.nsentences = 0;
+        payload = part.payload;
+        payload_len = part.length;
+    }
+
+    else if( ( 1 != nsentences ) || ( 1 != isentence ) )
+        return AIS_Partial;
+
+    if( !payload_len || ( payload_len >= AIS_MAX_MESSAGE_LEN ) )
+        return AIS_Partial;
+
+    //  Create the bit accessible string
+    AIS_Bitstring strbit( payload, payload_len );
+
+    //  Extract the MMSI
+    int mmsi = strbit.GetInt( 9, 30 );
+
+    bool bnewtarget;
+    int last_report_ticks;
+    AIS_Target_Data *pTargetData = PrepareTarget( mmsi, &bnewtarget, &last_report_ticks );
+    if( !pTargetData )
+        return AIS_NoError;                     // MMSI is ignored
+
+    // The normal Plain-Old AIS target code path....
+    bool bdecode_result = Parse_VDXBitstring( &strbit, pTargetData );       // Parse the new data
+
+    //     Update the most recent report period
+    pTargetData->RecentPeriod = pTargetData->PositionReportTicks - last_report_ticks;
+
+    CommitTarget( pTargetData, mmsi, bnewtarget, bdecode_result, !strncmp( str + 3, "VDO", 3 ) );
+
+    return AIS_NoError;
+}
+
+//----------------------------------------------------------------------------------
+//      Find the target a report is about, or make a new one.
+//      Returns NULL if the MMSI has been configured to be ignored.
+//----------------------------------------------------------------------------------
+AIS_Target_Data *AIS_Decoder::PrepareTarget( int mmsi, bool *pbnewtarget, int *plast_report_ticks )
+{
+    // Check to see if this MMSI has been configured to be ignored completely...
+    for(unsigned int i=0 ; i < g_MMSI_Props_Array.GetCount() ; i++){
+        MMSIProperties *props =  g_MMSI_Props_Array.Item(i);
+        if(mmsi == props->MMSI){
+            if(props->m_bignore)
+                return NULL;
             else
-                last_report_ticks = now.GetTicks();
+                break;
+        }
+    }
 
-            // Delete the stale AIS Target selectable point
-            if( pStaleTarget )
-                pSelectAIS->DeleteSelectablePoint( (void *) mmsi_long, SELTYPE_AISTARGET );
+    AIS_Target_Data *pTargetData;
 
-            bool bhad_name = false;
-            if( pStaleTarget ) bhad_name = pStaleTarget->b_nameValid;
-
-            if( gpsg_mmsi && pTargetData ) {
-                pTargetData->PositionReportTicks = now.GetTicks();
-                pTargetData->StaticReportTicks = now.GetTicks();
-                pTargetData->m_utc_hour = gpsg_utc_hour;
-                pTargetData->m_utc_min = gpsg_utc_min;
-                pTargetData->m_utc_sec = gpsg_utc_sec;
-                pTargetData->m_date_string = gpsg_date;
-                pTargetData->MMSI = gpsg_mmsi;
-                pTargetData->NavStatus = 0; // underway
-                pTargetData->Lat = gpsg_lat;
-                pTargetData->Lon = gpsg_lon;
-                pTargetData->b_positionOnceValid = true;
-                pTargetData->COG = gpsg_cog;
-                pTargetData->SOG = gpsg_sog;
-                pTargetData->ShipType = 52; // buddy
-                pTargetData->Class = AIS_GPSG_BUDDY;
-                strncpy( pTargetData->ShipName, gpsg_name_str, strlen( gpsg_name_str ) + 1 );
-                pTargetData->b_nameValid = true;
-                pTargetData->b_active = true;
-                pTargetData->b_lost = false;
-
-                bdecode_result = true;
-            } else if( arpa_mmsi && pTargetData ) {
-                pTargetData->m_utc_hour = arpa_utc_hour;
-                pTargetData->m_utc_min = arpa_utc_min;
-                pTargetData->m_utc_sec = arpa_utc_sec;
-                pTargetData->MMSI = arpa_mmsi;
-                pTargetData->NavStatus = 15; // undefined
-                if( str.Mid( 3, 3 ).IsSameAs( _T("TLL") ) ) {
-                    if( !bnewtarget ) {
-                        int age_of_last = ( now.GetTicks() - pTargetData->PositionReportTicks );
-                        if ( age_of_last > 0 ) {
-                            ll_gc_ll_reverse( pTargetData->Lat, pTargetData->Lon, arpa_lat, arpa_lon, &pTargetData->COG, &pTargetData->SOG );
-                            pTargetData->SOG = pTargetData->SOG * 3600 / age_of_last;
-                        }
-                    }
-                    pTargetData->Lat = arpa_lat;
-                    pTargetData->Lon = arpa_lon;
-                } else if( str.Mid( 3, 3 ).IsSameAs( _T("TTM") ) ) {
-                    if( arpa_dist != 0. ) //Not a new or turned off target
-                        ll_gc_ll( gLat, gLon, arpa_brg, arpa_dist, &pTargetData->Lat, &pTargetData->Lon );
-                    else
-                        arpa_lost = true;
-                    pTargetData->COG = arpa_cog;
-                    pTargetData->SOG = arpa_sog;
-                }
-                pTargetData->PositionReportTicks = now.GetTicks();
-                pTargetData->StaticReportTicks = now.GetTicks();
-                pTargetData->b_positionOnceValid = true;
-                pTargetData->ShipType = 55; // arpa
-                pTargetData->Class = AIS_ARPA;
-
-                strncpy( pTargetData->ShipName, arpa_name_str, strlen( arpa_name_str ) + 1 );
-                if( arpa_status != _T("Q") )
-                    pTargetData->b_nameValid = true;
-                else
-                    pTargetData->b_nameValid = false;
-                pTargetData->b_active = !arpa_lost;
-                pTargetData->b_lost = arpa_nottracked;
-
-                bdecode_result = true;
-            } else if( aprs_mmsi && pTargetData ) {
-                pTargetData->m_utc_hour = now.GetHour();
-                pTargetData->m_utc_min = now.GetMinute();
-                pTargetData->m_utc_sec = now.GetSecond();
-                pTargetData->MMSI = aprs_mmsi;
-                pTargetData->NavStatus = 15; // undefined
-                if( !bnewtarget ) {
-                    int age_of_last = (now.GetTicks() - pTargetData->PositionReportTicks);
-                    if ( age_of_last > 0 ) {
-                        ll_gc_ll_reverse( pTargetData->Lat, pTargetData->Lon, aprs_lat, aprs_lon, &pTargetData->COG, &pTargetData->SOG );
-                        pTargetData->SOG = pTargetData->SOG * 3600 / age_of_last;
-                    }
-                }
-                pTargetData->PositionReportTicks = now.GetTicks();
-                pTargetData->StaticReportTicks = now.GetTicks();
-                pTargetData->Lat = aprs_lat;
-                pTargetData->Lon = aprs_lon;
-                pTargetData->b_positionOnceValid = true;
-                pTargetData->ShipType = 56; // aprs
-                pTargetData->Class = AIS_APRS;
-                strncpy( pTargetData->ShipName, aprs_name_str, strlen( aprs_name_str ) + 1 );
-                pTargetData->b_nameValid = true;
-                pTargetData->b_active = true;
-                pTargetData->b_lost = false;
-
-                bdecode_result = true;
-            } else{
-                // The normal Plain-Old AIS target code path....
-                bdecode_result = Parse_VDXBitstring( &strbit, pTargetData );       // Parse the new data
-            }
+     //  Search the current AISTargetList for an MMSI match
+    AIS_Target_Hash::iterator it = AISTargetList->find( mmsi );
+    if( it == AISTargetList->end() ) {                 // not found
+        pTargetData = new AIS_Target_Data;
+        *pbnewtarget = true;
+        m_n_targets++;
 
-                //     Update the most recent report period
-            if( pTargetData )    
-                pTargetData->RecentPeriod = pTargetData->PositionReportTicks - last_report_ticks;
-            ret = AIS_NoError;
-            
-        } else{
-            ret = AIS_Partial;                // accumulating parts of a multi-sentence message
-            pTargetData = 0;
+        wxDateTime now = wxDateTime::Now();
+        now.MakeGMT();
+        *plast_report_ticks = now.GetTicks();
+    } else {
+        pTargetData = it->second;                       // find current entry
+        *pbnewtarget = false;
+
+        //  Grab the stale targets's last report time
+        *plast_report_ticks = pTargetData->PositionReportTicks;
+    }
+
+    return pTargetData;
+}
+
+//----------------------------------------------------------------------------------
+//      Move the target's selectable point to its current position
+//----------------------------------------------------------------------------------
+void AIS_Decoder::UpdateSelectableTarget( AIS_Target_Data *pTargetData )
+{
+    long mmsi_long = pTargetData->MMSI;
+
+    if( !pTargetData->b_OwnShip && pTargetData->b_positionOnceValid ) {
+        if( !pSelectAIS->ModifySelectablePoint( pTargetData->Lat, pTargetData->Lon,
+                                                (void *) mmsi_long, SELTYPE_AISTARGET ) ) {
+            SelectItem *pSel = pSelectAIS->AddSelectablePoint( pTargetData->Lat,
+                    pTargetData->Lon, (void *) mmsi_long, SELTYPE_AISTARGET );
+            pSel->SetUserData( pTargetData->MMSI );
         }
-        
+    }
+    else
+        pSelectAIS->DeleteSelectablePoint( (void *) mmsi_long, SELTYPE_AISTARGET );
+}
 
-        if(pTargetData){
-            //  pTargetData is valid, either new or existing. Continue processing
+//----------------------------------------------------------------------------------
+//      Publish a freshly decoded report, or discard it
+//----------------------------------------------------------------------------------
+void AIS_Decoder::CommitTarget( AIS_Target_Data *pTargetData, int mmsi, bool bnewtarget,
+                                bool bdecode_result, bool b_vdo )
+{
+    //  pTargetData is valid, either new or existing. Continue processing
 
-            m_pLatestTargetData = pTargetData;
+    m_pLatestTargetData = pTargetData;
 
-            if( str.Mid( 3, 3 ).IsSameAs( _T("VDO") ) )
-                pTargetData->b_OwnShip = true;
+    if( b_vdo )
+        pTargetData->b_OwnShip = true;
 
-            // Check to see if this MMSI wants VDM translated to VDO or whether we want to persist it's track...
-            for(unsigned int i=0 ; i < g_MMSI_Props_Array.GetCount() ; i++){
-                MMSIProperties *props =  g_MMSI_Props_Array.Item(i);
-                if(mmsi == props->MMSI)
-                {
-                    pTargetData->b_OwnShip = (props->m_bVDM) ? true : false;
-                    pTargetData->b_PersistTrack = (props->m_bPersistentTrack) ? true : false;
-                    pTargetData->b_NoTrack = (props->TrackType == TRACKTYPE_NEVER) ? true : false;                    
-                    break;
-                }
-            }
-                
+    // Check to see if this MMSI wants VDM translated to VDO or whether we want to persist it's track...
+    for(unsigned int i=0 ; i < g_MMSI_Props_Array.GetCount() ; i++){
+        MMSIProperties *props =  g_MMSI_Props_Array.Item(i);
+        if(mmsi == props->MMSI)
+        {
+            pTargetData->b_OwnShip = (props->m_bVDM) ? true : false;
+            pTargetData->b_PersistTrack = (props->m_bPersistentTrack) ? true : false;
+            pTargetData->b_NoTrack = (props->TrackType == TRACKTYPE_NEVER) ? true : false;                    
+            break;
+        }
+    }
+        
 
-            //  If the message was decoded correctly
-            //  Update the AIS Target information
-            if( bdecode_result ) {
-                if(g_benableAISNameCache){
-                    // Check for valid name data
-                    if( !pTargetData->b_nameValid ){
-                        AIS_Target_Name_Hash::iterator it = AISTargetNames->find( mmsi );
-                        if(  it != AISTargetNames->end()  ) {
-                        // If we don't have a name yet but have one in the MMSI->ShipName hash, use the one in the hash
-                            wxString ship_name = ( *AISTargetNames )[mmsi];
-                            strncpy( pTargetData->ShipName, ship_name.mb_str(), ship_name.length() + 1 );
-                            pTargetData->b_nameValid = true;
-                            pTargetData->b_nameFromCache = true;
+    //  If the message was decoded correctly
+    //  Update the AIS Target information
+    if( bdecode_result ) {
+        if(g_benableAISNameCache){
+            // Check for valid name data
+            if( !pTargetData->b_nameValid ){
+                AIS_Target_Name_Hash::iterator it = AISTargetNames->find( mmsi );
+                if(  it != AISTargetNames->end()  ) {
+                // If we don't have a name yet but have one in the MMSI->ShipName hash, use the one in the hash
+                    wxString ship_name = ( *AISTargetNames )[mmsi];
+                    strncpy( pTargetData->ShipName, ship_name.mb_str(), ship_name.length() + 1 );
+                    pTargetData->b_nameValid = true;
+                    pTargetData->b_nameFromCache = true;
+                }
+            } 
+            else if ((pTargetData->MID == 5) || (pTargetData->MID == 24) || (pTargetData->MID == 19)) {
+                //  This message contains ship static data, so has a name field
+                pTargetData->b_nameFromCache = false;
+                AIS_Target_Name_Hash::iterator it = AISTargetNames->find( mmsi );
+                if(  it == AISTargetNames->end()  ) {
+                // If have a name but haven't saved it to the hash, save it
+                    wxString ship_name = trimAISField( pTargetData->ShipName );
+                    ( *AISTargetNames )[mmsi] = ship_name;
+                // Write the MMSI->ShipName hash file
+                    std::ofstream outfile( AISTargetNameFileName.mb_str(), std::ios_base::app );
+                    if( outfile.is_open() ) {
+                        outfile << mmsi << "," << ship_name.mb_str() << "\r\n";
+                    }
+                    outfile.close();
+                }
+                else{               // there is an entry in the cache for this MMSI
+                                    // Check to see if the cached name matches the name just received.
+                    wxString ship_name = trimAISField( pTargetData->ShipName );
+                    if( it->second != ship_name){
+                        ( *AISTargetNames )[mmsi] = ship_name;  // update the in-core cache
+                        
+                        // Write an MMSI->ShipName hash file entry
+                        // Note that due to the manner in which the cache file is loaded on program start,
+                        //   the last recorded entry for a particular MMSI number, 
+                        //   (i.e. this one), takes precedence.
+                        // This also means that duplicates may be present in the cache file over time.
+                        //   A subject for later analysis...
+
+                        //  To avoid perverse behaviour if there are repeated name changes from a single target,
+                        //  only allow one name change per MMSI per session.
+                        bool bFound = false;
+                        for( unsigned int i=0; i<m_MMSI_MismatchVec.size(); i++ ) {
+                            if(m_MMSI_MismatchVec[i] == mmsi ){
+                                bFound = true;
+                                break;
+                            }
                         }
-                    } 
-                    else if ((pTargetData->MID == 5) || (pTargetData->MID == 24) || (pTargetData->MID == 19)) {
-                        //  This message contains ship static data, so has a name field
-                        pTargetData->b_nameFromCache = false;
-                        AIS_Target_Name_Hash::iterator it = AISTargetNames->find( mmsi );
-                        if(  it == AISTargetNames->end()  ) {
-                        // If have a name but haven't saved it to the hash, save it
-                            wxString ship_name = trimAISField( pTargetData->ShipName );
-                            ( *AISTargetNames )[mmsi] = ship_name;
-                        // Write the MMSI->ShipName hash file
+                            
+                        if(!bFound){    //  Write an entry to the cache file, tagged with "Mismatch"
                             std::ofstream outfile( AISTargetNameFileName.mb_str(), std::ios_base::app );
                             if( outfile.is_open() ) {
-                                outfile << mmsi << "," << ship_name.mb_str() << "\r\n";
+                                outfile << mmsi << "," << ship_name.mb_str() << ",Mismatch" << "\r\n";
                             }
                             outfile.close();
-                        }
-                        else{               // there is an entry in the cache for this MMSI
-                                            // Check to see if the cached name matches the name just received.
-                            wxString ship_name = trimAISField( pTargetData->ShipName );
-                            if( it->second != ship_name){
-                                ( *AISTargetNames )[mmsi] = ship_name;  // update the in-core cache
-                                
-                                // Write an MMSI->ShipName hash file entry
-                                // Note that due to the manner in which the cache file is loaded on program start,
-                                //   the last recorded entry for a particular MMSI number, 
-                                //   (i.e. this one), takes precedence.
-                                // This also means that duplicates may be present in the cache file over time.
-                                //   A subject for later analysis...
-
-                                //  To avoid perverse behaviour if there are repeated name changes from a single target,
-                                //  only allow one name change per MMSI per session.
-                                bool bFound = false;
-                                for( unsigned int i=0; i<m_MMSI_MismatchVec.size(); i++ ) {
-                                    if(m_MMSI_MismatchVec[i] == mmsi ){
-                                        bFound = true;
-                                        break;
-                                    }
-                                }
-                                    
-                                if(!bFound){    //  Write an entry to the cache file, tagged with "Mismatch"
-                                    std::ofstream outfile( AISTargetNameFileName.mb_str(), std::ios_base::app );
-                                    if( outfile.is_open() ) {
-                                        outfile << mmsi << "," << ship_name.mb_str() << ",Mismatch" << "\r\n";
-                                    }
-                                    outfile.close();
-                                
-                                    m_MMSI_MismatchVec.push_back(mmsi);
-                                }
-                            }
+                        
+                            m_MMSI_MismatchVec.push_back(mmsi);
                         }
                     }
                 }
-                
-                ( *AISTargetList )[pTargetData->MMSI] = pTargetData;            // update the hash table entry
-
-                if( !pTargetData->area_notices.empty() ) {
-                    AIS_Target_Hash::iterator it = AIS_AreaNotice_Sources->find( pTargetData->MMSI );
-                    if( it == AIS_AreaNotice_Sources->end() )
-                        ( *AIS_AreaNotice_Sources ) [pTargetData->MMSI] = pTargetData;
-                }
+            }
+        }
+        
+        AISTargetList->Set( pTargetData->MMSI, pTargetData );            // update the hash table entry
 
+        if( !pTargetData->area_notices.empty() ) {
+            AIS_Target_Hash::iterator it = AIS_AreaNotice_Sources->find( pTargetData->MMSI );
+            if( it == AIS_AreaNotice_Sources->end() )
+                AIS_AreaNotice_Sources->Set( pTargetData->MMSI, pTargetData );
+        }
 
-                //  If this is not an ownship message, update the AIS Target in the Selectable list, and update the CPA info
-                if( !pTargetData->b_OwnShip ) {
-                    if( pTargetData->b_positionOnceValid ) {
-                        long mmsi_long = pTargetData->MMSI;
-                        SelectItem *pSel = pSelectAIS->AddSelectablePoint( pTargetData->Lat,
-                                pTargetData->Lon, (void *) mmsi_long, SELTYPE_AISTARGET );
-                        pSel->SetUserData( pTargetData->MMSI );
-                    }
 
-                    //    Calculate CPA info for this target immediately
-                    UpdateOneCPA( pTargetData );
+        //  If this is not an ownship message, update the AIS Target in the Selectable list, and update the CPA info
+        UpdateSelectableTarget( pTargetData );
+        if( !pTargetData->b_OwnShip ) {
+            //    Calculate CPA info for this target immediately
+            UpdateOneCPA( pTargetData );
 
-                    //    Update this target's track
-                    if( pTargetData->b_show_track )
-                        UpdateOneTrack( pTargetData );
-                }
-                // TODO add ais message call
-                SendJSONMsg( pTargetData );
-            } else {
-    //             printf("Unrecognised AIS message ID: %d\n", pTargetData->MID);
-                if( bnewtarget ) {
-                    delete pTargetData;                           // this target is not going to be used
-                    m_n_targets--;
-                } else {
-                    //  If this is not an ownship message, update the AIS Target in the Selectable list
-                    //  even if the message type was not recognized
-                    if( !pTargetData->b_OwnShip ) {
-                        if( pTargetData->b_positionOnceValid ) {
-                            long mmsi_long = pTargetData->MMSI;
-                            SelectItem *pSel = pSelectAIS->AddSelectablePoint( pTargetData->Lat,
-                                                pTargetData->Lon, (void *) mmsi_long, SELTYPE_AISTARGET );
-                            pSel->SetUserData( pTargetData->MMSI );
-                        }
-                    }
-                }
-            }
+            //    Update this target's track
+            if( pTargetData->b_show_track )
+                UpdateOneTrack( pTargetData );
         }
+        // TODO add ais message call
+        SendJSONMsg( pTargetData );
+    } else {
+    //             printf("Unrecognised AIS message ID: %d\n", pTargetData->MID);
+        if( bnewtarget ) {
+            delete pTargetData;                           // this target is not going to be used
+            m_n_targets--;
+        } else {
+            AISTargetList->Set( mmsi, pTargetData );
 
-    n_msgs++;
-#ifdef AIS_DEBUG
-    if((n_msgs % 10000) == 0)
-    printf("n_msgs %10d m_n_targets: %6d  n_msg1: %10d  n_msg5+24: %10d  n_new5: %10d \n", n_msgs, m_n_targets, n_msg1, n_msg5 + n_msg24, n_newname);
-#endif
-
-    return ret;
+            //  If this is not an ownship message, update the AIS Target in the Selectable list
+            //  even if the message type was not recognized
+            UpdateSelectableTarget( pTargetData );
+        }
+    }
 }
 
 AIS_Target_Data *AIS_Decoder::ProcessDSx( const wxString& str, bool b_take_dsc )
@@ -1183,7 +1271,7 @@ AIS_Target_Data *AIS_Decoder::ProcessDSx( const wxString& str, bool b_take_dsc )
     AIS_Target_Hash::iterator it = AISTargetList->find( mmsi );
     if( it == AISTargetList->end() ) {                 // not found
     } else {
-        pStaleTarget = ( *AISTargetList )[mmsi];          // find current entry
+        pStaleTarget = AISTargetList->Get( mmsi );          // find current entry
         last_report_ticks = pStaleTarget->PositionReportTicks;
     }
     
@@ -1242,11 +1330,11 @@ AIS_Target_Data *AIS_Decoder::ProcessDSx( const wxString& str, bool b_take_dsc )
             if( it == AISTargetList->end() ) {                 // not found
                 pTargetData = m_ptentative_dsctarget;
             } else {
-                pTargetData = ( *AISTargetList )[mmsi];          // find current entry
-                AISTargetTrackList *ptrack = pTargetData->m_ptrack;
-                pTargetData->CloneFrom( m_ptentative_dsctarget);  // this will make an empty track list
+                pTargetData = AISTargetList->Get( mmsi );          // find current entry
+                AISTargetTrack *ptrack = pTargetData->m_ptrack;
+                pTargetData->CloneFrom( m_ptentative_dsctarget);  // this will copy the tentative track
                 
-                delete pTargetData->m_ptrack;           // get rid of the new empty one
+                delete pTargetData->m_ptrack;           // get rid of the copy
                 pTargetData->m_ptrack = ptrack;         // and substitute the old track list
                 
                 delete m_ptentative_dsctarget;
@@ -1257,7 +1345,7 @@ AIS_Target_Data *AIS_Decoder::ProcessDSx( const wxString& str, bool b_take_dsc )
             
             m_pLatestTargetData = pTargetData;
             
-            ( *AISTargetList )[pTargetData->MMSI] = pTargetData;            // update the hash table entry
+            AISTargetList->Set( pTargetData->MMSI, pTargetData );            // update the hash table entry
                 
             long mmsi_long = pTargetData->MMSI;
 
@@ -1824,39 +1912,43 @@ bool AIS_Decoder::Parse_VDXBitstring( AIS_Bitstring *bstr, AIS_Target_Data *ptd
 
 bool AIS_Decoder::NMEACheckSumOK( const wxString& str_in )
 {
-
-    unsigned char checksum_value = 0;
-    int sentence_hex_sum;
-
     wxCharBuffer buf = str_in.ToUTF8();
     if( !buf.data()) 
         return false;                           // cannot decode string
         
-    char str_ascii[AIS_MAX_MESSAGE_LEN + 1];
-    strncpy( str_ascii, buf.data(), AIS_MAX_MESSAGE_LEN );
-    str_ascii[AIS_MAX_MESSAGE_LEN] = '\0';
+    return NMEACheckSumOK( buf.data(), strlen( buf.data() ) );
+}
+
+bool AIS_Decoder::NMEACheckSumOK( const char *str, size_t len )
+{
+    unsigned char checksum_value = 0;
 
-    int string_length = strlen( str_ascii );
+    size_t string_length = wxMin( len, (size_t)AIS_MAX_MESSAGE_LEN );
 
-    int payload_length = 0;
-    while( ( payload_length < string_length ) && ( str_ascii[payload_length] != '*' ) ) // look for '*'
+    size_t payload_length = 0;
+    while( ( payload_length < string_length ) && ( str[payload_length] != '*' ) ) // look for '*'
         payload_length++;
 
     if( payload_length == string_length ) return false; // '*' not found at all, no checksum
 
-    int index = 1; // Skip over the $ at the begining of the sentence
+    size_t index = 1; // Skip over the $ at the begining of the sentence
 
     while( index < payload_length ) {
-        checksum_value ^= str_ascii[index];
+        checksum_value ^= str[index];
         index++;
     }
 
-    if( string_length > 4 ) {
-        char scanstr[3];
-        scanstr[0] = str_ascii[payload_length + 1];
-        scanstr[1] = str_ascii[payload_length + 2];
-        scanstr[2] = 0;
-        sscanf( scanstr, "%2x", &sentence_hex_sum );
+    if( ( string_length > 4 ) && ( payload_length + 2 < string_length ) ) {
+        int sentence_hex_sum = 0;
+        for( size_t i = payload_length + 1; i < payload_length + 3; i++ ) {
+            char c = str[i];
+            int digit;
+            if( c >= '0' && c <= '9' ) digit = c - '0';
+            else if( c >= 'a' && c <= 'f' ) digit = c - 'a' + 10;
+            else if( c >= 'A' && c <= 'F' ) digit = c - 'A' + 10;
+            else return false;
+            sentence_hex_sum = ( sentence_hex_sum << 4 ) | digit;
+        }
 
         if( sentence_hex_sum == checksum_value ) return true;
     }
@@ -1870,10 +1962,18 @@ void AIS_Decoder::UpdateAllCPA( void )
     AIS_Target_Hash::iterator it;
     AIS_Target_Hash *current_targets = GetTargetList();
 
+    bool b_ownship_valid = BeginCPA();
+
+    //    The work is done on the hot arrays of the target list,
+    //    the targets themselves are only visited to publish the results
     for( it = ( *current_targets ).begin(); it != ( *current_targets ).end(); ++it ) {
-        AIS_Target_Data *td = it->second;
+        if( NULL != it->second ) GatherOneCPA( it.GetSlot(), b_ownship_valid );
+    }
+
+    SolveCPA();
 
-        if( NULL != td ) UpdateOneCPA( td );
+    for( it = ( *current_targets ).begin(); it != ( *current_targets ).end(); ++it ) {
+        if( NULL != it->second ) PublishCPA( it );
     }
 }
 
@@ -1882,11 +1982,24 @@ void AIS_Decoder::UpdateAllTracks( void )
     //    Iterate thru all the targets
     AIS_Target_Hash::iterator it;
     AIS_Target_Hash *current_targets = GetTargetList();
+    AIS_Target_Hot &hot = current_targets->GetHot();
+
+    time_t now = wxDateTime::Now().GetTicks();
+    time_t test_time = now - (time_t) ( g_AISShowTracks_Mins * 60 );
 
     for( it = ( *current_targets ).begin(); it != ( *current_targets ).end(); ++it ) {
-        AIS_Target_Data *td = it->second;
+        size_t slot = it.GetSlot();
+        if( ( NULL == it->second ) || !( hot.flags[slot] & AIS_HOT_POSITION_VALID ) )
+            continue;
+
+        //    Persistent tracks need the full target
+        if( hot.flags[slot] & AIS_HOT_PERSIST_TRACK ) {
+            UpdateOneTrack( it->second );
+            continue;
+        }
 
-        if( NULL != td ) UpdateOneTrack( td );
+        hot.track[slot]->Append( hot.lat[slot], hot.lon[slot], now );
+        hot.track[slot]->RemoveOlderThan( test_time );
     }
 }
 
@@ -1895,12 +2008,8 @@ void AIS_Decoder::UpdateOneTrack( AIS_Target_Data *ptarget )
     if( !ptarget->b_positionOnceValid ) return;
 
     //    Add the newest point
-    AISTargetTrackPoint *ptrackpoint = new AISTargetTrackPoint;
-    ptrackpoint->m_lat = ptarget->Lat;
-    ptrackpoint->m_lon = ptarget->Lon;
-    ptrackpoint->m_time = wxDateTime::Now().GetTicks();
-
-    ptarget->m_ptrack->Append( ptrackpoint );
+    time_t now = wxDateTime::Now().GetTicks();
+    ptarget->m_ptrack->Append( ptarget->Lat, ptarget->Lon, now );
     
     if( ptarget->b_PersistTrack )
     {
@@ -1918,8 +2027,8 @@ void AIS_Decoder::UpdateOneTrack( AIS_Target_Data *ptarget )
             t = m_persistent_tracks[ptarget->MMSI];
         }
         TrackPoint *tp = t->GetLastPoint();
-        vector2D point( ptrackpoint->m_lon, ptrackpoint->m_lat );
-        TrackPoint *tp1 = t->AddNewPoint( point, wxDateTime(ptrackpoint->m_time).ToUTC() );        
+        vector2D point( ptarget->Lon, ptarget->Lat );
+        TrackPoint *tp1 = t->AddNewPoint( point, wxDateTime(now).ToUTC() );        
         if( tp )
         {
             pSelect->AddSelectableTrackSegment( tp->m_lat, tp->m_lon, tp1->m_lat,
@@ -1931,21 +2040,10 @@ void AIS_Decoder::UpdateOneTrack( AIS_Target_Data *ptarget )
 //                pRouteManagerDialog->UpdateTrkListCtrl();
     }
 
-    //    Walk the list, removing any track points that are older than the stipulated time
+    //    Remove any track points that are older than the stipulated time
 
     time_t test_time = wxDateTime::Now().GetTicks() - (time_t) ( g_AISShowTracks_Mins * 60 );
-
-    wxAISTargetTrackListNode *node = ptarget->m_ptrack->GetFirst();
-    while( node ) {
-        AISTargetTrackPoint *ptrack_point = node->GetData();
-
-        if( ptrack_point->m_time < test_time ) {
-            if( ptarget->m_ptrack->DeleteObject( ptrack_point ) ) {
-                node = ptarget->m_ptrack->GetFirst();                // restart the list
-            }
-        } else
-            node = node->GetNext();
-    }
+    ptarget->m_ptrack->RemoveOlderThan( test_time );
 }
 
 void AIS_Decoder::DeletePersistentTrack( Track *track )
@@ -2079,126 +2177,160 @@ void AIS_Decoder::UpdateAllAlarms( void )
 
 void AIS_Decoder::UpdateOneCPA( AIS_Target_Data *ptarget )
 {
-    ptarget->Range_NM = -1.;            // Defaults
-    ptarget->Brg = -1.;
+    AIS_Target_Hash::iterator it = AISTargetList->find( ptarget->MMSI );
+    if( ( it == AISTargetList->end() ) || ( it->second != ptarget ) )
+        return;
+
+    bool b_ownship_valid = BeginCPA();
+    GatherOneCPA( it.GetSlot(), b_ownship_valid );
+    SolveCPA();
+    PublishCPA( it );
+}
+
+//    Start a CPA batch, returning false if ownship motion is unknown
+bool AIS_Decoder::BeginCPA( void )
+{
+    m_cpa_slots.clear();
+    m_cpa_lat.clear();
+    m_cpa_lon.clear();
+    m_cpa_ve.clear();
+    m_cpa_vn.clear();
+
+//    Ownship is not reporting valid SOG, so no way to calculate CPA
+    if( wxIsNaN(gSog) || ( gSog > 102.2 ) )
+        return false;
+
+    double cpa_calc_ownship_cog = gCog;
 
-    if( !ptarget->b_positionOnceValid || !bGPSValid ) {
-        ptarget->bCPA_Valid = false;
+//    Ownship is maybe anchored and not reporting COG
+    if( wxIsNaN(gCog) || gCog == 360.0 ) {
+        if( gSog < .01 ) cpa_calc_ownship_cog = 0.;          // substitute value
+                                                             // for the case where SOG ~= 0, and COG is unknown.
+        else
+            return false;
+    }
+
+    //    Express the SOG as meters per hour, and split it on the plotting sheet
+    double v0 = gSog * 1852.;
+
+    m_cpa_own.lat = gLat;
+    m_cpa_own.lon = gLon;
+    m_cpa_own.coslat = cos( gLat * PI / 180. );
+    m_cpa_own.ve = v0 * cos( ( 90. - cpa_calc_ownship_cog ) * PI / 180. );
+    m_cpa_own.vn = v0 * sin( ( 90. - cpa_calc_ownship_cog ) * PI / 180. );
+
+    return true;
+}
+
+//    Compute range and bearing, and queue the target for SolveCPA() if a CPA is defined
+void AIS_Decoder::GatherOneCPA( size_t slot, bool b_ownship_valid )
+{
+    AIS_Target_Hot &hot = AISTargetList->GetHot();
+
+    hot.range[slot] = -1.;              // Defaults
+    hot.brg[slot] = -1.;
+
+    if( !( hot.flags[slot] & AIS_HOT_POSITION_VALID ) || !bGPSValid ) {
+        hot.flags[slot] &= ~AIS_HOT_CPA_VALID;
         return;
     }
 
     //    Compute the current Range/Brg to the target
     double brg, dist;
-    DistanceBearingMercator( ptarget->Lat, ptarget->Lon, gLat, gLon, &brg, &dist );
-    ptarget->Range_NM = dist;
-    ptarget->Brg = brg;
+    DistanceBearingMercator( hot.lat[slot], hot.lon[slot], gLat, gLon, &brg, &dist );
+    hot.range[slot] = dist;
+    hot.brg[slot] = brg;
 
-    if( dist <= 1e-5 ) ptarget->Brg = -1.0;             // Brg is undefined if Range == 0.
+    if( dist <= 1e-5 ) hot.brg[slot] = -1.0;            // Brg is undefined if Range == 0.
 
     //    There can be no collision between ownship and itself....
     //    This can happen if AIVDO messages are received, and there is another source of ownship position, like NMEA GLL
     //    The two positions are always temporally out of sync, and one will always be exactly in front of the other one.
-    if( ptarget->b_OwnShip ) {
-        ptarget->CPA = 100;
-        ptarget->TCPA = -100;
-        ptarget->bCPA_Valid = false;
+    if( hot.flags[slot] & AIS_HOT_OWNSHIP ) {
+        hot.cpa[slot] = 100;
+        hot.tcpa[slot] = -100;
+        hot.flags[slot] &= ~AIS_HOT_CPA_VALID;
         return;
     }
 
-    double cpa_calc_ownship_cog = gCog;
-    double cpa_calc_target_cog = ptarget->COG;
-
-//    Ownship is not reporting valid SOG, so no way to calculate CPA
-    if( wxIsNaN(gSog) || ( gSog > 102.2 ) ) {
-        ptarget->bCPA_Valid = false;
+    if( !b_ownship_valid ) {
+        hot.flags[slot] &= ~AIS_HOT_CPA_VALID;
         return;
     }
 
-//    Ownship is maybe anchored and not reporting COG
-    if( wxIsNaN(gCog) || gCog == 360.0 ) {
-        if( gSog < .01 ) cpa_calc_ownship_cog = 0.;          // substitute value
-                                                             // for the case where SOG ~= 0, and COG is unknown.
-        else {
-            ptarget->bCPA_Valid = false;
-            return;
-        }
-    }
+    double cpa_calc_target_cog = hot.cog[slot];
 
 //    Target is maybe anchored and not reporting COG
-    if( ptarget->COG == 360.0 ) {
-        if( ptarget->SOG > 102.2 ) {
-            ptarget->bCPA_Valid = false;
+    if( hot.cog[slot] == 360.0 ) {
+        if( hot.sog[slot] > 102.2 ) {
+            hot.flags[slot] &= ~AIS_HOT_CPA_VALID;
             return;
-        } else if( ptarget->SOG < .01 ) cpa_calc_target_cog = 0.;           // substitute value
+        } else if( hot.sog[slot] < .01 ) cpa_calc_target_cog = 0.;          // substitute value
                                                                             // for the case where SOG ~= 0, and COG is unknown.
         else {
-            ptarget->bCPA_Valid = false;
+            hot.flags[slot] &= ~AIS_HOT_CPA_VALID;
             return;
         }
     }
 
     //    Express the SOGs as meters per hour
     double v0 = gSog * 1852.;
-    double v1 = ptarget->SOG * 1852.;
+    double v1 = hot.sog[slot] * 1852.;
 
     if( ( v0 < 1e-6 ) && ( v1 < 1e-6 ) ) {
-        ptarget->TCPA = 0.;
-        ptarget->CPA = 0.;
+        hot.tcpa[slot] = 0.;
+        hot.cpa[slot] = 0.;
 
-        ptarget->bCPA_Valid = false;
-    } else {
-        //    Calculate the TCPA first
-
-        //    Working on a Reduced Lat/Lon orthogonal plotting sheet....
-        //    Get easting/northing to target,  in meters
-
-        double east1 = ( ptarget->Lon - gLon ) * 60 * 1852;
-        double north1 = ( ptarget->Lat - gLat ) * 60 * 1852;
+        hot.flags[slot] &= ~AIS_HOT_CPA_VALID;
+        return;
+    }
 
-        double east = east1 * ( cos( gLat * PI / 180. ) );
-        
-        double north = north1;
+    m_cpa_slots.push_back( slot );
+    m_cpa_lat.push_back( hot.lat[slot] );
+    m_cpa_lon.push_back( hot.lon[slot] );
+    m_cpa_ve.push_back( v1 * cos( ( 90. - cpa_calc_target_cog ) * PI / 180. ) );
+    m_cpa_vn.push_back( v1 * sin( ( 90. - cpa_calc_target_cog ) * PI / 180. ) );
+}
 
-        //    Convert COGs trigonometry to standard unit circle
-        double cosa = cos( ( 90. - cpa_calc_ownship_cog ) * PI / 180. );
-        double sina = sin( ( 90. - cpa_calc_ownship_cog ) * PI / 180. );
-        double cosb = cos( ( 90. - cpa_calc_target_cog ) * PI / 180. );
-        double sinb = sin( ( 90. - cpa_calc_target_cog ) * PI / 180. );
+//    Solve TCPA and CPA for all the queued targets in one pass
+void AIS_Decoder::SolveCPA( void )
+{
+    int n = m_cpa_slots.size();
+    if( !n )
+        return;
 
-        //    These will be useful
-        double fc = ( v0 * cosa ) - ( v1 * cosb );
-        double fs = ( v0 * sina ) - ( v1 * sinb );
+    m_cpa_tcpa.resize( n );
+    m_cpa_cpa.resize( n );
 
-        double d = ( fc * fc ) + ( fs * fs );
-        double tcpa;
+    CPA_Batch( n, &m_cpa_own, &m_cpa_lat[0], &m_cpa_lon[0], &m_cpa_ve[0], &m_cpa_vn[0],
+               &m_cpa_tcpa[0], &m_cpa_cpa[0] );
 
-        // the tracks are almost parallel
-        if( fabs( d ) < 1e-6 ) tcpa = 0.;
+    AIS_Target_Hot &hot = AISTargetList->GetHot();
+    for( int i = 0; i < n; i++ ) {
+        size_t slot = m_cpa_slots[i];
+        hot.tcpa[slot] = m_cpa_tcpa[i];
+        hot.cpa[slot] = m_cpa_cpa[i];
+        if( m_cpa_tcpa[i] >= 0 )
+            hot.flags[slot] |= AIS_HOT_CPA_VALID;
         else
-            //    Here is the equation for t, which will be in hours
-            tcpa = ( ( fc * east ) + ( fs * north ) ) / d;
-
-        //    Convert to minutes
-        ptarget->TCPA = tcpa * 60.;
-
-        //    Calculate CPA
-        //    Using TCPA, predict ownship and target positions
-
-        double OwnshipLatCPA, OwnshipLonCPA, TargetLatCPA, TargetLonCPA;
-
-        ll_gc_ll( gLat, gLon, cpa_calc_ownship_cog, gSog * tcpa, &OwnshipLatCPA, &OwnshipLonCPA );
-        ll_gc_ll( ptarget->Lat, ptarget->Lon, cpa_calc_target_cog, ptarget->SOG * tcpa,
-                &TargetLatCPA, &TargetLonCPA );
-
-        //   And compute the distance
-        ptarget->CPA = DistGreatCircle( OwnshipLatCPA, OwnshipLonCPA, TargetLatCPA, TargetLonCPA );
-
-        ptarget->bCPA_Valid = true;
-
-        if( ptarget->TCPA < 0 ) ptarget->bCPA_Valid = false;
+            hot.flags[slot] &= ~AIS_HOT_CPA_VALID;
     }
 }
 
+//    Copy the CPA results of one target from the hot arrays to the target
+void AIS_Decoder::PublishCPA( AIS_Target_Hash::iterator it )
+{
+    AIS_Target_Hot &hot = AISTargetList->GetHot();
+    size_t slot = it.GetSlot();
+    AIS_Target_Data *ptarget = it->second;
+
+    ptarget->Range_NM = hot.range[slot];
+    ptarget->Brg = hot.brg[slot];
+    ptarget->CPA = hot.cpa[slot];
+    ptarget->TCPA = hot.tcpa[slot];
+    ptarget->bCPA_Valid = ( hot.flags[slot] & AIS_HOT_CPA_VALID ) != 0;
+}
+
 void AIS_Decoder::OnTimerAISAudio( wxTimerEvent& event )
 {
     if( g_bAIS_CPA_Alert_Audio && m_bAIS_Audio_Alert_On ) {
@@ -2241,6 +2373,19 @@ void AIS_Decoder::OnTimerAIS( wxTimerEvent& event )
 
     it = ( *current_targets ).begin();
     wxArrayInt remove_array;                    // collector for MMSI of targets to be removed
+
+    //  Targets that reported more recently than any lost target timeout can be passed over
+    //  on their hot fields alone.  Inland ECDIS timeouts depend on more than the class.
+    double quiet_secs = -1.;
+    if( !g_bInlandEcdis ) {
+        double quiet_mins = 1e9;
+        if( g_bMarkLost )
+            quiet_mins = fmin( quiet_mins, g_MarkLost_Mins );
+        if( g_bRemoveLost )
+            quiet_mins = fmin( quiet_mins, fmin( fmax( g_RemoveLost_Mins, g_MarkLost_Mins ), 18.0 ) );
+        quiet_secs = quiet_mins * 60;
+    }
+    AIS_Target_Hot &hot = current_targets->GetHot();
     
     while( it != ( *current_targets ).end() ) {
         bool b_new_it = false;
@@ -2253,6 +2398,13 @@ void AIS_Decoder::OnTimerAIS( wxTimerEvent& event )
             break;                          // leave the loop
         }
 
+        size_t slot = it.GetSlot();
+        if( ( now.GetTicks() - hot.posn_ticks[slot] <= quiet_secs )
+            && !( ( hot.cls[slot] == AIS_ARPA ) && ( hot.flags[slot] & AIS_HOT_LOST ) ) ) {
+            ++it;
+            continue;
+        }
+
         int target_posn_age = now.GetTicks() - td->PositionReportTicks;
         int target_static_age = now.GetTicks() - td->StaticReportTicks;
 
@@ -2290,13 +2442,13 @@ void AIS_Decoder::OnTimerAIS( wxTimerEvent& event )
             }
                 
             if( ( target_posn_age > iECD_LostTimeOut ) && ( td->Class != AIS_GPSG_BUDDY ) )
-                    td->b_active = false;
+                    current_targets->SetActive( it, false );
                 
             removelost_Mins = (2 * iECD_LostTimeOut) / 60.;
         }               
         else if( g_bMarkLost ) {
             if( ( target_posn_age > g_MarkLost_Mins * 60 ) && ( td->Class != AIS_GPSG_BUDDY ) )
-                td->b_active = false;
+                current_targets->SetActive( it, false );
         }
 
         if( td->Class == AIS_SART )
@@ -2308,12 +2460,7 @@ void AIS_Decoder::OnTimerAIS( wxTimerEvent& event )
             bool b_arpalost = ( td->Class == AIS_ARPA  && td->b_lost ); //A lost ARPA target would be deleted at once
             if ( ( ( target_posn_age > removelost_Mins * 60 ) && ( td->Class != AIS_GPSG_BUDDY ) ) || b_arpalost ) {
                 //      So mark the target as lost, with unknown position, and make it not selectable
-                td->b_lost = true;
-                td->b_positionOnceValid = false;
-                td->COG = 360.0;
-                td->SOG = 103.0;
-                td->HDG = 511.0;
-                td->ROTAIS = -128;
+                current_targets->SetLost( it );
 
                 long mmsi_long = td->MMSI;
                 pSelectAIS->DeleteSelectablePoint( (void *) mmsi_long, SELTYPE_AISTARGET );
@@ -2526,7 +2673,7 @@ AIS_Target_Data *AIS_Decoder::Get_Target_Data_From_MMSI( int mmsi )
     if( AISTargetList->find( mmsi ) == AISTargetList->end() )     // if entry does not exist....
     return NULL;
     else
-        return ( *AISTargetList )[mmsi];          // find current entry
+        return AISTargetList->Get( mmsi );          // find current entry
 }
 
 
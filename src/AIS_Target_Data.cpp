@@ -155,8 +155,7 @@ AIS_Target_Data::AIS_Target_Data()
     b_PersistTrack = false;
     b_in_ack_timeout = false;
 
-    m_ptrack = new AISTargetTrackList;
-    m_ptrack->DeleteContents(true);
+    m_ptrack = new AISTargetTrack;
     
     b_active = false;
     blue_paddle = 0;
@@ -240,15 +239,7 @@ void AIS_Target_Data::CloneFrom( AIS_Target_Data* q )
     b_OwnShip = q->b_OwnShip;
     b_in_ack_timeout = q->b_in_ack_timeout;
     
-    m_ptrack = new AISTargetTrackList;
-    m_ptrack->DeleteContents(true);
-    
-    wxAISTargetTrackListNode *node = q->m_ptrack->GetFirst();
-    while( node ) {
-        AISTargetTrackPoint *ptrack_point = node->GetData();
-        m_ptrack->Append( ptrack_point );
-        node = node->GetNext();
-    }
+    m_ptrack = new AISTargetTrack( *q->m_ptrack );
     
     
     b_active = q->b_active;
@@ -263,7 +254,6 @@ void AIS_Target_Data::CloneFrom( AIS_Target_Data* q )
 
 AIS_Target_Data::~AIS_Target_Data()
 {
-    m_ptrack->Clear();
     delete m_ptrack;
 }
 
@@ -0,0 +1,87 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Per-chart bump allocator
+ * Author:   The OpenCPN developers
+ *
+ ***************************************************************************
+ *   Copyright (C) 2026 by the OpenCPN developers                          *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ *
+ */
+
+#include <stdlib.h>
+
+#include "ChartArena.h"
+
+#define CHARTARENA_ALIGN 8                 // enough for double and pointers
+
+ChartArena::ChartArena( size_t block_size )
+{
+    m_block_size = block_size;
+    m_next = NULL;
+    m_left = 0;
+    m_reserved = 0;
+    m_used = 0;
+}
+
+ChartArena::~ChartArena()
+{
+    Clear();
+}
+
+void *ChartArena::Alloc( size_t size )
+{
+    size = ( size + CHARTARENA_ALIGN - 1 ) & ~( (size_t) CHARTARENA_ALIGN - 1 );
+    if( !size )
+        size = CHARTARENA_ALIGN;
+
+    m_used += size;
+
+    //  Large requests get a block of their own, leaving the current block in use
+    if( size > m_block_size / 4 ) {
+        char *block = (char *) malloc( size );
+        m_blocks.push_back( block );
+        m_reserved += size;
+        return block;
+    }
+
+    if( size > m_left ) {
+        m_next = (char *) malloc( m_block_size );
+        m_blocks.push_back( m_next );
+        m_left = m_block_size;
+        m_reserved += m_block_size;
+    }
+
+    void *p = m_next;
+    m_next += size;
+    m_left -= size;
+    return p;
+}
+
+void ChartArena::Clear()
+{
+    for( size_t i = 0; i < m_blocks.size(); i++ )
+        free( m_blocks[i] );
+    m_blocks.clear();
+
+    m_next = NULL;
+    m_left = 0;
+    m_reserved = 0;
+    m_used = 0;
+}
@@ -0,0 +1,154 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Read-only memory mapped file
+ * Author:   The OpenCPN developers
+ *
+ ***************************************************************************
+ *   Copyright (C) 2026 by the OpenCPN developers                          *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ *
+ */
+
+#include "wx/wxprec.h"
+
+#ifndef  WX_PRECOMP
+#include "wx/wx.h"
+#endif
+
+#include <wx/file.h>
+
+#ifdef __WXMSW__
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "MappedFile.h"
+
+MappedFile::MappedFile()
+{
+    m_data = NULL;
+    m_size = 0;
+    m_bheap = false;
+#ifdef __WXMSW__
+    m_hFile = NULL;
+    m_hMapping = NULL;
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+bool MappedFile::Open( const wxString &path, bool b_append_shared )
+{
+    Close();
+    m_path = path;
+
+#ifdef __WXMSW__
+    DWORD share = FILE_SHARE_READ | FILE_SHARE_DELETE;
+    if( b_append_shared )
+        share |= FILE_SHARE_WRITE;
+    HANDLE hFile = CreateFileW( path.wc_str(), GENERIC_READ, share, NULL,
+                                OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+    if( hFile != INVALID_HANDLE_VALUE ) {
+        LARGE_INTEGER size;
+        if( GetFileSizeEx( hFile, &size ) && size.QuadPart > 0 ) {
+            HANDLE hMapping = CreateFileMapping( hFile, NULL, PAGE_READONLY, 0, 0, NULL );
+            if( hMapping ) {
+                void *p = MapViewOfFile( hMapping, FILE_MAP_READ, 0, 0, 0 );
+                if( p ) {
+                    m_data = (unsigned char *) p;
+                    m_size = (size_t) size.QuadPart;
+                    m_hFile = hFile;
+                    m_hMapping = hMapping;
+                    return true;
+                }
+                CloseHandle( hMapping );
+            }
+        }
+        CloseHandle( hFile );
+    }
+#else
+    int fd = open( path.fn_str(), O_RDONLY );
+    if( fd >= 0 ) {
+        struct stat st;
+        if( fstat( fd, &st ) == 0 && st.st_size > 0 ) {
+            void *p = mmap( NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+            if( p != MAP_FAILED ) {
+                close( fd );                    // the mapping keeps its own reference
+                m_data = (unsigned char *) p;
+                m_size = st.st_size;
+                return true;
+            }
+        }
+        close( fd );
+    }
+#endif
+
+    //  No mapping available, fall back to reading the whole file
+    wxFile file;
+    if( !wxFileExists( path ) || !file.Open( path ) )
+        return false;
+
+    wxFileOffset length = file.Length();
+    if( length <= 0 )
+        return false;
+
+    unsigned char *buf = (unsigned char *) malloc( length );
+    if( !buf )
+        return false;
+
+    if( file.Read( buf, length ) != length ) {
+        free( buf );
+        return false;
+    }
+
+    m_data = buf;
+    m_size = length;
+    m_bheap = true;
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if( m_data ) {
+        if( m_bheap )
+            free( m_data );
+        else {
+#ifdef __WXMSW__
+            UnmapViewOfFile( m_data );
+            CloseHandle( (HANDLE) m_hMapping );
+            CloseHandle( (HANDLE) m_hFile );
+            m_hMapping = NULL;
+            m_hFile = NULL;
+#else
+            munmap( m_data, m_size );
+#endif
+        }
+    }
+
+    m_data = NULL;
+    m_size = 0;
+    m_bheap = false;
+}
@@ -24,6 +24,7 @@
 #include "OCP_DataStreamInput_Thread.h"
 #include "OCPN_DataStreamEvent.h"
 #include "datastream.h"
+#include "SentenceRing.h"
 #include "dychart.h"
 
 #ifdef __WXQT__
@@ -37,6 +38,7 @@
 #define DS_RX_BUFFER_SIZE 4096
 
 extern const wxEventType wxEVT_OCPN_DATASTREAM;
+extern const wxEventType wxEVT_OCPN_DATASTREAMQUEUE;
 extern const wxEventType wxEVT_OCPN_THREADMSG;
 
 #include "chart1.h"
@@ -723,6 +725,19 @@ void OCP_DataStreamInput_Thread::HandleASuccessfulRead( char *szBuf, int nread )
 void OCP_DataStreamInput_Thread::Parse_And_Send_Posn(const char *buf)
 {
     if( m_pMessageTarget ) {
+        //  Queue the sentence, and wake up the consumer only if it is idle
+        SentenceRing *ring = m_launcher->GetSentenceRing();
+        if( ring && ( strlen( buf ) < SENTENCE_RING_SLOT_SIZE ) ) {
+            bool b_signal;
+            if( ring->Put( buf, &b_signal ) && b_signal ) {
+                OCPN_DataStreamEvent Qevent(wxEVT_OCPN_DATASTREAMQUEUE, 0);
+                Qevent.SetStream( m_launcher );
+                m_pMessageTarget->AddPendingEvent(Qevent);
+            }
+            return;                             // queued, or counted as dropped if the ring is full
+        }
+
+        //  Oversize sentences are sent on their own
         OCPN_DataStreamEvent Nevent(wxEVT_OCPN_DATASTREAM, 0);
         Nevent.SetNMEAString( buf );
         Nevent.SetStream( m_launcher );
@@ -31,6 +31,7 @@
 #endif //precompiled headers
 
 #include <setjmp.h>
+#include <new>
 
 #include <wx/wfstream.h>
 #include <wx/filename.h>
@@ -39,6 +40,7 @@
 #include "Osenc.h"
 #include "s52s57.h"
 #include "s57chart.h"
+#include "ChartArena.h"
 #include "cutil.h"
 #include "s57RegistrarMgr.h"
 #include "cpl_csv.h"
@@ -160,6 +162,71 @@ void Osenc_instreamFile::Init()
 }
 
 
+//--------------------------------------------------------------------------
+//      Osenc_instreamMapped implementation
+//      Records are handed out in place from the file image, so the loader
+//      need not copy them.  The image must outlive any pointer taken from it.
+//--------------------------------------------------------------------------
+Osenc_instreamMapped::Osenc_instreamMapped()
+{
+    m_pos = 0;
+    m_ok = false;
+}
+
+Osenc_instreamMapped::~Osenc_instreamMapped()
+{
+}
+
+bool Osenc_instreamMapped::Open( const wxString &senc_file_name )
+{
+    m_pos = 0;
+    m_ok = m_file.Open( senc_file_name );
+    return m_ok;
+}
+
+void Osenc_instreamMapped::Close()
+{
+    m_file.Close();
+    m_pos = 0;
+    m_ok = false;
+}
+
+Osenc_instream &Osenc_instreamMapped::Read(void *buffer, size_t size)
+{
+    const unsigned char *p = ReadInPlace( size );
+    if(p)
+        memcpy(buffer, p, size);
+
+    return *this;
+}
+
+const unsigned char *Osenc_instreamMapped::ReadInPlace(size_t size)
+{
+    if(!m_ok || (size > m_file.GetSize() - m_pos)){
+        m_ok = false;
+        return NULL;
+    }
+
+    const unsigned char *p = m_file.GetData() + m_pos;
+    m_pos += size;
+    return p;
+}
+
+bool Osenc_instreamMapped::IsOk()
+{
+    return m_ok;
+}
+
+bool Osenc_instreamMapped::isAvailable()
+{
+    return true;
+}
+
+void Osenc_instreamMapped::Shutdown()
+{
+}
+
+
 //--------------------------------------------------------------------------
 //      Osenc_outstreamFile implementation
 //      A simple file stream implementation based on wxFFileOutStream
@@ -255,6 +322,8 @@ Osenc::~Osenc()
     free( m_pNoCOVRTablePoints );
     free( m_pNoCOVRTable );
     
+    delete m_pInstream;
+    
     CPLPopErrorHandler();
     
     
@@ -284,6 +353,9 @@ void Osenc::init( void )
     m_pauxInstream = NULL;
     m_pOutstream = NULL;
     m_pInstream = NULL;
+    m_bPayloadInPlace = false;
+    m_pObjectArena = NULL;
+    m_nPriorFeaturesCopied = 0;
     
     m_bVerbose = true;
     g_OsencVerbose = true;
@@ -565,11 +637,24 @@ int Osenc::ingest200(const wxString &senc_file_name,
 //     }
 //     wxBufferedInputStream fpx( fpx_u );
 
+    //    Map the file, so that records are parsed in place rather than copied.
+    //    The stream lives as long as this Osenc, and edge vertices returned
+    //    in pVEArray point into it when m_bPayloadInPlace is set.
+    //    ARM cannot load doubles from the unaligned offsets found in the file.
+    delete m_pInstream;
+#ifdef __ARM_ARCH
+    m_pInstream = new Osenc_instreamFile;
+#else
+    m_pInstream = new Osenc_instreamMapped;
+#endif
+    Osenc_instream &fpx = *m_pInstream;
+    
     //    Sanity check for existence of file
-    Osenc_instreamFile fpx;
     fpx.Open( senc_file_name );
     if (!fpx.IsOk())
         return ERROR_SENCFILE_NOT_FOUND;
+
+    m_bPayloadInPlace = (fpx.ReadInPlace( 0 ) != NULL);
     
     S57Obj *obj = 0;
     int featureID;
@@ -593,8 +678,8 @@ int Osenc::ingest200(const wxString &senc_file_name,
         switch( record.record_type){
             case HEADER_SENC_VERSION:
             {
-                unsigned char *buf = getBuffer( record.record_length - sizeof(OSENC_Record_Base));
-                if(!fpx.Read(buf, record.record_length - sizeof(OSENC_Record_Base)).IsOk()){
+                unsigned char *buf = readPayload( fpx, record.record_length - sizeof(OSENC_Record_Base));
+                if(!buf){
                     dun = 1; break;
                 }
                 uint16_t *pint = (uint16_t*)buf;
@@ -603,8 +688,8 @@ int Osenc::ingest200(const wxString &senc_file_name,
             }
             case HEADER_CELL_NAME:
             {
-                unsigned char *buf = getBuffer( record.record_length - sizeof(OSENC_Record_Base));
-                if(!fpx.Read(buf, record.record_length - sizeof(OSENC_Record_Base)).IsOk()){
+                unsigned char *buf = readPayload( fpx, record.record_length - sizeof(OSENC_Record_Base));
+                if(!buf){
                     dun = 1; break;
                 }
                 m_Name = wxString( buf, wxConvUTF8 );
@@ -612,8 +697,8 @@ int Osenc::ingest200(const wxString &senc_file_name,
             }
             case HEADER_CELL_PUBLISHDATE:
             {
-                unsigned char *buf = getBuffer( record.record_length - sizeof(OSENC_Record_Base));
-                if(!fpx.Read(buf, record.record_length - sizeof(OSENC_Record_Base)).IsOk()){
+                unsigned char *buf = readPayload( fpx, record.record_length - sizeof(OSENC_Record_Base));
+                if(!buf){
                     dun = 1; break;
                 }
                 m_sdate000 = wxString( buf, wxConvUTF8 );
@@ -622,8 +707,8 @@ int Osenc::ingest200(const wxString &senc_file_name,
             
             case HEADER_CELL_EDITION:
             {
-                unsigned char *buf = getBuffer( record.record_length - sizeof(OSENC_Record_Base));
-                if(!fpx.Read(buf, record.record_length - sizeof(OSENC_Record_Base)).IsOk()){
+                unsigned char *buf = readPayload( fpx, record.record_length - sizeof(OSENC_Record_Base));
+                if(!buf){
                     dun = 1; break;
                 }
                 uint16_t *pint = (uint16_t*)buf;
@@ -634,8 +719,8 @@ int Osenc::ingest200(const wxString &senc_file_name,
             
             case HEADER_CELL_UPDATEDATE:
             {
-                unsigned char *buf = getBuffer( record.record_length - sizeof(OSENC_Record_Base));
-                if(!fpx.Read(buf, record.record_length - sizeof(OSENC_Record_Base)).IsOk()){
+                unsigned char *buf = readPayload( fpx, record.record_length - sizeof(OSENC_Record_Base));
+                if(!buf){
                     dun = 1; break;
                 }
                 m_LastUpdateDate = wxString( buf, wxConvUTF8 );
@@ -644,8 +729,8 @@ int Osenc::ingest200(const wxString &senc_file_name,
                 
             case HEADER_CELL_UPDATE:
             {
-                unsigned char *buf = getBuffer( record.record_length - sizeof(OSENC_Record_Base));
-                if(!fpx.Read(buf, record.record_length - sizeof(OSENC_Record_Base)).IsOk()){
+                unsigned char *buf = readPayload( fpx, record.record_length - sizeof(OSENC_Record_Base));
+                if(!buf){
                     dun = 1; break;
                 }
                 uint16_t *pint = (uint16_t*)buf;
@@ -656,8 +741,8 @@ int Osenc::ingest200(const wxString &senc_file_name,
             
             case HEADER_CELL_NATIVESCALE:
             {
-                unsigned char *buf = getBuffer( record.record_length - sizeof(OSENC_Record_Base));
-                if(!fpx.Read(buf, record.record_length - sizeof(OSENC_Record_Base)).IsOk()){
+                unsigned char *buf = readPayload( fpx, record.record_length - sizeof(OSENC_Record_Base));
+                if(!buf){
                     dun = 1; break;
                 }
                 uint32_t *pint = (uint32_t*)buf;
@@ -667,8 +752,8 @@ int Osenc::ingest200(const wxString &senc_file_name,
             
             case HEADER_CELL_SENCCREATEDATE:
             {
-                unsigned char *buf = getBuffer( record.record_length - sizeof(OSENC_Record_Base));
-                if(!fpx.Read(buf, record.record_length - sizeof(OSENC_Record_Base)).IsOk()){
+                unsigned char *buf = readPayload( fpx, record.record_length - sizeof(OSENC_Record_Base));
+                if(!buf){
                     dun = 1; break;
                 }
                 break;
@@ -676,8 +761,8 @@ int Osenc::ingest200(const wxString &senc_file_name,
             
             case CELL_EXTENT_RECORD:
             {
-                unsigned char *buf = getBuffer( record.record_length - sizeof(OSENC_Record_Base));
-                if(!fpx.Read(buf, record.record_length - sizeof(OSENC_Record_Base)).IsOk()){
+                unsigned char *buf = readPayload( fpx, record.record_length - sizeof(OSENC_Record_Base));
+                if(!buf){
                     dun = 1; break;
                 }
                 _OSENC_EXTENT_Record_Payload *pPayload = (_OSENC_EXTENT_Record_Payload *)buf;
@@ -696,8 +781,8 @@ int Osenc::ingest200(const wxString &senc_file_name,
             
             case CELL_COVR_RECORD:
             {
-                unsigned char *buf = getBuffer( record.record_length - sizeof(OSENC_Record_Base));
-                if(!fpx.Read(buf, record.record_length - sizeof(OSENC_Record_Base)).IsOk()){
+                unsigned char *buf = readPayload( fpx, record.record_length - sizeof(OSENC_Record_Base));
+                if(!buf){
                     dun = 1; break;
                 }
                 
@@ -706,8 +791,8 @@ int Osenc::ingest200(const wxString &senc_file_name,
             
             case CELL_NOCOVR_RECORD:
             {
-                unsigned char *buf = getBuffer( record.record_length - sizeof(OSENC_Record_Base));
-                if(!fpx.Read(buf, record.record_length - sizeof(OSENC_Record_Base)).IsOk()){
+                unsigned char *buf = readPayload( fpx, record.record_length - sizeof(OSENC_Record_Base));
+                if(!buf){
                     dun = 1; break;
                 }
                 
@@ -716,8 +801,8 @@ int Osenc::ingest200(const wxString &senc_file_name,
             
             case FEATURE_ID_RECORD:
             {
-                unsigned char *buf = getBuffer( record.record_length - sizeof(OSENC_Record_Base));
-                if(!fpx.Read(buf, record.record_length - sizeof(OSENC_Record_Base)).IsOk()){
+                unsigned char *buf = readPayload( fpx, record.record_length - sizeof(OSENC_Record_Base));
+                if(!buf){
                     dun = 1; break;
                 }
                 
@@ -742,8 +827,12 @@ int Osenc::ingest200(const wxString &senc_file_name,
 //                     int yyp = 4;
                 
                 if(acronym.length()){
-                    obj = new S57Obj(acronym.c_str());
+                    if( m_pObjectArena )
+                        obj = new( m_pObjectArena->Alloc( sizeof(S57Obj) ) ) S57Obj(acronym.c_str());
+                    else
+                        obj = new S57Obj(acronym.c_str());
                     obj->Index = featureID;
+                    obj->m_arena = m_pObjectArena;
                     
                     pObjectVector->push_back(obj);
                 }
@@ -753,8 +842,8 @@ int Osenc::ingest200(const wxString &senc_file_name,
                 
             case FEATURE_ATTRIBUTE_RECORD:
             {
-                unsigned char *buf = getBuffer( record.record_length - sizeof(OSENC_Record_Base));
-                if(!fpx.Read(buf, record.record_length - sizeof(OSENC_Record_Base)).IsOk()){
+                unsigned char *buf = readPayload( fpx, record.record_length - sizeof(OSENC_Record_Base));
+                if(!buf){
                     dun = 1; break;
                 }
                 
@@ -828,8 +917,8 @@ int Osenc::ingest200(const wxString &senc_file_name,
             
             case FEATURE_GEOMETRY_RECORD_POINT:
             {
-                unsigned char *buf = getBuffer( record.record_length - sizeof(OSENC_Record_Base));
-                if(!fpx.Read(buf, record.record_length - sizeof(OSENC_Record_Base)).IsOk()){
+                unsigned char *buf = readPayload( fpx, record.record_length - sizeof(OSENC_Record_Base));
+                if(!buf){
                     dun = 1; break;
                 }
                 
@@ -845,8 +934,8 @@ int Osenc::ingest200(const wxString &senc_file_name,
 
             case FEATURE_GEOMETRY_RECORD_AREA:
             {
-                unsigned char *buf = getBuffer( record.record_length - sizeof(OSENC_Record_Base));
-                if(!fpx.Read(buf, record.record_length - sizeof(OSENC_Record_Base)).IsOk()){
+                unsigned char *buf = readPayload( fpx, record.record_length - sizeof(OSENC_Record_Base));
+                if(!buf){
                     dun = 1; break;
                 }
 
@@ -887,8 +976,8 @@ int Osenc::ingest200(const wxString &senc_file_name,
 
             case FEATURE_GEOMETRY_RECORD_LINE:
             {
-                unsigned char *buf = getBuffer( record.record_length - sizeof(OSENC_Record_Base));
-                if(!fpx.Read(buf, record.record_length - sizeof(OSENC_Record_Base)).IsOk()){
+                unsigned char *buf = readPayload( fpx, record.record_length - sizeof(OSENC_Record_Base));
+                if(!buf){
                     dun = 1; break;
                 }
                 
@@ -907,8 +996,8 @@ int Osenc::ingest200(const wxString &senc_file_name,
  
             case FEATURE_GEOMETRY_RECORD_MULTIPOINT:
             {
-                unsigned char *buf = getBuffer( record.record_length - sizeof(OSENC_Record_Base));
-                if(!fpx.Read(buf, record.record_length - sizeof(OSENC_Record_Base)).IsOk()){
+                unsigned char *buf = readPayload( fpx, record.record_length - sizeof(OSENC_Record_Base));
+                if(!buf){
                     dun = 1; break;
                 }
 
@@ -937,8 +1026,8 @@ int Osenc::ingest200(const wxString &senc_file_name,
             
             case VECTOR_EDGE_NODE_TABLE_RECORD:
             {
-                unsigned char *buf = getBuffer( record.record_length - sizeof(OSENC_Record_Base));
-                if(!fpx.Read(buf, record.record_length - sizeof(OSENC_Record_Base)).IsOk()){
+                unsigned char *buf = readPayload( fpx, record.record_length - sizeof(OSENC_Record_Base));
+                if(!buf){
                     dun = 1; break;
                 }
                 
@@ -959,8 +1048,12 @@ int Osenc::ingest200(const wxString &senc_file_name,
                     
                     float *pPoints = NULL;
                     if( pointCount ) {
-                        pPoints = (float *) malloc( pointCount * 2 * sizeof(float) );
-                        memcpy(pPoints, pRun, pointCount * 2 * sizeof(float));
+                        if( m_bPayloadInPlace )
+                            pPoints = (float *)pRun;
+                        else {
+                            pPoints = (float *) malloc( pointCount * 2 * sizeof(float) );
+                            memcpy(pPoints, pRun, pointCount * 2 * sizeof(float));
+                        }
                     }
                     pRun += pointCount * 2 * sizeof(float);
                     
@@ -980,8 +1073,8 @@ int Osenc::ingest200(const wxString &senc_file_name,
 
             case VECTOR_CONNECTED_NODE_TABLE_RECORD:
             {
-                unsigned char *buf = getBuffer( record.record_length - sizeof(OSENC_Record_Base));
-                if(!fpx.Read(buf, record.record_length - sizeof(OSENC_Record_Base)).IsOk()){
+                unsigned char *buf = readPayload( fpx, record.record_length - sizeof(OSENC_Record_Base));
+                if(!buf){
                     dun = 1; break;
                 }
                 
@@ -1012,7 +1105,13 @@ int Osenc::ingest200(const wxString &senc_file_name,
             }
             
             default:
+            {
+                //  Step over records not used here, e.g. FEATURE_RCID_RECORD
+                if(!readPayload( fpx, record.record_length - sizeof(OSENC_Record_Base))){
+                    dun = 1; break;
+                }
                 break;
+            }
                 
         }       // switch
             
@@ -1059,13 +1158,19 @@ int Osenc::ingestCell( OGRS57DataSource *poS57DS, const wxString &FullPath000, c
     //      Open the OGRS57DataSource
     //      This will ingest the .000 file from the working dir, and apply updates
     
+    //  g_bGDAL_Debug is shared with the main thread, so only the main thread may change it
+    bool b_main = wxThread::IsMain();
     bool b_current_debug = g_bGDAL_Debug;
-    g_bGDAL_Debug = m_bVerbose;
+    if( b_main )
+        g_bGDAL_Debug = m_bVerbose;
     
-    if(poS57DS->Open( m_tmpup_array.Item( 0 ).mb_str(), TRUE, NULL))
-        return 1;
+    int open_ret = poS57DS->Open( m_tmpup_array.Item( 0 ).mb_str(), TRUE, NULL);
     
-    g_bGDAL_Debug = b_current_debug;
+    if( b_main )
+        g_bGDAL_Debug = b_current_debug;
+    
+    if( open_ret )
+        return 1;
     
     //      Get a pointer to the reader
     S57Reader *poReader = poS57DS->GetModule( 0 );
@@ -1161,7 +1266,7 @@ int Osenc::ValidateAndCountUpdates( const wxFileName file000, const wxString Cop
                     wxLogMessage(_T("   This ENC exchange set should be updated and SENCs rebuilt.") );
                     
                          
-                    if( !chain_broken_mssage_shown ){
+                    if( !chain_broken_mssage_shown && wxThread::IsMain() ){
                          OCPNMessageBox(NULL, 
                          _("S57 Cell Update chain incomplete.\nENC features may be incomplete or inaccurate.\n\nCheck the logfile for details."),
                          _("OpenCPN Create SENC Warning"), wxOK | wxICON_EXCLAMATION, 30 );
@@ -1297,7 +1402,7 @@ int Osenc::createSenc200(const wxString& FullPath000, const wxString& SENCFileNa
 {
     m_FullPath000 = FullPath000;
     
-    m_senc_file_create_version = 200;
+    m_senc_file_create_version = CURRENT_SENC_FORMAT_VERSION;
     
     if(!m_poRegistrar){
         errorMessage = _T("S57 Registrar not set.");
@@ -1317,9 +1422,15 @@ int Osenc::createSenc200(const wxString& FullPath000, const wxString& SENCFileNa
     }
     
     
-    //          Make a temp file to create the SENC in
-    wxFileName tfn;
-    wxString tmp_file = tfn.CreateTempFileName( _T("") );
+    //          Make a temp file to create the SENC in.
+    //          It lives beside the target, so that the final rename cannot cross file systems
+    //          and a partial SENC is never seen under the target name.
+    wxString tmp_file = wxFileName::CreateTempFileName( SENCfile.GetPathWithSep() + SENCfile.GetName() );
+    if( tmp_file.IsEmpty() ) {
+        errorMessage = _T("Unable to create temp SENC file for ");
+        errorMessage += SENCfile.GetFullPath();
+        return ERROR_CANNOT_CREATE_TEMP_SENC_FILE;
+    }
     
 //     FILE *fps57;
 //     const char *pp = "wb";
@@ -1343,12 +1454,12 @@ int Osenc::createSenc200(const wxString& FullPath000, const wxString& SENCFileNa
     if( !stream->Open( tmp_file) ) {
         errorMessage = _T("Unable to create temp SENC file: ");
         errorMessage += tmp_file;
-        return ERROR_CANNOT_CREATE_TEMP_SENC_FILE;
+        return abandonSenc200( tmp_file, NULL, ERROR_CANNOT_CREATE_TEMP_SENC_FILE );
     }
     
     //  Take a quick scan of the 000 file to get some basic attributes of the exchange set.
     if(!GetBaseFileAttr( FullPath000 ) ){
-        return ERROR_BASEFILE_ATTRIBUTES;
+        return abandonSenc200( tmp_file, NULL, ERROR_BASEFILE_ATTRIBUTES );
     }
     
     
@@ -1361,14 +1472,14 @@ int Osenc::createSenc200(const wxString& FullPath000, const wxString& SENCFileNa
     
     if(ingestCell( poS57DS, FullPath000, SENCfile.GetPath())){
         errorMessage = _T("Error ingesting: ") + FullPath000;
-        return ERROR_INGESTING000;
+        return abandonSenc200( tmp_file, poS57DS, ERROR_INGESTING000 );
     }
     
     S57Reader *poReader = poS57DS->GetModule( 0 );
     
     //  Create the Coverage table Records, which also calculates the chart extents
     if(!CreateCOVRTables( poReader, m_poRegistrar )){
-        return ERROR_SENCFILE_ABORT;
+        return abandonSenc200( tmp_file, poS57DS, ERROR_SENCFILE_ABORT );
     }
    
     //  Establish a common reference point for the chart, from the extent
@@ -1393,60 +1504,51 @@ int Osenc::createSenc200(const wxString& FullPath000, const wxString& SENCFileNa
         sname = buffer.data();
 
     if( !WriteHeaderRecord200( stream, HEADER_SENC_VERSION, (uint16_t)m_senc_file_create_version) ){
-        stream->Close();
-        return ERROR_SENCFILE_ABORT;
+        return abandonSenc200( tmp_file, poS57DS, ERROR_SENCFILE_ABORT );
     }
     
     if( !WriteHeaderRecord200( stream, HEADER_CELL_NAME, sname) ){
-        stream->Close();
-        return ERROR_SENCFILE_ABORT;
+        return abandonSenc200( tmp_file, poS57DS, ERROR_SENCFILE_ABORT );
     }
     
     wxString date000 = m_date000.Format( _T("%Y%m%d") );
     string sdata = date000.ToStdString();
     if( !WriteHeaderRecord200( stream, HEADER_CELL_PUBLISHDATE, sdata) ){
-        stream->Close();
-        return ERROR_SENCFILE_ABORT;
+        return abandonSenc200( tmp_file, poS57DS, ERROR_SENCFILE_ABORT );
     }
 
     
     long n000 = 0;
     m_edtn000.ToLong( &n000 );
     if( !WriteHeaderRecord200( stream, HEADER_CELL_EDITION, (uint16_t)n000) ){
-        stream->Close();
-        return ERROR_SENCFILE_ABORT;
+        return abandonSenc200( tmp_file, poS57DS, ERROR_SENCFILE_ABORT );
     }
     
     sdata = m_LastUpdateDate.ToStdString();
     if( !WriteHeaderRecord200( stream, HEADER_CELL_UPDATEDATE, sdata) ){
-        stream->Close();
-        return ERROR_SENCFILE_ABORT;
+        return abandonSenc200( tmp_file, poS57DS, ERROR_SENCFILE_ABORT );
     }
     
     
     if( !WriteHeaderRecord200( stream, HEADER_CELL_UPDATE, (uint16_t)m_last_applied_update) ){
-        stream->Close();
-        return ERROR_SENCFILE_ABORT;
+        return abandonSenc200( tmp_file, poS57DS, ERROR_SENCFILE_ABORT );
     }
 
     if( !WriteHeaderRecord200( stream, HEADER_CELL_NATIVESCALE, (uint32_t)m_native_scale) ){
-        stream->Close();
-        return ERROR_SENCFILE_ABORT;
+        return abandonSenc200( tmp_file, poS57DS, ERROR_SENCFILE_ABORT );
     }
     
     wxDateTime now = wxDateTime::Now();
     wxString dateNow = now.Format( _T("%Y%m%d") );
     sdata = dateNow.ToStdString();
     if( !WriteHeaderRecord200( stream, HEADER_CELL_SENCCREATEDATE, sdata) ){
-        stream->Close();
-        return ERROR_SENCFILE_ABORT;
+        return abandonSenc200( tmp_file, poS57DS, ERROR_SENCFILE_ABORT );
     }
     
  
     //  Write the Coverage table Records
     if(!CreateCovrRecords(stream)){
-        stream->Close();
-        return ERROR_SENCFILE_ABORT;
+        return abandonSenc200( tmp_file, poS57DS, ERROR_SENCFILE_ABORT );
     }
     
  
@@ -1468,6 +1570,15 @@ int Osenc::createSenc200(const wxString& FullPath000, const wxString& SENCFileNa
         pEdgeVectorRecordFeature = poReader->ReadVector( feid, RCNM_VE );
     }
     
+    //  Given the SENC of an earlier update, only features touched by the updates applied since
+    //  need be built afresh.  The rest are copied from it, saving the tessellation.
+    bool b_prior = false;
+    if( !m_PriorSENC.IsEmpty() ){
+        b_prior = preparePriorSENC( poReader );
+        if( !b_prior )
+            m_PriorImage.Close();
+    }
+    
     wxString Message = SENCfile.GetFullPath();
     Message.Append( _T("...Ingesting") );
     
@@ -1534,7 +1645,8 @@ int Osenc::createSenc200(const wxString& FullPath000, const wxString& SENCFileNa
             
             //      n.b  This next line causes skip of C_AGGR features w/o geometry
                 if( geoType != wkbUnknown ){                             // Write only if has wkbGeometry
-                    CreateSENCRecord200( objectDef, stream, 1, poReader );
+                    if( !b_prior || !copyPriorFeature( objectDef, stream ) )
+                        CreateSENCRecord200( objectDef, stream, 1, poReader );
                 }
                 
                 delete objectDef;
@@ -1556,33 +1668,40 @@ int Osenc::createSenc200(const wxString& FullPath000, const wxString& SENCFileNa
     //          All done, so clean up
     stream->Close();
     
+    //  The prior SENC must be unmapped before the new one can be renamed over it
+    m_PriorImage.Close();
+    
+    if( !bcont || !stream->IsOk() )             // aborted, or the SENC is incomplete
+        return abandonSenc200( tmp_file, poS57DS, ERROR_SENCFILE_ABORT );
+    
+    if( b_prior && m_bVerbose ){
+        wxString msg;
+        msg.Printf( _T("   Reused %d unchanged features from the prior SENC "), m_nPriorFeaturesCopied );
+        msg.Append( m_PriorSENC );
+        wxLogMessage( msg );
+    }
+    
     //  Delete any temporary (working) real and dummy update files,
     //  as well as .000 file created by ValidateAndCountUpdates()
     for( unsigned int iff = 0; iff < m_tmpup_array.GetCount(); iff++ )
         remove( m_tmpup_array.Item( iff ).mb_str() );
+    m_tmpup_array.Clear();
     
-    int ret_code = 0;
+    int ret_code = SENC_NO_ERROR;
     
-    if( !bcont )                // aborted
-    {
-        wxRemoveFile( tmp_file );                     // kill the temp file
+    bool cpok = wxRenameFile( tmp_file, SENCfile.GetFullPath() );
+    if( !cpok ) {
+        errorMessage =  _T("   Cannot rename temporary SENC file ");
+        errorMessage.Append( tmp_file );
+        errorMessage.Append( _T(" to ") );
+        errorMessage.Append( SENCfile.GetFullPath() );
+        wxRemoveFile( tmp_file );
         ret_code = ERROR_SENCFILE_ABORT;
     }
     
-    if( bcont ) {
-        bool cpok = wxRenameFile( tmp_file, SENCfile.GetFullPath() );
-        if( !cpok ) {
-            errorMessage =  _T("   Cannot rename temporary SENC file ");
-            errorMessage.Append( tmp_file );
-            errorMessage.Append( _T(" to ") );
-            errorMessage.Append( SENCfile.GetFullPath() );
-            ret_code = ERROR_SENCFILE_ABORT;
-        } else
-            ret_code = SENC_NO_ERROR;
-    }
-    
 #if wxUSE_PROGRESSDLG
     delete m_ProgDialog;
+    m_ProgDialog = NULL;
 #endif    
     
     delete poS57DS;
@@ -1592,6 +1711,264 @@ int Osenc::createSenc200(const wxString& FullPath000, const wxString& SENCFileNa
    
 }
 
+//  Clean up after a createSenc200() that cannot complete, leaving any existing SENC untouched
+int Osenc::abandonSenc200( const wxString &tmp_file, OGRS57DataSource *poS57DS, int ret_code )
+{
+    if( m_pOutstream )
+        m_pOutstream->Close();
+    
+    m_PriorImage.Close();
+    
+    wxRemoveFile( tmp_file );
+    
+    for( unsigned int iff = 0; iff < m_tmpup_array.GetCount(); iff++ )
+        remove( m_tmpup_array.Item( iff ).mb_str() );
+    m_tmpup_array.Clear();
+    
+#if wxUSE_PROGRESSDLG
+    delete m_ProgDialog;
+    m_ProgDialog = NULL;
+#endif    
+    
+    delete poS57DS;
+    
+    return ret_code;
+}
+
+//  Decide whether the prior SENC can serve as the base of this one, and if so
+//  gather what the updates applied since it was built have touched.
+bool Osenc::preparePriorSENC( S57Reader *poReader )
+{
+    int prior_update = 0;
+    if( !indexPriorSENC( prior_update ) )
+        return false;
+    
+    if( !collectUpdatedRecords( poReader, prior_update + 1 ) )
+        return false;
+    
+    if( m_bVerbose ){
+        wxString msg;
+        msg.Printf( _T("   Applying updates %d to %d to the prior SENC, touching %d features and %d spatial records."),
+                    prior_update + 1, m_last_applied_update,
+                    (int)m_updated_features.size(), (int)m_updated_vectors.size() );
+        wxLogMessage( msg );
+    }
+    
+    return true;
+}
+
+//  Map the prior SENC, check it against the cell just ingested, and index its feature
+//  records by source RCID.  Only SENCs of the current format carry FEATURE_RCID_RECORD.
+bool Osenc::indexPriorSENC( int &prior_update )
+{
+    m_prior_features.clear();
+    
+    if( !m_PriorImage.Open( m_PriorSENC ) )
+        return false;
+    
+    const unsigned char *pData = m_PriorImage.GetData();
+    size_t size = m_PriorImage.GetSize();
+    
+    int version = 0;
+    int edition = -1;
+    prior_update = -1;
+    bool b_extent_ok = false;
+    
+    size_t feature_start = 0;
+    int feature_rcid = -1;
+    bool b_in_feature = false;
+    
+    size_t pos = 0;
+    while( pos + sizeof(OSENC_Record_Base) <= size ) {
+        OSENC_Record_Base record;
+        memcpy( &record, pData + pos, sizeof(OSENC_Record_Base) );
+        if( ( record.record_length < sizeof(OSENC_Record_Base) ) || ( record.record_length > size - pos ) )
+            return false;                               // truncated, or not a SENC
+        
+        const unsigned char *pPayload = pData + pos + sizeof(OSENC_Record_Base);
+        
+        //  A feature's records run from its FEATURE_ID_RECORD up to the next record of any other kind
+        bool b_feature_record = ( record.record_type == FEATURE_ATTRIBUTE_RECORD ) ||
+                                ( record.record_type == FEATURE_RCID_RECORD ) ||
+                                ( ( record.record_type >= FEATURE_GEOMETRY_RECORD_POINT ) &&
+                                  ( record.record_type <= FEATURE_GEOMETRY_RECORD_MULTIPOINT ) );
+        if( b_in_feature && !b_feature_record ){
+            if( feature_rcid >= 0 ){
+                PriorFeatureRecords &pfr = m_prior_features[feature_rcid];
+                pfr.offset = feature_start;
+                pfr.length = pos - feature_start;
+            }
+            b_in_feature = false;
+        }
+        
+        switch( record.record_type ){
+            case HEADER_SENC_VERSION:
+            {
+                uint16_t val;
+                memcpy( &val, pPayload, sizeof(uint16_t) );
+                version = val;
+                break;
+            }
+            case HEADER_CELL_EDITION:
+            {
+                uint16_t val;
+                memcpy( &val, pPayload, sizeof(uint16_t) );
+                edition = val;
+                break;
+            }
+            case HEADER_CELL_UPDATE:
+            {
+                uint16_t val;
+                memcpy( &val, pPayload, sizeof(uint16_t) );
+                prior_update = val;
+                break;
+            }
+            case CELL_EXTENT_RECORD:
+            {
+                //  Every coordinate in the SENC is relative to the centre of the extent,
+                //  so records can only be reused if the extent is unchanged
+                _OSENC_EXTENT_Record_Payload extent;
+                memcpy( &extent, pPayload, sizeof(extent) );
+                b_extent_ok = ( extent.extent_nw_lat == m_extent.NLAT ) &&
+                              ( extent.extent_se_lat == m_extent.SLAT ) &&
+                              ( extent.extent_nw_lon == m_extent.WLON ) &&
+                              ( extent.extent_se_lon == m_extent.ELON );
+                break;
+            }
+            case FEATURE_ID_RECORD:
+            {
+                b_in_feature = ( record.record_length == sizeof(OSENC_Feature_Identification_Record_Base) );
+                feature_start = pos;
+                feature_rcid = -1;
+                break;
+            }
+            case FEATURE_RCID_RECORD:
+            {
+                uint32_t val;
+                memcpy( &val, pPayload, sizeof(uint32_t) );
+                feature_rcid = val;
+                break;
+            }
+            default:
+                break;
+        }
+        
+        pos += record.record_length;
+    }
+    
+    long n000 = 0;
+    m_edtn000.ToLong( &n000 );
+    
+    if( ( version != CURRENT_SENC_FORMAT_VERSION ) || ( edition != n000 ) || !b_extent_ok )
+        return false;
+    if( ( prior_update < 0 ) || ( prior_update > m_last_applied_update ) )
+        return false;
+    
+    return !m_prior_features.empty();
+}
+
+//  Collect the feature and spatial records inserted, deleted or modified by updates
+//  first_update to m_last_applied_update.  An edge is also touched if either of its
+//  end nodes is, since its geometry includes them.
+bool Osenc::collectUpdatedRecords( S57Reader *poReader, int first_update )
+{
+    m_updated_features.clear();
+    m_updated_vectors.clear();
+    
+    bool b_nodes_touched = false;
+    
+    for( int iff = first_update; iff <= m_last_applied_update; iff++ ) {
+        if( iff >= (int)m_tmpup_array.GetCount() )
+            return false;
+        
+        DDFModule oUpdateModule;
+        if( !oUpdateModule.Open( m_tmpup_array.Item( iff ).mb_str(), TRUE ) )
+            return false;
+        
+        DDFRecord *poRecord;
+        while( (poRecord = oUpdateModule.ReadRecord()) != NULL ) {
+            DDFField *poKeyField = poRecord->GetField( 1 );
+            if( !poKeyField )
+                continue;
+            
+            const char *pszKey = poKeyField->GetFieldDefn()->GetName();
+            if( EQUAL(pszKey, "FRID") )
+                m_updated_features.insert( poRecord->GetIntSubfield( "FRID", 0, "RCID", 0 ) );
+            else if( EQUAL(pszKey, "VRID") ) {
+                int nRCNM = poRecord->GetIntSubfield( "VRID", 0, "RCNM", 0 );
+                int nRCID = poRecord->GetIntSubfield( "VRID", 0, "RCID", 0 );
+                m_updated_vectors.insert( std::make_pair( nRCNM, nRCID ) );
+                if( nRCNM == RCNM_VC )
+                    b_nodes_touched = true;
+            }
+        }
+    }
+    
+    if( b_nodes_touched ) {
+        char ** papszReaderOptions = NULL;
+        papszReaderOptions = CSLSetNameValue( papszReaderOptions, S57O_UPDATES, "ON" );
+        papszReaderOptions = CSLSetNameValue( papszReaderOptions, S57O_RETURN_LINKAGES, "ON" );
+        papszReaderOptions = CSLSetNameValue( papszReaderOptions, S57O_RETURN_PRIMITIVES, "ON" );
+        poReader->SetOptions( papszReaderOptions );
+        
+        for( VectorHelperHash::iterator it = m_vector_helper_hash.begin(); it != m_vector_helper_hash.end(); ++it ) {
+            OGRFeature *pEdgeVectorRecordFeature = poReader->ReadVector( it->second, RCNM_VE );
+            if( NULL == pEdgeVectorRecordFeature )
+                continue;
+            
+            int start_rcid = pEdgeVectorRecordFeature->GetFieldAsInteger( "NAME_RCID_0" );
+            int end_rcid = pEdgeVectorRecordFeature->GetFieldAsInteger( "NAME_RCID_1" );
+            if( m_updated_vectors.count( std::make_pair( (int)RCNM_VC, start_rcid ) ) ||
+                m_updated_vectors.count( std::make_pair( (int)RCNM_VC, end_rcid ) ) )
+                m_updated_vectors.insert( std::make_pair( (int)RCNM_VE, it->first ) );
+            
+            delete pEdgeVectorRecordFeature;
+        }
+        
+        papszReaderOptions = CSLSetNameValue( papszReaderOptions, S57O_RETURN_PRIMITIVES, "OFF" );
+        poReader->SetOptions( papszReaderOptions );
+        CSLDestroy( papszReaderOptions );
+    }
+    
+    return true;
+}
+
+//  Copy a feature's records from the prior SENC if neither the feature nor any spatial
+//  record it uses has been touched by the newer updates.  Returns false if it must be rebuilt.
+bool Osenc::copyPriorFeature( OGRFeature *pFeature, Osenc_outstream *stream )
+{
+    int rcid = pFeature->GetFieldAsInteger( "RCID" );
+    
+    PriorFeatureHash::iterator it = m_prior_features.find( rcid );
+    if( it == m_prior_features.end() )
+        return false;
+    if( m_updated_features.count( rcid ) )
+        return false;
+    
+    int nRefs = 0;
+    const int *pNAME_RCID = pFeature->GetFieldAsIntegerList( "NAME_RCID", &nRefs );
+    const int *pNAME_RCNM = pFeature->GetFieldAsIntegerList( "NAME_RCNM", NULL );
+    for( int i = 0; i < nRefs; i++ ) {
+        if( m_updated_vectors.count( std::make_pair( pNAME_RCNM[i], pNAME_RCID[i] ) ) )
+            return false;
+    }
+    
+    //  The records go across as they stand, except for the feature ID, which is the
+    //  feature's index in this ingest and so shifts with inserts and deletes
+    const unsigned char *pRecords = m_PriorImage.GetData() + it->second.offset;
+    
+    OSENC_Feature_Identification_Record_Base fid;
+    memcpy( &fid, pRecords, sizeof(fid) );
+    fid.feature_ID = pFeature->GetFID();
+    
+    stream->Write( &fid, sizeof(fid) );
+    stream->Write( pRecords + sizeof(fid), it->second.length - sizeof(fid) );
+    
+    m_nPriorFeaturesCopied++;
+    
+    return true;
+}
+
 bool Osenc::CreateCovrRecords(Osenc_outstream *stream)
 {
     // First, create the Extent record
@@ -2673,6 +3050,10 @@ bool Osenc::CreateSENCRecord200( OGRFeature *pFeature, Osenc_outstream *stream,
 
     if(!WriteFIDRecord200( stream, nOBJL, pFeature->GetFID(), primitive) )
         return false;
+
+    //  The source record ID, so that a later update of the cell can find and reuse this feature
+    if(!WriteHeaderRecord200( stream, FEATURE_RCID_RECORD, (uint32_t)pFeature->GetFieldAsInteger( "RCID" )) )
+        return false;
         
     
     #define MAX_HDR_LINE    400
@@ -3053,10 +3434,16 @@ PolyTessGeo *Osenc::BuildPolyTessGeo(_OSENC_AreaGeometry_Record_Payload *record,
     ppg->m_bSMSENC = true;
     ppg->data_type = DATA_TYPE_DOUBLE;
 
+    //  The tessellation buffers go to the object arena, if any, and are released with it
+    ChartArena *arena = m_pObjectArena;
+    ppg->barena_alloc = ( arena != NULL );
     
     ppg->nContours = nContours;
     
-    ppg->pn_vertex = (int *)malloc(nContours * sizeof(int));
+    if( arena )
+        ppg->pn_vertex = (int *)arena->Alloc(nContours * sizeof(int));
+    else
+        ppg->pn_vertex = (int *)malloc(nContours * sizeof(int));
     int *pctr = ppg->pn_vertex;
     
     //  The point count array is the first element in the payload, length is known
@@ -3088,7 +3475,7 @@ PolyTessGeo *Osenc::BuildPolyTessGeo(_OSENC_AreaGeometry_Record_Payload *record,
         pPayloadRun += sizeof(uint32_t);
         
   
-        TriPrim *tp = new TriPrim;
+        TriPrim *tp = arena ? new( arena->Alloc( sizeof(TriPrim) ) ) TriPrim : new TriPrim;
         *p_prev_triprim = tp;                               // make the link
         p_prev_triprim = &(tp->p_next);
         tp->p_next = NULL;
@@ -3126,8 +3513,8 @@ PolyTessGeo *Osenc::BuildPolyTessGeo(_OSENC_AreaGeometry_Record_Payload *record,
         int byte_size = nvert * 2 * sizeof(float);              // the vertices
         total_byte_size += byte_size;
         
-        tp->p_vertex = (double *)malloc(byte_size);
-        memcpy(tp->p_vertex, pPayloadRun, byte_size);
+        //  Leave the vertices in the payload for now, they are gathered below
+        tp->p_vertex = (double *)pPayloadRun;
         
         
         pPayloadRun += byte_size;
@@ -3137,14 +3524,18 @@ PolyTessGeo *Osenc::BuildPolyTessGeo(_OSENC_AreaGeometry_Record_Payload *record,
     if(next_byte)
         *next_byte = pPayloadRun;
 
-    //  Convert the vertex arrays into a single float memory allocation to enable efficient access later
-    unsigned char *vbuf = (unsigned char *)malloc(total_byte_size);
+    //  Gather the vertex arrays straight from the payload into a single float memory allocation
+    //  to enable efficient access later
+    unsigned char *vbuf;
+    if( arena )
+        vbuf = (unsigned char *)arena->Alloc(total_byte_size);
+    else
+        vbuf = (unsigned char *)malloc(total_byte_size);
 
     TriPrim *p_tp = ppg->tri_prim_head;
     unsigned char *p_run = vbuf;
     while( p_tp ) {
             memcpy(p_run, p_tp->p_vertex, p_tp->nVert * 2 * sizeof(float));
-            free(p_tp->p_vertex);
             p_tp->p_vertex = (double  *)p_run;
             p_run += p_tp->nVert * 2 * sizeof(float);
             p_tp = p_tp->p_next; // pick up the next in chain
@@ -3447,8 +3838,10 @@ int Osenc::GetBaseFileInfo(const wxString& FullPath000, const wxString& SENCFile
     OGRS57DataSource *poS57DS = new OGRS57DataSource;
     poS57DS->SetS57Registrar( m_poRegistrar );
 
+    bool b_main = wxThread::IsMain();
     bool b_current_debug = g_bGDAL_Debug;
-    g_bGDAL_Debug = false;
+    if( b_main )
+        g_bGDAL_Debug = false;
     
     
     //  Ingest the .000 cell, with updates applied
@@ -3464,7 +3857,8 @@ int Osenc::GetBaseFileInfo(const wxString& FullPath000, const wxString& SENCFile
     CalculateExtent( poReader, m_poRegistrar );
     
     
-    g_bGDAL_Debug = b_current_debug;
+    if( b_main )
+        g_bGDAL_Debug = b_current_debug;
     
     //    delete poReader;
     delete poS57DS;
@@ -3560,3 +3954,20 @@ unsigned char *Osenc::getBuffer( size_t length){
         
 }
 
+//  Fetch the payload of the record just read, in place if the stream allows it,
+//  else copied into the persistent buffer.  Returns NULL on a short read.
+unsigned char *Osenc::readPayload( Osenc_instream &stream, size_t length )
+{
+    const unsigned char *p = stream.ReadInPlace( length );
+    if(p)
+        return (unsigned char *)p;
+    if(!stream.IsOk())
+        return NULL;
+
+    unsigned char *buf = getBuffer( length );
+    if(!stream.Read(buf, length).IsOk())
+        return NULL;
+
+    return buf;
+}
+
@@ -0,0 +1,149 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Thread pool for banded raster scaling
+ * Author:   The OpenCPN developers
+ *
+ ***************************************************************************
+ *   Copyright (C) 2026 by the OpenCPN developers                          *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ *
+ */
+
+#include "RasterBandPool.h"
+
+RasterBandPool *g_pRasterBandPool;
+
+class RasterBandThread : public wxThread
+{
+public:
+    RasterBandThread( RasterBandPool *pool ) : wxThread( wxTHREAD_JOINABLE ) { m_pool = pool; }
+
+    void *Entry()
+    {
+        m_pool->WorkerLoop();
+        return 0;
+    }
+
+private:
+    RasterBandPool *m_pool;
+};
+
+RasterBandPool::RasterBandPool( int nthreads )
+{
+    m_job = NULL;
+    m_nbands = 0;
+    m_next_band = 0;
+    m_ndone = 0;
+    m_bquit = false;
+
+    for( int i = 0; i < nthreads; i++ ) {
+        RasterBandThread *t = new RasterBandThread( this );
+        if( ( t->Create() != wxTHREAD_NO_ERROR ) || ( t->Run() != wxTHREAD_NO_ERROR ) ) {
+            delete t;
+            break;
+        }
+        m_threads.push_back( t );
+    }
+}
+
+RasterBandPool::~RasterBandPool()
+{
+    {
+        wxCriticalSectionLocker locker( m_lock );
+        m_bquit = true;
+    }
+    for( size_t i = 0; i < m_threads.size(); i++ )
+        m_work.Post();
+
+    for( size_t i = 0; i < m_threads.size(); i++ ) {
+        m_threads[i]->Wait();
+        delete m_threads[i];
+    }
+}
+
+//  Take and do one band of the current job, false when none is left
+bool RasterBandPool::DoNextBand()
+{
+    RasterBandJob *job;
+    int band;
+    {
+        wxCriticalSectionLocker locker( m_lock );
+        if( !m_job || m_next_band >= m_nbands )
+            return false;
+        job = m_job;
+        band = m_next_band++;
+    }
+
+    job->DoBand( band );
+
+    wxCriticalSectionLocker locker( m_lock );
+    if( ++m_ndone == m_nbands )
+        m_done.Post();
+    return true;
+}
+
+void RasterBandPool::WorkerLoop()
+{
+    for( ;; ) {
+        m_work.Wait();
+        {
+            wxCriticalSectionLocker locker( m_lock );
+            if( m_bquit )
+                break;
+        }
+        while( DoNextBand() )
+            ;
+    }
+}
+
+void RasterBandPool::Run( RasterBandJob *job, int nbands )
+{
+    if( nbands <= 0 )
+        return;
+
+    if( !m_threads.size() || nbands == 1 || m_run_mutex.TryLock() != wxMUTEX_NO_ERROR ) {
+        for( int band = 0; band < nbands; band++ )
+            job->DoBand( band );
+        return;
+    }
+
+    {
+        wxCriticalSectionLocker locker( m_lock );
+        m_job = job;
+        m_nbands = nbands;
+        m_next_band = 0;
+        m_ndone = 0;
+    }
+
+    int nwake = wxMin( (int) m_threads.size(), nbands - 1 );
+    for( int i = 0; i < nwake; i++ )
+        m_work.Post();
+
+    while( DoNextBand() )
+        ;
+    m_done.Wait();
+
+    {
+        wxCriticalSectionLocker locker( m_lock );
+        m_job = NULL;
+        m_nbands = 0;
+    }
+
+    m_run_mutex.Unlock();
+}
@@ -0,0 +1,234 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Shared, size bounded cache of decoded raster chart tiles
+ * Author:   The OpenCPN developers
+ *
+ ***************************************************************************
+ *   Copyright (C) 2026 by the OpenCPN developers                          *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ *
+ */
+
+#include <stdlib.h>
+
+#include "RasterTileCache.h"
+
+RasterTileCache *g_pRasterTileCache;
+
+RasterTileCache::RasterTileCache( size_t budget )
+{
+    m_head = m_tail = NULL;
+    m_bytes = 0;
+    m_budget = budget;
+    m_next_owner = 1;
+    m_hits = m_misses = m_evictions = 0;
+}
+
+RasterTileCache::~RasterTileCache()
+{
+    //  Owners are gone by now, nothing can still hold a tile
+    RasterTile *tile = m_head;
+    while( tile ) {
+        RasterTile *next = tile->next;
+        free( tile->data );
+        delete tile;
+        tile = next;
+    }
+}
+
+//  16 bits for each tile coordinate covers charts of up to 16M pixels a side
+uint64_t RasterTileCache::Key( int owner, int tx, int ty )
+{
+    return ( (uint64_t) (uint32_t) owner << 32 ) | ( (uint64_t) ( ty & 0xffff ) << 16 ) | (uint64_t) ( tx & 0xffff );
+}
+
+void RasterTileCache::SetBudget( size_t budget )
+{
+    wxCriticalSectionLocker locker( m_lock );
+    m_budget = budget;
+    Trim();
+}
+
+size_t RasterTileCache::GetBudget()
+{
+    wxCriticalSectionLocker locker( m_lock );
+    return m_budget;
+}
+
+void RasterTileCache::GetStats( RasterTileCacheStats &stats )
+{
+    wxCriticalSectionLocker locker( m_lock );
+    stats.hits = m_hits;
+    stats.misses = m_misses;
+    stats.evictions = m_evictions;
+    stats.bytes = m_bytes;
+    stats.budget = m_budget;
+    stats.ntiles = m_tiles.size();
+}
+
+void RasterTileCache::ResetStats()
+{
+    wxCriticalSectionLocker locker( m_lock );
+    m_hits = m_misses = m_evictions = 0;
+}
+
+int RasterTileCache::NewOwner()
+{
+    wxCriticalSectionLocker locker( m_lock );
+    return m_next_owner++;
+}
+
+void RasterTileCache::Unlink( RasterTile *tile )
+{
+    if( tile->prev )
+        tile->prev->next = tile->next;
+    else
+        m_head = tile->next;
+
+    if( tile->next )
+        tile->next->prev = tile->prev;
+    else
+        m_tail = tile->prev;
+
+    tile->prev = tile->next = NULL;
+}
+
+void RasterTileCache::PushFront( RasterTile *tile )
+{
+    tile->prev = NULL;
+    tile->next = m_head;
+    if( m_head )
+        m_head->prev = tile;
+    m_head = tile;
+    if( !m_tail )
+        m_tail = tile;
+}
+
+//  Take a tile out of the cache, freeing it now or when its last user releases it
+void RasterTileCache::Drop( RasterTile *tile )
+{
+    Unlink( tile );
+    m_tiles.erase( tile->key );
+    m_bytes -= TileBytes();
+
+    if( tile->refs ) {
+        tile->b_removed = true;
+        return;
+    }
+
+    free( tile->data );
+    delete tile;
+}
+
+void RasterTileCache::Trim()
+{
+    RasterTile *tile = m_tail;
+    while( tile && m_bytes > m_budget ) {
+        RasterTile *prev = tile->prev;
+        if( !tile->refs ) {
+            Drop( tile );
+            m_evictions++;
+        }
+        tile = prev;
+    }
+}
+
+RasterTile *RasterTileCache::Acquire( int owner, int tx, int ty )
+{
+    wxCriticalSectionLocker locker( m_lock );
+
+    std::map<uint64_t, RasterTile *>::iterator it = m_tiles.find( Key( owner, tx, ty ) );
+    if( it == m_tiles.end() ) {
+        m_misses++;
+        return NULL;
+    }
+
+    RasterTile *tile = it->second;
+    if( tile != m_head ) {
+        Unlink( tile );
+        PushFront( tile );
+    }
+    tile->refs++;
+    m_hits++;
+    return tile;
+}
+
+RasterTile *RasterTileCache::Add( int owner, int tx, int ty, unsigned char *data )
+{
+    wxCriticalSectionLocker locker( m_lock );
+
+    uint64_t key = Key( owner, tx, ty );
+
+    //  Another thread may have decoded the same tile meanwhile
+    std::map<uint64_t, RasterTile *>::iterator it = m_tiles.find( key );
+    if( it != m_tiles.end() ) {
+        free( data );
+        it->second->refs++;
+        return it->second;
+    }
+
+    RasterTile *tile = new RasterTile;
+    tile->key = key;
+    tile->data = data;
+    tile->refs = 1;
+    tile->b_removed = false;
+    PushFront( tile );
+    m_tiles[key] = tile;
+    m_bytes += TileBytes();
+
+    Trim();
+    return tile;
+}
+
+void RasterTileCache::Release( RasterTile *tile )
+{
+    wxCriticalSectionLocker locker( m_lock );
+
+    tile->refs--;
+    if( tile->refs )
+        return;
+
+    if( tile->b_removed ) {
+        free( tile->data );
+        delete tile;
+    } else if( m_bytes > m_budget )
+        Trim();
+}
+
+bool RasterTileCache::Contains( int owner, int tx, int ty )
+{
+    wxCriticalSectionLocker locker( m_lock );
+    return m_tiles.find( Key( owner, tx, ty ) ) != m_tiles.end();
+}
+
+//  Remove the owner's tiles in rows of tiles ty_first to ty_last, or all of them
+void RasterTileCache::Remove( int owner, int ty_first, int ty_last )
+{
+    wxCriticalSectionLocker locker( m_lock );
+
+    std::map<uint64_t, RasterTile *>::iterator it = m_tiles.lower_bound( Key( owner, 0, 0 ) );
+    while( it != m_tiles.end() && ( it->first >> 32 ) == (uint64_t) (uint32_t) owner ) {
+        RasterTile *tile = it->second;
+        ++it;
+
+        int ty = ( tile->key >> 16 ) & 0xffff;
+        if( ty >= ty_first && ( ty_last < 0 || ty <= ty_last ) )
+            Drop( tile );
+    }
+}
@@ -22,6 +22,8 @@
  ***************************************************************************
  */
 
+#include <algorithm>
+
 #include "Select.h"
 #include "georef.h"
 #include "vector2D.h"
@@ -31,9 +33,36 @@
 
 extern ChartCanvas *cc1;
 
+//  Grid cells per degree of each index level
+static const double s_cells_per_degree[SELECT_GRID_LEVELS] = { 256., 32., 4., 0.5 };
+
+static int SeltypeIndex( int seltype )
+{
+    for( int i = 0; i < N_SELTYPES; i++ )
+        if( seltype == ( 1 << i ) ) return i;
+    return -1;
+}
+
+static inline int CellIndex( double coord, int level )
+{
+    return (int) floor( coord * s_cells_per_degree[level] );
+}
+
+static inline wxInt64 CellKey( int cx, int cy )
+{
+    return ( ( (wxInt64) cx ) << 32 ) | (wxUint32) cy;
+}
+
+static bool CompareSelectOrder( const SelectItem *a, const SelectItem *b )
+{
+    return a->m_order < b->m_order;
+}
+
 Select::Select()
 {
     pSelectList = new SelectableItemList;
+    m_head_order = 0;
+    m_tail_order = 0;
     pixelRadius = 8;
     int w,h;
     wxDisplaySize( &w, &h );
@@ -81,6 +110,7 @@ bool Select::AddSelectableRoutePoint( float slat, float slon, RoutePoint *pRoute
         node = pSelectList->Append( pSelItem );
     else
         node = pSelectList->Insert( pSelItem );
+    AddToIndex( pSelItem, pRoutePointAdd->m_bIsInLayer );
 
     pRoutePointAdd->SetSelectNode(node);
     
@@ -104,6 +134,7 @@ bool Select::AddSelectableRouteSegment( float slat1, float slon1, float slat2, f
     if( pRoute->m_bIsInLayer ) pSelectList->Append( pSelItem );
     else
         pSelectList->Insert( pSelItem );
+    AddToIndex( pSelItem, pRoute->m_bIsInLayer );
 
     return true;
 }
@@ -120,6 +151,7 @@ bool Select::DeleteAllSelectableRouteSegments( Route *pr )
         if( pFindSel->m_seltype == SELTYPE_ROUTESEGMENT && 
             (Route *) pFindSel->m_pData3 == pr ) 
         {
+                UnindexItem( pFindSel );
                 delete pFindSel;
                 wxSelectableItemListNode *d = node;
                 node = node->GetNext();
@@ -150,6 +182,7 @@ bool Select::DeleteAllSelectableRoutePoints( Route *pr )
                 RoutePoint *prp = pnode->GetData();
 
                 if( prp == ps ) {
+                    UnindexItem( pFindSel );
                     delete pFindSel;
                     pSelectList->DeleteNode( node );   //delete node;
                     prp->SetSelectNode( NULL );
@@ -253,16 +286,20 @@ bool Select::UpdateSelectableRouteSegments( RoutePoint *prp )
         pFindSel = node->GetData();
         if( pFindSel->m_seltype == SELTYPE_ROUTESEGMENT ) {
             if( pFindSel->m_pData1 == prp ) {
+                UnindexItem( pFindSel );
                 pFindSel->m_slat = prp->m_lat;
                 pFindSel->m_slon = prp->m_lon;
+                IndexItem( pFindSel );
                 ret = true;
                 ;
             }
 
             else
                 if( pFindSel->m_pData2 == prp ) {
+                    UnindexItem( pFindSel );
                     pFindSel->m_slat2 = prp->m_lat;
                     pFindSel->m_slon2 = prp->m_lon;
+                    IndexItem( pFindSel );
                     ret = true;
                 }
         }
@@ -283,6 +320,7 @@ SelectItem *Select::AddSelectablePoint( float slat, float slon, const void *pdat
         pSelItem->m_pData1 = pdata;
 
         pSelectList->Append( pSelItem );
+        AddToIndex( pSelItem, true );
     }
 
     return pSelItem;
@@ -309,6 +347,7 @@ bool Select::DeleteSelectablePoint( void *pdata, int SeltypeToDelete )
             pFindSel = node->GetData();
             if( pFindSel->m_seltype == SeltypeToDelete ) {
                 if( pdata == pFindSel->m_pData1 ) {
+                    UnindexItem( pFindSel );
                     delete pFindSel;
                     delete node;
                     
@@ -336,6 +375,7 @@ bool Select::DeleteAllSelectableTypePoints( int SeltypeToDelete )
     while( node ) {
         pFindSel = node->GetData();
         if( pFindSel->m_seltype == SeltypeToDelete ) {
+            UnindexItem( pFindSel );
             delete node;
             
             if( SELTYPE_ROUTEPOINT == SeltypeToDelete ){
@@ -362,6 +402,7 @@ bool Select::DeleteSelectableRoutePoint( RoutePoint *prp )
         if(node){
             SelectItem *pFindSel = node->GetData();
             if(pFindSel){
+                UnindexItem( pFindSel );
                 delete pFindSel;
                 delete node;            // automatically removes from list
                 prp->SetSelectNode( NULL );
@@ -387,8 +428,7 @@ bool Select::ModifySelectablePoint( float lat, float lon, void *data, int Seltyp
         pFindSel = node->GetData();
         if( pFindSel->m_seltype == SeltypeToModify ) {
             if( data == pFindSel->m_pData1 ) {
-                pFindSel->m_slat = lat;
-                pFindSel->m_slon = lon;
+                ModifySelectableItem( pFindSel, lat, lon );
                 return true;
             }
         }
@@ -415,6 +455,7 @@ bool Select::AddSelectableTrackSegment( float slat1, float slon1, float slat2, f
     if( pTrack->m_bIsInLayer ) pSelectList->Append( pSelItem );
     else
         pSelectList->Insert( pSelItem );
+    AddToIndex( pSelItem, pTrack->m_bIsInLayer );
 
     return true;
 }
@@ -431,6 +472,7 @@ bool Select::DeleteAllSelectableTrackSegments( Track *pt )
         if( pFindSel->m_seltype == SELTYPE_TRACKSEGMENT && 
           (Track *) pFindSel->m_pData3 == pt  ) 
         {
+            UnindexItem( pFindSel );
             delete pFindSel;
             wxSelectableItemListNode *d = node;
             node = node->GetNext();
@@ -454,6 +496,7 @@ bool Select::DeletePointSelectableTrackSegments( TrackPoint *pt )
         if( pFindSel->m_seltype == SELTYPE_TRACKSEGMENT &&
             ( (TrackPoint *) pFindSel->m_pData1 == pt ||
               (TrackPoint *) pFindSel->m_pData2 == pt ) ) {
+                UnindexItem( pFindSel );
                 delete pFindSel;
                 wxSelectableItemListNode *d = node;
                 node = node->GetNext();
@@ -527,39 +570,34 @@ SelectItem *Select::FindSelection( float slat, float slon, int fseltype )
 
     CalcSelectRadius();
 
-//    Iterate on the list
-    wxSelectableItemListNode *node = pSelectList->GetFirst();
-
-    while( node ) {
-        pFindSel = node->GetData();
-        if( pFindSel->m_seltype == fseltype ) {
-            switch( fseltype ){
-                case SELTYPE_ROUTEPOINT:
-                case SELTYPE_TIDEPOINT:
-                case SELTYPE_CURRENTPOINT:
-                case SELTYPE_AISTARGET:
-                    a = fabs( slat - pFindSel->m_slat );
-                    b = fabs( slon - pFindSel->m_slon );
-
-                    if( ( fabs( slat - pFindSel->m_slat ) < selectRadius )
-                            && ( fabs( slon - pFindSel->m_slon ) < selectRadius ) ) goto find_ok;
-                    break;
-                case SELTYPE_ROUTESEGMENT:
-                case SELTYPE_TRACKSEGMENT: {
-                    a = pFindSel->m_slat;
-                    b = pFindSel->m_slat2;
-                    c = pFindSel->m_slon;
-                    d = pFindSel->m_slon2;
-
-                    if( IsSegmentSelected( a, b, c, d, slat, slon ) ) goto find_ok;
-                    break;
-                }
-                default:
-                    break;
+    //    Candidates from the index come back in select list order,
+    //    so the first hit is the same item a full list walk would find
+    SelectItemArray candidates;
+    GetIndexCandidates( slat, slon, fseltype, candidates );
+
+    for( unsigned int i = 0; i < candidates.size(); i++ ) {
+        pFindSel = candidates[i];
+        switch( fseltype ){
+            case SELTYPE_ROUTEPOINT:
+            case SELTYPE_TIDEPOINT:
+            case SELTYPE_CURRENTPOINT:
+            case SELTYPE_AISTARGET:
+                if( ( fabs( slat - pFindSel->m_slat ) < selectRadius )
+                        && ( fabs( slon - pFindSel->m_slon ) < selectRadius ) ) goto find_ok;
+                break;
+            case SELTYPE_ROUTESEGMENT:
+            case SELTYPE_TRACKSEGMENT: {
+                a = pFindSel->m_slat;
+                b = pFindSel->m_slat2;
+                c = pFindSel->m_slon;
+                d = pFindSel->m_slon2;
+
+                if( IsSegmentSelected( a, b, c, d, slat, slon ) ) goto find_ok;
+                break;
             }
+            default:
+                break;
         }
-
-        node = node->GetNext();
     }
 
     return NULL;
@@ -601,41 +639,177 @@ SelectableItemList Select::FindSelectionList( float slat, float slon, int fselty
 
     CalcSelectRadius();
 
-//    Iterate on the list
-    wxSelectableItemListNode *node = pSelectList->GetFirst();
-
-    while( node ) {
-        pFindSel = node->GetData();
-        if( pFindSel->m_seltype == fseltype ) {
-            switch( fseltype ){
-                case SELTYPE_ROUTEPOINT:
-                case SELTYPE_TIDEPOINT:
-                case SELTYPE_CURRENTPOINT:
-                case SELTYPE_AISTARGET:
-                    if( ( fabs( slat - pFindSel->m_slat ) < selectRadius )
-                            && ( fabs( slon - pFindSel->m_slon ) < selectRadius ) ) {
-                        ret_list.Append( pFindSel );
-                    }
-                    break;
-                case SELTYPE_ROUTESEGMENT:
-                case SELTYPE_TRACKSEGMENT: {
-                    a = pFindSel->m_slat;
-                    b = pFindSel->m_slat2;
-                    c = pFindSel->m_slon;
-                    d = pFindSel->m_slon2;
+    SelectItemArray candidates;
+    GetIndexCandidates( slat, slon, fseltype, candidates );
+
+    for( unsigned int i = 0; i < candidates.size(); i++ ) {
+        pFindSel = candidates[i];
+        switch( fseltype ){
+            case SELTYPE_ROUTEPOINT:
+            case SELTYPE_TIDEPOINT:
+            case SELTYPE_CURRENTPOINT:
+            case SELTYPE_AISTARGET:
+                if( ( fabs( slat - pFindSel->m_slat ) < selectRadius )
+                        && ( fabs( slon - pFindSel->m_slon ) < selectRadius ) ) {
+                    ret_list.Append( pFindSel );
+                }
+                break;
+            case SELTYPE_ROUTESEGMENT:
+            case SELTYPE_TRACKSEGMENT: {
+                a = pFindSel->m_slat;
+                b = pFindSel->m_slat2;
+                c = pFindSel->m_slon;
+                d = pFindSel->m_slon2;
 
-                    if( IsSegmentSelected( a, b, c, d, slat, slon ) ) ret_list.Append( pFindSel );
+                if( IsSegmentSelected( a, b, c, d, slat, slon ) ) ret_list.Append( pFindSel );
 
-                    break;
-                }
-                default:
-                    break;
+                break;
             }
+            default:
+                break;
         }
-
-        node = node->GetNext();
     }
 
     return ret_list;
 }
 
+//-----------------------------------------------------------------------------------
+//    Spatial index
+//-----------------------------------------------------------------------------------
+
+void Select::ModifySelectableItem( SelectItem *pitem, float slat, float slon )
+{
+    UnindexItem( pitem );
+    pitem->m_slat = slat;
+    pitem->m_slon = slon;
+    IndexItem( pitem );
+}
+
+//    Record the list position of a newly added item, and index it
+void Select::AddToIndex( SelectItem *pitem, bool b_append )
+{
+    pitem->m_order = b_append ? ++m_tail_order : --m_head_order;
+    IndexItem( pitem );
+}
+
+void Select::IndexItem( SelectItem *pitem )
+{
+    int it = SeltypeIndex( pitem->m_seltype );
+    if( it < 0 ) return;
+
+    float lat_min = pitem->m_slat;
+    float lat_max = pitem->m_slat;
+    float lon_min = pitem->m_slon;
+    float lon_max = pitem->m_slon;
+
+    bool b_segment = ( pitem->m_seltype == SELTYPE_ROUTESEGMENT ) || ( pitem->m_seltype == SELTYPE_TRACKSEGMENT );
+    if( b_segment ) {
+        //    Segments crossing the dateline are tested in unwrapped coordinates
+        //    by IsSegmentSelected(), keep them out of the grid
+        if( fabs( pitem->m_slon - pitem->m_slon2 ) > 180. ) {
+            pitem->m_index_level = SELECT_GRID_LEVEL_OVERSIZE;
+            m_oversize[it].push_back( pitem );
+            return;
+        }
+        lat_min = wxMin( lat_min, pitem->m_slat2 );
+        lat_max = wxMax( lat_max, pitem->m_slat2 );
+        lon_min = wxMin( lon_min, pitem->m_slon2 );
+        lon_max = wxMax( lon_max, pitem->m_slon2 );
+    }
+
+    for( int level = 0; level < SELECT_GRID_LEVELS; level++ ) {
+        int x0 = CellIndex( lon_min, level ), x1 = CellIndex( lon_max, level );
+        int y0 = CellIndex( lat_min, level ), y1 = CellIndex( lat_max, level );
+        if( ( x1 - x0 > 1 ) || ( y1 - y0 > 1 ) )
+            continue;
+
+        pitem->m_index_level = level;
+        pitem->m_cell_x0 = x0;
+        pitem->m_cell_x1 = x1;
+        pitem->m_cell_y0 = y0;
+        pitem->m_cell_y1 = y1;
+
+        for( int cx = x0; cx <= x1; cx++ )
+            for( int cy = y0; cy <= y1; cy++ )
+                m_grid[it][level][CellKey( cx, cy )].push_back( pitem );
+        return;
+    }
+
+    pitem->m_index_level = SELECT_GRID_LEVEL_OVERSIZE;
+    m_oversize[it].push_back( pitem );
+}
+
+static void RemoveFromArray( SelectItemArray &array, SelectItem *pitem )
+{
+    for( unsigned int i = 0; i < array.size(); i++ ) {
+        if( array[i] == pitem ) {
+            array[i] = array.back();
+            array.pop_back();
+            return;
+        }
+    }
+}
+
+void Select::UnindexItem( SelectItem *pitem )
+{
+    int it = SeltypeIndex( pitem->m_seltype );
+    if( it < 0 || pitem->m_index_level < 0 ) return;
+
+    if( pitem->m_index_level == SELECT_GRID_LEVEL_OVERSIZE )
+        RemoveFromArray( m_oversize[it], pitem );
+    else {
+        SelectGrid &grid = m_grid[it][pitem->m_index_level];
+        for( int cx = pitem->m_cell_x0; cx <= pitem->m_cell_x1; cx++ ) {
+            for( int cy = pitem->m_cell_y0; cy <= pitem->m_cell_y1; cy++ ) {
+                SelectGrid::iterator cell = grid.find( CellKey( cx, cy ) );
+                if( cell == grid.end() ) continue;
+                RemoveFromArray( cell->second, pitem );
+                if( cell->second.empty() ) grid.erase( cell );
+            }
+        }
+    }
+
+    pitem->m_index_level = -1;
+}
+
+//    Collect every item of the given type that may lie within selectRadius of slat/slon,
+//    in select list order
+void Select::GetIndexCandidates( float slat, float slon, int fseltype, SelectItemArray &candidates )
+{
+    int it = SeltypeIndex( fseltype );
+    if( it < 0 ) return;
+
+    for( int level = 0; level < SELECT_GRID_LEVELS; level++ ) {
+        SelectGrid &grid = m_grid[it][level];
+        if( grid.empty() ) continue;
+
+        int x0 = CellIndex( slon - selectRadius, level ), x1 = CellIndex( slon + selectRadius, level );
+        int y0 = CellIndex( slat - selectRadius, level ), y1 = CellIndex( slat + selectRadius, level );
+
+        //    Visit whichever is fewer, the cells under the search box or the occupied cells
+        double nsearch = (double) ( x1 - x0 + 1 ) * (double) ( y1 - y0 + 1 );
+        if( nsearch > grid.size() ) {
+            for( SelectGrid::iterator cell = grid.begin(); cell != grid.end(); ++cell ) {
+                int cx = (int) ( cell->first >> 32 );
+                int cy = (int) (wxInt32) ( cell->first & 0xffffffff );
+                if( cx >= x0 && cx <= x1 && cy >= y0 && cy <= y1 )
+                    candidates.insert( candidates.end(), cell->second.begin(), cell->second.end() );
+            }
+        }
+        else {
+            for( int cx = x0; cx <= x1; cx++ ) {
+                for( int cy = y0; cy <= y1; cy++ ) {
+                    SelectGrid::iterator cell = grid.find( CellKey( cx, cy ) );
+                    if( cell != grid.end() )
+                        candidates.insert( candidates.end(), cell->second.begin(), cell->second.end() );
+                }
+            }
+        }
+    }
+
+    candidates.insert( candidates.end(), m_oversize[it].begin(), m_oversize[it].end() );
+
+    //    Items may span several cells
+    std::sort( candidates.begin(), candidates.end(), CompareSelectOrder );
+    candidates.erase( std::unique( candidates.begin(), candidates.end() ), candidates.end() );
+}
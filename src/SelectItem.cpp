@@ -29,6 +29,8 @@ WX_DEFINE_LIST ( SelectableItemList );
 
 SelectItem::SelectItem()
 {
+    m_index_level = -1;
+    m_order = 0;
 }
 
 SelectItem::~SelectItem()
@@ -0,0 +1,247 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Batch creation of S57 SENC files on worker threads
+ * Author:   The OpenCPN developers
+ *
+ ***************************************************************************
+ *   Copyright (C) 2026 by the OpenCPN developers                          *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ *
+ */
+
+#include "wx/wxprec.h"
+
+#ifndef  WX_PRECOMP
+#include "wx/wx.h"
+#endif //precompiled headers
+
+#include "SencBatchBuilder.h"
+#include "s57chart.h"
+#include "s57RegistrarMgr.h"
+#include "mygdal/cpl_port.h"
+
+extern s57RegistrarMgr *m_pRegistrarMan;
+extern int             g_nCPUCount;
+
+class SencBatchThread : public wxThread
+{
+public:
+    SencBatchThread( SencBatchBuilder *builder, S57ClassRegistrar *registrar )
+        : wxThread( wxTHREAD_JOINABLE )
+    {
+        m_builder = builder;
+        m_registrar = registrar;
+    }
+
+    void *Entry()
+    {
+        for(;;) {
+            int i = m_builder->NextCell();
+            if( i == -1 )
+                break;
+            if( i == -2 ) {
+                wxThread::Sleep( 20 );
+                continue;
+            }
+
+            //  The cell is locked for us by NextCell(), and stays locked until the
+            //  chart is gone, since the chart may own a temporary copy of the cell
+            const SencBatchCell &cell = m_builder->m_cells[i];
+            Extent ext = cell.ext;
+
+            s57chart *chart = new s57chart;
+            chart->SetNativeScale( cell.scale );
+            chart->SetFullExtent( ext );
+            chart->SetSENCRegistrar( m_registrar );
+
+            int ret = chart->FindOrCreateSenc( cell.path, false );
+            delete chart;
+
+            s57chart::UnlockSENCCell( cell.path );
+            m_builder->CellDone( i, ret );
+        }
+
+        wxCriticalSectionLocker locker( m_builder->m_lock );
+        m_builder->m_nactive--;
+        return 0;
+    }
+
+private:
+    SencBatchBuilder  *m_builder;
+    S57ClassRegistrar *m_registrar;
+};
+
+SencBatchBuilder::SencBatchBuilder()
+{
+    m_first_open = 0;
+    m_nactive = 0;
+    m_ndone = 0;
+    m_nfailed = 0;
+    m_last_done = -1;
+    m_bcancel = false;
+    m_bstarted = false;
+}
+
+SencBatchBuilder::~SencBatchBuilder()
+{
+    Cancel();
+    Wait();
+}
+
+int SencBatchBuilder::GetDefaultThreadCount()
+{
+#if CPL_HAS_THREADLOCAL
+    int ncpu = ( g_nCPUCount > 0 ) ? g_nCPUCount : wxThread::GetCPUCount();
+    return wxMax( 1, wxMin( ncpu, 8 ) - 1 );
+#else
+    //  The ingest library keeps per thread state in statics, so one worker only
+    return 1;
+#endif
+}
+
+void SencBatchBuilder::Add( const wxString &path, int scale, const Extent &ext )
+{
+    wxASSERT( !m_bstarted );
+
+    SencBatchCell cell;
+    cell.path = wxString( path.c_str() );       // private copy for the workers
+    cell.scale = scale;
+    cell.ext = ext;
+    cell.result = SENC_BATCH_PENDING;
+
+    m_cells.push_back( cell );
+    m_taken.push_back( 0 );
+}
+
+bool SencBatchBuilder::Start( int nthreads )
+{
+    if( m_bstarted || !m_pRegistrarMan )
+        return false;
+    m_bstarted = true;
+
+#if !CPL_HAS_THREADLOCAL
+    nthreads = 1;
+#endif
+
+    for( int t = 0; t < nthreads; t++ ) {
+        //  Each thread selects classes in a registrar of its own.
+        //  Loading them here keeps the CSV readers on the main thread.
+        S57ClassRegistrar *registrar = m_pRegistrarMan->CreateRegistrar();
+        if( !registrar )
+            break;
+
+        SencBatchThread *thread = new SencBatchThread( this, registrar );
+        if( ( thread->Create() != wxTHREAD_NO_ERROR ) || ( thread->Run() != wxTHREAD_NO_ERROR ) ) {
+            delete thread;
+            delete registrar;
+            break;
+        }
+
+        wxCriticalSectionLocker locker( m_lock );
+        m_threads.push_back( thread );
+        m_registrars.push_back( registrar );
+        m_nactive++;
+    }
+
+    return m_threads.size() > 0;
+}
+
+void SencBatchBuilder::Cancel()
+{
+    wxCriticalSectionLocker locker( m_lock );
+    m_bcancel = true;
+}
+
+void SencBatchBuilder::Wait()
+{
+    for( size_t t = 0; t < m_threads.size(); t++ ) {
+        m_threads[t]->Wait();
+        delete m_threads[t];
+    }
+    m_threads.clear();
+
+    for( size_t t = 0; t < m_registrars.size(); t++ )
+        delete m_registrars[t];
+    m_registrars.clear();
+}
+
+bool SencBatchBuilder::IsRunning()
+{
+    wxCriticalSectionLocker locker( m_lock );
+    return m_nactive > 0;
+}
+
+int SencBatchBuilder::GetDoneCount()
+{
+    wxCriticalSectionLocker locker( m_lock );
+    return m_ndone;
+}
+
+int SencBatchBuilder::GetFailedCount()
+{
+    wxCriticalSectionLocker locker( m_lock );
+    return m_nfailed;
+}
+
+wxString SencBatchBuilder::GetLastDone()
+{
+    wxCriticalSectionLocker locker( m_lock );
+    if( m_last_done < 0 )
+        return wxEmptyString;
+    return wxString( m_cells[m_last_done].path.c_str() );
+}
+
+int SencBatchBuilder::NextCell()
+{
+    wxCriticalSectionLocker locker( m_lock );
+
+    if( m_bcancel )
+        return -1;
+
+    while( m_first_open < m_cells.size() && m_taken[m_first_open] )
+        m_first_open++;
+
+    if( m_first_open == m_cells.size() )
+        return -1;
+
+    for( size_t i = m_first_open; i < m_cells.size(); i++ ) {
+        if( !m_taken[i] && s57chart::TryLockSENCCell( m_cells[i].path ) ) {
+            m_taken[i] = 1;
+            return i;
+        }
+    }
+
+    return -2;
+}
+
+void SencBatchBuilder::CellDone( int i, int result )
+{
+    if( result != INIT_OK ) {
+        wxString msg( _T("   SENC batch: cannot create SENC for ") );
+        msg.Append( m_cells[i].path );
+        wxLogMessage( msg );
+    }
+
+    wxCriticalSectionLocker locker( m_lock );
+    m_cells[i].result = result;
+    m_ndone++;
+    if( result != INIT_OK )
+        m_nfailed++;
+    m_last_done = i;
+}
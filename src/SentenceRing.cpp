@@ -0,0 +1,101 @@
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Queue of NMEA sentences from a driver thread to the main thread
+ * Author:   The OpenCPN developers
+ *
+ ***************************************************************************
+ *   Copyright (C) 2026 by the OpenCPN developers                          *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ **************************************************************************/
+
+
+#include <string.h>
+
+#include "SentenceRing.h"
+
+SentenceRing::SentenceRing()
+{
+    m_slots = new char[SENTENCE_RING_SLOTS * SENTENCE_RING_SLOT_SIZE];
+    m_put = 0;
+    m_take = 0;
+    m_count = 0;
+    m_bsignalled = false;
+    m_drops = 0;
+}
+
+SentenceRing::~SentenceRing()
+{
+    delete[] m_slots;
+}
+
+bool SentenceRing::Put( const char *sentence, bool *pb_signal )
+{
+    *pb_signal = false;
+
+    size_t len = strlen( sentence );
+    if( len >= SENTENCE_RING_SLOT_SIZE )
+        return false;
+
+    wxCriticalSectionLocker locker( m_critical );
+
+    if( m_count == SENTENCE_RING_SLOTS ) {
+        m_drops++;
+        return false;
+    }
+
+    memcpy( &m_slots[m_put * SENTENCE_RING_SLOT_SIZE], sentence, len + 1 );
+    m_put = ( m_put + 1 ) % SENTENCE_RING_SLOTS;
+    m_count++;
+
+    if( !m_bsignalled ) {
+        m_bsignalled = true;
+        *pb_signal = true;
+    }
+
+    return true;
+}
+
+size_t SentenceRing::GetBatch( std::vector<std::string> &batch, size_t max_count, bool *pb_more )
+{
+    wxCriticalSectionLocker locker( m_critical );
+
+    size_t n = wxMin( m_count, max_count );
+    if( batch.size() < n )
+        batch.resize( n );
+
+    for( size_t i = 0; i < n; i++ ) {
+        batch[i].assign( &m_slots[m_take * SENTENCE_RING_SLOT_SIZE] );
+        m_take = ( m_take + 1 ) % SENTENCE_RING_SLOTS;
+    }
+    m_count -= n;
+
+    //  Stay signalled while there is work left, so the producer does not post again
+    *pb_more = ( m_count > 0 );
+    m_bsignalled = *pb_more;
+
+    return n;
+}
+
+unsigned long SentenceRing::TakeDropCount()
+{
+    wxCriticalSectionLocker locker( m_critical );
+
+    unsigned long drops = m_drops;
+    m_drops = 0;
+    return drops;
+}
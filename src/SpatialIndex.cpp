@@ -0,0 +1,257 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Packed R-tree of bounding boxes
+ * Author:   The OpenCPN developers
+ *
+ ***************************************************************************
+ *   Copyright (C) 2026 by the OpenCPN developers                          *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "SpatialIndex.h"
+
+#define SPATIALINDEX_NODE_SIZE 16        // fanout of the packed tree
+#define SPATIALINDEX_MIN_PENDING 32      // overflow list length always tolerated
+
+static inline bool EntryIntersects( const SpatialIndexEntry &e, float minx, float miny,
+                                    float maxx, float maxy )
+{
+    return ( e.minx <= maxx ) && ( e.maxx >= minx ) && ( e.miny <= maxy ) && ( e.maxy >= miny );
+}
+
+struct CompareCenterX
+{
+    bool operator()( const SpatialIndexEntry &a, const SpatialIndexEntry &b ) const
+    {
+        return ( a.minx + a.maxx ) < ( b.minx + b.maxx );
+    }
+};
+
+struct CompareCenterY
+{
+    bool operator()( const SpatialIndexEntry &a, const SpatialIndexEntry &b ) const
+    {
+        return ( a.miny + a.maxy ) < ( b.miny + b.maxy );
+    }
+};
+
+SpatialIndex::SpatialIndex()
+{
+    m_nremoved = 0;
+}
+
+void SpatialIndex::Clear()
+{
+    m_levels.clear();
+    m_pending.clear();
+    m_nremoved = 0;
+}
+
+void SpatialIndex::Reserve( size_t n )
+{
+    m_pending.reserve( n );
+}
+
+size_t SpatialIndex::GetCount() const
+{
+    size_t n = m_pending.size();
+    if( m_levels.size() )
+        n += m_levels[0].size() - m_nremoved;
+    return n;
+}
+
+void SpatialIndex::Add( int id, float minx, float miny, float maxx, float maxy )
+{
+    SpatialIndexEntry e;
+    e.minx = minx;
+    e.miny = miny;
+    e.maxx = maxx;
+    e.maxy = maxy;
+    e.id = id;
+    m_pending.push_back( e );
+}
+
+void SpatialIndex::Insert( int id, float minx, float miny, float maxx, float maxy )
+{
+    Add( id, minx, miny, maxx, maxy );
+
+    //  Keep the linear part small relative to the packed part
+    size_t npacked = m_levels.size() ? m_levels[0].size() : 0;
+    if( m_pending.size() > SPATIALINDEX_MIN_PENDING && m_pending.size() > npacked / 8 )
+        Build();
+}
+
+bool SpatialIndex::Remove( int id )
+{
+    for( size_t i = 0; i < m_pending.size(); i++ ) {
+        if( m_pending[i].id == id ) {
+            m_pending.erase( m_pending.begin() + i );
+            return true;
+        }
+    }
+
+    if( !m_levels.size() )
+        return false;
+
+    std::vector<SpatialIndexEntry> &leaves = m_levels[0];
+    for( size_t i = 0; i < leaves.size(); i++ ) {
+        if( leaves[i].id == id ) {
+            //  Leave a tombstone that can never match a query
+            leaves[i].id = -1;
+            leaves[i].minx = leaves[i].miny = 1.f;
+            leaves[i].maxx = leaves[i].maxy = -1.f;
+            m_nremoved++;
+
+            if( m_nremoved > leaves.size() / 4 )
+                Build();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void SpatialIndex::Renumber( int first_id, int delta )
+{
+    for( size_t i = 0; i < m_pending.size(); i++ ) {
+        if( m_pending[i].id >= first_id )
+            m_pending[i].id += delta;
+    }
+
+    if( m_levels.size() ) {
+        std::vector<SpatialIndexEntry> &leaves = m_levels[0];
+        for( size_t i = 0; i < leaves.size(); i++ ) {
+            if( leaves[i].id >= first_id )
+                leaves[i].id += delta;
+        }
+    }
+}
+
+void SpatialIndex::Build()
+{
+    std::vector<SpatialIndexEntry> leaves;
+    leaves.reserve( GetCount() );
+
+    if( m_levels.size() ) {
+        for( size_t i = 0; i < m_levels[0].size(); i++ ) {
+            if( m_levels[0][i].id != -1 )
+                leaves.push_back( m_levels[0][i] );
+        }
+    }
+    leaves.insert( leaves.end(), m_pending.begin(), m_pending.end() );
+
+    m_levels.clear();
+    m_pending.clear();
+    m_nremoved = 0;
+
+    if( !leaves.size() )
+        return;
+
+    m_levels.push_back( leaves );
+
+    //  Pack upward until the top level is small enough to be scanned linearly
+    while( m_levels.back().size() > SPATIALINDEX_NODE_SIZE ) {
+        std::vector<SpatialIndexEntry> parent;
+        Pack( m_levels.back(), parent );
+        m_levels.push_back( parent );
+    }
+}
+
+//  Sort-Tile-Recursive packing.  Reorders "level" so that each run of
+//  SPATIALINDEX_NODE_SIZE entries is spatially compact, and emits one
+//  parent entry per run.
+void SpatialIndex::Pack( std::vector<SpatialIndexEntry> &level, std::vector<SpatialIndexEntry> &parent )
+{
+    size_t n = level.size();
+    size_t nnodes = ( n + SPATIALINDEX_NODE_SIZE - 1 ) / SPATIALINDEX_NODE_SIZE;
+    size_t nslices = (size_t) ceil( sqrt( (double) nnodes ) );
+    size_t slice_size = nslices * SPATIALINDEX_NODE_SIZE;
+
+    std::sort( level.begin(), level.end(), CompareCenterX() );
+    for( size_t s = 0; s < n; s += slice_size ) {
+        size_t e = std::min( s + slice_size, n );
+        std::sort( level.begin() + s, level.begin() + e, CompareCenterY() );
+    }
+
+    parent.reserve( nnodes );
+    for( size_t s = 0; s < n; s += SPATIALINDEX_NODE_SIZE ) {
+        size_t e = std::min( s + SPATIALINDEX_NODE_SIZE, n );
+        SpatialIndexEntry node = level[s];
+        for( size_t i = s + 1; i < e; i++ ) {
+            node.minx = std::min( node.minx, level[i].minx );
+            node.miny = std::min( node.miny, level[i].miny );
+            node.maxx = std::max( node.maxx, level[i].maxx );
+            node.maxy = std::max( node.maxy, level[i].maxy );
+        }
+        node.id = (int) s;
+        parent.push_back( node );
+    }
+}
+
+void SpatialIndex::Query( float x, float y, std::vector<int> &ids ) const
+{
+    Query( x, y, x, y, ids );
+}
+
+void SpatialIndex::Query( float minx, float miny, float maxx, float maxy, std::vector<int> &ids ) const
+{
+    for( size_t i = 0; i < m_pending.size(); i++ ) {
+        if( EntryIntersects( m_pending[i], minx, miny, maxx, maxy ) )
+            ids.push_back( m_pending[i].id );
+    }
+
+    if( !m_levels.size() )
+        return;
+
+    //  Depth first walk with an explicit stack of (level, first child) ranges
+    int stack_level[64 * SPATIALINDEX_NODE_SIZE];
+    size_t stack_first[64 * SPATIALINDEX_NODE_SIZE];
+    int sp = 0;
+
+    stack_level[sp] = m_levels.size() - 1;
+    stack_first[sp] = 0;
+    sp++;
+
+    while( sp ) {
+        sp--;
+        int ilevel = stack_level[sp];
+        const std::vector<SpatialIndexEntry> &level = m_levels[ilevel];
+        size_t first = stack_first[sp];
+        size_t last = ( ilevel == (int) m_levels.size() - 1 ) ? level.size()
+                      : std::min( first + SPATIALINDEX_NODE_SIZE, level.size() );
+
+        for( size_t i = first; i < last; i++ ) {
+            const SpatialIndexEntry &e = level[i];
+            if( !EntryIntersects( e, minx, miny, maxx, maxy ) )
+                continue;
+
+            if( ilevel == 0 )
+                ids.push_back( e.id );
+            else {
+                stack_level[sp] = ilevel - 1;
+                stack_first[sp] = e.id;
+                sp++;
+            }
+        }
+    }
+}
@@ -141,9 +141,6 @@ static const long long lNaN = 0xfff8000000000000;
 #define NAN (*(double*)&lNaN)
 #endif
 
-#include <wx/listimpl.cpp>
-WX_DEFINE_LIST(AISTargetTrackList);
-
 wxString ais_get_status(int index)
 {
     static const wxString ais_status[] = {
@@ -927,10 +924,9 @@ static void AISDrawTarget( AIS_Target_Data *td, ocpnDC& dc, ViewPort& vp, ChartC
     else
     //  If AIS tracks are shown, is the first point of the track on-screen?
     if( 1/*g_bAISShowTracks*/ && td->b_show_track ) {
-        wxAISTargetTrackListNode *node = td->m_ptrack->GetFirst();
-        if( node ) {
-            AISTargetTrackPoint *ptrack_point = node->GetData();
-            if( vp.GetBBox().Contains( ptrack_point->m_lat,  ptrack_point->m_lon ) )
+        if( !td->m_ptrack->IsEmpty() ) {
+            const AISTargetTrackPoint &track_point = td->m_ptrack->Item( 0 );
+            if( vp.GetBBox().Contains( track_point.m_lat,  track_point.m_lon ) )
                 drawit++;
         }
     }
@@ -1748,13 +1744,10 @@ static void AISDrawTarget( AIS_Target_Data *td, ocpnDC& dc, ViewPort& vp, ChartC
         if (TrackLength > 1) {
             int TrackPointCount;
             wxPoint *TrackPoints = new wxPoint[TrackLength];
-            wxAISTargetTrackListNode *node = td->m_ptrack->GetFirst();
-            for (TrackPointCount = 0; node && (TrackPointCount < TrackLength); TrackPointCount++) {
-                AISTargetTrackPoint *ptrack_point = node->GetData();
-                GetCanvasPointPix(vp, cp, ptrack_point->m_lat, ptrack_point->m_lon, &TrackPoints[TrackPointCount]);
-                node = node->GetNext();
+            for (TrackPointCount = 0; TrackPointCount < TrackLength; TrackPointCount++) {
+                const AISTargetTrackPoint &track_point = td->m_ptrack->Item( TrackPointCount );
+                GetCanvasPointPix(vp, cp, track_point.m_lat, track_point.m_lon, &TrackPoints[TrackPointCount]);
             }
-            TrackLength = TrackPointCount;
             if ( dc.GetDC() && (TrackLength > 1) )
                 dc.StrokeLines(TrackPointCount, TrackPoints);
 #ifdef ocpnUSE_GL
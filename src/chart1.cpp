@@ -83,6 +83,8 @@
 #include "tcmgr.h"
 #include "ais.h"
 #include "chartimg.h"               // for ChartBaseBSB
+#include "RasterTileCache.h"
+#include "RasterBandPool.h"
 #include "routeprop.h"
 #include "toolbar.h"
 #include "compass.h"
@@ -128,6 +130,7 @@
 #include "cm93.h"
 #include "s52plib.h"
 #include "s57chart.h"
+#include "SencBatchBuilder.h"
 #include "mygdal/cpl_csv.h"
 #include "s52utils.h"
 #endif
@@ -172,6 +175,9 @@ int                       g_unit_test_1;
 bool                      g_start_fullscreen;
 bool                      g_rebuild_gl_cache;
 bool                      g_parse_all_enc;
+bool                      g_bPreheatENC;
+int                       g_nPreheatENCRadius;
+SencBatchBuilder          *g_pSencPreheat;
 
 MyFrame                   *gFrame;
 
@@ -431,6 +437,8 @@ bool                      g_bUseGLL;
 
 int                       g_nCacheLimit;
 int                       g_memCacheLimit;
+int                       g_nRasterTileCacheMB;
+extern int                g_nCPUCount;
 bool                      g_bGDAL_Debug;
 
 double                    g_VPRotate; // Viewport rotation angle, used on "Course Up" mode
@@ -1216,36 +1224,6 @@ static char *get_X11_property (Display *disp, Window win,
 #endif
 
 static wxStopWatch init_sw;
-class ParseENCWorkerThread : public wxThread
-{
-public:
-    ParseENCWorkerThread(wxString filename, Extent &ext, int scale)
-        : wxThread(wxTHREAD_JOINABLE)
-        {
-            m_filename = filename;
-            m_ext = ext;
-            m_scale = scale;
-            Create();
-        }
-        
-    void *Entry() {
-//         ChartBase *pchart = ChartData->OpenChartFromDB(m_filename, FULL_INIT);
-//         ChartData->DeleteCacheChart(pchart);
-        s57chart *newChart = new s57chart;
-        
-        newChart->SetNativeScale(m_scale);
-        newChart->SetFullExtent(m_ext);
-        
-        newChart->FindOrCreateSenc(m_filename);
-        delete newChart;
-        return 0;
-    }
-
-    wxString m_filename;
-    Extent m_ext;
-    int m_scale;
-};
-
 // begin duplicated code
 static double chart_dist(int index)
 {
@@ -1343,28 +1321,6 @@ void ParseAllENC()
         ct_array.Add(pct);
     }
     
-    int thread_count = 0;
-    ParseENCWorkerThread **workers = NULL;
-    /*    
-     *    extern int              g_nCPUCount;
-     *    if(g_nCPUCount > 0)
-     *        thread_count = g_nCPUCount;
-     *    else
-     *        thread_count = wxThread::GetCPUCount();
-     *        
-     *    if (thread_count < 1) {
-     *        // obviously there's a least one CPU!
-     *        thread_count = 1;
-     }
-     */
-    thread_count = 1; // for now because there is a problem with more than 1
-    
-    #if 0    
-    workers = new ParseENCWorkerThread*[thread_count];
-    for(int t = 0; t < thread_count; t++)
-        workers[t] = NULL;
-    #endif
-    
     wxGenericProgressDialog *prog = 0;
     wxSize csz = GetOCPNCanvasWindow()->GetClientSize();
     
@@ -1392,22 +1348,64 @@ void ParseAllENC()
         prog->Move( -1, yp );
     }
     
+    //  Convert the cells on a worker pool, nearest first, while this (the UI) thread
+    //  reports progress.  The serial loop remains for when no worker can be started.
+    SencBatchBuilder *builder = new SencBatchBuilder;
+    for(unsigned int j = 0; j<ct_array.GetCount(); j++) {
+        wxString filename = ct_array.Item(j).chart_path;
+        int index = ChartData->FinddbIndex(filename);
+        const ChartTableEntry &cte = ChartData->GetChartTableEntry(index);
+        Extent ext;
+        ext.NLAT = cte.GetLatMax();
+        ext.SLAT = cte.GetLatMin();
+        ext.WLON = cte.GetLonMin();
+        ext.ELON = cte.GetLonMax();
+
+        builder->Add(filename, cte.GetScale(), ext);
+    }
+
+    bool skip = false;
+    if(ps52plib && builder->Start(SencBatchBuilder::GetDefaultThreadCount())){
+        int nreported = -1;
+        while(builder->IsRunning()) {
+            int ndone = builder->GetDoneCount();
+            if(prog){
+                if(ndone != nreported){
+                    wxString msg;
+                    msg.Printf( _("ENC Completed:  %d/%d"), ndone, count);
+                    wxString last = builder->GetLastDone();
+                    if(last.Len() && (prog->GetSize().x > 600)){
+                        msg += _T("   Chart:");
+                        msg += last;
+                    }
+                    prog->Update(ndone, msg, &skip );
+#ifndef __WXMSW__
+                    prog->Raise();
+#endif
+                    nreported = ndone;
+                }
+                else
+                    prog->Update(ndone, wxEmptyString, &skip );
+            }
+            if(skip)
+                builder->Cancel();
+
+            wxThread::Sleep(20);
+        }
+        builder->Wait();
+
+        wxLogMessage(wxString::Format(_T("ParseAllENC() done = %d  failed = %d"),
+                                      builder->GetDoneCount(), builder->GetFailedCount() ));
+    }
+    else {
         // parse targets
-        bool skip = false;
         count = 0;
         for(unsigned int j = 0; j<ct_array.GetCount(); j++) {
             wxString filename = ct_array.Item(j).chart_path;
             double distance = ct_array.Item(j).distance;
-            int index = ChartData->FinddbIndex(filename);
-            const ChartTableEntry &cte = ChartData->GetChartTableEntry(index);
-            Extent ext;
-            ext.NLAT = cte.GetLatMax();
-            ext.SLAT = cte.GetLatMin();
-            ext.WLON = cte.GetLonMin();
-            ext.ELON = cte.GetLonMax();
-            
-            int scale = cte.GetScale();
-            
+            const SencBatchCell &cell = builder->GetCell(j);
+            Extent ext = cell.ext;
+
             wxString msg;
             msg.Printf( _("Distance from Ownship:  %4.0f NMi"), distance);
              
@@ -1428,15 +1426,16 @@ void ParseAllENC()
                     break;
             }
             
-            #if 1
             if(ps52plib){
                 s57chart *newChart = new s57chart;
                 
-                newChart->SetNativeScale(scale);
+                newChart->SetNativeScale(cell.scale);
                 newChart->SetFullExtent(ext);
                 
+                s57chart::LockSENCCell(filename);
                 newChart->FindOrCreateSenc(filename);
                 delete newChart;
+                s57chart::UnlockSENCCell(filename);
                 
                 if(wxThread::IsMain()){
                     msg.Printf( _("ENC Completed.") );
@@ -1449,48 +1448,61 @@ void ParseAllENC()
                     if(skip)
                         break;
                 }
-                
-                
-            }
-            
-            
-            #else        
-            for(int t = 0;; t=(t+1)%thread_count) {
-                if(!workers[t]) {
-                    workers[t] = new ParseENCWorkerThread(filename);
-                    workers[t]->Run();
-                    break;
-                }
-                
-                if(!workers[t]->IsAlive()) {
-                    workers[t]->Wait();
-                    delete workers[t];
-                    workers[t] = NULL;
-                }
-                if(t == 0) {
-                    //                ::wxYield();                // allow ChartCanvas main message loop to run 
-                    wxThread::Sleep(1); /* wait for a worker to finish */
-                }
             }
-            #endif 
             
 #ifdef __WXMSW__            
             ::wxSafeYield();
 #endif            
         }
-        
-        #if 0    
-        /* wait for workers to finish, and clean up after then */
-        for(int t = 0; t<thread_count; t++) {
-                        if(workers[t]) {
-                            workers[t]->Wait();
-                            delete workers[t];
-                        }
-        }
-        delete [] workers;
-        #endif    
-        
-        delete prog;
+    }
+
+    delete builder;
+    delete prog;
+}
+
+//  Bring the SENCs of the cells around ownship up to date in the background,
+//  so that the first view of the region does not wait on SENC creation.
+void StartPreheatENC()
+{
+    if( !ps52plib || !ChartData || g_pSencPreheat )
+        return;
+
+    MySortedArrayInt idx_sorted_by_distance(CompareInts);
+    for(int i = 0; i<ChartData->GetChartTableEntries(); i++) {
+        const ChartTableEntry &cte = ChartData->GetChartTableEntry(i);
+        if(CHART_TYPE_S57 != cte.GetChartType())
+            continue;
+        if(chart_dist(i) > g_nPreheatENCRadius)
+            continue;
+
+        idx_sorted_by_distance.Add(i);
+    }
+
+    if(idx_sorted_by_distance.GetCount() == 0)
+        return;
+
+    SencBatchBuilder *builder = new SencBatchBuilder;
+    for(unsigned int j = 0; j<idx_sorted_by_distance.GetCount(); j++) {
+        const ChartTableEntry &cte = ChartData->GetChartTableEntry(idx_sorted_by_distance.Item(j));
+        Extent ext;
+        ext.NLAT = cte.GetLatMax();
+        ext.SLAT = cte.GetLatMin();
+        ext.WLON = cte.GetLonMin();
+        ext.ELON = cte.GetLonMax();
+
+        builder->Add(wxString(cte.GetpFullPath(), wxConvUTF8), cte.GetScale(), ext);
+    }
+
+    //  Leave most of the machine to the UI
+    int nthreads = wxMin(2, SencBatchBuilder::GetDefaultThreadCount());
+    if(!builder->Start(nthreads)) {
+        delete builder;
+        return;
+    }
+
+    wxLogMessage(wxString::Format(_T("Preheating %d ENC cells within %d NMi"),
+                                  builder->GetCount(), g_nPreheatENCRadius ));
+    g_pSencPreheat = builder;
 }
 
 
@@ -1897,6 +1909,19 @@ bool MyApp::OnInit()
     g_memCacheLimit = 100 * 1024;
 #endif
 
+    //  Decoded raster chart pixels are shared by all open charts, within a fixed budget
+    if( g_nRasterTileCacheMB <= 0 )
+        g_nRasterTileCacheMB = 128;
+    g_pRasterTileCache = new RasterTileCache( (size_t) g_nRasterTileCacheMB * 1024 * 1024 );
+
+    //  Software raster scaling shares the work with one less thread than there are cores
+    int nScaleThreads = wxMax(1, wxThread::GetCPUCount());
+    if( g_nCPUCount > 0 )
+        nScaleThreads = g_nCPUCount;
+    nScaleThreads = wxMin(nScaleThreads, 8) - 1;
+    if( nScaleThreads > 0 )
+        g_pRasterBandPool = new RasterBandPool( nScaleThreads );
+
 //      Establish location and name of chart database
     ChartListFileName = newPrivateFileName(g_Platform->GetPrivateDataDir(), "chartlist.dat", "CHRTLIST.DAT");
 
@@ -2324,6 +2349,8 @@ extern ocpnGLOptions g_GLOptions;
 
     if(g_parse_all_enc )
         ParseAllENC();
+    else if(g_bPreheatENC)
+        StartPreheatENC();
 
 //      establish GPS timeout value as multiple of frame timer
 //      This will override any nonsense or unset value from the config file
@@ -2493,6 +2520,18 @@ int MyApp::OnExit()
 
     delete pDummyChart;
 
+    if( g_pRasterTileCache ) {
+        RasterTileCacheStats stats;
+        g_pRasterTileCache->GetStats( stats );
+        wxLogMessage( wxString::Format( _T("Raster tile cache: %lu hits, %lu misses, %lu evictions"),
+                                        stats.hits, stats.misses, stats.evictions ) );
+        delete g_pRasterTileCache;
+        g_pRasterTileCache = NULL;
+    }
+
+    delete g_pRasterBandPool;
+    g_pRasterBandPool = NULL;
+
     wxLogMessage( _T("opencpn::MyApp exiting cleanly...\n") );
     wxLog::FlushActive();
 
@@ -3408,6 +3447,10 @@ void MyFrame::OnCloseWindow( wxCloseEvent& event )
 
     b_inCloseWindow = true;
 
+    //  Stop preparing SENCs in the background, cells already started are finished
+    delete g_pSencPreheat;
+    g_pSencPreheat = NULL;
+
     ::wxSetCursor( wxCURSOR_WAIT );
 
     // If we happen to have the measure tool open on Ctrl-Q quit
@@ -5779,15 +5822,6 @@ int MyFrame::ProcessOptionsDialog( int rr, ArrayOfCDI *pNewDirArray )
         b_need_refresh = true;
     }
 
-#ifdef ocpnUSE_GL
-    if(rr & REBUILD_RASTER_CACHE){
-        if(g_glTextureManager){
-            cc1->Disable();
-            g_glTextureManager->BuildCompressedCache();
-            cc1->Enable();
-        }
-    }
-#endif
 
     if(g_config_display_size_mm > 0){
         g_display_size_mm = g_config_display_size_mm;
@@ -359,6 +359,20 @@ void ChartDB::ClearCacheInUseFlags(void)
 }
 
 
+//      The heap may keep a deleted chart's pages for a while, so what the chart reported
+//      holding is counted as freed until the measured usage has dropped by as much.
+//      A drop already measured is not credited again.  Returns the memory in use, in KB.
+static int CreditPurgedChart( int chart_kb, int &mem_measured, int &mem_pending )
+{
+    int mem_now;
+    GetMemoryStatus(0, &mem_now);
+
+    mem_pending = wxMax(0, mem_pending + chart_kb - (mem_measured - mem_now));
+    mem_measured = mem_now;
+
+    return mem_now - mem_pending;
+}
+
 //      Try to purge and delete charts from the cache until the application memory used is
 //      until the application memory used is less than {factor * Limit}
 //      Purge charts on LRU policy
@@ -373,6 +387,8 @@ void ChartDB::PurgeCacheUnusedCharts( double factor)
                 int mem_used;
                 GetMemoryStatus(0, &mem_used);
                 int mem_limit = g_memCacheLimit * factor;
+                int mem_measured = mem_used;
+                int mem_pending = 0;
 
                 int nl = pChartCache->GetCount();       // max loop count, by definition
                     
@@ -385,7 +401,11 @@ void ChartDB::PurgeCacheUnusedCharts( double factor)
                     }
                     
                     CacheEntry *pce = FindOldestDeleteCandidate( false );
+                    int chart_kb = 0;
                     if(pce){
+                        if(pce->pChart)
+                            chart_kb = ((ChartBase *)pce->pChart)->GetMemoryUsageKB();
+                        
                         // don't purge background spooler
                         DeleteCacheEntry(pce, false /*true*/, msg);
 
@@ -394,7 +414,7 @@ void ChartDB::PurgeCacheUnusedCharts( double factor)
                         break;
                     }
                     
-                    GetMemoryStatus(0, &mem_used);
+                    mem_used = CreditPurgedChart( chart_kb, mem_measured, mem_pending );
                     
                     nl--;
                 }
@@ -495,11 +515,15 @@ int ChartDB::BuildChartStack(ChartStack * cstk, float lat, float lon)
       if(!cstk)
             return 0;                           // Chartstack not ready yet
 
-      int nEntry = GetChartTableEntries();
+      //    Only charts whose bounding box may contain the position are candidates.
+      //    They come back in dbIndex order, so the resulting stack is unchanged
+      //    from a full scan of the chart table.
+      std::vector<int> candidates;
+      GetChartsAtPosition(lat, lon, candidates);
 
-      for(int db_index=0 ; db_index<nEntry ; db_index++)
+      for(unsigned int ic=0 ; ic<candidates.size() ; ic++)
       {
-
+            int db_index = candidates[ic];
             const ChartTableEntry &cte = GetChartTableEntry(db_index);
             
             //    Check to see if the candidate chart is in the currently active group
@@ -1176,16 +1200,22 @@ ChartBase *ChartDB::OpenChartUsingCache(int dbindex, ChartInitFlag init_flag)
                     
                     if((mem_used > g_memCacheLimit * 8 / 10) && (pChartCache->GetCount() > 2)) {
                         wxString msg(_T("Removing oldest chart from cache: "));
+                        int mem_measured = mem_used;
+                        int mem_pending = 0;
                         while (1)
                         {
                           CacheEntry *pce = FindOldestDeleteCandidate(true);
                           if (pce == 0)
                               break;                      // no possible delete candidate
                           
+                          int chart_kb = 0;
+                          if(pce->pChart)
+                              chart_kb = ((ChartBase *)pce->pChart)->GetMemoryUsageKB();
+                          
                           // purge texture cache, really need memory here
                           DeleteCacheEntry(pce, true, msg);
 
-                          GetMemoryStatus(0, &mem_used);
+                          mem_used = CreditPurgedChart( chart_kb, mem_measured, mem_pending );
                           if((mem_used < g_memCacheLimit * 8 / 10) || (pChartCache->GetCount() <= 2)) 
                               break;
                                 
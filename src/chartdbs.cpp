@@ -29,10 +29,13 @@
 #include "wx/wx.h"
 #endif
 
+#include <algorithm>
+
 #include <wx/arrimpl.cpp>
 #include <wx/encconv.h>
 #include <wx/regex.h>
 #include <wx/progdlg.h>
+#include <wx/thread.h>
 #include "wx/tokenzr.h"
 #include "wx/dir.h"
 
@@ -41,6 +44,7 @@
 #include "pluginmanager.h"
 #include "mygeom.h"                     // For DouglasPeucker();
 #include "FlexHash.h"
+#include "MappedFile.h"
 #ifndef UINT32
 #define UINT32 unsigned int
 #endif
@@ -116,15 +120,16 @@ bool ChartTableHeader::CheckValid()
 //          return false;       // no match....
 
 
-          // Try previous version....
-          sprintf(vb, "V%03d", DB_VERSION_PREVIOUS);
-          if (strncmp(vb, dbVersion, sizeof(dbVersion)))
-                return false;
-          else
-          {
-                wxLogMessage(_T("   Scheduling db upgrade to current db version on Options->Charts page visit..."));
-                return true;
+          // Try previous versions....
+          for(int version = DB_VERSION_PREVIOUS ; version >= DB_VERSION_OLDEST ; version--) {
+                sprintf(vb, "V%03d", version);
+                if (!strncmp(vb, dbVersion, sizeof(dbVersion)))
+                {
+                      wxLogMessage(_T("   Migrating chart db to current db version..."));
+                      return true;
+                }
           }
+          return false;
 
 
     }
@@ -371,19 +376,23 @@ ChartTableEntry::ChartTableEntry(ChartBase &theChart)
 
 ChartTableEntry::~ChartTableEntry()
 {
-    free(pFullPath);
-    free(pPlyTable);
-    
-    for (int i = 0; i < nAuxPlyEntries; i++)
-        free(pAuxPlyTable[i]);
+    //  Pool backed entries own only their table pointer arrays
+    if(!m_bPoolBacked) {
+        free(pFullPath);
+        free(pPlyTable);
+        for (int i = 0; i < nAuxPlyEntries; i++)
+            free(pAuxPlyTable[i]);
+        free(pAuxCntTable);
+    }
     free(pAuxPlyTable);
-    free(pAuxCntTable);
 
     if (nNoCovrPlyEntries) {
-        for (int i = 0; i < nNoCovrPlyEntries; i++) 
-            free( pNoCovrPlyTable[i] );
+        if(!m_bPoolBacked) {
+            for (int i = 0; i < nNoCovrPlyEntries; i++) 
+                free( pNoCovrPlyTable[i] );
+            free( pNoCovrCntTable );
+        }
         free( pNoCovrPlyTable );
-        free( pNoCovrCntTable );
     }
     
     delete m_pfilename;
@@ -392,6 +401,36 @@ ChartTableEntry::~ChartTableEntry()
 
 ///////////////////////////////////////////////////////////////////////
 
+void ChartTableEntry::MakeHelperStrings(void) const
+{
+    wxString fullfilename;
+    if(pFullPath)
+        fullfilename = wxString(pFullPath, wxConvUTF8);
+
+    if(!m_pfilename) {
+        wxFileName fn(fullfilename);
+        m_pfilename = new wxString(fn.GetFullName());
+    }
+    if(!m_psFullPath)
+        m_psFullPath = new wxString(fullfilename);
+}
+
+const wxString *ChartTableEntry::GetpFileName(void) const
+{
+    if(!m_pfilename)
+        MakeHelperStrings();
+    return m_pfilename;
+}
+
+wxString *ChartTableEntry::GetpsFullPath(void)
+{
+    if(!m_psFullPath)
+        MakeHelperStrings();
+    return m_psFullPath;
+}
+
+///////////////////////////////////////////////////////////////////////
+
 
 ///////////////////////////////////////////////////////////////////////
 
@@ -791,16 +830,22 @@ bool ChartTableEntry::Read(const ChartDatabase *pDb, wxInputStream &is)
 
 ///////////////////////////////////////////////////////////////////////
 
-bool ChartTableEntry::Write(const ChartDatabase *pDb, wxOutputStream &os)
+//  Append raw data to a database pool, returning its offset
+static int AppendToPool(std::vector<unsigned char> &pool, const void *data, size_t size)
 {
-    os.Write(pFullPath, strlen(pFullPath) + 1);
+    int offset = pool.size();
+    if(size)
+        pool.insert(pool.end(), (const unsigned char *)data, (const unsigned char *)data + size);
+    return offset;
+}
 
-    //      Write the current version type only
-    //      Create an on_disk table entry
-    ChartTableEntry_onDisk_18 cte;
+void ChartTableEntry::WriteToPools(ChartTableEntry_onDisk_19 &cte, std::vector<unsigned char> &string_pool,
+                                   std::vector<unsigned char> &ply_pool) const
+{
+    const char *path = pFullPath ? pFullPath : "";
+    cte.PathOffset = AppendToPool(string_pool, path, strlen(path) + 1);
 
-      //    Transcribe the elements....
-    cte.EntryOffset = EntryOffset;
+    //    Transcribe the elements....
     cte.ChartType = ChartType;
     cte.ChartFamily = ChartFamily;
     cte.LatMax = LatMax;
@@ -812,49 +857,153 @@ bool ChartTableEntry::Write(const ChartDatabase *pDb, wxOutputStream &os)
     cte.edition_date = edition_date;
     cte.file_date = file_date;
 
-    cte.nPlyEntries = nPlyEntries;
-    cte.nAuxPlyEntries = nAuxPlyEntries;
-
     cte.skew = Skew;
     cte.ProjectionType = ProjectionType;
-
     cte.bValid = bValid;
 
+    cte.nPlyEntries = nPlyEntries;
+    cte.PlyOffset = AppendToPool(ply_pool, pPlyTable, nPlyEntries * 2 * sizeof(float));
+
+    cte.nAuxPlyEntries = nAuxPlyEntries;
+    cte.AuxPlyOffset = AppendToPool(ply_pool, pAuxCntTable, nAuxPlyEntries * sizeof(int));
+    for (int i = 0; i < nAuxPlyEntries; i++)
+        AppendToPool(ply_pool, pAuxPlyTable[i], pAuxCntTable[i] * 2 * sizeof(float));
+
     cte.nNoCovrPlyEntries = nNoCovrPlyEntries;
-    
-    os.Write(&cte, sizeof(ChartTableEntry_onDisk_18));
-    wxLogVerbose(_T("  Wrote Chart %s"), pFullPath);
+    cte.NoCovrPlyOffset = AppendToPool(ply_pool, pNoCovrCntTable, nNoCovrPlyEntries * sizeof(int));
+    for (int i = 0; i < nNoCovrPlyEntries; i++)
+        AppendToPool(ply_pool, pNoCovrPlyTable[i], pNoCovrCntTable[i] * 2 * sizeof(float));
+}
 
-    //      Write out the tables
-    if (nPlyEntries) {
-        int npeSize = nPlyEntries * 2 * sizeof(float);
-        os.Write(pPlyTable, npeSize);
+//  Check that a set of ply tables (counts followed by points) lies within the pool
+static bool CheckPoolPlyTables(const unsigned char *ply_pool, size_t ply_pool_size, int offset, int ntables)
+{
+    if(ntables == 0)
+        return true;
+    if(offset < 0 || ntables < 0 || (offset % sizeof(int)))
+        return false;
+
+    size_t end = offset + (size_t)ntables * sizeof(int);
+    if(end > ply_pool_size)
+        return false;
+
+    const int *pcnt = (const int *)(ply_pool + offset);
+    for (int i = 0; i < ntables; i++) {
+        if(pcnt[i] < 0)
+            return false;
+        end += (size_t)pcnt[i] * 2 * sizeof(float);
+        if(end > ply_pool_size)
+            return false;
     }
-        
-    if (nAuxPlyEntries) {
-        int napeSize = nAuxPlyEntries * sizeof(int);
-        os.Write(pAuxCntTable, napeSize);
+    return true;
+}
 
-        for (int nAuxPlyEntry = 0; nAuxPlyEntry < nAuxPlyEntries; nAuxPlyEntry++) {
-            int nfSize = pAuxCntTable[nAuxPlyEntry] * 2 * sizeof(float);
-            os.Write(pAuxPlyTable[nAuxPlyEntry], nfSize);
-        }
+static float **MakePoolPlyTableArray(const unsigned char *ply_pool, int offset, int ntables)
+{
+    float **ppt = (float **)malloc(ntables * sizeof(float *));
+    const int *pcnt = (const int *)(ply_pool + offset);
+    float *pf = (float *)(ply_pool + offset + ntables * sizeof(int));
+    for (int i = 0; i < ntables; i++) {
+        ppt[i] = pf;
+        pf += pcnt[i] * 2;
     }
-    
-    if (nNoCovrPlyEntries ) {
-        int ncSize = nNoCovrPlyEntries * sizeof(int);
-        os.Write(pNoCovrCntTable, ncSize);
-        
-        for (int i = 0; i < nNoCovrPlyEntries; i++) {
-            int nctSize = pNoCovrCntTable[i] * 2 * sizeof(float);
-            os.Write(pNoCovrPlyTable[i], nctSize);
-        }
+    return ppt;
+}
+
+//  Populate this entry to refer directly to the pools of a mapped database.
+//  Nothing but the table pointer arrays is copied; the pools must outlive the entry,
+//  or DetachFromPools() must be called first.
+bool ChartTableEntry::ReadFromPools(const ChartTableEntry_onDisk_19 &cte, const char *string_pool, size_t string_pool_size,
+                                    const unsigned char *ply_pool, size_t ply_pool_size)
+{
+    Clear();
+
+    //  Validate all the offsets before anything is referenced
+    if(cte.PathOffset < 0 || (size_t)cte.PathOffset >= string_pool_size)
+        return false;
+    if(cte.nPlyEntries < 0 || cte.PlyOffset < 0 || (cte.PlyOffset % sizeof(float)) ||
+       cte.PlyOffset + (size_t)cte.nPlyEntries * 2 * sizeof(float) > ply_pool_size)
+        return false;
+    if(!CheckPoolPlyTables(ply_pool, ply_pool_size, cte.AuxPlyOffset, cte.nAuxPlyEntries))
+        return false;
+    if(!CheckPoolPlyTables(ply_pool, ply_pool_size, cte.NoCovrPlyOffset, cte.nNoCovrPlyEntries))
+        return false;
+
+    m_bPoolBacked = true;
+    pFullPath = (char *)string_pool + cte.PathOffset;
+
+    //    Transcribe the elements....
+    ChartType = cte.ChartType;
+    ChartFamily = cte.ChartFamily;
+    LatMax = cte.LatMax;
+    LatMin = cte.LatMin;
+    LonMax = cte.LonMax;
+    LonMin = cte.LonMin;
+
+    m_bbox.Set(LatMin, LonMin, LatMax, LonMax);
+
+    Skew = cte.skew;
+    ProjectionType = cte.ProjectionType;
+
+    Scale = cte.Scale;
+    edition_date = cte.edition_date;
+    file_date = cte.file_date;
+
+    bValid = cte.bValid != 0;
+
+    nPlyEntries = cte.nPlyEntries;
+    if (nPlyEntries)
+        pPlyTable = (float *)(ply_pool + cte.PlyOffset);
+
+    nAuxPlyEntries = cte.nAuxPlyEntries;
+    if (nAuxPlyEntries) {
+        pAuxCntTable = (int *)(ply_pool + cte.AuxPlyOffset);
+        pAuxPlyTable = MakePoolPlyTableArray(ply_pool, cte.AuxPlyOffset, nAuxPlyEntries);
+    }
+
+    nNoCovrPlyEntries = cte.nNoCovrPlyEntries;
+    if (nNoCovrPlyEntries) {
+        pNoCovrCntTable = (int *)(ply_pool + cte.NoCovrPlyOffset);
+        pNoCovrPlyTable = MakePoolPlyTableArray(ply_pool, cte.NoCovrPlyOffset, nNoCovrPlyEntries);
     }
-    
 
     return true;
 }
 
+static void *CopyOf(const void *data, size_t size)
+{
+    void *p = malloc(size);
+    if(size)
+        memcpy(p, data, size);
+    return p;
+}
+
+//  Take private copies of everything that refers to a mapped database
+void ChartTableEntry::DetachFromPools()
+{
+    if(!m_bPoolBacked)
+        return;
+
+    pFullPath = (char *)CopyOf(pFullPath, strlen(pFullPath) + 1);
+
+    if (nPlyEntries)
+        pPlyTable = (float *)CopyOf(pPlyTable, nPlyEntries * 2 * sizeof(float));
+
+    if (nAuxPlyEntries) {
+        for (int i = 0; i < nAuxPlyEntries; i++)
+            pAuxPlyTable[i] = (float *)CopyOf(pAuxPlyTable[i], pAuxCntTable[i] * 2 * sizeof(float));
+        pAuxCntTable = (int *)CopyOf(pAuxCntTable, nAuxPlyEntries * sizeof(int));
+    }
+
+    if (nNoCovrPlyEntries) {
+        for (int i = 0; i < nNoCovrPlyEntries; i++)
+            pNoCovrPlyTable[i] = (float *)CopyOf(pNoCovrPlyTable[i], pNoCovrCntTable[i] * 2 * sizeof(float));
+        pNoCovrCntTable = (int *)CopyOf(pNoCovrCntTable, nNoCovrPlyEntries * sizeof(int));
+    }
+
+    m_bPoolBacked = false;
+}
+
 ///////////////////////////////////////////////////////////////////////
 
 void ChartTableEntry::Clear()
@@ -874,6 +1023,7 @@ void ChartTableEntry::Clear()
     
     m_pfilename = NULL;             // a helper member, not on disk
     m_psFullPath = NULL;
+    m_bPoolBacked = false;
     
 }
 
@@ -907,10 +1057,19 @@ WX_DEFINE_OBJARRAY(ArrayOfChartClassDescriptor);
 ChartDatabase::ChartDatabase()
 {
       m_ChartTableEntryDummy.Clear();
+      m_pMappedDB = NULL;
+      m_bPathIndexValid = false;
 
       UpdateChartClassDescriptorArray();
 }
 
+ChartDatabase::~ChartDatabase()
+{
+      //  Entries may refer to the mapping, so they go first
+      active_chartTable.Clear();
+      delete m_pMappedDB;
+}
+
 void ChartDatabase::UpdateChartClassDescriptorArray(void)
 {
       m_ChartClassDescriptorArray.Clear();
@@ -1016,18 +1175,186 @@ wxString ChartDatabase::GetMagicNumberCached(wxString dir)
 
 
 
-bool ChartDatabase::Read(const wxString &filePath)
+//  Simple FNV-1a hash, used to validate mapped databases
+static unsigned int ChartTableChecksum(unsigned int hash, const void *data, size_t size)
 {
-    ChartTableEntry entry;
-    int entries;
+    const unsigned char *p = (const unsigned char *)data;
+    for(size_t i = 0 ; i < size ; i++) {
+        hash ^= p[i];
+        hash *= 16777619U;
+    }
+    return hash;
+}
 
+#define CHARTTABLE_CHECKSUM_SEED 2166136261U
+
+//  Checksum of the header, layout and fixed size tables of a mapped database
+static unsigned int ChartTableLayoutChecksum(const ChartTableHeader &cth, const ChartTableLayout_19 &layout,
+                                             const void *dirs, size_t dirs_size,
+                                             const void *entries, size_t entries_size)
+{
+    ChartTableLayout_19 l = layout;
+    l.Checksum = 0;
+
+    unsigned int checksum = CHARTTABLE_CHECKSUM_SEED;
+    checksum = ChartTableChecksum(checksum, &cth, sizeof(ChartTableHeader));
+    checksum = ChartTableChecksum(checksum, &l, sizeof(ChartTableLayout_19));
+    checksum = ChartTableChecksum(checksum, dirs, dirs_size);
+    checksum = ChartTableChecksum(checksum, entries, entries_size);
+    return checksum;
+}
+
+bool ChartDatabase::Read(const wxString &filePath)
+{
     bValid = false;
+    ReleaseMappedDB();
 
     wxFileName file(filePath);
     if (!file.FileExists()) return false;
 
     m_DBFileName = filePath;
 
+    //  Current format databases are mapped and used in place
+    MappedFile *pmap = new MappedFile;
+    if(pmap->Open(filePath) && pmap->GetSize() >= sizeof(ChartTableHeader)){
+        char vb[5];
+        sprintf(vb, "V%03d", DB_VERSION_CURRENT);
+        if(!strncmp(vb, (const char *)pmap->GetData(), 4)){
+            if(ReadMapped(pmap)){
+                m_pMappedDB = pmap;
+                BuildSpatialIndex();
+                return true;
+            }
+
+            wxLogMessage(_T("Chartdb: Mapped chart database is not valid"));
+            active_chartTable.Clear();
+            delete pmap;
+            InvalidatePathIndex();
+            m_chartDirs.Clear();
+            m_nentries = 0;
+            return false;
+        }
+    }
+    delete pmap;
+
+    //  Older formats are parsed, and migrated to the current format right away
+    bool ret = ReadStream(filePath);
+    BuildSpatialIndex();
+
+    if(ret && (m_dbversion < DB_VERSION_CURRENT)) {
+        if(Write(filePath)) {
+            s_dbVersion = m_dbversion;
+            wxLogMessage(_T("Chartdb: Migrated chart db to version %d"), m_dbversion);
+        }
+    }
+
+    return ret;
+}
+
+bool ChartDatabase::ReadMapped(MappedFile *pmap)
+{
+    const unsigned char *data = pmap->GetData();
+    size_t size = pmap->GetSize();
+    size_t body = sizeof(ChartTableHeader) + sizeof(ChartTableLayout_19);
+    if(size < body)
+        return false;
+
+    ChartTableHeader cth;
+    memcpy(&cth, data, sizeof(ChartTableHeader));
+    if (!cth.CheckValid()) return false;
+
+    ChartTableLayout_19 layout;
+    memcpy(&layout, data + sizeof(ChartTableHeader), sizeof(ChartTableLayout_19));
+
+    //  Sanity check the layout before trusting any offset
+    int nDirs = cth.GetDirEntries();
+    int nEntries = cth.GetTableEntries();
+    if( (nDirs < 0) || (nEntries < 0) ||
+        (layout.EntrySize != sizeof(ChartTableEntry_onDisk_19)) ||
+        (layout.DirTableOffset < (int)body) || (layout.DirTableOffset % sizeof(int)) ||
+        (layout.DirTableOffset + (size_t)nDirs * sizeof(int) > size) ||
+        (layout.EntryTableOffset < (int)body) || (layout.EntryTableOffset % sizeof(int)) ||
+        (layout.EntryTableOffset + (size_t)nEntries * layout.EntrySize > size) ||
+        (layout.StringPoolOffset < (int)body) || (layout.StringPoolSize < 0) ||
+        (layout.StringPoolOffset + (size_t)layout.StringPoolSize > size) ||
+        (layout.PlyPoolOffset < (int)body) || (layout.PlyPoolOffset % sizeof(int)) || (layout.PlyPoolSize < 0) ||
+        (layout.PlyPoolOffset + (size_t)layout.PlyPoolSize > size) )
+        return false;
+
+    //  Only the fixed size parts are checksummed, so validation does not touch the pools.
+    //  Pool contents are reached only through the bounds checked offsets below.
+    if(ChartTableLayoutChecksum(cth, layout, data + layout.DirTableOffset, (size_t)nDirs * sizeof(int),
+                                data + layout.EntryTableOffset, (size_t)nEntries * layout.EntrySize) != layout.Checksum)
+        return false;
+
+    const char *string_pool = (const char *)(data + layout.StringPoolOffset);
+    const unsigned char *ply_pool = data + layout.PlyPoolOffset;
+
+    //  Every string offset that passes a bounds check must be terminated within the pool
+    if(layout.StringPoolSize && string_pool[layout.StringPoolSize - 1])
+        return false;
+
+    m_dbversion = DB_VERSION_CURRENT;
+    s_dbVersion = m_dbversion;                  // save the static copy
+
+    wxLogVerbose(wxT("Chartdb:Mapping %d directory entries, %d table entries"), nDirs, nEntries);
+    wxLogMessage(_T("Chartdb: Chart directory list follows"));
+    if(0 == nDirs)
+          wxLogMessage(_T("  Nil"));
+
+    const int *dir_table = (const int *)(data + layout.DirTableOffset);
+    for (int iDir = 0; iDir < nDirs; iDir++) {
+        if(dir_table[iDir] < 0 || dir_table[iDir] >= layout.StringPoolSize)
+            return false;
+        wxString dir(string_pool + dir_table[iDir], wxConvUTF8);
+
+        wxString msg;
+        msg.Printf(wxT("  Chart directory #%d: "), iDir);
+        msg.Append(dir);
+        wxLogMessage(msg);
+        m_chartDirs.Add(dir);
+    }
+
+    ChartTableEntry entry;
+    const ChartTableEntry_onDisk_19 *pcte = (const ChartTableEntry_onDisk_19 *)(data + layout.EntryTableOffset);
+
+    active_chartTable.Alloc(nEntries);
+    InvalidatePathIndex();
+    for (int i = 0; i < nEntries; i++) {
+        if(!entry.ReadFromPools(pcte[i], string_pool, layout.StringPoolSize, ply_pool, layout.PlyPoolSize)) {
+            entry.Clear();
+            return false;
+        }
+        entry.SetEntryOffset(i);
+        active_chartTable.Add(entry);
+    }
+
+    entry.Clear();
+    bValid = true;
+    entry.SetAvailable(true);
+
+    m_nentries = active_chartTable.GetCount();
+    return true;
+}
+
+//  Make every entry independent of the mapped database file, and drop the mapping
+void ChartDatabase::ReleaseMappedDB(void)
+{
+    if(!m_pMappedDB)
+        return;
+
+    for(unsigned int i=0 ; i<active_chartTable.GetCount() ; i++)
+        active_chartTable[i].DetachFromPools();
+
+    delete m_pMappedDB;
+    m_pMappedDB = NULL;
+}
+
+bool ChartDatabase::ReadStream(const wxString &filePath)
+{
+    ChartTableEntry entry;
+    int entries;
+
     wxFFileInputStream ifs(filePath);
     if(!ifs.Ok()) return false;
 
@@ -1042,12 +1369,15 @@ bool ChartDatabase::Read(const wxString &filePath)
     m_dbversion = atoi(&vbo[1]);
     s_dbVersion = m_dbversion;                  // save the static copy
 
+    //  The current format can only be mapped, see ReadMapped()
+    if(m_dbversion == DB_VERSION_CURRENT)
+        return false;
+
     wxLogVerbose(wxT("Chartdb:Reading %d directory entries, %d table entries"), cth.GetDirEntries(), cth.GetTableEntries());
     wxLogMessage(_T("Chartdb: Chart directory list follows"));
     if(0 == cth.GetDirEntries())
           wxLogMessage(_T("  Nil"));
 
-    int ind = 0;
     for (int iDir = 0; iDir < cth.GetDirEntries(); iDir++) {
         wxString dir;
         int dirlen;
@@ -1070,11 +1400,9 @@ bool ChartDatabase::Read(const wxString &filePath)
 
     entries = cth.GetTableEntries();
     active_chartTable.Alloc(entries);
-    active_chartTable_pathindex.clear();
-    while (entries-- && entry.Read(this, ifs)) {
-        active_chartTable_pathindex[wxString(entry.GetpFullPath(), wxConvUTF8)] = ind++;
+    InvalidatePathIndex();
+    while (entries-- && entry.Read(this, ifs))
         active_chartTable.Add(entry);
-    }
 
     entry.Clear();
     bValid = true;
@@ -1098,26 +1426,73 @@ bool ChartDatabase::Write(const wxString &filePath)
 
     if (!dir.DirExists() && !dir.Mkdir()) return false;
 
-    wxFFileOutputStream ofs(filePath);
-    if(!ofs.Ok()) return false;
+    //  The file about to be replaced may be the one our entries are mapped from
+    ReleaseMappedDB();
 
-    ChartTableHeader cth(m_chartDirs.GetCount(), active_chartTable.GetCount());
-    cth.Write(ofs);
+    //  Assemble the tables and pools
+    std::vector<unsigned char> string_pool;
+    std::vector<unsigned char> ply_pool;
 
-    for (int iDir = 0; iDir < cth.GetDirEntries(); iDir++) {
-        wxString &dir = m_chartDirs[iDir];
-        int dirlen = dir.length();
-        char s[200];
-        strncpy(s, dir.mb_str(wxConvUTF8), 199);
-        s[199] = 0;
-        dirlen = strlen(s);
-        ofs.Write(&dirlen, sizeof(int));
-//        ofs.Write(dir.fn_str(), dirlen);
-        ofs.Write(s, dirlen);
+    std::vector<int> dir_table;
+    for (unsigned int iDir = 0; iDir < m_chartDirs.GetCount(); iDir++) {
+        wxCharBuffer dirbuf = m_chartDirs[iDir].mb_str(wxConvUTF8);
+        const char *s = dirbuf.data() ? dirbuf.data() : "";
+        dir_table.push_back(AppendToPool(string_pool, s, strlen(s) + 1));
     }
 
+    std::vector<ChartTableEntry_onDisk_19> entry_table(active_chartTable.size());
     for (UINT32 iTable = 0; iTable < active_chartTable.size(); iTable++)
-        active_chartTable[iTable].Write(this, ofs);
+        active_chartTable[iTable].WriteToPools(entry_table[iTable], string_pool, ply_pool);
+
+    while(string_pool.size() % sizeof(int))
+        string_pool.push_back(0);
+
+    ChartTableHeader cth(dir_table.size(), entry_table.size());
+
+    size_t dir_table_size = dir_table.size() * sizeof(int);
+    size_t entry_table_size = entry_table.size() * sizeof(ChartTableEntry_onDisk_19);
+
+    ChartTableLayout_19 layout;
+    layout.EntrySize = sizeof(ChartTableEntry_onDisk_19);
+    layout.DirTableOffset = sizeof(ChartTableHeader) + sizeof(ChartTableLayout_19);
+    layout.EntryTableOffset = layout.DirTableOffset + dir_table_size;
+    layout.StringPoolOffset = layout.EntryTableOffset + entry_table_size;
+    layout.StringPoolSize = string_pool.size();
+    layout.PlyPoolOffset = layout.StringPoolOffset + string_pool.size();
+    layout.PlyPoolSize = ply_pool.size();
+
+    const void *pdirs = dir_table_size ? (const void *)&dir_table[0] : NULL;
+    const void *pentries = entry_table_size ? (const void *)&entry_table[0] : NULL;
+    const void *pstrings = string_pool.size() ? (const void *)&string_pool[0] : NULL;
+    const void *pplys = ply_pool.size() ? (const void *)&ply_pool[0] : NULL;
+
+    //  Write() stamps the version into the header, do the same before it is checksummed
+    char vb[5];
+    sprintf(vb, "V%03d", DB_VERSION_CURRENT);
+    memcpy(cth.GetDBVersionString(), vb, 4);
+    layout.Checksum = ChartTableLayoutChecksum(cth, layout, pdirs, dir_table_size, pentries, entry_table_size);
+
+    //  Other instances may have the live file mapped, so write it aside and rename it over
+    wxString tmp_path = filePath + _T(".tmp");
+    bool ok;
+    {
+        wxFFileOutputStream ofs(tmp_path);
+        if(!ofs.Ok()) return false;
+
+        cth.Write(ofs);
+        ofs.Write(&layout, sizeof(ChartTableLayout_19));
+        ofs.Write(pdirs, dir_table_size);
+        ofs.Write(pentries, entry_table_size);
+        ofs.Write(pstrings, string_pool.size());
+        ofs.Write(pplys, ply_pool.size());
+
+        ok = ofs.IsOk() && ofs.Close();
+    }
+
+    if(!ok || !wxRenameFile(tmp_path, filePath, true)) {
+        wxRemoveFile(tmp_path);
+        return false;
+    }
 
     //      Explicitly set the version
     m_dbversion = DB_VERSION_CURRENT;
@@ -1350,7 +1725,7 @@ bool ChartDatabase::Create(ArrayOfCDI &dir_array, wxGenericProgressDialog *pprog
 
       m_chartDirs.Clear();
       active_chartTable.Clear();
-      active_chartTable_pathindex.clear();
+      InvalidatePathIndex();
 
       Update(dir_array, true, pprog);                   // force the update the reload everything
 
@@ -1427,18 +1802,62 @@ bool ChartDatabase::Update(ArrayOfCDI& dir_array, bool bForce, wxGenericProgress
       }
 
       //    And once more, setting the Entry index field
-      active_chartTable_pathindex.clear();
-      for(unsigned int i=0 ; i<active_chartTable.GetCount() ; i++) {
-          active_chartTable_pathindex[wxString(active_chartTable[i].GetpFullPath(), wxConvUTF8)] = i;
+      InvalidatePathIndex();
+      for(unsigned int i=0 ; i<active_chartTable.GetCount() ; i++)
           active_chartTable[i].SetEntryOffset( i );
-      }
 
       m_nentries = active_chartTable.GetCount();
+      BuildSpatialIndex();
       
       bValid = true;
       return true;
 }
 
+//-------------------------------------------------------------------
+//    Spatial index of chart table entry bounding boxes
+//-------------------------------------------------------------------
+
+static void AddEntryToIndex(SpatialIndex &index, int db_index, const ChartTableEntry &cte, bool b_insert)
+{
+    //  Disabled charts have their latitudes offset by 1000 (see ChartTableEntry::Disable()),
+    //  index them at their true position so that a later ReEnable() needs no index update.
+    float lat_max = cte.GetLatMax();
+    float lat_min = cte.GetLatMin();
+    if(lat_max > 90.){
+        lat_max -= (float) 1000.;
+        lat_min -= (float) 1000.;
+    }
+
+    if(b_insert)
+        index.Insert(db_index, cte.GetLonMin(), lat_min, cte.GetLonMax(), lat_max);
+    else
+        index.Add(db_index, cte.GetLonMin(), lat_min, cte.GetLonMax(), lat_max);
+}
+
+void ChartDatabase::BuildSpatialIndex(void)
+{
+    m_chart_index.Clear();
+    m_chart_index.Reserve(active_chartTable.GetCount());
+
+    for(unsigned int i=0 ; i<active_chartTable.GetCount() ; i++)
+        AddEntryToIndex(m_chart_index, i, active_chartTable[i], false);
+
+    m_chart_index.Build();
+}
+
+//  Return, in ascending order, the dbIndex of every chart whose bounding box
+//  may contain lat/lon.  Charts spanning or lying beyond the international
+//  dateline are stored with longitudes > 180, so those are looked up too.
+void ChartDatabase::GetChartsAtPosition(float lat, float lon, std::vector<int> &db_indices) const
+{
+    db_indices.clear();
+    m_chart_index.Query(lon, lat, db_indices);
+    m_chart_index.Query(lon + 360., lat, db_indices);
+
+    std::sort(db_indices.begin(), db_indices.end());
+    db_indices.erase(std::unique(db_indices.begin(), db_indices.end()), db_indices.end());
+}
+
 //-------------------------------------------------------------------
 //    Find Chart dbIndex
 //-------------------------------------------------------------------
@@ -1456,13 +1875,28 @@ int ChartDatabase::FinddbIndex(wxString PathToFind)
             }
       }
 #else
-      if(active_chartTable_pathindex.find(PathToFind) != active_chartTable_pathindex.end())
-          return active_chartTable_pathindex[PathToFind];
+      //  The index is only wanted by path lookups, so it is built on first use
+      if(!m_bPathIndexValid) {
+          active_chartTable_pathindex.clear();
+          for(unsigned int i=0 ; i<active_chartTable.GetCount() ; i++)
+              active_chartTable_pathindex[wxString(active_chartTable[i].GetpFullPath(), wxConvUTF8)] = i;
+          m_bPathIndexValid = true;
+      }
+
+      std::map<wxString, int>::iterator it = active_chartTable_pathindex.find(PathToFind);
+      if(it != active_chartTable_pathindex.end())
+          return it->second;
 #endif
 
       return -1;
 }
 
+void ChartDatabase::InvalidatePathIndex(void)
+{
+      active_chartTable_pathindex.clear();
+      m_bPathIndexValid = false;
+}
+
 
 
 //-------------------------------------------------------------------
@@ -1826,6 +2260,154 @@ wxString ChartDatabase::Get_CM93_FileName(wxString dir_name)
 
 WX_DECLARE_STRING_HASH_MAP( int, ChartCollisionsHashMap );
 
+// ----------------------------------------------------------------------------
+//  Parallel chart header ingestion
+//
+//  SearchDirAndAddCharts() hands the files that will need a new ChartTableEntry
+//  to a small pool of ChartTableEntryWorker threads.  Each result is stored by
+//  file index, and the usual sequential duplicate resolution then consumes them
+//  in file order, so the resulting table does not depend on thread timing.
+// ----------------------------------------------------------------------------
+
+class ChartTableEntryJobs
+{
+public:
+    wxCriticalSection                   m_lock;
+    std::vector<wxString>               m_paths;        // private copies, one per job
+    std::vector<int>                    m_file_index;   // job -> FileList index
+    std::vector<ChartTableEntry *>      m_results;      // by job
+    size_t                              m_next;
+    size_t                              m_ndone;
+    int                                 m_last_done;
+};
+
+class ChartTableEntryWorker : public wxThread
+{
+public:
+    ChartTableEntryWorker(ChartDatabase *pdb, const ChartClassDescriptor &chart_desc, ChartTableEntryJobs *pjobs)
+        : wxThread(wxTHREAD_JOINABLE)
+    {
+        m_pdb = pdb;
+        m_pjobs = pjobs;
+
+        //  Deep copies, wxString is not safe to share between threads
+        m_desc.m_class_name = wxString(chart_desc.m_class_name.c_str());
+        m_desc.m_search_mask = wxString(chart_desc.m_search_mask.c_str());
+        m_desc.m_descriptor_type = chart_desc.m_descriptor_type;
+    }
+
+    void *Entry()
+    {
+        for(;;) {
+            size_t job;
+            {
+                wxCriticalSectionLocker locker(m_pjobs->m_lock);
+                if(m_pjobs->m_next >= m_pjobs->m_paths.size())
+                    break;
+                job = m_pjobs->m_next++;
+            }
+
+            ChartTableEntry *pentry = m_pdb->CreateChartTableEntry(m_pjobs->m_paths[job], m_desc);
+
+            wxCriticalSectionLocker locker(m_pjobs->m_lock);
+            m_pjobs->m_results[job] = pentry;
+            m_pjobs->m_ndone++;
+            m_pjobs->m_last_done = job;
+        }
+        return 0;
+    }
+
+private:
+    ChartDatabase               *m_pdb;
+    ChartTableEntryJobs         *m_pjobs;
+    ChartClassDescriptor        m_desc;
+};
+
+//  Only chart classes whose header parsing is known to be reentrant are built in parallel.
+//  s57chart::Init() guards against recursion with a static flag, and plugin charts make
+//  no promise at all, so those are still ingested one at a time.
+static bool IsChartClassReentrant(const ChartClassDescriptor &chart_desc)
+{
+    return (chart_desc.m_descriptor_type == BUILTIN_DESCRIPTOR) &&
+           ((chart_desc.m_class_name == _T("ChartKAP")) || (chart_desc.m_class_name == _T("ChartGEO")));
+}
+
+//  Build ChartTableEntries for the flagged files on a worker pool.
+//  Returns the number of files handled; entries[ifile] is valid where built[ifile] is set.
+int ChartDatabase::BuildChartTableEntries(const wxArrayString &FileList, const std::vector<char> &needed,
+                                          ChartClassDescriptor &chart_desc, wxGenericProgressDialog *pprog,
+                                          std::vector<ChartTableEntry *> &entries, std::vector<char> &built)
+{
+    entries.assign(FileList.GetCount(), (ChartTableEntry *)NULL);
+    built.assign(FileList.GetCount(), 0);
+
+    int nthreads = wxMax(1, wxThread::GetCPUCount());
+    nthreads = wxMin(nthreads, 8);
+
+    ChartTableEntryJobs jobs;
+    for(unsigned int i=0 ; i < FileList.GetCount() ; i++) {
+        if(needed[i]) {
+            jobs.m_paths.push_back(wxString(FileList.Item(i).c_str()));
+            jobs.m_file_index.push_back(i);
+        }
+    }
+
+    size_t njobs = jobs.m_paths.size();
+    if((nthreads < 2) || (njobs < 2 * (size_t)nthreads) || !IsChartClassReentrant(chart_desc))
+        return 0;
+
+    jobs.m_results.assign(njobs, (ChartTableEntry *)NULL);
+    jobs.m_next = 0;
+    jobs.m_ndone = 0;
+    jobs.m_last_done = -1;
+
+    std::vector<ChartTableEntryWorker *> workers;
+    for(int t = 0 ; t < nthreads ; t++) {
+        ChartTableEntryWorker *pworker = new ChartTableEntryWorker(this, chart_desc, &jobs);
+        if((pworker->Create() != wxTHREAD_NO_ERROR) || (pworker->Run() != wxTHREAD_NO_ERROR)) {
+            delete pworker;
+            break;
+        }
+        workers.push_back(pworker);
+    }
+
+    if(!workers.size())
+        return 0;
+
+    //  Report progress from this (the UI) thread while the workers run
+    size_t nreported = 0;
+    for(;;) {
+        size_t ndone;
+        int last_done;
+        {
+            wxCriticalSectionLocker locker(jobs.m_lock);
+            ndone = jobs.m_ndone;
+            last_done = jobs.m_last_done;
+        }
+
+        if(pprog && (ndone != nreported) && (last_done >= 0))
+            pprog->Update( wxMin((int)((ndone * 100) / njobs), 100), FileList.Item(jobs.m_file_index[last_done]) );
+        nreported = ndone;
+
+        if(ndone == njobs)
+            break;
+
+        wxThread::Sleep(20);
+    }
+
+    for(unsigned int t = 0 ; t < workers.size() ; t++) {
+        workers[t]->Wait();
+        delete workers[t];
+    }
+
+    for(size_t job = 0 ; job < njobs ; job++) {
+        entries[jobs.m_file_index[job]] = jobs.m_results[job];
+        built[jobs.m_file_index[job]] = 1;
+    }
+
+    return njobs;
+}
+
 int ChartDatabase::SearchDirAndAddCharts(wxString& dir_name_base,
                                          ChartClassDescriptor &chart_desc,
                                          wxGenericProgressDialog *pprog)
@@ -1916,6 +2498,33 @@ int ChartDatabase::SearchDirAndAddCharts(wxString& dir_name_base,
           collision_map[table_file.GetFullName()] = i;
       }
 
+      //    Find the files that will surely need a new ChartTableEntry, that is all of
+      //    them except those already in the table under the same path and not modified since.
+      //    Build those entries concurrently up front.
+      std::vector<char> needed(nFile, 0);
+      for(int ifile=0 ; ifile < nFile ; ifile++)
+      {
+            wxFileName file(FileList.Item(ifile));
+            wxString file_name = file.GetFullName();
+            if(!file_name.Matches(lowerFileSpec) && !file_name.Matches(filespec) &&
+               !file_name.Matches(lowerFileSpecXZ) && !file_name.Matches(filespecXZ) &&
+               !b_found_cm93)
+                continue;
+
+            needed[ifile] = 1;
+            ChartCollisionsHashMap::const_iterator collision_ptr = collision_map.find( file_name );
+            if( bthis_dir_in_dB && ( collision_ptr != collision_map.end() ) ) {
+                ChartTableEntry *pEntry = &active_chartTable[collision_ptr->second];
+                if( file.GetFullPath().IsSameAs( wxString::FromUTF8(pEntry->GetpFullPath()) ) &&
+                    ( file.GetModificationTime().GetTicks() <= pEntry->GetFileTime() ) )
+                    needed[ifile] = 0;
+            }
+      }
+
+      std::vector<ChartTableEntry *> prebuilt;
+      std::vector<char> b_prebuilt;
+      bool b_parallel = BuildChartTableEntries(FileList, needed, chart_desc, pprog, prebuilt, b_prebuilt) > 0;
+
       int nFileProgressQuantum = wxMax( nFile / 100, 2 );
       double rFileProgressRatio = 100.0 / wxMax( nFile, 1 );
 
@@ -1933,7 +2542,7 @@ int ChartDatabase::SearchDirAndAddCharts(wxString& dir_name_base,
                 continue;
             }
 
-            if( pprog && ( ( ifile % nFileProgressQuantum ) == 0 ) )
+            if( pprog && !b_parallel && ( ( ifile % nFileProgressQuantum ) == 0 ) )
                   pprog->Update( static_cast<int>( ifile * rFileProgressRatio ), full_name );
 
             ChartTableEntry *pnewChart = NULL;
@@ -1981,7 +2590,12 @@ int ChartDatabase::SearchDirAndAddCharts(wxString& dir_name_base,
                 msg.Append(full_name);
                 wxLogMessage(msg);
             } else {
-                pnewChart = CreateChartTableEntry(full_name, chart_desc);
+                if( b_prebuilt[ifile] ) {
+                    pnewChart = prebuilt[ifile];
+                    prebuilt[ifile] = NULL;
+                }
+                else
+                    pnewChart = CreateChartTableEntry(full_name, chart_desc);
                 if(!pnewChart)
                 {
                     bAddFinal = false;
@@ -2064,6 +2678,10 @@ int ChartDatabase::SearchDirAndAddCharts(wxString& dir_name_base,
             }
       }
 
+      //    Discard any entries built for files that turned out not to need them
+      for(unsigned int i=0 ; i < prebuilt.size() ; i++)
+            delete prebuilt[i];
+
       m_nentries = active_chartTable.GetCount();
       
       return nDirEntry;
@@ -2252,22 +2870,34 @@ bool ChartDatabase::AddSingleChart( wxString &ChartFullPath, bool b_force_full_s
     if(!b_force_full_search)
         b_recurse = IsChartDirUsed(dir_name);
     
+    unsigned int n_before = active_chartTable.GetCount();
     bool rv = AddChart( ChartFullPath, desc, NULL, 0,  b_recurse );
 
     //  remove duplicates marked in AddChart()
 
+    bool b_removed = false;
     for(unsigned int i=0 ; i<active_chartTable.GetCount() ; i++)
     {
         if(!active_chartTable[i].GetbValid())
         {
             active_chartTable.RemoveAt(i);
             i--;                 // entry is gone, recheck this index for next entry
+            b_removed = true;
         }
     }
     
     //    Update the Entry index fields
     for(unsigned int i=0 ; i<active_chartTable.GetCount() ; i++)
         active_chartTable[i].SetEntryOffset( i );
+
+    //    Update the spatial index.  Pure appends can be inserted in place,
+    //    anything else has shifted the dbIndex of existing entries.
+    if(b_removed)
+        BuildSpatialIndex();
+    else {
+        for(unsigned int i=n_before ; i<active_chartTable.GetCount() ; i++)
+            AddEntryToIndex(m_chart_index, i, active_chartTable[i], true);
+    }
  
     //  Get a new magic number
     wxString new_magic;
@@ -2329,6 +2959,8 @@ bool ChartDatabase::RemoveSingleChart( wxString &ChartFullPath )
     for(unsigned int i=0 ; i<active_chartTable.GetCount() ; i++) {
         if( !strcmp( ChartFullPath.mb_str(), GetChartTableEntry(i).GetpFullPath() ) ){
             active_chartTable.RemoveAt(i);
+            m_chart_index.Remove(i);
+            m_chart_index.Renumber(i + 1, -1);
             break;
         }
     }
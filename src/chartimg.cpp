@@ -49,6 +49,7 @@
 #include "wx/wfstream.h"
 #include "wx/tokenzr.h"
 #include "wx/filename.h"
+#include "wx/ffile.h"
 #include <wx/image.h>
 #include <wx/fileconf.h>
 #include <sys/stat.h>
@@ -57,6 +58,17 @@
 #include "chartimg.h"
 #include "ocpn_pixel.h"
 #include "ChartDataInputStream.h"
+#include "OCPNPlatform.h"
+#include "FlexHash.h"
+#include "RasterTileCache.h"
+#include "RasterBandPool.h"
+
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define OCPN_BSB_SSE2 1
+#endif
 
 #ifndef __WXMSW__
 #include <signal.h>
@@ -101,6 +113,22 @@ class MyConfig;
 extern MyConfig        *pConfig;
 #endif
 
+extern OCPNPlatform    *g_Platform;
+
+//  Line index sidecar files, saved so that charts whose embedded index needed
+//  checking or recreating can be opened quickly next time
+#define LINE_INDEX_MAGIC        0x4c494458
+#define LINE_INDEX_VERSION      1
+
+struct LineIndexHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t filesize;
+    int64_t  mtime;
+    int32_t  size_y;
+    int32_t  line_offset;
+};
+
 typedef struct  {
       float y;
       float x;
@@ -1649,7 +1677,7 @@ ChartBaseBSB::ChartBaseBSB()
 
       pPixCache = NULL;
 
-      pLineCache = NULL;
+      m_tile_owner = 0;
 
       m_bilinear_limit = 8;         // bilinear scaling only up to n
 
@@ -1723,7 +1751,6 @@ ChartBaseBSB::~ChartBaseBSB()
 
 //    Free the line cache
       FreeLineCacheRows();
-      free (pLineCache);
 
       delete pPixCache;
 
@@ -1733,32 +1760,22 @@ ChartBaseBSB::~ChartBaseBSB()
 
 }
 
+//    Drop the cached tiles covering rows start to end
 void ChartBaseBSB::FreeLineCacheRows(int start, int end)
 {
-    if(pLineCache)
+    if(m_tile_owner && g_pRasterTileCache)
     {
         if(end < 0)
-            end = Size_Y;
-        else
-            end = wxMin(end, Size_Y);
-        for(int ylc = start ; ylc < end ; ylc++) {
-            CachedLine *pt = &pLineCache[ylc];
-            if(pt->bValid) {
-                free (pt->pTileOffset);
-                free (pt->pPix);
-                pt->bValid = false;
-            }
-        }
+            g_pRasterTileCache->Remove(m_tile_owner, start / RASTER_TILE_SIZE);
+        else if(end > start)
+            g_pRasterTileCache->Remove(m_tile_owner, start / RASTER_TILE_SIZE, (end - 1) / RASTER_TILE_SIZE);
     }
 }
 
 bool ChartBaseBSB::HaveLineCacheRow(int row)
 {
-    if(pLineCache)
-    {
-        CachedLine *pt = &pLineCache[row];
-        return pt->bValid;
-    }
+    if(m_tile_owner && g_pRasterTileCache)
+        return g_pRasterTileCache->Contains(m_tile_owner, 0, row / RASTER_TILE_SIZE);
     return false;
 }
 
@@ -1938,6 +1955,53 @@ InitReturn ChartBaseBSB::PostInit(void)
       if(!pline_table)
             return INIT_FAIL_REMOVE;
 
+      //    A sidecar saved by an earlier open spares us checking or rebuilding the index
+      if(!LoadLineIndexSidecar())
+      {
+            InitReturn index_ret = ReadLineIndex();
+            if(index_ret != INIT_OK)
+                  return index_ret;
+      }
+
+      //    Decoded pixels live in the shared tile cache, under our own id
+      if(bUseLineCache && g_pRasterTileCache)
+            m_tile_owner = g_pRasterTileCache->NewOwner();
+
+
+      //    Validate/Set Depth Unit Type
+      wxString test_str = m_DepthUnits.Upper();
+      if(test_str.IsSameAs(_T("FEET"), FALSE))
+          m_depth_unit_id = DEPTH_UNIT_FEET;
+      else if(test_str.IsSameAs(_T("METERS"), FALSE))
+          m_depth_unit_id = DEPTH_UNIT_METERS;
+      else if(test_str.IsSameAs(_T("METRES"), FALSE))                  // Special case for alternate spelling
+          m_depth_unit_id = DEPTH_UNIT_METERS;
+      else if(test_str.IsSameAs(_T("METRIC"), FALSE))
+          m_depth_unit_id = DEPTH_UNIT_METERS;
+      else if(test_str.IsSameAs(_T("FATHOMS"), FALSE))
+          m_depth_unit_id = DEPTH_UNIT_FATHOMS;
+      else if(test_str.Find(_T("FATHOMS")) != wxNOT_FOUND)             // Special case for "Fathoms and Feet"
+          m_depth_unit_id = DEPTH_UNIT_FATHOMS;
+      else if(test_str.Find(_T("METERS")) != wxNOT_FOUND)             // Special case for "Meters and decimeters"
+            m_depth_unit_id = DEPTH_UNIT_METERS;
+
+           
+      //   Analyze Refpoints
+      int analyze_ret_val = AnalyzeRefpoints();
+      if(0 != analyze_ret_val)
+            return INIT_FAIL_REMOVE;
+
+
+      bReadyToRender = true;
+      return INIT_OK;
+}
+
+
+
+//    Read the line offset table embedded at the end of the bitmap file,
+//    checking it and recreating it if need be
+InitReturn ChartBaseBSB::ReadLineIndex(void)
+{
       ifs_bitmap->SeekI((Size_Y+1) * -4, wxFromEnd);                 // go to Beginning of offset table
       pline_table[Size_Y] = ifs_bitmap->TellI();                     // fill in useful last table entry
 
@@ -2060,119 +2124,162 @@ InitReturn ChartBaseBSB::PostInit(void)
           }
       }
 
+      //  Save the work of checking or recreating the index for the next open
+      if(!bline_index_ok || ver < 2.0)
+          SaveLineIndexSidecar();
 
-
-      //    Allocate the Line Cache
-      if(bUseLineCache)
-      {
-            pLineCache = (CachedLine *)malloc(Size_Y * sizeof(CachedLine));
-            CachedLine *pt;
-
-            for(int ylc = 0 ; ylc < Size_Y ; ylc++)
-            {
-                  pt = &pLineCache[ylc];
-                  pt->bValid = false;
-                  pt->pPix = NULL;        //(unsigned char *)malloc(1);
-                  pt->pTileOffset = NULL;
-            }
-      }
-      else
-            pLineCache = NULL;
-
-
-      //    Validate/Set Depth Unit Type
-      wxString test_str = m_DepthUnits.Upper();
-      if(test_str.IsSameAs(_T("FEET"), FALSE))
-          m_depth_unit_id = DEPTH_UNIT_FEET;
-      else if(test_str.IsSameAs(_T("METERS"), FALSE))
-          m_depth_unit_id = DEPTH_UNIT_METERS;
-      else if(test_str.IsSameAs(_T("METRES"), FALSE))                  // Special case for alternate spelling
-          m_depth_unit_id = DEPTH_UNIT_METERS;
-      else if(test_str.IsSameAs(_T("METRIC"), FALSE))
-          m_depth_unit_id = DEPTH_UNIT_METERS;
-      else if(test_str.IsSameAs(_T("FATHOMS"), FALSE))
-          m_depth_unit_id = DEPTH_UNIT_FATHOMS;
-      else if(test_str.Find(_T("FATHOMS")) != wxNOT_FOUND)             // Special case for "Fathoms and Feet"
-          m_depth_unit_id = DEPTH_UNIT_FATHOMS;
-      else if(test_str.Find(_T("METERS")) != wxNOT_FOUND)             // Special case for "Meters and decimeters"
-            m_depth_unit_id = DEPTH_UNIT_METERS;
-
-           
-      //   Analyze Refpoints
-      int analyze_ret_val = AnalyzeRefpoints();
-      if(0 != analyze_ret_val)
-            return INIT_FAIL_REMOVE;
-
-
-      bReadyToRender = true;
       return INIT_OK;
 }
 
-
 bool ChartBaseBSB::CreateLineIndex()
 {
     //  Assumes file stream ifs_bitmap is currently open
 
-//    wxBufferedInputStream *pbis = new wxBufferedInputStream(*ifss_bitmap);
-
     //  Seek to start of data
     ifs_bitmap->SeekI(nFileOffsetDataStart);                 // go to Beginning of data
 
-    for(int iplt=0 ; iplt<Size_Y ; iplt++)
+    //  Scan the image in large blocks through one buffer, rather than the stream
+    //  a byte at a time.  A row running off the end of the buffer is carried to
+    //  its front and scanned again once the next block is in.
+    const size_t block_size = 1024 * 1024;
+    std::vector<unsigned char> buf(block_size);
+    size_t have = 0;                                // bytes in buf
+    size_t start = 0;                               // current row in buf
+    int buf_offset = nFileOffsetDataStart;          // file offset of buf[0]
+    bool beof = false;
+
+    for(int iplt=0 ; iplt<Size_Y ; )
     {
-        int offset = ifs_bitmap->TellI();
-
-        int iscan;
-        iscan = BSBScanScanline(ifs_bitmap);
-
-        //  There is no sense reporting an error here, since we are recreating after an error
-/*
-        if(iscan > Size_Y)
+        if(have || beof)
         {
-
-            wxString msg(_("CreateLineIndex() failed on chart "));
-            msg.Append(m_FullPath);
-            wxLogMessage(msg);
-           return false;
+            const unsigned char *base = &buf[0];
+            const unsigned char *end = base + have;
+            const unsigned char *lp = base + start;
+            BSBScanScanline(lp, end);
+
+            //  There is no sense reporting an error in the line number here,
+            //  since we are recreating after an error
+            if((lp < end) || beof)
+            {
+                pline_table[iplt++] = buf_offset + start;
+                start = lp - base;
+                continue;
+            }
         }
 
-        //  Skipped lines?
-        if(iscan != iplt)
+        //  The row may go on in the next block
+        if(start)
         {
-            while((iplt < iscan) && (iplt < Size_Y))
-            {
-                pline_table[iplt] = 0;
-                iplt++;
-            }
+            have -= start;
+            memmove(&buf[0], &buf[start], have);
+            buf_offset += start;
+            start = 0;
         }
-*/
-        pline_table[iplt] = offset;
+        else if(have == buf.size())
+            buf.resize(buf.size() * 2);             // a row longer than the buffer
 
+        size_t want = buf.size() - have;
+        ifs_bitmap->Read(&buf[have], want);
+        size_t nread = ifs_bitmap->LastRead();
+        if((nread == 0) && (buf_offset == nFileOffsetDataStart) && (have == 0))
+            return false;
+        have += nread;
+        if(nread < want)
+            beof = true;
     }
 
     return true;
 }
 
+//  The file holding the bitmap data, which the line index describes
+wxString ChartBaseBSB::GetBitmapFilePath(void)
+{
+    if( (m_ChartType == CHART_TYPE_GEO) && pBitmapFilePath )
+        return *pBitmapFilePath;
+    return m_FullPath;
+}
+
+static wxString LineIndexSidecarPath(const wxString &bitmap_path)
+{
+    wxCharBuffer buf = bitmap_path.ToUTF8();
+    unsigned char hash[16];
+    FlexHash::Compute( buf.data(), strlen(buf.data()), hash, sizeof(hash) );
+
+    wxString name;
+    for(unsigned int i=0 ; i < sizeof(hash) ; i++)
+        name += wxString::Format(_T("%02X"), hash[i]);
+
+    wxChar separator = wxFileName::GetPathSeparator();
+    return g_Platform->GetPrivateDataDir() + separator + _T("raster_line_index") + separator + name;
+}
+
+bool ChartBaseBSB::LoadLineIndexSidecar(void)
+{
+    wxString bitmap_path = GetBitmapFilePath();
+    wxString path = LineIndexSidecarPath(bitmap_path);
+    if(!wxFileExists(path))
+        return false;
+
+    wxFFile f(path, _T("rb"));
+    if(!f.IsOpened())
+        return false;
+
+    LineIndexHeader hdr;
+    if(f.Read(&hdr, sizeof(hdr)) != sizeof(hdr))
+        return false;
+
+    //  Only trust the index if the chart file is exactly as it was
+    if( hdr.magic != LINE_INDEX_MAGIC || hdr.version != LINE_INDEX_VERSION ||
+        hdr.size_y != Size_Y ||
+        hdr.filesize != wxFileName::GetSize(bitmap_path).GetValue() ||
+        hdr.mtime != (int64_t)wxFileModificationTime(bitmap_path) )
+        return false;
+
+    size_t table_size = (Size_Y + 1) * sizeof(int);
+    if(f.Read(pline_table, table_size) != table_size)
+        return false;
+
+    m_nLineOffset = hdr.line_offset;
+    return true;
+}
+
+void ChartBaseBSB::SaveLineIndexSidecar(void)
+{
+    wxString bitmap_path = GetBitmapFilePath();
+    wxString path = LineIndexSidecarPath(bitmap_path);
+
+    wxFileName fn(path);
+    if(!fn.DirExists())
+        fn.Mkdir();
+
+    LineIndexHeader hdr;
+    hdr.magic = LINE_INDEX_MAGIC;
+    hdr.version = LINE_INDEX_VERSION;
+    hdr.filesize = wxFileName::GetSize(bitmap_path).GetValue();
+    hdr.mtime = wxFileModificationTime(bitmap_path);
+    hdr.size_y = Size_Y;
+    hdr.line_offset = m_nLineOffset;
+
+    //  Write aside and rename, so a reader never sees a partial table
+    wxString tmp_path = path + _T(".tmp");
+    wxFFile f(tmp_path, _T("wb"));
+    if(!f.IsOpened())
+        return;
+
+    size_t table_size = (Size_Y + 1) * sizeof(int);
+    bool ok = (f.Write(&hdr, sizeof(hdr)) == sizeof(hdr)) &&
+              (f.Write(pline_table, table_size) == table_size);
+    f.Close();
+
+    if(!ok || !wxRenameFile(tmp_path, path, true))
+        wxRemoveFile(tmp_path);
+}
+
 
 //    Invalidate and Free the line cache contents
 void ChartBaseBSB::InvalidateLineCache(void)
 {
-      if(pLineCache)
-      {
-            CachedLine *pt;
-            for(int ylc = 0 ; ylc < Size_Y ; ylc++)
-            {
-                  pt = &pLineCache[ylc];
-                  if(pt)
-                  {
-                      free (pt->pPix);
-                      pt->pPix = NULL;
-                      free (pt->pTileOffset);
-                      pt->pTileOffset = NULL;
-                      pt->bValid = false;
-                  }
-            }
-      }
+      FreeLineCacheRows();
 }
 
 bool ChartBaseBSB::GetChartExtent(Extent *pext)
@@ -3687,183 +3794,300 @@ bool ChartBaseBSB::GetView( wxRect& source, wxRect& dest, ScaleTypeEnum scale_ty
 }
 
 
-bool ChartBaseBSB::GetAndScaleData(unsigned char *ppn, size_t data_size, wxRect& source, int source_stride,
-                                   wxRect& dest, int dest_stride, double scale_factor, ScaleTypeEnum scale_type)
-{
+//-----------------------------------------------------------------------
+//    Downsampling for GetAndScaleData, done in bands of output rows
+//      so that the bands can run on the raster band pool
+//-----------------------------------------------------------------------
 
-      unsigned char *s_data = NULL;
+#define SCALE_BAND_MIN_ROWS     16
+#define SCALE_BAND_MIN_PIXELS   65536   // smaller jobs are not worth the threads
 
-      double factor = scale_factor;
-      int Factor =  (int)factor;
+//  Add up "nrows" rows of "row_bytes" bytes, column by column
+static void SumRows16(const unsigned char *src, int row_bytes, int nrows, uint16_t *sum)
+{
+    memset(sum, 0, row_bytes * sizeof(uint16_t));
+
+    for(int r = 0 ; r < nrows ; r++) {
+        const unsigned char *s = src + r * row_bytes;
+        int i = 0;
+#ifdef OCPN_BSB_SSE2
+        __m128i zero = _mm_setzero_si128();
+        for( ; i + 16 <= row_bytes ; i += 16) {
+            __m128i v = _mm_loadu_si128((const __m128i*)(s + i));
+            __m128i lo = _mm_loadu_si128((const __m128i*)(sum + i));
+            __m128i hi = _mm_loadu_si128((const __m128i*)(sum + i + 8));
+            lo = _mm_add_epi16(lo, _mm_unpacklo_epi8(v, zero));
+            hi = _mm_add_epi16(hi, _mm_unpackhi_epi8(v, zero));
+            _mm_storeu_si128((__m128i*)(sum + i), lo);
+            _mm_storeu_si128((__m128i*)(sum + i + 8), hi);
+        }
+#endif
+        for( ; i < row_bytes ; i++)
+            sum[i] += s[i];
+    }
+}
 
-      int target_width = (int)wxRound((double)source.width  / factor) ;
-      int target_height = (int)wxRound((double)source.height / factor);
+class ScaleDownJob : public RasterBandJob
+{
+public:
+    virtual void DoBand(int band);
+
+    void DoHiDef(int y_first, int y_last);
+    void DoLoDef(int y_first, int y_last);
+
+    ChartBaseBSB  *m_chart;
+    ScaleTypeEnum m_scale_type;
+    wxRect        m_source;
+    wxRect        m_dest;
+    unsigned char *m_data;
+    int           m_dest_line_length;
+    double        m_factor;
+    int           m_target_width;
+    int           m_target_height;
+    int           m_band_rows;
+};
 
-      int dest_line_length = dest_stride * BPP/8;
-      
-      //  On MSW, if using DibSections, each scan line starts on a DWORD boundary.
-      //  The DibSection has been allocated to conform with this requirement.
-#ifdef __PIX_CACHE_DIBSECTION__      
-      dest_line_length = (((dest_stride * 24) + 31) & ~31) >> 3;
-#endif      
-      
-      if((target_height == 0) || (target_width == 0))
-            return false;
+void ScaleDownJob::DoBand(int band)
+{
+    int y_first = m_dest.y + band * m_band_rows;
+    int y_last = wxMin(y_first + m_band_rows, m_dest.y + m_dest.height);
 
-      unsigned char *target_data = ppn;
-      unsigned char *data = ppn;
+    if(m_scale_type == RENDER_HIDEF)
+        DoHiDef(y_first, y_last);
+    else if(m_scale_type == RENDER_LODEF)
+        DoLoDef(y_first, y_last);
+}
 
-      if(factor > 1)                // downsampling
-      {
+//  Box filter, each target pixel is the average of a blur_factor square of source pixels
+void ScaleDownJob::DoHiDef(int y_first, int y_last)
+{
+      double factor = m_factor;
+      int Factor =  (int)factor;
+      int Size_X = m_chart->GetSize_X();
+      wxRect source = m_source;
 
-            if(scale_type == RENDER_HIDEF)
-            {
 //    Allocate a working buffer based on scale factor
-                  int blur_factor = wxMax(2, Factor);
-                  int wb_size = (source.width) * (blur_factor * 2) * BPP/8 ;
-                  s_data = (unsigned char *) malloc( wb_size ); // work buffer
-                  unsigned char *pixel;
-                  int y_offset;
+      int blur_factor = wxMax(2, Factor);
+      int wb_size = (source.width) * (blur_factor * 2) * BPP/8 ;
+      unsigned char *s_data = (unsigned char *) malloc( wb_size ); // work buffer
+      unsigned char *pixel;
+      int y_offset;
+
+      //  Column sums fit 16 bits up to 257 rows, and let the rows be added
+      //  a vector at a time.  Padded for the last target pixel's box.
+      uint16_t *col_sum = NULL;
+      if(blur_factor <= 257)
+            col_sum = (uint16_t *) calloc( (source.width + 2 * blur_factor) * BPP/8, sizeof(uint16_t) );
+
+      for (int y = y_first; y < y_last; y++)
+      {
+      //    Read "blur_factor" lines
 
-                  for (int y = dest.y; y < (dest.y + dest.height); y++)
-                  {
-                  //    Read "blur_factor" lines
+            wxRect s1;
+            s1.x = source.x;
+            s1.y = source.y  + (int)(y * factor);
+            s1.width = source.width;
+            s1.height = blur_factor;
+            m_chart->GetChartBits(s1, s_data, 1);
+
+            unsigned char *target_data = m_data + (y * m_dest_line_length);
+
+            if(col_sum)
+                  SumRows16(s_data, source.width * BPP/8, blur_factor, col_sum);
 
-                        wxRect s1;
-                        s1.x = source.x;
-                        s1.y = source.y  + (int)(y * factor);
-                        s1.width = source.width;
-                        s1.height = blur_factor;
-                        GetChartBits(s1, s_data, 1);
+            unsigned int pixel_count = blur_factor * blur_factor;
 
-                        target_data = data + (y * dest_line_length/*dest_stride * BPP/8*/);
+            for (int x = 0; x < m_target_width; x++)
+            {
+                  unsigned int avgRed = 0 ;
+                  unsigned int avgGreen = 0;
+                  unsigned int avgBlue = 0;
 
-                        for (int x = 0; x < target_width; x++)
+                  if((x * Factor) < (Size_X - source.x))
+                  {
+                        if(col_sum)
+                        {
+                              const uint16_t *sum = col_sum + BPP/8 * ((int)( x * factor ));
+                              for ( int x1 = 0 ; x1 < blur_factor ; ++x1 )
+                              {
+                                  avgRed   += sum[0] ;
+                                  avgGreen += sum[1] ;
+                                  avgBlue  += sum[2] ;
+                                  sum += BPP/8;
+                              }
+                        }
+                        else
                         {
-                              unsigned int avgRed = 0 ;
-                              unsigned int avgGreen = 0;
-                              unsigned int avgBlue = 0;
-                              unsigned int pixel_count = 0;
                               unsigned char *pix0 = s_data +  BPP/8 * ((int)( x * factor )) ;
                               y_offset = 0;
 
-                              if((x * Factor) < (Size_X - source.x))
-                              {
-            // determine average
-                                    for ( int y1 = 0 ; y1 < blur_factor ; ++y1 )
-                                    {
-                                        pixel = pix0 + (BPP/8 * y_offset ) ;
-                                        for ( int x1 = 0 ; x1 < blur_factor ; ++x1 )
-                                        {
-                                            avgRed   += pixel[0] ;
-                                            avgGreen += pixel[1] ;
-                                            avgBlue  += pixel[2] ;
-
-                                            pixel += BPP/8;
-
-                                            pixel_count++;
-                                        }
-                                        y_offset += source.width ;
-                                    }
-
-                                    if(0 == pixel_count)                // Protect
-                                        pixel_count = 1;
-                                    
-                                    target_data[0] = avgRed / pixel_count;     // >> scounter;
-                                    target_data[1] = avgGreen / pixel_count;   // >> scounter;
-                                    target_data[2] = avgBlue / pixel_count;    // >> scounter;
-                                    target_data += BPP/8;
-                              }
-                              else
+// determine average
+                              for ( int y1 = 0 ; y1 < blur_factor ; ++y1 )
                               {
-                                    target_data[0] = 0;
-                                    target_data[1] = 0;
-                                    target_data[2] = 0;
-                                    target_data += BPP/8;
+                                  pixel = pix0 + (BPP/8 * y_offset ) ;
+                                  for ( int x1 = 0 ; x1 < blur_factor ; ++x1 )
+                                  {
+                                      avgRed   += pixel[0] ;
+                                      avgGreen += pixel[1] ;
+                                      avgBlue  += pixel[2] ;
+
+                                      pixel += BPP/8;
+                                  }
+                                  y_offset += source.width ;
                               }
+                        }
 
-                        }  // for x
+                        target_data[0] = avgRed / pixel_count;
+                        target_data[1] = avgGreen / pixel_count;
+                        target_data[2] = avgBlue / pixel_count;
+                        target_data += BPP/8;
+                  }
+                  else
+                  {
+                        target_data[0] = 0;
+                        target_data[1] = 0;
+                        target_data[2] = 0;
+                        target_data += BPP/8;
+                  }
 
-                  }  // for y
+            }  // for x
 
-            }           // SCALE_BILINEAR
+      }  // for y
 
-            else if (scale_type == RENDER_LODEF)
-            {
-                        int get_bits_submap = 1;
+      free(col_sum);
+      free(s_data);
+}
 
-                        int scaler = 16;
+//  Subsampling, each target pixel is the nearest source pixel
+void ScaleDownJob::DoLoDef(int y_first, int y_last)
+{
+      int Size_X = m_chart->GetSize_X();
+      wxRect source = m_source;
+      wxRect dest = m_dest;
+      int get_bits_submap = 1;
 
-                        if(source.width > 32767)                  // High underscale can exceed signed math bits
-                              scaler = 8;
+      int scaler = 16;
 
-                        int wb_size = (Size_X) * ((/*Factor +*/ 1) * 2) * BPP/8 ;
-                        s_data = (unsigned char *) malloc( wb_size ); // work buffer
+      if(source.width > 32767)                  // High underscale can exceed signed math bits
+            scaler = 8;
 
-                        long x_delta = (source.width<<scaler) / target_width;
-                        long y_delta = (source.height<<scaler) / target_height;
+      int wb_size = (Size_X) * ((/*Factor +*/ 1) * 2) * BPP/8 ;
+      unsigned char *s_data = (unsigned char *) malloc( wb_size ); // work buffer
 
-                        int y = dest.y;                // starting here
-                        long ys = dest.y * y_delta;
+      long x_delta = (source.width<<scaler) / m_target_width;
+      long y_delta = (source.height<<scaler) / m_target_height;
 
-                        while ( y < dest.y + dest.height)
-                        {
-                        //    Read 1 line at the right place from the source
+      int y = y_first;                // starting here
+      long ys = y_first * y_delta;
 
-                              wxRect s1;
-                              s1.x = 0;
-                              s1.y = source.y + (ys >> scaler);
-                              s1.width = Size_X;
-                              s1.height = 1;
-                              GetChartBits(s1, s_data, get_bits_submap);
+      while ( y < y_last)
+      {
+      //    Read 1 line at the right place from the source
 
-                              target_data = data + (y * dest_line_length/*dest_stride * BPP/8*/) + (dest.x * BPP / 8);
+            wxRect s1;
+            s1.x = 0;
+            s1.y = source.y + (ys >> scaler);
+            s1.width = Size_X;
+            s1.height = 1;
+            m_chart->GetChartBits(s1, s_data, get_bits_submap);
 
-                              long x = (source.x << scaler) + (dest.x * x_delta);
-                              long sizex16 = Size_X << scaler;
-                              int xt = dest.x;
+            unsigned char *target_data = m_data + (y * m_dest_line_length) + (dest.x * BPP / 8);
 
-                              while((xt < dest.x + dest.width) && (x < 0))
-                              {
-                                    target_data[0] = 0;
-                                    target_data[1] = 0;
-                                    target_data[2] = 0;
+            long x = (source.x << scaler) + (dest.x * x_delta);
+            long sizex16 = Size_X << scaler;
+            int xt = dest.x;
 
-                                    target_data += BPP/8;
-                                    x += x_delta;
-                                    xt++;
-                              }
+            while((xt < dest.x + dest.width) && (x < 0))
+            {
+                  target_data[0] = 0;
+                  target_data[1] = 0;
+                  target_data[2] = 0;
 
-                              while ((xt < dest.x + dest.width) && ( x < sizex16))
-                              {
+                  target_data += BPP/8;
+                  x += x_delta;
+                  xt++;
+            }
 
-                                    unsigned char* src_pixel = &s_data[(x>>scaler)*BPP/8];
+            while ((xt < dest.x + dest.width) && ( x < sizex16))
+            {
 
-                                    target_data[0] = src_pixel[0];
-                                    target_data[1] = src_pixel[1];
-                                    target_data[2] = src_pixel[2];
+                  unsigned char* src_pixel = &s_data[(x>>scaler)*BPP/8];
 
-                                    target_data += BPP/8;
-                                    x += x_delta;
-                                    xt++;
-                              }
+                  target_data[0] = src_pixel[0];
+                  target_data[1] = src_pixel[1];
+                  target_data[2] = src_pixel[2];
 
-                              while(xt < dest.x + dest.width)
-                              {
-                                    target_data[0] = 0;
-                                    target_data[1] = 0;
-                                    target_data[2] = 0;
+                  target_data += BPP/8;
+                  x += x_delta;
+                  xt++;
+            }
 
-                                    target_data += BPP/8;
-                                    xt++;
-                              }
+            while(xt < dest.x + dest.width)
+            {
+                  target_data[0] = 0;
+                  target_data[1] = 0;
+                  target_data[2] = 0;
 
-                              y++;
-                              ys += y_delta;
-                        }
+                  target_data += BPP/8;
+                  xt++;
+            }
+
+            y++;
+            ys += y_delta;
+      }
+
+      free(s_data);
+}
+
+bool ChartBaseBSB::GetAndScaleData(unsigned char *ppn, size_t data_size, wxRect& source, int source_stride,
+                                   wxRect& dest, int dest_stride, double scale_factor, ScaleTypeEnum scale_type)
+{
+
+      unsigned char *s_data = NULL;
+
+      double factor = scale_factor;
+
+      int target_width = (int)wxRound((double)source.width  / factor) ;
+      int target_height = (int)wxRound((double)source.height / factor);
+
+      int dest_line_length = dest_stride * BPP/8;
+      
+      //  On MSW, if using DibSections, each scan line starts on a DWORD boundary.
+      //  The DibSection has been allocated to conform with this requirement.
+#ifdef __PIX_CACHE_DIBSECTION__      
+      dest_line_length = (((dest_stride * 24) + 31) & ~31) >> 3;
+#endif      
+      
+      if((target_height == 0) || (target_width == 0))
+            return false;
 
-            }     // SCALE_SUBSAMP
+      unsigned char *target_data = ppn;
+      unsigned char *data = ppn;
 
+      if(factor > 1)                // downsampling
+      {
+            ScaleDownJob job;
+            job.m_chart = this;
+            job.m_scale_type = scale_type;
+            job.m_source = source;
+            job.m_dest = dest;
+            job.m_data = data;
+            job.m_dest_line_length = dest_line_length;
+            job.m_factor = factor;
+            job.m_target_width = target_width;
+            job.m_target_height = target_height;
+
+            //  Rows are independent, so hand out bands of them to the pool
+            int nbands = 1;
+            if(g_pRasterBandPool && ((long)dest.height * target_width >= SCALE_BAND_MIN_PIXELS))
+                  nbands = wxMax(1, wxMin(dest.height / SCALE_BAND_MIN_ROWS,
+                                          (g_pRasterBandPool->GetThreadCount() + 1) * 4));
+            job.m_band_rows = (dest.height + nbands - 1) / nbands;
+
+            if(g_pRasterBandPool)
+                  g_pRasterBandPool->Run(&job, nbands);
+            else
+                  job.DoBand(0);
       }
       else  //factor < 1, overzoom
       {
@@ -3983,10 +4207,9 @@ bool ChartBaseBSB::GetAndScaleData(unsigned char *ppn, size_t data_size, wxRect&
 
 
 
+//  Safe to call from several threads at once, BSBGetScanline() serializes the file access
 bool ChartBaseBSB::GetChartBits(wxRect& source, unsigned char *pPix, int sub_samp)
 {
-    wxCriticalSectionLocker locker(m_critSect);
-    
       int iy;
 #define FILL_BYTE 0
 
@@ -4150,60 +4373,42 @@ int ChartBaseBSB::ReadBSBHdrLine(wxInputStream* ifs, char* buf, int buf_len_max)
 
 //-----------------------------------------------------------------------
 //    Scan a BSB Scan Line from raw data
-//      Leaving stream pointer at start of next line
+//      Leaving lp at start of next line
 //-----------------------------------------------------------------------
-int   ChartBaseBSB::BSBScanScanline(wxInputStream *pinStream )
+int   ChartBaseBSB::BSBScanScanline(const unsigned char *&lp, const unsigned char *end)
 {
-      int nLineMarker, nValueShift, iPixel = 0;
-      unsigned char byValueMask, byCountMask;
+      int nLineMarker, iPixel = 0;
+      unsigned char byCountMask;
       unsigned char byNext;
-      int coffset;
 
-//      if(1)
-      {
 //      Read the line number.
-            nLineMarker = 0;
-            do
-            {
-                  byNext = pinStream->GetC();
-                  nLineMarker = nLineMarker * 128 + (byNext & 0x7f);
-            } while( (byNext & 0x80) != 0 );
+      nLineMarker = 0;
+      do
+      {
+            byNext = (lp < end) ? *lp++ : 0;
+            nLineMarker = nLineMarker * 128 + (byNext & 0x7f);
+      } while( (byNext & 0x80) != 0 );
 
 //      Setup masking values.
-            nValueShift = 7 - nColorSize;
-            byValueMask = (((1 << nColorSize)) - 1) << nValueShift;
-            byCountMask = (1 << (7 - nColorSize)) - 1;
-
-//      Read and simulate expansion of runs.
-
-            while( ((byNext = pinStream->GetC()) != 0 ) && (iPixel < Size_X))
-            {
-
-                  int   nPixValue;
-                  int nRunCount;
-                  nPixValue = (byNext & byValueMask) >> nValueShift;
-
-                  nRunCount = byNext & byCountMask;
-
-                  while( (byNext & 0x80) != 0 )
-                  {
-                        byNext = pinStream->GetC();
-                        nRunCount = nRunCount * 128 + (byNext & 0x7f);
-                  }
+      byCountMask = (1 << (7 - nColorSize)) - 1;
 
-                  if( iPixel + nRunCount + 1 > Size_X )
-                        nRunCount = Size_X - iPixel - 1;
+//      Skip the runs, we only need to know where the line ends.
 
+      while( (lp < end) && ((byNext = *lp++) != 0 ) && (iPixel < Size_X))
+      {
+            int nRunCount = byNext & byCountMask;
 
-//          Store nPixValue in the destination
-//                  memset(pCL, nPixValue, nRunCount+1);
-//                  pCL += nRunCount+1;
-                  iPixel += nRunCount+1;
+            while( ((byNext & 0x80) != 0) && (lp < end) )
+            {
+                  byNext = *lp++;
+                  nRunCount = nRunCount * 128 + (byNext & 0x7f);
             }
-            coffset = pinStream->TellI();
 
-      }
+            if( iPixel + nRunCount + 1 > Size_X )
+                  nRunCount = Size_X - iPixel - 1;
 
+            iPixel += nRunCount+1;
+      }
 
       return nLineMarker;
 }
@@ -4228,11 +4433,7 @@ inline void memset_short(unsigned char *dst, unsigned char cbyte, int count)
     memset(dst, cbyte, count);
 #endif    
 }
-// could use a larger value for slightly less ram but slower random access,
-// this is chosen as it is also the opengl tile size so should work well
-#define TILE_SIZE 512
 
-//#define USE_OLD_CACHE  // removed this (and simplify code below) once the new method is verified
 //#define PRINT_TIMINGS  // enable for profiling
 
 #ifdef PRINT_TIMINGS
@@ -4253,266 +4454,250 @@ private:
 };
 #endif
 
-#define FAIL \
-    do { \
-      free(pt->pTileOffset); \
-      pt->pTileOffset = NULL; \
-      free(pt->pPix); \
-      pt->pPix = NULL; \
-      pt->bValid = false; \
-      return 0; \
-    } while(0)
-
 //-----------------------------------------------------------------------
-//    Get a BSB Scan Line Using Cache and scan line index if available
+//    Read the raw, run length encoded data of one line into ifs_buf
+//      Returns the data size, or 0 on failure
 //-----------------------------------------------------------------------
-int   ChartBaseBSB::BSBGetScanline( unsigned char *pLineBuf, int y, int xs, int xl, int sub_samp)
-
+int ChartBaseBSB::ReadRawLine(int y)
 {
-      unsigned char *prgb = pLineBuf;
-      int nValueShift, iPixel = 0;
-      unsigned char byValueMask, byCountMask;
-      unsigned char byNext;
-      CachedLine *pt = NULL, cached_line;
-      unsigned char *pCL;
-      int rgbval;
-      unsigned char *lp;
-      register int ix = xs;
+      if(pline_table[y] == 0 || pline_table[y+1] == 0)
+          return 0;
+
+      int thisline_size = pline_table[y+1] - pline_table[y] ;
+      if(thisline_size <= 0)
+          return 0;
 
-      if(bUseLineCache && pLineCache)
+      if(thisline_size > ifs_bufsize)
       {
-//    Is the requested line in the cache, and valid?
-          pt = &pLineCache[y];
-      } else {
-          pt = &cached_line;
-          pt->bValid = false;
+          unsigned char * tmp = ifs_buf;
+          if(!(ifs_buf = (unsigned char *)realloc(ifs_buf, thisline_size))) {
+              ifs_buf = tmp;
+              return 0;
+          }
+          ifs_bufsize = thisline_size;
       }
 
-#ifdef PRINT_TIMINGS
-      OCPNStopWatch sw;
-      static double ttime;
-      static int cnt;
-      cnt++;
-#endif
+      // as of 2015, in wxWidgets buffered streams don't test for a zero seek
+      // so we check here to possibly avoid this seek with a measured performance gain
+      if(ifs_bitmap->TellI() != pline_table[y] &&
+         wxInvalidOffset == ifs_bitmap->SeekI(pline_table[y], wxFromStart))
+          return 0;
 
-      if(!pt->bValid) // not valid, allocate
-      {
-          int thisline_size = pline_table[y+1] - pline_table[y] ;
+      ifs_bitmap->Read(ifs_buf, thisline_size);
+      return ifs_bitmap->LastRead();
+}
 
-#ifdef USE_OLD_CACHE
-          pt->pPix = (unsigned char *)malloc(Size_X);
-#else
-          pt->pTileOffset = (TileOffsetCache *)calloc(sizeof(TileOffsetCache)*(Size_X/TILE_SIZE + 1), 1);
-          pt->pPix = (unsigned char *)malloc(thisline_size);
-#endif
-          if(pline_table[y] == 0 || pline_table[y+1] == 0)
-              FAIL;
+//-----------------------------------------------------------------------
+//    Expand the first "width" pixels of a raw line to palette indices
+//-----------------------------------------------------------------------
+void ChartBaseBSB::DecodeLineIndices(const unsigned char *lp, const unsigned char *end,
+                                     unsigned char *pCL, int width)
+{
+      unsigned char byNext;
 
-          // as of 2015, in wxWidgets buffered streams don't test for a zero seek
-          // so we check here to possibly avoid this seek with a measured performance gain
-          if(ifs_bitmap->TellI() != pline_table[y] &&
-             wxInvalidOffset == ifs_bitmap->SeekI(pline_table[y], wxFromStart))
-              FAIL;
+      //      skip the line number.
+      do byNext = (lp < end) ? *lp++ : 0; while( (byNext & 0x80) != 0 );
 
-#ifdef USE_OLD_CACHE
-          if(thisline_size > ifs_bufsize)
-          {
-              unsigned char * tmp = ifs_buf;
-              if(!(ifs_buf = (unsigned char *)realloc(ifs_buf, thisline_size))) {
-                  free(tmp);
-                  FAIL;
-              }
-              ifs_bufsize = thisline_size;
-          }
+      //      Setup masking values.
+      int nValueShift = 7 - nColorSize;
+      unsigned char byValueMask = (((1 << nColorSize)) - 1) << nValueShift;
+      unsigned char byCountMask = (1 << (7 - nColorSize)) - 1;
 
-          lp = ifs_buf;
-#else
-          lp = pt->pPix;
-#endif
-          ifs_bitmap->Read(lp, thisline_size);
+      //      Read and expand runs.
+      int iPixel = 0;
+      while(iPixel < width)
+      {
+          if(lp >= end)
+              break;
+          byNext = *lp++;
+          if(byNext == 0)
+              break;                    // finished early...corrupt?
 
-#ifdef USE_OLD_CACHE
-          pCL = pt->pPix;
-#else
-          if(!bUseLineCache) {
-              ix = 0;
-              //      skip the line number.
-              do byNext = *lp++; while( (byNext & 0x80) != 0 );
-              goto nocachestart;
-          }
-          pCL = ifs_buf;
+          int nPixValue = (byNext & byValueMask) >> nValueShift;
+          int nRunCount = byNext & byCountMask;
 
-          if(Size_X > ifs_bufsize)
+          while( ((byNext & 0x80) != 0) && (lp < end) )
           {
-              unsigned char * tmp = ifs_buf;
-              if(!(ifs_buf = (unsigned char *)realloc(ifs_buf, Size_X))) {
-                  free(tmp);
-                  FAIL;
-              }
-              ifs_bufsize = Size_X;
+              byNext = *lp++;
+              nRunCount = nRunCount * 128 + (byNext & 0x7f);
           }
-#endif
-          //    At this point, the unexpanded, raw line is at *lp, and the expansion destination is pCL
-          
-          //      skip the line number.
-          do byNext = *lp++; while( (byNext & 0x80) != 0 );
-
-          //      Setup masking values.
-          nValueShift = 7 - nColorSize;
-          byValueMask = (((1 << nColorSize)) - 1) << nValueShift;
-          byCountMask = (1 << (7 - nColorSize)) - 1;
 
-          //      Read and expand runs.
-          unsigned int iPixel = 0;
+          nRunCount++;
 
-#ifndef USE_OLD_CACHE
-          pt->pTileOffset[0].offset = lp - pt->pPix;
-          pt->pTileOffset[0].pixel = 0;
-          unsigned int tileindex = 1, nextTile = TILE_SIZE;
-#endif
-          unsigned int nRunCount;
-          unsigned char *end = pt->pPix+thisline_size;
-          while(iPixel < (unsigned int)Size_X)
-#ifdef USE_OLD_CACHE
-          {
-              nPixValue = (byNext & byValueMask) >> nValueShift;
+          if( iPixel + nRunCount > width ) // protection against corrupt data
+              nRunCount = width - iPixel;
 
-              nRunCount = byNext & byCountMask;
-
-              while( (byNext & 0x80) != 0 )
-              {
-                  byNext = *lp++;
-                  nRunCount = nRunCount * 128 + (byNext & 0x7f);
-              }
-
-              nRunCount++;
+          memset_short(pCL + iPixel, nPixValue, nRunCount);
+          iPixel += nRunCount;
+      }
 
-              if( iPixel + nRunCount > (unsigned int)Size_X ) // protection against corrupt data
-                  nRunCount = nRunCount - iPixel;
+      if(iPixel < width)
+          memset(pCL + iPixel, 0, width - iPixel);
+}
 
-              //          Store nPixValue in the destination
-              memset_short(pCL + iPixel, nPixValue, nRunCount);
-              iPixel += nRunCount;
-          }
-#else
-          // build tile offset table for faster random access
-          {
-              byNext = *lp++;
-              unsigned char *offset = lp - 1;
-              if(byNext == 0 || lp == end) {
-                  // finished early...corrupt?
-                  while(tileindex < (unsigned int)Size_X/TILE_SIZE + 1) {
-                      pt->pTileOffset[tileindex].offset = pt->pTileOffset[0].offset;
-                      pt->pTileOffset[tileindex].pixel = 0;
-                      tileindex++;
-                  }
+//-----------------------------------------------------------------------
+//    Decode one row of tiles, from tile column tx_first up to tx_last,
+//      into the raster tile cache.
+//      Returns tile tx_first, acquired
+//-----------------------------------------------------------------------
+RasterTile *ChartBaseBSB::LoadRasterTiles(int ty, int tx_first, int tx_last)
+{
+      int ntiles = tx_last - tx_first + 1;
+      std::vector<unsigned char *> tiles(ntiles, (unsigned char *)NULL);
+
+      //  Only decode what nobody else has since
+      bool b_any = false;
+      for(int i = 0 ; i < ntiles ; i++) {
+          if(i == 0 || !g_pRasterTileCache->Contains(m_tile_owner, tx_first + i, ty)) {
+              tiles[i] = (unsigned char *)malloc(RasterTileCache::TileBytes());
+              if(!tiles[i])
                   break;
-              }
+              b_any = true;
+          }
+      }
 
-              nRunCount = byNext & byCountMask;
+      if(b_any) {
+          int width = wxMin((tx_last + 1) * RASTER_TILE_SIZE, Size_X);
+          unsigned char *pLine = (unsigned char *)malloc(width);
 
-              while( (byNext & 0x80) != 0 )
-              {
-                  byNext = *lp++;
-                  nRunCount = nRunCount * 128 + (byNext & 0x7f);
+          int y0 = ty * RASTER_TILE_SIZE;
+          int y1 = wxMin(y0 + RASTER_TILE_SIZE, Size_Y);
+          for(int y = y0 ; y < y1 ; y++) {
+              int size = ReadRawLine(y);
+              if(size)
+                  DecodeLineIndices(ifs_buf, ifs_buf + size, pLine, width);
+              else
+                  memset(pLine, 0, width);
+
+              for(int i = 0 ; i < ntiles ; i++) {
+                  if(!tiles[i])
+                      continue;
+                  int x0 = (tx_first + i) * RASTER_TILE_SIZE;
+                  int n = wxMin(RASTER_TILE_SIZE, width - x0);
+                  memcpy(tiles[i] + (y - y0) * RASTER_TILE_SIZE, pLine + x0, n);
               }
+          }
+          free(pLine);
+      }
 
-              nRunCount++;
+      RasterTile *first = NULL;
+      for(int i = 0 ; i < ntiles ; i++) {
+          if(!tiles[i])
+              continue;
+          RasterTile *tile = g_pRasterTileCache->Add(m_tile_owner, tx_first + i, ty, tiles[i]);
+          if(i == 0)
+              first = tile;
+          else
+              g_pRasterTileCache->Release(tile);
+      }
 
-              if( iPixel + nRunCount > (unsigned int)Size_X ) // protection against corrupt data
-                  nRunCount = Size_X - iPixel;
+      return first;
+}
 
-              while( iPixel + nRunCount > nextTile) {
-                  pt->pTileOffset[tileindex].offset = offset - pt->pPix;
-                  pt->pTileOffset[tileindex].pixel = iPixel;
-                  tileindex++;
-                  nextTile += TILE_SIZE;
-              }
-              iPixel += nRunCount;
-          }
-#endif
+//-----------------------------------------------------------------------
+//    Get a BSB Scan Line Using the tile cache and scan line index if available
+//-----------------------------------------------------------------------
+int   ChartBaseBSB::BSBGetScanline( unsigned char *pLineBuf, int y, int xs, int xl, int sub_samp)
 
-          pt->bValid = true;
-      }
+{
+      unsigned char *prgb = pLineBuf;
+      int rgbval;
 
-//          Line is valid, de-reference thru proper pallete directly to target
+#ifdef PRINT_TIMINGS
+      OCPNStopWatch sw;
+      static double ttime;
+      static int cnt;
+      cnt++;
+#endif
 
       if(xl > Size_X)
             xl = Size_X;
 
-#ifdef USE_OLD_CACHE
-      pCL = pt->pPix + xs;
+      if(xs >= xl)
+            return 1;
 
-      //    Optimization for most usual case
-      if((BPP == 24) && (1 == sub_samp))
-      {
-            ix = xs;
-            while(ix < xl-1)
-            {
-                  unsigned char cur_by = *pCL;
-                  rgbval = (int)(pPalette[cur_by]);
-                  while((ix < xl-1))
-                  {
-                        if(cur_by != *pCL)
-                              break;
-                        *((int *)prgb) = rgbval;
-                        prgb += 3;
-                        pCL ++;
-                        ix  ++;
-                  }
-            }
-      }
-      else
+      if(bUseLineCache && g_pRasterTileCache)
       {
-            int dest_inc_val_bytes = (BPP/8) * sub_samp;
-            ix = xs;
-            while(ix < xl-1)
-            {
+          //    Dereference the cached palette indices thru proper pallete directly to target,
+          //    a tile at a time
+          int ty = y / RASTER_TILE_SIZE;
+          int row = y % RASTER_TILE_SIZE;
+          int tx_last = (xl - 1) / RASTER_TILE_SIZE;
+
+          for(int tx = xs / RASTER_TILE_SIZE ; tx <= tx_last ; tx++)
+          {
+              RasterTile *tile = g_pRasterTileCache->Acquire(m_tile_owner, tx, ty);
+              if(!tile) {
+                  wxCriticalSectionLocker locker(m_critSect);
+
+                  //  Another thread may have decoded it while we waited
+                  tile = g_pRasterTileCache->Acquire(m_tile_owner, tx, ty);
+                  if(!tile)
+                      tile = LoadRasterTiles(ty, tx, tx_last);
+              }
+              if(!tile)
+                  return 0;
+
+              int x0 = wxMax(xs, tx * RASTER_TILE_SIZE);
+              int x1 = wxMin(xl, (tx + 1) * RASTER_TILE_SIZE);
+              unsigned char *pCL = tile->data + row * RASTER_TILE_SIZE + (x0 - tx * RASTER_TILE_SIZE);
+
+              // the last pixel of the line is stored byte by byte below,
+              // so that we never write beyond the end of the buffer
+              if(x1 == xl)
+                  x1--;
+
+              int ix = x0;
+              while(ix < x1)
+              {
                   unsigned char cur_by = *pCL;
                   rgbval = (int)(pPalette[cur_by]);
-                  while((ix < xl-1))
+                  while((ix < x1) && (cur_by == *pCL))
                   {
-                        if(cur_by != *pCL)
-                              break;
-                        *((int *)prgb) = rgbval;
-                        prgb+=dest_inc_val_bytes ;
-                        pCL += sub_samp;
-                        ix  += sub_samp;
+                      *(uint32_t*)prgb = rgbval;
+                      prgb += 3;
+                      pCL ++;
+                      ix  ++;
                   }
-            }
-      }
+              }
 
-// Get the last pixel explicitely
-//  irrespective of the sub_sampling factor
+              if(x1 == xl - 1)
+              {
+                  rgbval = (int)(pPalette[*pCL]);        // last pixel
+                  unsigned char a = rgbval & 0xff;
+                  *prgb++ = a;
+                  a = (rgbval >> 8) & 0xff;
+                  *prgb++ = a;
+                  a = (rgbval >> 16) & 0xff;
+                  *prgb = a;
+              }
 
-      if(xs < xl-1)
-      {
-        unsigned char *pCLast = pt->pPix + (xl - 1);
-        unsigned char *prgb_last = pLineBuf + ((xl - 1)-xs) * BPP/8;
+              g_pRasterTileCache->Release(tile);
+          }
 
-        rgbval = (int)(pPalette[*pCLast]);        // last pixel
-        unsigned char a = rgbval & 0xff;
-        *prgb_last++ = a;
-        a = (rgbval >> 8) & 0xff;
-        *prgb_last++ = a;
-        a = (rgbval >> 16) & 0xff;
-        *prgb_last = a;
+#ifdef PRINT_TIMINGS
+          ttime += sw.Time();
+#endif
+          return 1;
       }
-#else
-      {
-          int tileindex = xs / TILE_SIZE;
-          int tileoffset = pt->pTileOffset[tileindex].offset;
 
-          lp = pt->pPix + tileoffset;
-          ix = pt->pTileOffset[tileindex].pixel;
-      }
+      //    No cache, so expand the raw line straight to the target
+      wxCriticalSectionLocker locker(m_critSect);
 
-nocachestart:
-      unsigned int i = 0;
+      int thisline_size = ReadRawLine(y);
+      if(!thisline_size)
+          return 0;
 
-      nValueShift = 7 - nColorSize;
-      byValueMask = (((1 << nColorSize)) - 1) << nValueShift;
-      byCountMask = (1 << (7 - nColorSize)) - 1;
+      unsigned char *lp = ifs_buf;
+      unsigned char byNext;
+      int ix = 0;
+
+      //      skip the line number.
+      do byNext = *lp++; while( (byNext & 0x80) != 0 );
+
+      int nValueShift = 7 - nColorSize;
+      unsigned char byValueMask = (((1 << nColorSize)) - 1) << nValueShift;
+      unsigned char byCountMask = (1 << (7 - nColorSize)) - 1;
       int nPixValue = 0; // satisfy stupid compiler warning
       bool bLastPixValueValid = false;
 
@@ -4638,7 +4823,6 @@ nocachestart:
         a = (rgbval >> 16) & 0xff;
         *prgb = a;
     }
-#endif
 
 #ifdef PRINT_TIMINGS
     ttime += sw.Time();
@@ -4652,13 +4836,6 @@ nocachestart:
     }
 #endif
 
-    if(!bUseLineCache) {
-#ifndef USE_OLD_CACHE
-        free(pt->pTileOffset);
-#endif
-        free(pt->pPix);
-    }
-
     return 1;
 }
 
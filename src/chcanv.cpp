@@ -5784,16 +5784,14 @@ bool ChartCanvas::MouseEventProcessObjects( wxMouseEvent& event )
                                                     
                                                     m_pRoutePointEditTarget->m_lat = m_cursor_lat;     // update the RoutePoint entry
                                                     m_pRoutePointEditTarget->m_lon = m_cursor_lon;
-                                                    m_pFoundPoint->m_slat = m_cursor_lat;             // update the SelectList entry
-                                                    m_pFoundPoint->m_slon = m_cursor_lon;
+                                                    pSelect->ModifySelectableItem( m_pFoundPoint, m_cursor_lat, m_cursor_lon );             // update the SelectList entry
                                                     
                                                     if( CheckEdgePan( x, y, true, 5, 2 ) ) {
                                                         double new_cursor_lat, new_cursor_lon;
                                                         GetCanvasPixPoint( x, y, new_cursor_lat, new_cursor_lon );
                                                         m_pRoutePointEditTarget->m_lat = new_cursor_lat;  // update the RoutePoint entry
                                                         m_pRoutePointEditTarget->m_lon = new_cursor_lon;
-                                                        m_pFoundPoint->m_slat = new_cursor_lat;           // update the SelectList entry
-                                                        m_pFoundPoint->m_slon = new_cursor_lon;
+                                                        pSelect->ModifySelectableItem( m_pFoundPoint, new_cursor_lat, new_cursor_lon );           // update the SelectList entry
                                                     }
                                                     
                                                     //    Update the MarkProperties Dialog, if currently shown
@@ -5875,8 +5873,7 @@ bool ChartCanvas::MouseEventProcessObjects( wxMouseEvent& event )
                         
                         m_pRoutePointEditTarget->m_lat = m_cursor_lat;    // update the RoutePoint entry
                         m_pRoutePointEditTarget->m_lon = m_cursor_lon;
-                        m_pFoundPoint->m_slat = m_cursor_lat;             // update the SelectList entry
-                        m_pFoundPoint->m_slon = m_cursor_lon;
+                        pSelect->ModifySelectableItem( m_pFoundPoint, m_cursor_lat, m_cursor_lon );             // update the SelectList entry
                         
                         
                             
@@ -0,0 +1,136 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Batch AIS CPA/TCPA computation
+ * Author:   The OpenCPN developers
+ *
+ ***************************************************************************
+ *   Copyright (C) 2026 by the OpenCPN developers                          *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ */
+
+#include <math.h>
+#include <stdint.h>
+
+#include "cpa.h"
+
+#ifdef __MSVC__
+
+#include <Windows.h>
+#include <intrin.h>
+
+static void cpuid(int32_t out[4], int32_t x) {
+    __cpuidex(out,x,0);
+}
+
+static uint64_t xgetbv(uint32_t index) {
+    return _xgetbv(index);
+}
+
+#else
+# if defined(__x86_64__) || defined(__i686__)
+
+static void cpuid(int32_t out[4], int32_t x){
+    __asm__ __volatile__ (
+        "cpuid":
+        "=a" (out[0]),
+        "=b" (out[1]),
+        "=c" (out[2]),
+        "=d" (out[3])
+        : "a" (x), "c" (0)
+    );
+}
+
+static uint64_t xgetbv(uint32_t index){
+    uint32_t eax, edx;
+    __asm__ __volatile__ (
+        "xgetbv":
+        "=a" (eax),
+        "=d" (edx)
+        : "c" (index)
+    );
+    return ((uint64_t)edx << 32) | eax;
+}
+
+#if !defined( __WXOSX__ ) 
+#include <cpuid.h>
+#endif
+
+# endif
+#endif
+
+
+void CPA_Batch_generic( int n, const CPA_Ownship *own,
+                        const double *lat, const double *lon, const double *ve, const double *vn,
+                        double *tcpa, double *cpa )
+{
+    int i;
+    for( i = 0; i < n; i++ ) {
+        //    Easting/northing to target, in meters
+        double east = ( lon[i] - own->lon ) * 60 * 1852 * own->coslat;
+        double north = ( lat[i] - own->lat ) * 60 * 1852;
+
+        //    Velocity of ownship relative to target
+        double fc = own->ve - ve[i];
+        double fs = own->vn - vn[i];
+        double d = ( fc * fc ) + ( fs * fs );
+
+        // the tracks are almost parallel
+        double t = 0.;
+        if( fabs( d ) >= 1e-6 )
+            t = ( ( fc * east ) + ( fs * north ) ) / d;     // hours
+
+        //    Target position relative to ownship at CPA
+        double x = east - fc * t;
+        double y = north - fs * t;
+
+        tcpa[i] = t * 60.;
+        cpa[i] = sqrt( ( x * x ) + ( y * y ) ) / 1852.;
+    }
+}
+
+void (*CPA_Batch)( int n, const CPA_Ownship *own,
+                   const double *lat, const double *lon, const double *ve, const double *vn,
+                   double *tcpa, double *cpa ) = CPA_Batch_generic;
+
+void CPA_ResolveRoutines()
+{
+#if defined(__x86_64__) || defined(__i686__) || (defined(__MSVC__) &&  (_MSC_VER >= 1700)) 
+    int info[4];
+    cpuid(info, 0);
+
+    int nIds = info[0];
+
+    //  Detect Features
+    if (nIds >= 0x00000001) {
+        cpuid(info,0x00000001);
+
+        if(info[3] & bit_SSE2)
+            CPA_Batch = CPA_Batch_sse2;
+
+        //  AVX also needs the OS to save the ymm registers,
+        //  i.e. the SSE and AVX state bits set in XCR0
+        if((info[2] & bit_AVX) && (info[2] & bit_OSXSAVE) && ((xgetbv(0) & 0x6) == 0x6))
+            CPA_Batch = CPA_Batch_avx;
+    }
+#endif
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+    CPA_Batch = CPA_Batch_neon;
+#endif
+}
@@ -0,0 +1,81 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Batch AIS CPA/TCPA computation
+ * Author:   The OpenCPN developers
+ *
+ ***************************************************************************
+ *   Copyright (C) 2026 by the OpenCPN developers                          *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ */
+
+#ifndef __CPA_H__
+#define __CPA_H__
+
+#if defined(__MSVC__) || defined(__WXOSX__)
+#ifndef bit_SSE2
+#define bit_SSE2        (1 << 26)
+#endif
+#ifndef bit_OSXSAVE
+#define bit_OSXSAVE     (1 << 27)
+#endif
+#ifndef bit_AVX
+#define bit_AVX         (1 << 28)
+#endif
+#endif
+
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+//  Ownship motion, shared by every target of a batch.
+//  Velocities are in meters per hour, east and north components.
+typedef struct {
+    double lat, lon;
+    double coslat;              // scale of the reduced plotting sheet at ownship
+    double ve, vn;
+} CPA_Ownship;
+
+//  For each of n targets, given its position in degrees and its velocity
+//  in meters per hour, compute the time to CPA in minutes and the CPA
+//  distance in nautical miles.  Both come from the relative motion
+//  solution on a plotting sheet centered on ownship.  Arrays need not be aligned.
+extern void (*CPA_Batch)( int n, const CPA_Ownship *own,
+                          const double *lat, const double *lon, const double *ve, const double *vn,
+                          double *tcpa, double *cpa );
+
+void CPA_ResolveRoutines();
+
+void CPA_Batch_generic( int n, const CPA_Ownship *own,
+                        const double *lat, const double *lon, const double *ve, const double *vn,
+                        double *tcpa, double *cpa );
+void CPA_Batch_sse2( int n, const CPA_Ownship *own,
+                     const double *lat, const double *lon, const double *ve, const double *vn,
+                     double *tcpa, double *cpa );
+void CPA_Batch_avx( int n, const CPA_Ownship *own,
+                    const double *lat, const double *lon, const double *ve, const double *vn,
+                    double *tcpa, double *cpa );
+void CPA_Batch_neon( int n, const CPA_Ownship *own,
+                     const double *lat, const double *lon, const double *ve, const double *vn,
+                     double *tcpa, double *cpa );
+
+#ifdef  __cplusplus
+}
+#endif
+#endif
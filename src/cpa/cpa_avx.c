@@ -0,0 +1,75 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Batch AIS CPA/TCPA computation
+ * Author:   The OpenCPN developers
+ *
+ ***************************************************************************
+ *   Copyright (C) 2026 by the OpenCPN developers                          *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ */
+
+#include "cpa.h"
+
+#if defined(__AVX__) || (defined(__MSVC__) &&  (_MSC_VER >= 1700))
+
+#include <immintrin.h>
+
+// four targets per step
+void CPA_Batch_avx( int n, const CPA_Ownship *own,
+                    const double *lat, const double *lon, const double *ve, const double *vn,
+                    double *tcpa, double *cpa )
+{
+    __m256d own_lat = _mm256_set1_pd( own->lat );
+    __m256d own_lon = _mm256_set1_pd( own->lon );
+    __m256d own_ve = _mm256_set1_pd( own->ve );
+    __m256d own_vn = _mm256_set1_pd( own->vn );
+    __m256d scale_n = _mm256_set1_pd( 60. * 1852. );
+    __m256d scale_e = _mm256_set1_pd( 60. * 1852. * own->coslat );
+    __m256d min_d = _mm256_set1_pd( 1e-6 );
+    __m256d one = _mm256_set1_pd( 1. );
+    __m256d minutes = _mm256_set1_pd( 60. );
+    __m256d nm = _mm256_set1_pd( 1. / 1852. );
+
+    int i;
+    for( i = 0; i + 4 <= n; i += 4 ) {
+        __m256d east = _mm256_mul_pd( _mm256_sub_pd( _mm256_loadu_pd( lon + i ), own_lon ), scale_e );
+        __m256d north = _mm256_mul_pd( _mm256_sub_pd( _mm256_loadu_pd( lat + i ), own_lat ), scale_n );
+
+        __m256d fc = _mm256_sub_pd( own_ve, _mm256_loadu_pd( ve + i ) );
+        __m256d fs = _mm256_sub_pd( own_vn, _mm256_loadu_pd( vn + i ) );
+        __m256d d = _mm256_add_pd( _mm256_mul_pd( fc, fc ), _mm256_mul_pd( fs, fs ) );
+
+        // the tracks are almost parallel, d is never negative
+        __m256d moving = _mm256_cmp_pd( d, min_d, _CMP_GE_OQ );
+        d = _mm256_blendv_pd( one, d, moving );
+        __m256d t = _mm256_div_pd( _mm256_add_pd( _mm256_mul_pd( fc, east ), _mm256_mul_pd( fs, north ) ), d );
+        t = _mm256_and_pd( moving, t );
+
+        __m256d x = _mm256_sub_pd( east, _mm256_mul_pd( fc, t ) );
+        __m256d y = _mm256_sub_pd( north, _mm256_mul_pd( fs, t ) );
+
+        _mm256_storeu_pd( tcpa + i, _mm256_mul_pd( t, minutes ) );
+        _mm256_storeu_pd( cpa + i, _mm256_mul_pd( _mm256_sqrt_pd( _mm256_add_pd( _mm256_mul_pd( x, x ), _mm256_mul_pd( y, y ) ) ), nm ) );
+    }
+    _mm256_zeroupper();
+
+    if( i < n )
+        CPA_Batch_generic( n - i, own, lat + i, lon + i, ve + i, vn + i, tcpa + i, cpa + i );
+}
+#endif
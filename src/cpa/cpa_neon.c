@@ -0,0 +1,75 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Batch AIS CPA/TCPA computation
+ * Author:   The OpenCPN developers
+ *
+ ***************************************************************************
+ *   Copyright (C) 2026 by the OpenCPN developers                          *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ */
+
+#include "cpa.h"
+
+// double precision lanes are only available on 64 bit arm
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+
+// two targets per step
+void CPA_Batch_neon( int n, const CPA_Ownship *own,
+                     const double *lat, const double *lon, const double *ve, const double *vn,
+                     double *tcpa, double *cpa )
+{
+    float64x2_t own_lat = vdupq_n_f64( own->lat );
+    float64x2_t own_lon = vdupq_n_f64( own->lon );
+    float64x2_t own_ve = vdupq_n_f64( own->ve );
+    float64x2_t own_vn = vdupq_n_f64( own->vn );
+    float64x2_t scale_n = vdupq_n_f64( 60. * 1852. );
+    float64x2_t scale_e = vdupq_n_f64( 60. * 1852. * own->coslat );
+    float64x2_t min_d = vdupq_n_f64( 1e-6 );
+    float64x2_t one = vdupq_n_f64( 1. );
+    float64x2_t zero = vdupq_n_f64( 0. );
+    float64x2_t minutes = vdupq_n_f64( 60. );
+    float64x2_t nm = vdupq_n_f64( 1. / 1852. );
+
+    int i;
+    for( i = 0; i + 2 <= n; i += 2 ) {
+        float64x2_t east = vmulq_f64( vsubq_f64( vld1q_f64( lon + i ), own_lon ), scale_e );
+        float64x2_t north = vmulq_f64( vsubq_f64( vld1q_f64( lat + i ), own_lat ), scale_n );
+
+        float64x2_t fc = vsubq_f64( own_ve, vld1q_f64( ve + i ) );
+        float64x2_t fs = vsubq_f64( own_vn, vld1q_f64( vn + i ) );
+        float64x2_t d = vaddq_f64( vmulq_f64( fc, fc ), vmulq_f64( fs, fs ) );
+
+        // the tracks are almost parallel, d is never negative
+        uint64x2_t moving = vcgeq_f64( d, min_d );
+        d = vbslq_f64( moving, d, one );
+        float64x2_t t = vdivq_f64( vaddq_f64( vmulq_f64( fc, east ), vmulq_f64( fs, north ) ), d );
+        t = vbslq_f64( moving, t, zero );
+
+        float64x2_t x = vsubq_f64( east, vmulq_f64( fc, t ) );
+        float64x2_t y = vsubq_f64( north, vmulq_f64( fs, t ) );
+
+        vst1q_f64( tcpa + i, vmulq_f64( t, minutes ) );
+        vst1q_f64( cpa + i, vmulq_f64( vsqrtq_f64( vaddq_f64( vmulq_f64( x, x ), vmulq_f64( y, y ) ) ), nm ) );
+    }
+
+    if( i < n )
+        CPA_Batch_generic( n - i, own, lat + i, lon + i, ve + i, vn + i, tcpa + i, cpa + i );
+}
+#endif
@@ -0,0 +1,74 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Batch AIS CPA/TCPA computation
+ * Author:   The OpenCPN developers
+ *
+ ***************************************************************************
+ *   Copyright (C) 2026 by the OpenCPN developers                          *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ */
+
+#include "cpa.h"
+
+#if defined(__SSE2__) || (defined(__MSVC__) &&  (_MSC_VER >= 1700))
+
+#include <emmintrin.h>
+
+// two targets per step
+void CPA_Batch_sse2( int n, const CPA_Ownship *own,
+                     const double *lat, const double *lon, const double *ve, const double *vn,
+                     double *tcpa, double *cpa )
+{
+    __m128d own_lat = _mm_set1_pd( own->lat );
+    __m128d own_lon = _mm_set1_pd( own->lon );
+    __m128d own_ve = _mm_set1_pd( own->ve );
+    __m128d own_vn = _mm_set1_pd( own->vn );
+    __m128d scale_n = _mm_set1_pd( 60. * 1852. );
+    __m128d scale_e = _mm_set1_pd( 60. * 1852. * own->coslat );
+    __m128d min_d = _mm_set1_pd( 1e-6 );
+    __m128d one = _mm_set1_pd( 1. );
+    __m128d minutes = _mm_set1_pd( 60. );
+    __m128d nm = _mm_set1_pd( 1. / 1852. );
+
+    int i;
+    for( i = 0; i + 2 <= n; i += 2 ) {
+        __m128d east = _mm_mul_pd( _mm_sub_pd( _mm_loadu_pd( lon + i ), own_lon ), scale_e );
+        __m128d north = _mm_mul_pd( _mm_sub_pd( _mm_loadu_pd( lat + i ), own_lat ), scale_n );
+
+        __m128d fc = _mm_sub_pd( own_ve, _mm_loadu_pd( ve + i ) );
+        __m128d fs = _mm_sub_pd( own_vn, _mm_loadu_pd( vn + i ) );
+        __m128d d = _mm_add_pd( _mm_mul_pd( fc, fc ), _mm_mul_pd( fs, fs ) );
+
+        // the tracks are almost parallel, d is never negative
+        __m128d moving = _mm_cmpge_pd( d, min_d );
+        d = _mm_or_pd( _mm_and_pd( moving, d ), _mm_andnot_pd( moving, one ) );
+        __m128d t = _mm_div_pd( _mm_add_pd( _mm_mul_pd( fc, east ), _mm_mul_pd( fs, north ) ), d );
+        t = _mm_and_pd( moving, t );
+
+        __m128d x = _mm_sub_pd( east, _mm_mul_pd( fc, t ) );
+        __m128d y = _mm_sub_pd( north, _mm_mul_pd( fs, t ) );
+
+        _mm_storeu_pd( tcpa + i, _mm_mul_pd( t, minutes ) );
+        _mm_storeu_pd( cpa + i, _mm_mul_pd( _mm_sqrt_pd( _mm_add_pd( _mm_mul_pd( x, x ), _mm_mul_pd( y, y ) ) ), nm ) );
+    }
+
+    if( i < n )
+        CPA_Batch_generic( n - i, own, lat + i, lon + i, ve + i, vn + i, tcpa + i, cpa + i );
+}
+#endif
@@ -52,6 +52,7 @@
 #include "datastream.h"
 #include "OCPN_DataStreamEvent.h"
 #include "OCP_DataStreamInput_Thread.h"
+#include "SentenceRing.h"
 #include "garmin/jeeps/garmin_wrapper.h"
 
 #ifdef __OCPN__ANDROID__
@@ -66,6 +67,7 @@ static const long long lNaN = 0xfff8000000000000;
 #endif
 
 const wxEventType wxEVT_OCPN_DATASTREAM = wxNewEventType();
+const wxEventType wxEVT_OCPN_DATASTREAMQUEUE = wxNewEventType();
 
 #define N_DOG_TIMEOUT   5
 
@@ -90,10 +92,10 @@ bool CheckSumCheck(const std::string& sentence)
     if(check_start == wxString::npos || check_start > sentence.size() - 3)
         return false; // * not found, or it didn't have 2 characters following it.
         
-    std::string check_str = sentence.substr(check_start+1,2);
+    char check_str[3] = { sentence[check_start+1], sentence[check_start+2], 0 };
     unsigned long checksum;
     //    if(!check_str.ToULong(&checksum,16))
-    if(!(checksum = strtol(check_str.c_str(), 0, 16)))
+    if(!(checksum = strtol(check_str, 0, 16)))
         return false;
     
     unsigned char calculated_checksum = 0;
@@ -104,6 +106,15 @@ bool CheckSumCheck(const std::string& sentence)
     
 }
 
+void GetSentenceKey(const wxString& sentence, char *key)
+{
+    size_t len = sentence.Length();
+    for(size_t i = 0; i < DS_SENTENCE_KEY_LENGTH; i++) {
+        wxChar c = ( i + 1 < len ) ? (wxChar)sentence.GetChar(i + 1) : 0;
+        key[i] = ( c > 0 && c < 128 ) ? (char)c : 0;
+    }
+}
+
 
 
 
@@ -111,6 +122,8 @@ bool CheckSumCheck(const std::string& sentence)
 //    DataStream Implementation
 //------------------------------------------------------------------------------
 
+int DataStream::s_filter_serial = 0;
+
 BEGIN_EVENT_TABLE(DataStream, wxEvtHandler)
 
     EVT_SOCKET(DS_SOCKET_ID, DataStream::OnSocketEvent)
@@ -140,6 +153,7 @@ DataStream::DataStream(wxEvtHandler *input_consumer,
     m_user_data = user_data;
     m_bGarmin_GRMN_mode = bGarmin;
     m_connection_type = conn_type;
+    s_filter_serial++;
 
     Init();
 
@@ -149,6 +163,7 @@ DataStream::DataStream(wxEvtHandler *input_consumer,
 void DataStream::Init(void)
 {
     m_pSecondary_Thread = NULL;
+    m_pSentenceRing = NULL;
     m_GarminHandler = NULL;
     m_bok = false;
     SetSecThreadInActive();
@@ -216,6 +231,8 @@ void DataStream::Open(void)
 #endif
 
     //    Kick off the DataSource RX thread
+            if( !m_pSentenceRing )
+                m_pSentenceRing = new SentenceRing;
             m_pSecondary_Thread = new OCP_DataStreamInput_Thread(this,
                                                                  m_consumer,
                                                                  comx, m_BaudRate,
@@ -406,6 +423,8 @@ void DataStream::Open(void)
 DataStream::~DataStream()
 {
     Close();
+    delete m_pSentenceRing;
+    s_filter_serial++;
 }
 
 void DataStream::Close()
@@ -697,43 +716,48 @@ void DataStream::OnServerSocketEvent(wxSocketEvent& event)
 
 bool DataStream::SentencePassesFilter(const wxString& sentence, FilterDirection direction)
 {
-    wxArrayString filter;
-    bool listype = false;
+    char key[DS_SENTENCE_KEY_LENGTH];
+    GetSentenceKey(sentence, key);
+    return SentencePassesFilter(key, direction);
+}
+
+bool DataStream::SentencePassesFilter(const char *key, FilterDirection direction)
+{
+    const wxArrayString &filter = (direction == FILTER_INPUT) ? m_input_filter : m_output_filter;
+    bool listype;
 
     if (direction == FILTER_INPUT)
-    {
-        filter = m_input_filter;
-        if (m_input_filter_type == WHITELIST)
-            listype = true;
-    }
+        listype = (m_input_filter_type == WHITELIST);
     else
-    {
-        filter = m_output_filter;
-        if (m_output_filter_type == WHITELIST)
-            listype = true;
-    }
+        listype = (m_output_filter_type == WHITELIST);
+
     if (filter.Count() == 0) //Empty list means everything passes
         return true;
 
-    wxString fs;
     for (size_t i = 0; i < filter.Count(); i++)
     {
-        fs = filter.Item(i);
+        const wxString &fs = filter.Item(i);
+        size_t offset;
         switch (fs.Length())
         {
-            case 2:
-                if (fs == sentence.Mid(1, 2))
-                    return listype;
+            case 2:                     // talker, e.g. "GP"
+                offset = 0;
                 break;
-            case 3:
-                if (fs == sentence.Mid(3, 3))
-                    return listype;
+            case 3:                     // sentence, e.g. "RMC"
+                offset = 2;
                 break;
-            case 5:
-                if (fs == sentence.Mid(1, 5))
-                    return listype;
+            case 5:                     // both, or a proprietary sentence
+                offset = 0;
                 break;
+            default:
+                continue;
         }
+
+        size_t j = 0;
+        while ((j < fs.Length()) && ((wxChar)fs.GetChar(j) == (wxChar)key[offset + j]))
+            j++;
+        if (j == fs.Length())
+            return listype;
     }
     return !listype;
 }
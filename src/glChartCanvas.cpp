@@ -2494,6 +2494,8 @@ void glChartCanvas::RenderRasterChartRegionGL( ChartBase *chart, ViewPort &vp, L
     if( !pBSBChart ) return;
 
     if(b_inCompressAllCharts) return; // don't want multiple texfactories to exist
+    if(g_glTextureManager->ReleasePrebuildChart(chart->GetFullPath()))
+        return; // nor here, the background job stops shortly
     
     double scalefactor = pBSBChart->GetRasterScaleFactor(vp);
 
@@ -27,6 +27,7 @@
 #include <wx/wxprec.h>
 #include <wx/tokenzr.h>
 #include <wx/filename.h>
+#include <wx/stopwatch.h>
 
 #include <stdint.h>
 
@@ -79,63 +80,14 @@ extern bool GetMemoryStatus( int *mem_total, int *mem_used );
 extern wxString CompressedCachePath(wxString path);
 extern glTextureManager   *g_glTextureManager;
 
-//      CatalogEntry implementation
-CatalogEntry::CatalogEntry()
-{
-}
-
-CatalogEntry::~CatalogEntry()
-{
-}
-
-CatalogEntry::CatalogEntry(int level, int x0, int y0, ColorScheme colorscheme)
-{
-    k.mip_level = level;
-    k.x = x0;
-    k.y = y0;
-    k.tcolorscheme = colorscheme;
-}
-
-int CatalogEntry::GetSerialSize()
-{
-    return CATALOG_ENTRY_SERIAL_SIZE;
-}
-
-void CatalogEntry::Serialize( unsigned char *t)
-{
-    uint32_t *p = (uint32_t *)t;
-    
-    *p++ = k.mip_level;
-    *p++ = k.x;
-    *p++ = k.y;
-    *p++ = k.tcolorscheme;
-    *p++ = v.texture_offset;
-    *p++ = v.compressed_size;
-    
-}
-
-
-void CatalogEntry::DeSerialize( unsigned char *t)
-{
-    uint32_t *p = (uint32_t *)t;
-    
-     k.mip_level = *p++;
-     k.x = *p++;
-     k.y = *p++;
-     k.tcolorscheme = (ColorScheme)*p++;
-     v.texture_offset = *p++;
-     v.compressed_size = *p++;
-     
-}
-
 //      glTexFactory Implementation
 enum TextureDataType {COMPRESSED_BUFFER_OK, MAP_BUFFER_OK};
 
 glTexFactory::glTexFactory(ChartBase *chart, int raster_format)
 {
 //    m_pchart = chart;
-    n_catalog_entries = 0;
     m_catalog_offset = sizeof(CompressedCacheHeader);
+    m_stamp = 0;
     wxDateTime ed = chart->GetEditionDate();
     m_chart_date_binary = (uint32_t)ed.GetTicks();
     m_chartfile_date_binary = ::wxFileModificationTime(chart->GetFullPath());
@@ -143,6 +95,7 @@ glTexFactory::glTexFactory(ChartBase *chart, int raster_format)
     m_ChartPath = chart->GetFullPath();
     
     m_CompressedCacheFilePath = CompressedCachePath(chart->GetFullPath());
+    m_catalog_key = glTexCatalog::ChartKey(m_CompressedCacheFilePath);
     m_hdrOK = false;
     m_catalogOK = false;
     m_newCatalog = true;
@@ -152,11 +105,6 @@ glTexFactory::glTexFactory(ChartBase *chart, int raster_format)
     m_fs = 0;
     m_LRUtime = 0;
 
-    for (int i = 0; i < N_COLOR_SCHEMES; i++) {
-        for (int j = 0; j < MAX_TEX_LEVEL; j++) {
-            m_cache[i][j] = NULL;
-        }
-    }
     //  Initialize the TextureDescriptor array
     ChartBaseBSB *pBSBChart = dynamic_cast<ChartBaseBSB*>( chart );
     
@@ -187,15 +135,6 @@ glTexFactory::~glTexFactory()
     DeleteAllTextures();
     DeleteAllDescriptors();
 
-    for (int i = 0; i < N_COLOR_SCHEMES; i++) {
-        for (int j = 0; j < MAX_TEX_LEVEL; j++) {
-            CatalogEntryValue *v = m_cache[i][j];
-            if (v) {
-                free(v);
-            }
-        }
-    }
- 
     free( m_td_array );         // array is empty
 
     if(m_tiles)
@@ -247,8 +186,8 @@ bool glTexFactory::OnTimer()
                     if( ptd->compcomp_array[0] )
                         continue; // ok
                     
-                    CatalogEntryValue *p = GetCacheEntryValue(0, x*dim, y*dim, ptd->m_colorscheme);
-                    if(!p)
+                    glTexCatalogTile v;
+                    if(!GetCacheEntryValue(0, x*dim, y*dim, ptd->m_colorscheme, v))
                         goto keeplines;
                 }
 
@@ -408,33 +347,31 @@ void glTexFactory::DeleteSingleTexture( glTextureDescriptor *ptd )
     ptd->nGPU_compressed = GPU_TEXTURE_UNKNOWN;
 }
 
-void  glTexFactory::ArrayXY(wxRect *r, int index) const
+bool glTexFactory::CacheTileKey(int level, int x, int y, ColorScheme color_scheme, uint32_t &key) const
 {
-    r->y = (index / m_stride)*m_tex_dim;
-    r->x = (index -((r->y/m_tex_dim)*m_stride)) *m_tex_dim;
+    if (level < 0 || level >= MAX_TEX_LEVEL)
+        return false;
+
+    if (ArrayIndex(x, y) >= m_ntex)
+        return false;
+
+    return glTexCatalog::TileKey(level, color_scheme, x / m_tex_dim, y / m_tex_dim, key);
 }
 
-CatalogEntryValue *glTexFactory::GetCacheEntryValue(int level, int x, int y, ColorScheme color_scheme)
+bool glTexFactory::GetCacheEntryValue(int level, int x, int y, ColorScheme color_scheme, glTexCatalogTile &v)
 {
-    if (level < 0 || level >= MAX_TEX_LEVEL)
-        return 0;
+    uint32_t key;
+    if (!CacheTileKey(level, x, y, color_scheme, key))
+        return false;
 
     //  Look in the cache
     LoadCatalog();
 
-    CatalogEntryValue *v = m_cache[color_scheme][level];
-    if (v == 0)
-        return 0;
-
-    int array_index = ArrayIndex(x, y);
-    if (array_index >= m_ntex)
-        return 0;
-
-    CatalogEntryValue *r = &v[array_index];
-    if (r->compressed_size == 0)
-        return 0;
+    if (!g_glTexCatalog || !g_glTexCatalog->FindTile(m_catalog_key, key, v))
+        return false;
 
-    return r;    
+    //  Tiles indexed before a crash may lie beyond the data the header vouches for
+    return v.size != 0 && (size_t)v.offset + v.size <= (size_t)m_catalog_offset;
 }
 
 bool glTexFactory::IsLevelInCache( int level, const wxRect &rect, ColorScheme color_scheme )
@@ -445,7 +382,8 @@ bool glTexFactory::IsLevelInCache( int level, const wxRect &rect, ColorScheme co
         g_GLOptions.m_bTextureCompressionCaching) {
          
     //  Search for the requested texture
-        if (GetCacheEntryValue(level, rect.x, rect.y, color_scheme) != 0)
+        glTexCatalogTile v;
+        if (GetCacheEntryValue(level, rect.x, rect.y, color_scheme, v))
             b_ret = true;
     }
     
@@ -883,6 +821,30 @@ void glTexFactory::PrepareTiles(const ViewPort &vp, bool use_norm_vp, ChartBase
     }
 }
 
+//  Geographic centre of a tile, and the radius in degrees of latitude of a
+//  circle around it covering the tile.  Known once PrepareTiles() has run.
+bool glTexFactory::GetTileCenter(const wxRect &rect, double &lat, double &lon, double &radius)
+{
+    if(!m_tiles || rect.x < 0 || rect.y < 0 || rect.IsEmpty())
+        return false;
+
+    int x = rect.x / m_tex_dim, y = rect.y / m_tex_dim;
+    if(x >= m_nx_tex || y >= m_ny_tex)
+        return false;
+
+    glTexTile *tile = m_tiles[y*m_nx_tex + x];
+    if(!tile || !tile->box.GetValid())
+        return false;
+
+    lat = (tile->box.GetMinLat() + tile->box.GetMaxLat()) / 2;
+    lon = (tile->box.GetMinLon() + tile->box.GetMaxLon()) / 2;
+
+    double dlat = tile->box.GetMaxLat() - tile->box.GetMinLat();
+    double dlon = (tile->box.GetMaxLon() - tile->box.GetMinLon()) * cos(lat * PI / 180.);
+    radius = sqrt(dlat*dlat + dlon*dlon) / 2;
+    return true;
+}
+
 
 bool glTexFactory::UpdateCacheLevel( const wxRect &rect, int level, ColorScheme color_scheme, unsigned char *data, int size)
 {
@@ -894,10 +856,10 @@ bool glTexFactory::UpdateCacheLevel( const wxRect &rect, int level, ColorScheme
 
     //  Search for the requested texture
         //  Search the catalog for this particular texture
-    CatalogEntryValue *v = GetCacheEntryValue(level, rect.x, rect.y, color_scheme) ;
+    glTexCatalogTile v;
         
     //      This texture is already done
-    if(v != 0)
+    if(GetCacheEntryValue(level, rect.x, rect.y, color_scheme, v))
         return false;
     
     return UpdateCachePrecomp(data, size, rect, level, color_scheme);
@@ -914,7 +876,7 @@ bool glTexFactory::UpdateCacheAllLevels( const wxRect &rect, ColorScheme color_s
     for (int level = 0; level < g_mipmap_max_level + 1; level++ )
         work |= UpdateCacheLevel( rect, level, color_scheme, compcomp_array[level], compcomp_size[level] );
     if (work) {
-        WriteCatalogAndHeader();
+        WriteHeader();
     }    
     
     return work;
@@ -938,24 +900,35 @@ int glTexFactory::GetTextureLevel( glTextureDescriptor *ptd, const wxRect &rect,
             //  If cacheing compressed textures, look in the cache
             //  Search for the requested texture
             //  Search the catalog for this particular texture
-            CatalogEntryValue *p = GetCacheEntryValue(level, rect.x, rect.y, color_scheme);
+            glTexCatalogTile v;
         
             //      Requested texture level is found in the cache
             //      so go load it
-            if( p != 0 ) {
+            if( GetCacheEntryValue(level, rect.x, rect.y, color_scheme, v) ) {
                 int size = TextureTileSize(level, true);
 
-                if(m_fs->IsOpened()){
-                    m_fs->Seek(p->texture_offset);
-                    ptd->comp_array[level] = (unsigned char*)malloc(size);
-                    int max_compressed_size = LZ4_COMPRESSBOUND(g_tile_size);
-                    char *compressed_data = (char*)malloc(p->compressed_size);
-                    m_fs->Read(compressed_data, p->compressed_size);
-                    LZ4_decompress_fast(compressed_data, (char*)ptd->comp_array[level], size);
-                    free(compressed_data);
+                //  Decompress straight out of the mapped cache file
+                const unsigned char *cdata = MapCacheData(v);
+                if(cdata) {
+                    unsigned char *cb = (unsigned char*)malloc(size);
+                    if(LZ4_decompress_safe((const char*)cdata, (char*)cb, v.size, size) == size) {
+                        ptd->comp_array[level] = cb;
+                        return COMPRESSED_BUFFER_OK;
+                    }
+                    free(cb);           // corrupt entry, build the texture below
                 }
+                else {
+                    if(m_fs->IsOpened()){
+                        m_fs->Seek(v.offset);
+                        ptd->comp_array[level] = (unsigned char*)malloc(size);
+                        char *compressed_data = (char*)malloc(v.size);
+                        m_fs->Read(compressed_data, v.size);
+                        LZ4_decompress_fast(compressed_data, (char*)ptd->comp_array[level], size);
+                        free(compressed_data);
+                    }
             
-                return COMPRESSED_BUFFER_OK;
+                    return COMPRESSED_BUFFER_OK;
+                }
             }
         }
     }
@@ -969,6 +942,31 @@ int glTexFactory::GetTextureLevel( glTextureDescriptor *ptd, const wxRect &rect,
 }
 
 
+//  The compressed bytes of a cached tile, in place in the mapped cache file.
+//  Tiles are only ever appended, so the mapping stays valid for everything
+//  below its end; tiles appended after it was made are reached by remapping.
+const unsigned char *glTexFactory::MapCacheData(const glTexCatalogTile &v)
+{
+    size_t end = (size_t)v.offset + v.size;
+    if(end > m_map.GetSize()) {
+        if(m_fs && m_fs->IsOpened())
+            m_fs->Flush();
+        m_map.Open(m_CompressedCacheFilePath, true);
+        if(end > m_map.GetSize())
+            return NULL;
+    }
+
+    return m_map.GetData() + v.offset;
+}
+
+//  Identifies one incarnation of a cache file, so that catalog records
+//  left over from a previous file of the same name are not trusted
+static uint32_t NewCacheStamp()
+{
+    uint32_t stamp = wxGetLocalTimeMillis().GetLo();
+    return stamp ? stamp : 1;
+}
+
 // return not used
 // false? never
 // true 
@@ -1002,14 +1000,14 @@ bool glTexFactory::LoadHeader(void)
                     need_new = true;
                 }
                 else {      // good header
-                    n_catalog_entries = hdr.m_nentries;
+                    m_stamp = hdr.stamp;
                     m_catalog_offset = hdr.catalog_offset;
                 }
             }
             else{  // file exists, and is empty
-                n_catalog_entries = 0;
+                m_stamp = NewCacheStamp();
                 m_catalog_offset = 0;
-                WriteCatalogAndHeader();
+                WriteHeader();
             }
         }  // is open
         
@@ -1029,11 +1027,11 @@ bool glTexFactory::LoadHeader(void)
     }
 
     if (need_new) {
-        //  Create new file, with empty catalog, and correct header
+        //  Create new file, with no tiles, and correct header
         m_fs = new wxFFile(m_CompressedCacheFilePath, _T("wb"));
-        n_catalog_entries = 0;
+        m_stamp = NewCacheStamp();
         m_catalog_offset = 0;
-        WriteCatalogAndHeader();
+        WriteHeader();
         delete m_fs;
 
         m_fs = new wxFFile(m_CompressedCacheFilePath, _T("rb+"));
@@ -1042,27 +1040,8 @@ bool glTexFactory::LoadHeader(void)
     return true;
 }
 
-bool glTexFactory::AddCacheEntryValue(const CatalogEntry &p)
-{
-    if ((int)p.k.tcolorscheme < 0 || p.k.tcolorscheme >= N_COLOR_SCHEMES) 
-        return false;
-
-    if (p.k.mip_level < 0 || p.k.mip_level >= MAX_TEX_LEVEL) 
-        return false;
-
-    int array_index = ArrayIndex(p.k.x, p.k.y);
-    if (array_index < 0 || array_index >= m_ntex) 
-        return false;
-
-    if (m_cache[p.k.tcolorscheme][p.k.mip_level] == 0) 
-        m_cache[p.k.tcolorscheme][p.k.mip_level] = (CatalogEntryValue* )calloc(m_ntex, sizeof (CatalogEntryValue) );
-
-    CatalogEntryValue *v = m_cache[p.k.tcolorscheme][p.k.mip_level];
-    CatalogEntryValue *r = &v[array_index];
-    *r = p.v; 
-    return true;
-}
-
+//  The tile index itself lives in g_glTexCatalog.  Here we only make sure
+//  the catalog's record of this chart describes the cache file on disk.
 bool glTexFactory::LoadCatalog(void)
 {
     m_newCatalog = false;
@@ -1071,80 +1050,42 @@ bool glTexFactory::LoadCatalog(void)
 
     if( !LoadHeader() )
         return false;
-    
-    if (n_catalog_entries == 0) {
-        // new empty header
-        m_catalogOK = true;
-        m_newCatalog = true;
-        return true;
-    }
-    
-    m_fs->Seek(m_catalog_offset);
- 
-    CatalogEntry ps;
-    int buf_size =  ps.GetSerialSize();
-    unsigned char *buf = (unsigned char *)malloc(buf_size);
-    
-    CatalogEntry p;
-    bool bad = false;
-    for(int i=0 ; i < n_catalog_entries ; i++){
-        m_fs->Read(buf, buf_size);
-        p.DeSerialize(buf);
-        if (!AddCacheEntryValue(p))
-            bad = true;
-    }
-    
-    free(buf);
-    if (bad && !m_catalogCorrupted) {
-        wxLogMessage(_T("Bad cache catalog %s %s"), m_ChartPath.c_str(), m_CompressedCacheFilePath.c_str());
-        m_catalogCorrupted = true;
+
+    if( !g_glTexCatalog )
+        return false;
+
+    glTexCatalogChart rec;
+    bool found = g_glTexCatalog->FindChart(m_catalog_key, rec);
+    if( !found || rec.stamp != m_stamp || rec.data_end > (uint32_t)m_catalog_offset ) {
+        //  Same file, but the catalog claims more data than it holds
+        if( found && rec.stamp == m_stamp && !m_catalogCorrupted ) {
+            wxLogMessage(_T("Bad cache catalog %s %s"), m_ChartPath.c_str(), m_CompressedCacheFilePath.c_str());
+            m_catalogCorrupted = true;
+        }
+
+        rec.stamp = m_stamp;
+        rec.data_end = m_catalog_offset;
+        g_glTexCatalog->ResetChart(m_catalog_key, rec);
     }
+
+    // new empty cache file
+    m_newCatalog = rec.data_end == 0;
     m_catalogOK = true;
     return true;
 }
 
 
-bool glTexFactory::WriteCatalogAndHeader()
+bool glTexFactory::WriteHeader()
 {
     if(m_fs && m_fs->IsOpened()){
 
+        //   Write header at file end, just past the tile data
         m_fs->Seek(m_catalog_offset);
         
-        CatalogEntry ps;
-        int buf_size =  ps.GetSerialSize();
-        unsigned char buf[CATALOG_ENTRY_SERIAL_SIZE];   // MSVC requires constant stack array size...
-        int new_n_catalog_entries = 0;
-        CatalogEntry p;
-        wxRect rect;
-        for (int i = 0; i < N_COLOR_SCHEMES; i++) {
-            p.k.tcolorscheme = (ColorScheme)i;
-            for (int j = 0; j < MAX_TEX_LEVEL; j++) {
-                CatalogEntryValue *v = m_cache[i][j];
-                if (!v) 
-                    continue;
-                p.k.mip_level = j;
-                for (int k = 0; k < m_ntex; k++) {
-                    ArrayXY(&rect, k);
-                    p.k.y = rect.y;
-                    p.k.x = rect.x;
-                    CatalogEntryValue *r = &v[k];
-                    if (r->compressed_size == 0)
-                        continue;
-                    p.v = *r;
-                    new_n_catalog_entries++;
-                    p.Serialize(buf);
-                    m_fs->Write( buf, buf_size);
-
-                }
-            }
-        }
-
-        n_catalog_entries = new_n_catalog_entries;
-        //   Write header at file end
         CompressedCacheHeader hdr;
         hdr.magic = COMPRESSED_CACHE_MAGIC;
         hdr.format = g_raster_format;
-        hdr.m_nentries = n_catalog_entries;
+        hdr.stamp = m_stamp;
         hdr.catalog_offset = m_catalog_offset;
         hdr.chartdate = m_chart_date_binary;
         hdr.chartfile_date = m_chartfile_date_binary;
@@ -1152,6 +1093,14 @@ bool glTexFactory::WriteCatalogAndHeader()
         
         m_fs->Write( &hdr, sizeof(hdr));
         m_fs->Flush();
+
+        //  The tiles are on disk now, so the global catalog may rely on them
+        if(m_catalogOK && g_glTexCatalog) {
+            glTexCatalogChart rec;
+            rec.stamp = m_stamp;
+            rec.data_end = m_catalog_offset;
+            g_glTexCatalog->SetChart(m_catalog_key, rec);
+        }
         
         return true;
     }
@@ -1160,39 +1109,34 @@ bool glTexFactory::WriteCatalogAndHeader()
 }
 
 bool glTexFactory::UpdateCachePrecomp(unsigned char *data, int data_size, const wxRect &rect,
-                                      int level, ColorScheme color_scheme, bool write_catalog)
+                                      int level, ColorScheme color_scheme, bool write_header)
 {
-    if (level < 0 || level >= MAX_TEX_LEVEL)
+    uint32_t key;
+    if (!CacheTileKey(level, rect.x, rect.y, color_scheme, key))
         return false;	// XXX BUG
 
     //  Search the catalog for this particular texture
-    if (GetCacheEntryValue(level, rect.x, rect.y, color_scheme) != 0) 
+    glTexCatalogTile v;
+    if (GetCacheEntryValue(level, rect.x, rect.y, color_scheme, v)) 
         return false;
     
     // Make sure the file exists
     wxASSERT(m_fs != 0);
         
-    if( ! m_fs->IsOpened() )
+    if( ! m_fs->IsOpened() || !g_glTexCatalog )
         return false;
 
-    //      Create a new catalog entry
-    CatalogEntry p( level, rect.x, rect.y, color_scheme);
-    
-    //      Write the compressed data to disk
-    p.v.texture_offset = m_catalog_offset;
-    
-    p.v.compressed_size = data_size;
-    AddCacheEntryValue(p);            
-    n_catalog_entries++;
-
-    //      We write the new data at the current catalog offset, overwriting the old catalog
+    //      We write the new data at the end of the tile data, overwriting the header
+    v.offset = m_catalog_offset;
+    v.size = data_size;
     m_fs->Seek( m_catalog_offset );
     m_fs->Write( data, data_size );
-    
-    //      Write the catalog and Header (which follows the catalog at the end of the file
     m_catalog_offset += data_size;
-    if (write_catalog)
-        WriteCatalogAndHeader();
+
+    //      Index it, and rewrite the header (which follows the tile data at the end of the file)
+    g_glTexCatalog->AddTile(m_catalog_key, key, v);
+    if (write_header)
+        WriteHeader();
     
     return true;
 }
@@ -0,0 +1,420 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Global catalog of compressed raster texture cache tiles
+ * Author:   The OpenCPN developers
+ *
+ ***************************************************************************
+ *   Copyright (C) 2026 by the OpenCPN developers                          *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ *
+ */
+
+#include <string.h>
+#include <vector>
+#include <set>
+
+#include <wx/file.h>
+#include <wx/filefn.h>
+#include <wx/filename.h>
+#include <wx/dir.h>
+#include <wx/log.h>
+
+#include "glTexCatalog.h"
+#include "FlexHash.h"
+
+#define TEXCATALOG_MAGIC        0x54435431      // change this when the format changes
+#define TEXCATALOG_MIN_CHARTS   16
+#define TEXCATALOG_MIN_TILES    1024
+
+glTexCatalog *g_glTexCatalog;
+
+//  File layout: header, chart table, tile table.  Both tables are open
+//  addressed with linear probing, at most half full, and a zero chart key
+//  marks an empty slot.
+
+struct TexCatalogHeader
+{
+    uint32_t magic;
+    uint32_t nchart_slots;              // powers of two
+    uint32_t ntile_slots;
+    uint32_t ncharts;
+    uint32_t ntiles;
+    uint32_t reserved[3];
+};
+
+struct TexCatalogChartSlot
+{
+    uint64_t chart;
+    glTexCatalogChart rec;
+};
+
+struct TexCatalogTileSlot
+{
+    uint64_t chart;
+    uint32_t tile;
+    glTexCatalogTile value;
+    uint32_t pad;
+};
+
+static inline size_t ChartSlot( uint64_t chart, uint32_t mask )
+{
+    //  Chart keys are already well mixed
+    return (size_t) ( ( chart ^ ( chart >> 32 ) ) & mask );
+}
+
+static inline size_t TileSlot( uint64_t chart, uint32_t tile, uint32_t mask )
+{
+    uint64_t h = ( chart ^ tile ) * 0x9E3779B97F4A7C15ULL;
+    return (size_t) ( ( h >> 32 ) & mask );
+}
+
+static uint32_t TableSize( size_t nitems, uint32_t min_size )
+{
+    uint32_t n = min_size;
+    while( n < 2 * nitems )
+        n <<= 1;
+    return n;
+}
+
+glTexCatalog::glTexCatalog()
+{
+    m_bdirty = false;
+}
+
+glTexCatalog::~glTexCatalog()
+{
+}
+
+uint64_t glTexCatalog::ChartKey( const wxString &chart_path )
+{
+    wxCharBuffer buf = chart_path.ToUTF8();
+    uint64_t key = 0;
+    FlexHash::Compute( buf.data(), strlen( buf.data() ), &key, sizeof( key ) );
+    return key ? key : 1;
+}
+
+//  Tiles are identified by their position in tile units, so the key fits 30 bits
+bool glTexCatalog::TileKey( int level, int scheme, int tx, int ty, uint32_t &key )
+{
+    if( level < 0 || level >= 16 || scheme < 0 || scheme >= 4 ||
+        tx < 0 || tx >= 4096 || ty < 0 || ty >= 4096 )
+        return false;
+
+    key = ( (uint32_t) scheme << 28 ) | ( (uint32_t) level << 24 ) | ( (uint32_t) ty << 12 ) | (uint32_t) tx;
+    return true;
+}
+
+bool glTexCatalog::Open( const wxString &path )
+{
+    wxCriticalSectionLocker locker( m_lock );
+
+    m_path = path;
+    m_pending.clear();
+    m_bdirty = false;
+
+    if( !wxFileExists( path ) || !m_map.Open( path ) )
+        return false;
+
+    //  A damaged or foreign file is treated as an empty catalog
+    bool ok = false;
+    if( m_map.GetSize() >= sizeof( TexCatalogHeader ) ) {
+        const TexCatalogHeader *hdr = (const TexCatalogHeader *) m_map.GetData();
+        size_t expected = sizeof( TexCatalogHeader ) + (size_t) hdr->nchart_slots * sizeof( TexCatalogChartSlot )
+                          + (size_t) hdr->ntile_slots * sizeof( TexCatalogTileSlot );
+        ok = hdr->magic == TEXCATALOG_MAGIC &&
+             hdr->nchart_slots && ( hdr->nchart_slots & ( hdr->nchart_slots - 1 ) ) == 0 &&
+             hdr->ntile_slots && ( hdr->ntile_slots & ( hdr->ntile_slots - 1 ) ) == 0 &&
+             m_map.GetSize() == expected;
+    }
+
+    if( !ok ) {
+        wxLogMessage( _T("Ignoring bad texture cache catalog %s"), path.c_str() );
+        m_map.Close();
+        return false;
+    }
+
+    //  Have the next Save() drop the records of cache files removed since
+    std::set<uint64_t> live;
+    GatherLiveCharts( live );
+
+    const TexCatalogHeader *hdr = (const TexCatalogHeader *) m_map.GetData();
+    const TexCatalogChartSlot *cslots = (const TexCatalogChartSlot *) ( hdr + 1 );
+    for( size_t i = 0; i < hdr->nchart_slots; i++ ) {
+        if( cslots[i].chart && live.find( cslots[i].chart ) == live.end() ) {
+            m_bdirty = true;
+            break;
+        }
+    }
+
+    return true;
+}
+
+//  The keys of the cache files beside the catalog.  The cache file paths are keyed
+//  as built, so the directory is taken from our own path as is, not normalized.
+void glTexCatalog::GatherLiveCharts( std::set<uint64_t> &live ) const
+{
+    wxString dirname = m_path.BeforeLast( wxFileName::GetPathSeparator() );
+    wxDir dir( dirname );
+    if( !dir.IsOpened() )
+        return;
+
+    wxString name;
+    bool cont = dir.GetFirst( &name, wxEmptyString, wxDIR_FILES );
+    while( cont ) {
+        live.insert( ChartKey( dirname + wxFileName::GetPathSeparator() + name ) );
+        cont = dir.GetNext( &name );
+    }
+}
+
+void glTexCatalog::Clear()
+{
+    wxCriticalSectionLocker locker( m_lock );
+
+    m_map.Close();
+    m_pending.clear();
+    m_bdirty = false;
+}
+
+bool glTexCatalog::IsDirty()
+{
+    wxCriticalSectionLocker locker( m_lock );
+    return m_bdirty;
+}
+
+bool glTexCatalog::FindMappedChart( uint64_t chart, glTexCatalogChart &rec ) const
+{
+    if( !m_map.IsOk() )
+        return false;
+
+    const TexCatalogHeader *hdr = (const TexCatalogHeader *) m_map.GetData();
+    const TexCatalogChartSlot *slots = (const TexCatalogChartSlot *) ( hdr + 1 );
+    uint32_t mask = hdr->nchart_slots - 1;
+
+    //  A damaged table may have no empty slot, so look at each slot at most once
+    size_t i = ChartSlot( chart, mask );
+    for( size_t n = 0; n < hdr->nchart_slots; n++, i = ( i + 1 ) & mask ) {
+        if( slots[i].chart == chart ) {
+            rec = slots[i].rec;
+            return true;
+        }
+        if( slots[i].chart == 0 )
+            return false;
+    }
+    return false;
+}
+
+bool glTexCatalog::FindMappedTile( uint64_t chart, uint32_t tile, glTexCatalogTile &value ) const
+{
+    if( !m_map.IsOk() )
+        return false;
+
+    const TexCatalogHeader *hdr = (const TexCatalogHeader *) m_map.GetData();
+    const TexCatalogTileSlot *slots = (const TexCatalogTileSlot *)
+        ( (const TexCatalogChartSlot *) ( hdr + 1 ) + hdr->nchart_slots );
+    uint32_t mask = hdr->ntile_slots - 1;
+
+    size_t i = TileSlot( chart, tile, mask );
+    for( size_t n = 0; n < hdr->ntile_slots; n++, i = ( i + 1 ) & mask ) {
+        if( slots[i].chart == chart && slots[i].tile == tile ) {
+            value = slots[i].value;
+            return true;
+        }
+        if( slots[i].chart == 0 )
+            return false;
+    }
+    return false;
+}
+
+bool glTexCatalog::FindChart( uint64_t chart, glTexCatalogChart &rec )
+{
+    wxCriticalSectionLocker locker( m_lock );
+
+    std::map<uint64_t, PendingChart>::iterator it = m_pending.find( chart );
+    if( it != m_pending.end() && it->second.b_rec ) {
+        rec = it->second.rec;
+        return true;
+    }
+    return FindMappedChart( chart, rec );
+}
+
+void glTexCatalog::SetChart( uint64_t chart, const glTexCatalogChart &rec )
+{
+    wxCriticalSectionLocker locker( m_lock );
+
+    PendingChart &p = m_pending[chart];
+    p.rec = rec;
+    p.b_rec = true;
+    m_bdirty = true;
+}
+
+void glTexCatalog::ResetChart( uint64_t chart, const glTexCatalogChart &rec )
+{
+    wxCriticalSectionLocker locker( m_lock );
+
+    PendingChart &p = m_pending[chart];
+    p.rec = rec;
+    p.b_rec = true;
+    p.b_reset = true;
+    p.tiles.clear();
+    m_bdirty = true;
+}
+
+bool glTexCatalog::FindTile( uint64_t chart, uint32_t tile, glTexCatalogTile &value )
+{
+    wxCriticalSectionLocker locker( m_lock );
+
+    std::map<uint64_t, PendingChart>::iterator it = m_pending.find( chart );
+    if( it != m_pending.end() ) {
+        glTexCatalogTileHash::iterator t = it->second.tiles.find( (int) tile );
+        if( t != it->second.tiles.end() ) {
+            value = t->second;
+            return true;
+        }
+        if( it->second.b_reset )
+            return false;
+    }
+    return FindMappedTile( chart, tile, value );
+}
+
+void glTexCatalog::AddTile( uint64_t chart, uint32_t tile, const glTexCatalogTile &value )
+{
+    wxCriticalSectionLocker locker( m_lock );
+
+    m_pending[chart].tiles[(int) tile] = value;
+    m_bdirty = true;
+}
+
+//  Merge the pending changes with the mapped catalog into a new file,
+//  and switch over to it.
+bool glTexCatalog::Save()
+{
+    wxCriticalSectionLocker locker( m_lock );
+
+    if( !m_bdirty || m_path.IsEmpty() )
+        return true;
+
+    //  Gather the surviving charts and tiles, of cache files that still exist
+    std::set<uint64_t> live;
+    GatherLiveCharts( live );
+
+    std::map<uint64_t, glTexCatalogChart> charts;
+    std::vector<TexCatalogTileSlot> tiles;
+
+    const TexCatalogHeader *hdr = m_map.IsOk() ? (const TexCatalogHeader *) m_map.GetData() : NULL;
+    if( hdr ) {
+        const TexCatalogChartSlot *cslots = (const TexCatalogChartSlot *) ( hdr + 1 );
+        for( size_t i = 0; i < hdr->nchart_slots; i++ ) {
+            if( cslots[i].chart && live.find( cslots[i].chart ) != live.end() )
+                charts[cslots[i].chart] = cslots[i].rec;
+        }
+    }
+
+    for( std::map<uint64_t, PendingChart>::iterator it = m_pending.begin(); it != m_pending.end(); ++it ) {
+        if( it->second.b_rec && live.find( it->first ) != live.end() )
+            charts[it->first] = it->second.rec;
+    }
+
+    if( hdr ) {
+        const TexCatalogTileSlot *tslots = (const TexCatalogTileSlot *)
+            ( (const TexCatalogChartSlot *) ( hdr + 1 ) + hdr->nchart_slots );
+        tiles.reserve( hdr->ntiles );
+        for( size_t i = 0; i < hdr->ntile_slots; i++ ) {
+            const TexCatalogTileSlot &s = tslots[i];
+            if( !s.chart || charts.find( s.chart ) == charts.end() )
+                continue;
+            std::map<uint64_t, PendingChart>::iterator it = m_pending.find( s.chart );
+            if( it != m_pending.end() &&
+                ( it->second.b_reset || it->second.tiles.find( (int) s.tile ) != it->second.tiles.end() ) )
+                continue;
+            tiles.push_back( s );
+        }
+    }
+
+    for( std::map<uint64_t, PendingChart>::iterator it = m_pending.begin(); it != m_pending.end(); ++it ) {
+        if( charts.find( it->first ) == charts.end() )
+            continue;           // tiles of a chart never registered
+        glTexCatalogTileHash &ptiles = it->second.tiles;
+        for( glTexCatalogTileHash::iterator t = ptiles.begin(); t != ptiles.end(); ++t ) {
+            TexCatalogTileSlot s;
+            s.chart = it->first;
+            s.tile = (uint32_t) t->first;
+            s.value = t->second;
+            s.pad = 0;
+            tiles.push_back( s );
+        }
+    }
+
+    //  Build the new tables
+    TexCatalogHeader nhdr;
+    memset( &nhdr, 0, sizeof( nhdr ) );
+    nhdr.magic = TEXCATALOG_MAGIC;
+    nhdr.nchart_slots = TableSize( charts.size(), TEXCATALOG_MIN_CHARTS );
+    nhdr.ntile_slots = TableSize( tiles.size(), TEXCATALOG_MIN_TILES );
+    nhdr.ncharts = charts.size();
+    nhdr.ntiles = tiles.size();
+
+    std::vector<TexCatalogChartSlot> ctable( nhdr.nchart_slots );
+    memset( &ctable[0], 0, ctable.size() * sizeof( TexCatalogChartSlot ) );
+    for( std::map<uint64_t, glTexCatalogChart>::iterator it = charts.begin(); it != charts.end(); ++it ) {
+        size_t i = ChartSlot( it->first, nhdr.nchart_slots - 1 );
+        while( ctable[i].chart )
+            i = ( i + 1 ) & ( nhdr.nchart_slots - 1 );
+        ctable[i].chart = it->first;
+        ctable[i].rec = it->second;
+    }
+
+    std::vector<TexCatalogTileSlot> ttable( nhdr.ntile_slots );
+    memset( &ttable[0], 0, ttable.size() * sizeof( TexCatalogTileSlot ) );
+    for( size_t j = 0; j < tiles.size(); j++ ) {
+        size_t i = TileSlot( tiles[j].chart, tiles[j].tile, nhdr.ntile_slots - 1 );
+        while( ttable[i].chart )
+            i = ( i + 1 ) & ( nhdr.ntile_slots - 1 );
+        ttable[i] = tiles[j];
+    }
+
+    //  Write it beside the live file, then replace the live file
+    wxString tmp_path = m_path + _T(".tmp");
+    bool ok;
+    {
+        wxFile f( tmp_path, wxFile::write );
+        ok = f.IsOpened() &&
+             f.Write( &nhdr, sizeof( nhdr ) ) == sizeof( nhdr ) &&
+             f.Write( &ctable[0], ctable.size() * sizeof( TexCatalogChartSlot ) ) == ctable.size() * sizeof( TexCatalogChartSlot ) &&
+             f.Write( &ttable[0], ttable.size() * sizeof( TexCatalogTileSlot ) ) == ttable.size() * sizeof( TexCatalogTileSlot );
+    }
+
+    if( !ok ) {
+        wxLogMessage( _T("Failed to write texture cache catalog %s"), tmp_path.c_str() );
+        wxRemoveFile( tmp_path );
+        return false;
+    }
+
+    m_map.Close();
+    if( !wxRenameFile( tmp_path, m_path, true ) ) {
+        wxLogMessage( _T("Failed to replace texture cache catalog %s"), m_path.c_str() );
+        wxRemoveFile( tmp_path );
+        m_map.Open( m_path );
+        return false;
+    }
+
+    m_map.Open( m_path );
+    m_pending.clear();
+    m_bdirty = false;
+    return true;
+}
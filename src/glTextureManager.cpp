@@ -26,6 +26,8 @@
 
 #include <wx/wxprec.h>
 #include <wx/progdlg.h>
+#include <wx/textfile.h>
+#include <algorithm>
 
 #include "viewport.h"
 #include "glTexCache.h"
@@ -116,6 +118,28 @@ wxString CompressedCachePath(wxString path)
     
 }
 
+static wxString TextureCatalogPath()
+{
+    wxChar separator = wxFileName::GetPathSeparator();
+    return g_Platform->GetPrivateDataDir() + separator + _T("raster_texture_cache") + separator + _T("catalog");
+}
+
+//  "running" or "paused", followed by the charts finished so far
+static wxString PrebuildStatePath()
+{
+    wxChar separator = wxFileName::GetPathSeparator();
+    return g_Platform->GetPrivateDataDir() + separator + _T("raster_texture_cache") + separator + _T("prebuild");
+}
+
+//  The key glChartCanvas files a chart's texture factory under
+static wxString TexFactoryKey(wxString path)
+{
+    wxChar separator = wxFileName::GetPathSeparator();
+    for(unsigned int pos = 0; pos < path.size(); pos = path.find(separator, pos))
+        path.replace(pos, 1, _T("!"));
+    return path;
+}
+
 int g_mipmap_max_level = 4;
 
 #if 0
@@ -193,6 +217,11 @@ WX_DECLARE_OBJARRAY(compress_target, ArrayOfCompressTargets);
 
 JobTicket::JobTicket()
 {
+    pthread = NULL;
+    b_located = false;
+    m_priority = 0;
+    b_prebuild = false;
+    m_progress = 0;
     for(int i=0 ; i < 10 ; i++) {
         compcomp_size_array[i] = 0;
         comp_bits_array[i] = NULL;
@@ -423,16 +452,29 @@ bool JobTicket::DoJob()
         
         rect.x = 0;
         for( int x = 0; x < nx_tex; x++ ) {
-            if(!DoJob(rect))
+            if(b_abort)
                 return false;
+
+            //  Tiles already cached are kept, so an interrupted build resumes where it stopped
+            bool b_cached = true;
+            for(int level = 0; level < g_mipmap_max_level + 1 && b_cached; level++)
+                b_cached = pFact->IsLevelInCache(level, rect, global_color_scheme);
+
+            if(!b_cached) {
+                //  Read the bits here, the caller holds the chart locked in the cache
+                level0_bits = (unsigned char *) malloc( rect.width * rect.height * 4 );
+                pBSBChart->GetChartBits( rect, level0_bits, 1 );
+
+                if(!DoJob(rect))
+                    return false;
             
-            pFact->UpdateCacheAllLevels(rect, global_color_scheme, compcomp_bits_array, compcomp_size_array);
+                pFact->UpdateCacheAllLevels(rect, global_color_scheme, compcomp_bits_array, compcomp_size_array);
 
-            for(int i=0 ; i < g_mipmap_max_level+1 ; i++) {
-                free(comp_bits_array[i]), comp_bits_array[i] = 0;
-                free(compcomp_bits_array[i]), compcomp_bits_array[i] = 0;
+                for(int i=0 ; i < g_mipmap_max_level+1 ; i++) {
+                    free(comp_bits_array[i]), comp_bits_array[i] = 0;
+                    free(compcomp_bits_array[i]), compcomp_bits_array[i] = 0;
+                }
             }
-
             
             rect.x += rect.width;
         }
@@ -680,10 +722,12 @@ wxEvent* OCPN_CompressionThreadEvent::Clone() const
 
 
 
-CompressionPoolThread::CompressionPoolThread(JobTicket *ticket, wxEvtHandler *message_target)
+CompressionPoolThread::CompressionPoolThread(glTextureManager *manager, wxEvtHandler *message_target)
+    : wxThread(wxTHREAD_JOINABLE)
 {
+    m_pManager = manager;
     m_pMessageTarget = message_target;
-    m_ticket = ticket;
+    m_ticket = NULL;
     
     Create();
 }
@@ -693,17 +737,30 @@ void * CompressionPoolThread::Entry()
 
 #ifdef __MSVC__
     _set_se_translator(my_translate);
+#endif    
+
+    SetPriority( WXTHREAD_MIN_PRIORITY );
+
+    while( (m_ticket = m_pManager->WaitForJob()) )
+        RunJob();
 
+    return 0;
+}
+
+void CompressionPoolThread::RunJob()
+{
+#ifdef __MSVC__
     //  On Windows, if anything in this thread produces a SEH exception (like access violation)
-    //  we handle the exception locally, and simply alow the thread to exit smoothly with no results.
+    //  we handle the exception locally, and simply abandon the job with no results.
     //  Upstream will notice that nothing got done, and maybe try again later.
     
     try
 #endif    
     {
-    SetPriority( WXTHREAD_MIN_PRIORITY );
+    m_ticket->pthread = this;
 
-    if(!m_ticket->DoJob())
+    //  Jobs cancelled while they waited in the queue cost nothing more
+    if(m_ticket->b_abort || !m_ticket->DoJob())
         m_ticket->b_isaborted = true;
 
     if( m_pMessageTarget ) {
@@ -714,8 +771,6 @@ void * CompressionPoolThread::Entry()
         // from here m_ticket is undefined (if deleted in event handler)
     }
 
-    return 0;
-
     }           // try
     
 #ifdef __MSVC__    
@@ -728,12 +783,10 @@ void * CompressionPoolThread::Entry()
             Nevent.type = 0;
             m_pMessageTarget->QueueEvent(Nevent.Clone());
         }
-        
-        
-        return 0;
     }
 #endif    
     
+    m_ticket = NULL;
 }
 
 //      ProgressInfoItem Implementation
@@ -774,15 +827,55 @@ glTextureManager::glTextureManager()
     m_skip = false;
     m_bcompact = false;
     m_skipout = false;
+    m_bstop_workers = false;
+
+    m_bprebuild = false;
+    m_prebuild_total = 0;
+    m_prebuild_slots = wxMax(m_max_jobs - 1, 1);
+    m_prebuild_calm_ticks = 0;
+
+    //  One tile catalog for all the chart cache files
+    g_glTexCatalog = new glTexCatalog;
+    g_glTexCatalog->Open(TextureCatalogPath());
     
     m_timer.Connect(wxEVT_TIMER, wxTimerEventHandler( glTextureManager::OnTimer ), NULL, this);
     m_timer.Start(500);
+    m_tick_watch.Start();
 }
 
 glTextureManager::~glTextureManager()
 {
 //    ClearAllRasterTextures();
     ClearJobList();
+
+    //  Abort every job in flight, so the workers can be joined promptly
+    wxJobListNode *node = running_list.GetFirst();
+    while(node){
+        node->GetData()->b_abort = true;
+        node = node->GetNext();
+    }
+    StopWorkers();
+
+    //  Completion events for the tickets still listed will never be handled,
+    //  so free them here, with the factories the prebuild jobs own
+    node = running_list.GetFirst();
+    while(node){
+        JobTicket *ticket = node->GetData();
+        for(int i=0 ; i < 10 ; i++) {
+            free(ticket->comp_bits_array[i]);
+            free(ticket->compcomp_bits_array[i]);
+        }
+        if(ticket->b_prebuild)
+            delete ticket->pFact;
+        delete ticket;
+        node = node->GetNext();
+    }
+    running_list.Clear();
+    m_prebuild_jobs.clear();
+
+    g_glTexCatalog->Save();
+    delete g_glTexCatalog;
+    g_glTexCatalog = NULL;
 }
 
 #define NBAR_LENGTH 40
@@ -791,6 +884,25 @@ void glTextureManager::OnEvtThread( OCPN_CompressionThreadEvent & event )
 {
     JobTicket *ticket = event.GetTicket();
 
+    if(ticket->b_prebuild) {
+        if(event.type == 1) {
+            ticket->m_progress = (double)event.nstat / event.nstat_max;
+            return;
+        }
+
+        for(int i=0 ; i < g_mipmap_max_level+1 ; i++) {
+            free(ticket->comp_bits_array[i]);
+            free(ticket->compcomp_bits_array[i]);
+        }
+        FinishPrebuildJob(ticket);
+        running_list.DeleteObject(ticket);
+        delete ticket;
+
+        StartTopJob();
+        PrebuildStep();
+        return;
+    }
+
     if(event.type ==1){
         if(m_progDialog){
             
@@ -889,7 +1001,7 @@ void glTextureManager::OnEvtThread( OCPN_CompressionThreadEvent & event )
         
         if(bthread_debug)
             printf( "    Abort job: %08X  Jobs running: %d             Job count: %lu   \n",
-                    ticket->ident, GetRunningJobCount(), (unsigned long)todo_list.GetCount());
+                    ticket->ident, GetRunningJobCount(), (unsigned long)todo_list.size());
     } else if(!b_inCompressAllCharts) {
         //   Normal completion from here
         glTextureDescriptor *ptd = ticket->pFact->GetpTD( ticket->m_rect );
@@ -918,7 +1030,7 @@ void glTextureManager::OnEvtThread( OCPN_CompressionThreadEvent & event )
 
         if(bthread_debug)
             printf( "    Finished job: %08X  Jobs running: %d             Job count: %lu   \n",
-                    ticket->ident, GetRunningJobCount(), (unsigned long)todo_list.GetCount());
+                    ticket->ident, GetRunningJobCount(), (unsigned long)todo_list.size());
     }
 
     //      Free all possible memory
@@ -944,9 +1056,32 @@ void glTextureManager::OnEvtThread( OCPN_CompressionThreadEvent & event )
     }
 }
 
+#define CATALOG_SAVE_TICKS      120     // one minute of 500 ms timer ticks
+#define PREBUILD_RESUME_TICKS   20
+
 void glTextureManager::OnTimer(wxTimerEvent &event)
 {
     m_ticks++;
+
+    //  Drop work for tiles the viewport has moved away from
+    if(running_list.GetCount() || todo_list.size())
+        PrioritizeJobs();
+
+    //  Persist new cache tiles now and then, not on every one
+    if((m_ticks % CATALOG_SAVE_TICKS) == 0 && g_glTexCatalog->IsDirty())
+        g_glTexCatalog->Save();
+
+    //  Pick up a background prebuild interrupted by the last shutdown,
+    //  once the charts are loaded
+    if(m_ticks == PREBUILD_RESUME_TICKS && !m_bprebuild) {
+        wxTextFile state(PrebuildStatePath());
+        if(state.Exists() && state.Open() && state.GetLineCount() &&
+           state.GetFirstLine() == _T("running"))
+            StartPrebuild();
+    }
+
+    ThrottlePrebuild();
+    PrebuildStep();
     
     //  Scrub all the TD's, looking for any completed compression jobs
     //  that have finished
@@ -993,27 +1128,25 @@ bool glTextureManager::ScheduleJob(glTexFactory* client, const wxRect &rect, int
 {
     wxString chart_path = client->GetChartPath();
     if(!b_nolimit) {
-        if(todo_list.GetCount() >= 50){
+        if(todo_list.size() >= 50){
             // remove last job which is least important
-            wxJobListNode *node = todo_list.GetLast();
-            JobTicket *ticket = node->GetData();
-            todo_list.DeleteNode(node);
-            delete ticket;
+            PrioritizeJobs();
+            if(todo_list.size() >= 50) {
+                delete todo_list.back();
+                todo_list.pop_back();
+            }
         }
 
     //  Avoid adding duplicate jobs, i.e. the same chart_path, and the same rectangle
-        wxJobListNode *node = todo_list.GetFirst();
-        while(node){
-            JobTicket *ticket = node->GetData();
+        for(size_t i = 0; i < todo_list.size(); i++) {
+            JobTicket *ticket = todo_list[i];
             if( (ticket->m_ChartPath == chart_path) && (ticket->m_rect == rect)) {
                 // bump to front
-                todo_list.DeleteNode(node);
-                todo_list.Insert(ticket);
+                todo_list.erase(todo_list.begin() + i);
+                todo_list.insert(todo_list.begin(), ticket);
                 ticket->level_min_request = level;
                 return false;
             }
-        
-            node = node->GetNext();
         }
 
         // avoid duplicate worker jobs
@@ -1043,6 +1176,10 @@ bool glTextureManager::ScheduleJob(glTexFactory* client, const wxRect &rect, int
     pt->bpost_zip_compress = b_postZip;
     pt->binplace = b_inplace;
 
+    //  Viewport driven jobs are ranked by where their tile lies
+    if(!b_nolimit)
+        pt->b_located = client->GetTileCenter(rect, pt->m_lat, pt->m_lon, pt->m_radius);
+
     /* do we compress in ram using builtin libraries, or do we
        upload to the gpu and use the driver to perform compression?
        we have builtin libraries for DXT1 (squish) and ETC1 (etcpak)
@@ -1054,11 +1191,11 @@ bool glTextureManager::ScheduleJob(glTexFactory* client, const wxRect &rect, int
     we can use multiple threads to take advantage of multiple cores */
 
     if(g_raster_format != GL_COMPRESSED_RGB_FXT1_3DFX) {
-        todo_list.Insert(pt); // push to front as a stack
+        todo_list.insert(todo_list.begin(), pt); // push to front as a stack
         if(bthread_debug){
             int mem_used;
             GetMemoryStatus(0, &mem_used);
-            printf( "Adding job: %08X  Job Count: %lu  mem_used %d\n", pt->ident, (unsigned long)todo_list.GetCount(), mem_used);
+            printf( "Adding job: %08X  Job Count: %lu  mem_used %d\n", pt->ident, (unsigned long)todo_list.size(), mem_used);
         }
  
         StartTopJob();
@@ -1081,17 +1218,19 @@ bool glTextureManager::ScheduleJob(glTexFactory* client, const wxRect &rect, int
 
 bool glTextureManager::StartTopJob()
 {
-    wxJobListNode *node = todo_list.GetFirst();
-    if(!node)
+    if(todo_list.empty())
         return false;
 
-    JobTicket *ticket = node->GetData();
-
     //  Is it possible to start another job?
-    if(GetRunningJobCount() >= wxMax(m_max_jobs - ticket->b_throttle, 1))
+    if(GetRunningJobCount() >= wxMax(m_max_jobs - todo_list.front()->b_throttle, 1))
         return false;
 
-    todo_list.DeleteNode(node);
+    PrioritizeJobs();
+    if(todo_list.empty())
+        return false;
+
+    JobTicket *ticket = todo_list.front();
+    todo_list.erase(todo_list.begin());
 
     glTextureDescriptor *ptd = ticket->pFact->GetpTD( ticket->m_rect );
     // don't need the job if we already have the compressed data
@@ -1123,18 +1262,145 @@ bool glTextureManager::StartTopJob()
 bool glTextureManager::DoThreadJob(JobTicket* pticket)
 {
     if(bthread_debug)
-        printf( "  Starting job: %08X  Jobs running: %d Jobs left: %lu\n", pticket->ident, GetRunningJobCount(), (unsigned long)todo_list.GetCount());
+        printf( "  Starting job: %08X  Jobs running: %d Jobs left: %lu\n", pticket->ident, GetRunningJobCount(), (unsigned long)todo_list.size());
     
-///    qDebug() << "Starting job" << GetRunningJobCount() <<  (unsigned long)todo_list.GetCount() << g_tex_mem_used;
-    CompressionPoolThread *t = new CompressionPoolThread( pticket, this);
-    pticket->pthread = t;
-    
-    t->Run();
+///    qDebug() << "Starting job" << GetRunningJobCount() <<  (unsigned long)todo_list.size() << g_tex_mem_used;
+    if(m_workers.empty())
+        StartWorkers();
+
+    {
+        wxCriticalSectionLocker locker(m_ready_lock);
+        m_ready_list.push_back(pticket);
+    }
+    m_ready_semaphore.Post();
     
     return true;
     
 }
 
+JobTicket *glTextureManager::WaitForJob()
+{
+    m_ready_semaphore.Wait();
+
+    wxCriticalSectionLocker locker(m_ready_lock);
+    if(m_bstop_workers || m_ready_list.empty())
+        return NULL;
+
+    JobTicket *ticket = m_ready_list.front();
+    m_ready_list.pop_front();
+    return ticket;
+}
+
+void glTextureManager::StartWorkers()
+{
+    for(int i=0 ; i < m_max_jobs ; i++) {
+        CompressionPoolThread *t = new CompressionPoolThread( this, this);
+        if(t->Run() != wxTHREAD_NO_ERROR) {
+            delete t;
+            continue;
+        }
+        m_workers.push_back(t);
+    }
+}
+
+//  Let running jobs finish, then join the workers.
+//  Jobs marked b_abort give up at their next check.
+void glTextureManager::StopWorkers()
+{
+    {
+        wxCriticalSectionLocker locker(m_ready_lock);
+        m_bstop_workers = true;
+    }
+    for(size_t i=0 ; i < m_workers.size() ; i++)
+        m_ready_semaphore.Post();
+
+    for(size_t i=0 ; i < m_workers.size() ; i++) {
+        m_workers[i]->Wait();
+        delete m_workers[i];
+    }
+    m_workers.clear();
+
+    //  Tickets never picked up are still on the running list, their owner frees them
+    m_ready_list.clear();
+}
+
+#define JOB_CANCEL_DISTANCE     2.0     // viewport half diagonals beyond the viewport edge
+
+static bool CompareJobPriority(const JobTicket *a, const JobTicket *b)
+{
+    return a->m_priority < b->m_priority;
+}
+
+//  Distance from the viewport centre to the nearest point of a job's tile,
+//  in viewport half diagonals
+static double JobDistance(const JobTicket *ticket, ViewPort &vp, double coslat, double half_diag)
+{
+    double dlat = ticket->m_lat - vp.clat;
+    double dlon = ticket->m_lon - vp.clon;
+    while(dlon > 180.)
+        dlon -= 360.;
+    while(dlon < -180.)
+        dlon += 360.;
+    dlon *= coslat;
+
+    return wxMax(sqrt(dlat*dlat + dlon*dlon) - ticket->m_radius, 0.) / half_diag;
+}
+
+//  Sort the pending jobs so that tiles nearest the viewport centre, and finer
+//  mip levels among those, are compressed first.  Jobs without a known tile keep
+//  their stack order ahead of them.  Jobs for tiles the viewport has moved well
+//  away from are dropped if pending, and aborted if running.
+void glTextureManager::PrioritizeJobs()
+{
+    if(!cc1 || b_inCompressAllCharts)
+        return;
+
+    ViewPort &vp = cc1->GetVP();
+    LLBBox &box = vp.GetBBox();
+    if(!box.GetValid())
+        return;
+
+    double coslat = cos(vp.clat * PI / 180.);
+    double dlat = box.GetMaxLat() - box.GetMinLat();
+    double dlon = (box.GetMaxLon() - box.GetMinLon()) * coslat;
+    double half_diag = sqrt(dlat*dlat + dlon*dlon) / 2;
+    if(!(half_diag > 0))
+        return;
+
+    size_t n = 0;
+    for(size_t i = 0; i < todo_list.size(); i++) {
+        JobTicket *ticket = todo_list[i];
+        if(!ticket->b_located) {
+            ticket->m_priority = -1;
+            todo_list[n++] = ticket;
+            continue;
+        }
+
+        double distance = JobDistance(ticket, vp, coslat, half_diag);
+        if(distance > 1. + JOB_CANCEL_DISTANCE) {
+            if(bthread_debug)
+                printf("Pool:  Drop pending job %08X, out of view\n", ticket->ident);
+            delete ticket;
+            continue;
+        }
+
+        ticket->m_priority = distance + .25 * ticket->level_min_request;
+        todo_list[n++] = ticket;
+    }
+    todo_list.resize(n);
+
+    std::stable_sort(todo_list.begin(), todo_list.end(), CompareJobPriority);
+
+    wxJobListNode *node = running_list.GetFirst();
+    while(node){
+        JobTicket *ticket = node->GetData();
+        if(ticket->b_located && !ticket->b_abort &&
+           JobDistance(ticket, vp, coslat, half_diag) > 1. + JOB_CANCEL_DISTANCE)
+            ticket->b_abort = true;
+        node = node->GetNext();
+    }
+}
+
 bool glTextureManager::AsJob( wxString const &chart_path ) const
 {
     if(chart_path.Len()){    
@@ -1154,20 +1420,18 @@ void glTextureManager::PurgeJobList( wxString chart_path )
 {
     if(chart_path.Len()){    
         //  Remove all pending jobs relating to the passed chart path
-        wxJobListNode *tnode = todo_list.GetFirst();
-        while(tnode){
-            JobTicket *ticket = tnode->GetData();
+        size_t n = 0;
+        for(size_t i = 0; i < todo_list.size(); i++) {
+            JobTicket *ticket = todo_list[i];
             if(ticket->m_ChartPath.IsSameAs(chart_path)){
                 if(bthread_debug)
                     printf("Pool:  Purge pending job for purged chart\n");
-                todo_list.DeleteNode(tnode);
                 delete ticket;
-                tnode = todo_list.GetFirst();  // restart the list
-            }
-            else{
-                tnode = tnode->GetNext();
             }
+            else
+                todo_list[n++] = ticket;
         }
+        todo_list.resize(n);
 
         wxJobListNode *node = running_list.GetFirst();
         while(node){
@@ -1179,18 +1443,12 @@ void glTextureManager::PurgeJobList( wxString chart_path )
         }
             
         if(bthread_debug)
-            printf("Pool:  Purge, todo count: %lu\n", (long unsigned)todo_list.GetCount());
+            printf("Pool:  Purge, todo count: %lu\n", (long unsigned)todo_list.size());
     }
     else {
-        wxJobListNode *node = todo_list.GetFirst();
-        while(node){
-            JobTicket *ticket = node->GetData();
-            delete ticket;
-            node = node->GetNext();
-        }
-        todo_list.Clear();
+        ClearJobList();
         //  Mark all running tasks for "abort"
-        node = running_list.GetFirst();
+        wxJobListNode *node = running_list.GetFirst();
         while(node){
             JobTicket *ticket = node->GetData();
             ticket->b_abort = true;
@@ -1201,16 +1459,24 @@ void glTextureManager::PurgeJobList( wxString chart_path )
 
 void glTextureManager::ClearJobList()
 {
-    wxJobListNode *node = todo_list.GetFirst();
-    while(node){
-        JobTicket *ticket = node->GetData();
-        delete ticket;
-        node = node->GetNext();
-    }
-    todo_list.Clear();
+    for(size_t i = 0; i < todo_list.size(); i++)
+        delete todo_list[i];
+    todo_list.clear();
 }
 
 
+//  Abort every job, and wait until the workers have let go of them,
+//  so nothing is writing to the cache files any more
+void glTextureManager::AbortAllJobs()
+{
+    PurgeJobList();
+
+    while(GetRunningJobCount() || m_prebuild_jobs.size()) {
+        wxThread::Sleep(1);
+        ::wxYield();
+    }
+}
+
 void glTextureManager::ClearAllRasterTextures( void )
 {
     
@@ -1409,6 +1675,12 @@ void glTextureManager::BuildCompressedCache()
     b_inCompressAllCharts = true;
     PurgeJobList();
     ClearAllRasterTextures();
+
+    //  Background prebuild jobs hold texture factories of their own
+    while(m_prebuild_jobs.size()) {
+        wxThread::Sleep(1);
+        ::wxYield();
+    }
     
     //  Build another array of sorted compression targets.
     //  We need to do this, as the chart table will not be invariant
@@ -1590,3 +1862,240 @@ void glTextureManager::BuildCompressedCache()
     m_progDialog = NULL;
 }
 
+
+//  Background cache prebuild
+//
+//  Whole chart jobs for every raster chart, nearest to ownship first, run on
+//  the worker pool beside the viewport driven jobs.  They give way to those
+//  jobs, to charts on display, and to a busy main thread.
+
+static bool IsChartDisplayed(wxString chart_path)
+{
+    if(Current_Ch && Current_Ch->GetFullPath() == chart_path)
+        return true;
+    if(cc1 && cc1->GetQuiltMode() && cc1->m_pQuilt && cc1->m_pQuilt->IsChartInQuilt(chart_path))
+        return true;
+
+    ChartPathHashTexfactType &hash = g_glTextureManager->m_chart_texfactory_hash;
+    return hash.find(TexFactoryKey(chart_path)) != hash.end();
+}
+
+void glTextureManager::StartPrebuild()
+{
+    if(m_bprebuild || !ChartData)
+        return;
+
+    //  FXT1 is compressed by the driver, on the main thread only
+    if(!g_GLOptions.m_bTextureCompression || !g_GLOptions.m_bTextureCompressionCaching ||
+       g_raster_format == GL_RGB || g_raster_format == GL_COMPRESSED_RGB_FXT1_3DFX)
+        return;
+
+    //  Charts finished by an earlier run
+    m_prebuild_done.clear();
+    wxTextFile state(PrebuildStatePath());
+    if(state.Exists() && state.Open()) {
+        for(size_t i = 1; i < state.GetLineCount(); i++)
+            m_prebuild_done.insert(state.GetLine(i));
+        state.Close();
+    }
+
+    idx_sorted_by_distance.Clear();
+    for(int i = 0; i<ChartData->GetChartTableEntries(); i++) {
+        const ChartTableEntry &cte = ChartData->GetChartTableEntry(i);
+        if((ChartTypeEnum)cte.GetChartType() == CHART_TYPE_KAP)
+            idx_sorted_by_distance.Add(i);
+    }
+
+    //  Paths rather than indices, the chart table may change under us
+    m_prebuild_todo.clear();
+    m_prebuild_total = idx_sorted_by_distance.GetCount();
+    for(int j = m_prebuild_total - 1; j >= 0; j--) {
+        const ChartTableEntry &cte = ChartData->GetChartTableEntry(idx_sorted_by_distance.Item(j));
+        wxString chart_path(cte.GetpFullPath(), wxConvUTF8);
+        if(m_prebuild_done.find(chart_path) == m_prebuild_done.end())
+            m_prebuild_todo.push_back(chart_path);
+    }
+    idx_sorted_by_distance.Clear();
+
+    wxLogMessage(wxString::Format(_T("Texture cache prebuild: %d of %d charts to do"),
+                                  (int)m_prebuild_todo.size(), m_prebuild_total));
+
+    m_bprebuild = true;
+    WritePrebuildState();
+    PrebuildStep();
+}
+
+//  Running jobs stop at their next tile; what they finished stays in the cache
+void glTextureManager::StopPrebuild()
+{
+    if(!m_bprebuild)
+        return;
+
+    m_bprebuild = false;
+    m_prebuild_todo.clear();
+    for(size_t i = 0; i < m_prebuild_jobs.size(); i++)
+        m_prebuild_jobs[i]->b_abort = true;
+
+    WritePrebuildState();
+}
+
+PrebuildProgress glTextureManager::GetPrebuildProgress() const
+{
+    PrebuildProgress p;
+    p.b_running = m_bprebuild;
+    p.charts_total = m_prebuild_total;
+    p.charts_done = m_prebuild_total - (int)m_prebuild_todo.size() - (int)m_prebuild_jobs.size();
+
+    double done = p.charts_done;
+    for(size_t i = 0; i < m_prebuild_jobs.size(); i++)
+        done += m_prebuild_jobs[i]->m_progress;
+    p.fraction = m_prebuild_total ? done / m_prebuild_total : 0.;
+
+    return p;
+}
+
+//  The display wants a chart a prebuild job is working on.  Ask the job
+//  to stop, since there must be only one texture factory per chart.
+bool glTextureManager::ReleasePrebuildChart( const wxString &chart_path )
+{
+    for(size_t i = 0; i < m_prebuild_jobs.size(); i++) {
+        if(m_prebuild_jobs[i]->m_ChartPath == chart_path) {
+            m_prebuild_jobs[i]->b_abort = true;
+            return true;
+        }
+    }
+    return false;
+}
+
+void glTextureManager::WritePrebuildState()
+{
+    wxFileName fn(PrebuildStatePath());
+    if(!fn.DirExists())
+        fn.Mkdir();
+
+    wxFFile f(PrebuildStatePath(), _T("w"));
+    if(!f.IsOpened())
+        return;
+
+    f.Write(m_bprebuild ? _T("running\n") : _T("paused\n"));
+    for(std::set<wxString>::iterator it = m_prebuild_done.begin(); it != m_prebuild_done.end(); ++it)
+        f.Write(*it + _T("\n"));
+}
+
+//  Timer ticks that arrive late mean the main thread is starved, so run fewer jobs
+void glTextureManager::ThrottlePrebuild()
+{
+    long interval = m_tick_watch.Time();
+    m_tick_watch.Start();
+
+    int max_slots = wxMax(m_max_jobs - 1, 1);
+    if(interval > 750) {
+        m_prebuild_calm_ticks = 0;
+        m_prebuild_slots = wxMax(m_prebuild_slots - 1, 0);
+
+        //  Stop the newest job beyond the allowance, it resumes from the cache later
+        if((int)m_prebuild_jobs.size() > m_prebuild_slots)
+            m_prebuild_jobs.back()->b_abort = true;
+    }
+    else if(++m_prebuild_calm_ticks >= 10) {
+        m_prebuild_calm_ticks = 0;
+        m_prebuild_slots = wxMin(m_prebuild_slots + 1, max_slots);
+    }
+}
+
+void glTextureManager::PrebuildStep()
+{
+    if(!m_bprebuild || b_inCompressAllCharts || !ChartData)
+        return;
+
+    if(m_prebuild_todo.empty() && m_prebuild_jobs.empty()) {
+        wxLogMessage(_T("Texture cache prebuild complete"));
+        m_bprebuild = false;
+        m_prebuild_done.clear();
+        wxRemoveFile(PrebuildStatePath());
+        return;
+    }
+
+    //  Viewport jobs come first, make room for them
+    if(todo_list.size()) {
+        if(GetRunningJobCount() >= m_max_jobs && m_prebuild_jobs.size())
+            m_prebuild_jobs.back()->b_abort = true;
+        return;
+    }
+
+    //  Nearest first, passing over charts on display
+    for(int i = m_prebuild_todo.size() - 1;
+        i >= 0 && (int)m_prebuild_jobs.size() < m_prebuild_slots; i--) {
+        wxString chart_path = m_prebuild_todo[i];
+        if(IsChartDisplayed(chart_path))
+            continue;
+
+        m_prebuild_todo.erase(m_prebuild_todo.begin() + i);
+        StartPrebuildJob(chart_path);
+    }
+}
+
+bool glTextureManager::StartPrebuildJob( const wxString &chart_path )
+{
+    ChartBase *pchart = ChartData->OpenChartFromDBAndLock( chart_path, FULL_INIT );
+    ChartBaseBSB *pBSBChart = dynamic_cast<ChartBaseBSB*>( pchart );
+    if(!pBSBChart) {
+        //  Probably a corrupt chart, don't try again
+        if(pchart)
+            ChartData->DeleteCacheChart(pchart);
+        m_prebuild_done.insert(chart_path);
+        return false;
+    }
+
+    JobTicket *pt = new JobTicket;
+    pt->pFact = new glTexFactory(pchart, g_raster_format);
+    pt->m_rect = wxRect();
+    pt->level_min_request = 0;
+    pt->ident = 0;
+    pt->b_throttle = true;
+    pt->m_ChartPath = chart_path;
+    pt->level0_bits = NULL;
+    pt->b_abort = false;
+    pt->b_isaborted = false;
+    pt->bpost_zip_compress = true;
+    pt->binplace = false;
+    pt->b_prebuild = true;
+
+    m_prebuild_jobs.push_back(pt);
+    running_list.Append(pt);
+    DoThreadJob(pt);
+
+    return true;
+}
+
+void glTextureManager::FinishPrebuildJob( JobTicket *ticket )
+{
+    m_prebuild_jobs.erase(std::find(m_prebuild_jobs.begin(), m_prebuild_jobs.end(), ticket));
+    delete ticket->pFact;
+
+    //  Release our hold on the chart, and free it unless it is wanted for display
+    if(ChartData->IsChartInCache(ticket->m_ChartPath)) {
+        if(IsChartDisplayed(ticket->m_ChartPath))
+            ChartData->UnLockCacheChart(ChartData->FinddbIndex(ticket->m_ChartPath));
+        else
+            ChartData->DeleteCacheChart(ChartData->OpenChartFromDB(ticket->m_ChartPath, FULL_INIT));
+    }
+
+    if(ticket->b_isaborted || ticket->b_abort) {
+        //  Try again later, after the others
+        if(m_bprebuild)
+            m_prebuild_todo.insert(m_prebuild_todo.begin(), ticket->m_ChartPath);
+
+        //  The display may have been waiting for this chart
+        if(cc1) {
+            glChartCanvas::Invalidate();
+            cc1->Refresh();
+        }
+        return;
+    }
+
+    m_prebuild_done.insert(ticket->m_ChartPath);
+    wxFFile f(PrebuildStatePath(), _T("a"));
+    if(f.IsOpened())
+        f.Write(ticket->m_ChartPath + _T("\n"));
+}
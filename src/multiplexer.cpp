@@ -30,6 +30,9 @@
 #include "NMEALogWindow.h"
 #include "garmin/jeeps/garmin_wrapper.h"
 #include "OCPN_DataStreamEvent.h"
+#include "SentenceRing.h"
+
+#define MUX_SENTENCE_BATCH      32      // queued sentences handled per event
 
 extern PlugInManager    *g_pi_manager;
 extern wxString         g_GPS_Ident;
@@ -47,7 +50,9 @@ Multiplexer::Multiplexer()
 {
     m_aisconsumer = NULL;
     m_gpsconsumer = NULL;
+    m_routes_serial = -1;
     Connect(wxEVT_OCPN_DATASTREAM, (wxObjectEventFunction)(wxEventFunction)&Multiplexer::OnEvtStream);
+    Connect(wxEVT_OCPN_DATASTREAMQUEUE, (wxObjectEventFunction)(wxEventFunction)&Multiplexer::OnEvtStreamQueue);
     m_pdatastreams = new wxArrayOfDataStreams();
 }
 
@@ -60,6 +65,7 @@ Multiplexer::~Multiplexer()
 void Multiplexer::AddStream(DataStream *stream)
 {
     m_pdatastreams->Add(stream);
+    m_routes.clear();
 }
 
 void Multiplexer::StopAllStreams()
@@ -77,6 +83,7 @@ void Multiplexer::ClearStreams()
         delete m_pdatastreams->Item(i);         // Implicit Close(), see datastream dtor
     }
     m_pdatastreams->Clear();
+    m_routes.clear();
 }
 
 DataStream *Multiplexer::FindStream(const wxString & port)
@@ -100,6 +107,7 @@ void Multiplexer::StopAndRemoveStream( DataStream *stream )
         if( wxNOT_FOUND != index )
             m_pdatastreams->RemoveAt( index );
     }
+    m_routes.clear();
 }
 
 void Multiplexer::StartAllStreams( void )
@@ -244,32 +252,137 @@ void Multiplexer::SetGPSHandler(wxEvtHandler *handler)
     m_gpsconsumer = handler;
 }
 
+//      Drain a batch of sentences queued by a stream's RX thread.
+//      The batch size bounds the time spent here per event, so that a busy stream
+//      cannot starve the GUI.  If more remain, come back through the event queue.
+void Multiplexer::OnEvtStreamQueue(OCPN_DataStreamEvent& event)
+{
+    DataStream *stream = event.GetStream();
+    if( !stream || ( wxNOT_FOUND == m_pdatastreams->Index( stream ) ) )
+        return;                                 // stream closed meanwhile
+
+    SentenceRing *ring = stream->GetSentenceRing();
+    if( !ring )
+        return;
+
+    unsigned long drops = ring->TakeDropCount();
+    if( drops ) {
+        wxString msg;
+        msg.Printf(_T("Input queue full, %lu sentences dropped"), drops);
+        LogInputMessage( msg, stream->GetPort(), false, true );
+    }
+
+    bool b_more;
+    size_t n = ring->GetBatch( m_sentence_batch, MUX_SENTENCE_BATCH, &b_more );
+
+    for( size_t i = 0; i < n; i++ ) {
+        OCPN_DataStreamEvent Nevent(wxEVT_OCPN_DATASTREAM, 0);
+        Nevent.SetNMEAString( m_sentence_batch[i] );
+        Nevent.SetStream( stream );
+        OnEvtStream( Nevent );
+    }
+
+    if( b_more )
+        AddPendingEvent( event );
+}
+
+//      Sentences sent to the AIS consumer, by position and length within the sentence key
+static const struct {
+    size_t offset;
+    size_t length;
+    const char *id;
+} s_ais_sentences[] = {
+    { 2, 3, "VDM" },
+    { 0, 5, "FRPOS" },
+    { 0, 2, "CD" },
+    { 2, 3, "TLL" },
+    { 2, 3, "TTM" },
+    { 2, 3, "OSD" }
+};
+
+#define MUX_ROUTE_TABLE_MAX     1024    // distinct keys cached, guards against garbage input
+
+MuxRoute Multiplexer::GetRoute(const char *key)
+{
+    //  Any change to streams or their filters invalidates the table
+    if( m_routes_serial != DataStream::GetFilterSerial() || m_routes.size() > MUX_ROUTE_TABLE_MAX ) {
+        m_routes.clear();
+        m_routes_serial = DataStream::GetFilterSerial();
+    }
+
+    wxUint64 hash = 0;
+    for( size_t i = 0; i < DS_SENTENCE_KEY_LENGTH; i++ )
+        hash = ( hash << 8 ) | (unsigned char)key[i];
+
+    MuxRouteTable::iterator it = m_routes.find( hash );
+    if( it != m_routes.end() )
+        return it->second;
+
+    MuxRoute route;
+    route.b_ais = false;
+    for( size_t i = 0; i < sizeof(s_ais_sentences) / sizeof(s_ais_sentences[0]); i++ ) {
+        if( !strncmp( key + s_ais_sentences[i].offset, s_ais_sentences[i].id, s_ais_sentences[i].length ) ) {
+            route.b_ais = true;
+            break;
+        }
+    }
+    route.b_wpl = !strncmp( key + 2, "WPL", 3 );
+
+    route.input_pass = 0;
+    route.output_pass = 0;
+    route.b_checksum_ok = false;
+    for( size_t i = 0; i < m_pdatastreams->Count() && i < MUX_ROUTE_STREAMS; i++ ) {
+        DataStream *s = m_pdatastreams->Item(i);
+        if( s->SentencePassesFilter( key, FILTER_INPUT ) )
+            route.input_pass |= 1U << i;
+        if( s->SentencePassesFilter( key, FILTER_OUTPUT ) )
+            route.output_pass |= 1U << i;
+    }
+
+    m_routes[hash] = route;
+    return route;
+}
+
+bool Multiplexer::StreamPassesFilter(const MuxRoute &route, size_t index, DataStream *stream,
+                                     const char *key, FilterDirection direction)
+{
+    if( index < MUX_ROUTE_STREAMS && index < m_pdatastreams->Count() && m_pdatastreams->Item(index) == stream ) {
+        wxUint32 mask = ( direction == FILTER_INPUT ) ? route.input_pass : route.output_pass;
+        return ( mask >> index ) & 1;
+    }
+    return stream->SentencePassesFilter( key, direction );
+}
+
 void Multiplexer::OnEvtStream(OCPN_DataStreamEvent& event)
 {
     wxString message = event.ProcessNMEA4Tags();
     
     DataStream *stream = event.GetStream();
-    wxString port(_T("Virtual:"));
-    if( stream )
-        port = wxString(stream->GetPort());
+    static const wxString virtual_port(_T("Virtual:"));
+    const wxString &port = stream ? stream->GetPort() : virtual_port;
+    const std::string &nmea = event.GetNMEAString();
 
     if( !message.IsEmpty() )
     {
+        char key[DS_SENTENCE_KEY_LENGTH];
+        GetSentenceKey( message, key );
+        MuxRoute route = GetRoute( key );
+
+        //  Real streams check as configured, virtual ones (PlugIns) always
+        route.b_checksum_ok = stream ? stream->ChecksumOK( nmea ) : CheckSumCheck( nmea );
+
         //Send to core consumers
         //if it passes the source's input filter
         //  If there is no datastream, as for PlugIns, then pass everything
         bool bpass = true;
-        if( stream )
-            bpass = stream->SentencePassesFilter( message, FILTER_INPUT );
+        if( stream ) {
+            int index = m_pdatastreams->Index( stream );
+            bpass = StreamPassesFilter( route, ( index == wxNOT_FOUND ) ? MUX_ROUTE_STREAMS : index,
+                                        stream, key, FILTER_INPUT );
+        }
 
         if( bpass ) {
-            if( message.Mid(3,3).IsSameAs(_T("VDM")) ||
-                message.Mid(1,5).IsSameAs(_T("FRPOS")) ||
-                message.Mid(1,2).IsSameAs(_T("CD")) ||
-                message.Mid(3,3).IsSameAs(_T("TLL")) ||
-                message.Mid(3,3).IsSameAs(_T("TTM")) ||
-                message.Mid(3,3).IsSameAs(_T("OSD")) ||
-                ( g_bWplIsAprsPosition && message.Mid(3,3).IsSameAs(_T("WPL")) ) )
+            if( route.b_ais || ( g_bWplIsAprsPosition && route.b_wpl ) )
             {
                 if( m_aisconsumer )
                     m_aisconsumer->AddPendingEvent(event);
@@ -284,17 +397,8 @@ void Multiplexer::OnEvtStream(OCPN_DataStreamEvent& event)
         if ((g_b_legacy_input_filter_behaviour && !bpass) || bpass) {
 
             //Send to plugins
-            if ( g_pi_manager ){
-                if(stream){                     // Is this a real or a virtual stream?
-                    if( stream->ChecksumOK(event.GetNMEAString()) )
-                        g_pi_manager->SendNMEASentenceToAllPlugIns( message );
-                }
-                else{
-                    if( CheckSumCheck(event.GetNMEAString()) )
-                        g_pi_manager->SendNMEASentenceToAllPlugIns( message );
-                }
-                    
-            }
+            if ( g_pi_manager && route.b_checksum_ok )
+                g_pi_manager->SendNMEASentenceToAllPlugIns( message );
 
            //Send to all the other outputs
             for (size_t i = 0; i < m_pdatastreams->Count(); i++)
@@ -305,8 +409,10 @@ void Multiplexer::OnEvtStream(OCPN_DataStreamEvent& event)
                         if ( s->GetIoSelect() == DS_TYPE_INPUT_OUTPUT || s->GetIoSelect() == DS_TYPE_OUTPUT ) {
                             bool bout_filter = true;
 
+                            //  A sentence failing its stream's checksum check is not relayed
                             bool bxmit_ok = true;
-                            if(s->SentencePassesFilter( message, FILTER_OUTPUT ) ) {
+                            if( ( !stream || route.b_checksum_ok )
+                                    && StreamPassesFilter( route, i, s, key, FILTER_OUTPUT ) ) {
                                 bxmit_ok = s->SendSentence(message);
                                 bout_filter = false;
                             }
@@ -329,11 +435,10 @@ void Multiplexer::OnEvtStream(OCPN_DataStreamEvent& event)
             //Send to the Debug Window, if open
             //  Special formatting for non-printable characters helps debugging NMEA problems
         if (NMEALogWindow::Get().Active()) {
-            std::string str= event.GetNMEAString();    
             wxString fmsg;
             
             bool b_error = false;
-            for ( std::string::iterator it=str.begin(); it!=str.end(); ++it){
+            for ( std::string::const_iterator it=nmea.begin(); it!=nmea.end(); ++it){
                 if(isprint(*it))
                     fmsg += *it;
                 else{
@@ -126,19 +126,32 @@
  * messages cannot be longer than 2000 chars... which is quite reasonable
  * (that's 25 lines of 80 chars!!!)
  */
-static char gszCPLLastErrMsg[2000] = "";
-static int  gnCPLLastErrNo = 0;
-static CPLErr geCPLLastErrType = CE_None;
+static CPL_THREADLOCAL char gszCPLLastErrMsg[2000] = "";
+static CPL_THREADLOCAL int  gnCPLLastErrNo = 0;
+static CPL_THREADLOCAL CPLErr geCPLLastErrType = CE_None;
 
 static CPLErrorHandler gpfnCPLErrorHandler = CPLDefaultErrorHandler;
 
+/* Handlers pushed by CPLPushErrorHandler() are private to the pushing
+ * thread, so that cells may be ingested on several threads at once.
+ * Each node holds the handler that was pushed; with an empty stack the
+ * process wide handler set by CPLSetErrorHandler() is used.
+ */
 typedef struct errHandler
 {
     struct errHandler   *psNext;
     CPLErrorHandler     pfnHandler;
 } CPLErrorHandlerNode;
 
-static CPLErrorHandlerNode * psHandlerStack = NULL;
+static CPL_THREADLOCAL CPLErrorHandlerNode * psHandlerStack = NULL;
+
+static CPLErrorHandler CPLGetActiveErrorHandler()
+{
+    if( psHandlerStack != NULL )
+        return psHandlerStack->pfnHandler;
+
+    return gpfnCPLErrorHandler;
+}
 
 /**********************************************************************
  *                          CPLError()
@@ -210,8 +223,9 @@ void    CPLErrorV(CPLErr eErrClass, int err_no, const char *fmt, va_list args )
     if( CPLGetConfigOption("CPL_LOG_ERRORS",NULL) != NULL )
         CPLDebug( "CPLError", "%s", gszCPLLastErrMsg );
 
-    if( gpfnCPLErrorHandler )
-        gpfnCPLErrorHandler(eErrClass, err_no, gszCPLLastErrMsg);
+    CPLErrorHandler pfnHandler = CPLGetActiveErrorHandler();
+    if( pfnHandler )
+        pfnHandler(eErrClass, err_no, gszCPLLastErrMsg);
 
     if( eErrClass == CE_Fatal )
         abort();
@@ -323,8 +337,9 @@ void CPLDebug( const char * pszCategory, const char * pszFormat, ... )
 /*      If the user provided his own error handling function, then call */
 /*      it, otherwise print the error to stderr and return.             */
 /* -------------------------------------------------------------------- */
-    if( gpfnCPLErrorHandler )
-        gpfnCPLErrorHandler(CE_Debug, CPLE_None, pszMessage);
+    CPLErrorHandler pfnHandler = CPLGetActiveErrorHandler();
+    if( pfnHandler )
+        pfnHandler(CE_Debug, CPLE_None, pszMessage);
 
     VSIFree( pszMessage );
 }
@@ -579,7 +594,8 @@ CPLErrorHandler CPLSetErrorHandler( CPLErrorHandler pfnErrorHandler )
  * The old handler is "pushed down" onto a stack and can be easily
  * restored with CPLPopErrorHandler().  Otherwise this works similarly
  * to CPLSetErrorHandler() which contains more details on how error
- * handlers work.
+ * handlers work.  The stack belongs to the calling thread, and takes
+ * precedence over the handler installed with CPLSetErrorHandler().
  *
  * @param pfnErrorHandler new error handler function.
  */
@@ -591,11 +607,9 @@ void CPLPushErrorHandler( CPLErrorHandler pfnErrorHandler )
 
     psNode = (CPLErrorHandlerNode *) VSIMalloc(sizeof(CPLErrorHandlerNode));
     psNode->psNext = psHandlerStack;
-    psNode->pfnHandler = gpfnCPLErrorHandler;
+    psNode->pfnHandler = pfnErrorHandler;
 
     psHandlerStack = psNode;
-
-    CPLSetErrorHandler( pfnErrorHandler );
 }
 
 /************************************************************************/
@@ -617,7 +631,6 @@ void CPLPopErrorHandler()
         CPLErrorHandlerNode     *psNode = psHandlerStack;
 
         psHandlerStack = psNode->psNext;
-        CPLSetErrorHandler( psNode->pfnHandler );
         VSIFree( psNode );
     }
 }
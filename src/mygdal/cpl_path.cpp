@@ -83,7 +83,7 @@
 
 /* should be size of larged possible filename */
 #define CPL_PATH_BUF_SIZE 2048
-static char     szStaticResult[CPL_PATH_BUF_SIZE];
+static CPL_THREADLOCAL char szStaticResult[CPL_PATH_BUF_SIZE];
 
 #ifdef WIN32
 #define SEP_CHAR '\\'
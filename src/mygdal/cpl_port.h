@@ -242,6 +242,31 @@ typedef unsigned long    GUIntBig;
 #endif
 
 
+/* -------------------------------------------------------------------- */
+/*      Storage class for the few static work buffers that must not be  */
+/*      shared between threads ingesting cells concurrently.            */
+/* -------------------------------------------------------------------- */
+#ifndef CPL_THREADLOCAL
+#  if defined(_MSC_VER)
+#    define CPL_THREADLOCAL     __declspec(thread)
+#    define CPL_HAS_THREADLOCAL 1
+#  elif defined(__clang__)
+#    if __has_feature(tls)
+#      define CPL_THREADLOCAL     __thread
+#      define CPL_HAS_THREADLOCAL 1
+#    else
+#      define CPL_THREADLOCAL
+#      define CPL_HAS_THREADLOCAL 0
+#    endif
+#  elif defined(__GNUC__)
+#    define CPL_THREADLOCAL     __thread
+#    define CPL_HAS_THREADLOCAL 1
+#  else
+#    define CPL_THREADLOCAL
+#    define CPL_HAS_THREADLOCAL 0
+#  endif
+#endif
+
 #ifndef NULL
 #  define NULL  0
 #endif
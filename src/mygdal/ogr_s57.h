@@ -110,7 +110,8 @@ class OGRS57DataSource
 
     S57Writer           *poWriter;
 
-    static S57ClassRegistrar *poRegistrar;
+    S57ClassRegistrar   *poRegistrar;          // not owned
+    static S57ClassRegistrar *poDefaultRegistrar;
 
     int                 bClassCountSet;
     int                 anClassCount[MAX_CLASSES];
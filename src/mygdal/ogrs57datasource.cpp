@@ -33,7 +33,7 @@
 #include "cpl_conv.h"
 #include "cpl_string.h"
 
-S57ClassRegistrar *OGRS57DataSource::poRegistrar = NULL;
+S57ClassRegistrar *OGRS57DataSource::poDefaultRegistrar = NULL;
 
 /************************************************************************/
 /*                          OGRS57DataSource()                          */
@@ -48,6 +48,7 @@ OGRS57DataSource::OGRS57DataSource()
     nModules = 0;
     papoModules = NULL;
     poWriter = NULL;
+    poRegistrar = NULL;
 
     pszName = NULL;
 
@@ -243,13 +244,17 @@ int OGRS57DataSource::Open( const char * pszFilename, int bTestOpen, CallBackFun
 /* -------------------------------------------------------------------- */
     if( poRegistrar == NULL )
     {
-        poRegistrar = new S57ClassRegistrar();
-
-        if( !poRegistrar->LoadInfo( NULL, FALSE ) )
+        if( poDefaultRegistrar == NULL )
         {
-            delete poRegistrar;
-            poRegistrar = NULL;
+            poDefaultRegistrar = new S57ClassRegistrar();
+
+            if( !poDefaultRegistrar->LoadInfo( NULL, FALSE ) )
+            {
+                delete poDefaultRegistrar;
+                poDefaultRegistrar = NULL;
+            }
         }
+        poRegistrar = poDefaultRegistrar;
     }
 
 /* -------------------------------------------------------------------- */
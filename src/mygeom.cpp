@@ -1698,6 +1698,7 @@ PolyTriGroup::PolyTriGroup()
     tri_prim_head = NULL;         // head of linked list of TriPrims
     m_bSMSENC = false;
     bsingle_alloc = false;
+    barena_alloc = false;
     single_buffer = NULL;
     single_buffer_size = 0;
     data_type = DATA_TYPE_DOUBLE;
@@ -1707,8 +1708,13 @@ PolyTriGroup::PolyTriGroup()
 
 PolyTriGroup::~PolyTriGroup()
 {
-    free(pn_vertex);
     free(pgroup_geom);
+
+    //  Released with the arena, all at once
+    if(barena_alloc)
+        return;
+
+    free(pn_vertex);
     //Walk the list of TriPrims, deleting as we go
     TriPrim *tp_next;
     TriPrim *tp = tri_prim_head;
@@ -243,6 +243,9 @@ extern int              gps_watchdog_timeout_ticks;
 
 extern int              g_nCacheLimit;
 extern int              g_memCacheLimit;
+extern int              g_nRasterTileCacheMB;
+extern bool             g_bPreheatENC;
+extern int              g_nPreheatENCRadius;
 
 extern bool             g_bGDAL_Debug;
 extern bool             g_bDebugCM93;
@@ -537,6 +540,10 @@ int MyConfig::LoadMyConfig()
     if(mem_limit > 0)
         g_memCacheLimit = mem_limit * 1024;       // convert from MBytes to kBytes
 
+    Read( _T ( "RasterTileCacheMB" ), &g_nRasterTileCacheMB, 0 );
+    Read( _T ( "PreheatENC" ), &g_bPreheatENC, 0 );
+    Read( _T ( "PreheatENCRadius" ), &g_nPreheatENCRadius, 40 );
+
     Read( _T( "NCPUCount" ), &g_nCPUCount, -1);    
 
     Read( _T ( "DebugGDAL" ), &g_bGDAL_Debug, 0 );
@@ -56,6 +56,7 @@
 
 #ifdef ocpnUSE_GL
 #include "glChartCanvas.h"
+#include "glTexCatalog.h"
 extern GLuint g_raster_format;
 #endif
 
@@ -5460,6 +5461,7 @@ void options::OnOpenGLOptions(wxCommandEvent& event) {
       g_GLOptions.m_bTextureCompression = dlg.GetTextureCompression();
       ::wxBeginBusyCursor();
       cc1->GetglCanvas()->SetupCompression();
+      g_glTextureManager->StopPrebuild();
       g_glTextureManager->ClearAllRasterTextures();
       ::wxEndBusyCursor();
     }
@@ -5467,11 +5469,6 @@ void options::OnOpenGLOptions(wxCommandEvent& event) {
       g_GLOptions.m_bTextureCompression = dlg.GetTextureCompression();
     
   }
-
-  if (dlg.GetRebuildCache()) {
-    m_returnChanges = REBUILD_RASTER_CACHE;
-    Finish();
-  }
 #endif
 }
 
@@ -8393,12 +8390,13 @@ void SentenceListDlg::OnCheckAllClick(wxCommandEvent& event) {
 }
 
 // OpenGLOptionsDlg
-enum { ID_BUTTON_REBUILD, ID_BUTTON_CLEAR };
+enum { ID_BUTTON_REBUILD, ID_BUTTON_CLEAR, ID_PREBUILD_TIMER };
 
 #ifdef ocpnUSE_GL
 BEGIN_EVENT_TABLE(OpenGLOptionsDlg, wxDialog)
 EVT_BUTTON(ID_BUTTON_REBUILD, OpenGLOptionsDlg::OnButtonRebuild)
 EVT_BUTTON(ID_BUTTON_CLEAR, OpenGLOptionsDlg::OnButtonClear)
+EVT_TIMER(ID_PREBUILD_TIMER, OpenGLOptionsDlg::OnRefreshTimer)
 END_EVENT_TABLE()
 
 OpenGLOptionsDlg::OpenGLOptionsDlg(wxWindow* parent)
@@ -8408,7 +8406,7 @@ OpenGLOptionsDlg::OpenGLOptionsDlg(wxWindow* parent)
                                   | wxSTAY_ON_TOP
 #endif
                ),
-      m_brebuild_cache(FALSE) {
+      m_refreshTimer(this, ID_PREBUILD_TIMER) {
           
   wxFont* dialogFont = GetOCPNScaledFont(_("Dialog"));
   SetFont(*dialogFont);
@@ -8427,12 +8425,15 @@ OpenGLOptionsDlg::OpenGLOptionsDlg(wxWindow* parent)
   m_sTextureMemorySize->SetRange(1, 16384);
   m_cacheSize =
       new wxStaticText(this, wxID_ANY, _("Size: ") + GetTextureCacheSize());
-  wxButton* btnRebuild =
+  m_prebuildStatus = new wxStaticText(this, wxID_ANY, wxEmptyString);
+  m_btnRebuild =
       new wxButton(this, ID_BUTTON_REBUILD, _("Rebuild Texture Cache"));
   wxButton* btnClear =
       new wxButton(this, ID_BUTTON_CLEAR, _("Clear Texture Cache"));
-  btnRebuild->Enable(g_GLOptions.m_bTextureCompressionCaching);
-  if (!g_bopengl || g_raster_format == GL_RGB) btnRebuild->Disable();
+  m_btnRebuild->Enable(g_GLOptions.m_bTextureCompressionCaching);
+  if (!g_bopengl || g_raster_format == GL_RGB ||
+      g_raster_format == GL_COMPRESSED_RGB_FXT1_3DFX)
+    m_btnRebuild->Disable();
   btnClear->Enable(g_GLOptions.m_bTextureCompressionCaching);
   m_cbShowFPS = new wxCheckBox(this, wxID_ANY, _("Show FPS"));
   m_cbSoftwareGL =
@@ -8451,7 +8452,9 @@ OpenGLOptionsDlg::OpenGLOptionsDlg(wxWindow* parent)
                  wxALIGN_RIGHT | wxALIGN_CENTER_VERTICAL, 5);
   flexSizer->Add(m_cacheSize, 0, wxALIGN_CENTER | wxALIGN_CENTER_VERTICAL, 5);
   flexSizer->AddSpacer(0);
-  flexSizer->Add(btnRebuild, 0, wxALL | wxEXPAND, 5);
+  flexSizer->Add(m_prebuildStatus, 0, wxALL | wxEXPAND, 5);
+  flexSizer->AddSpacer(0);
+  flexSizer->Add(m_btnRebuild, 0, wxALL | wxEXPAND, 5);
   flexSizer->AddSpacer(0);
   flexSizer->Add(btnClear, 0, wxALL | wxEXPAND, 5);
   flexSizer->Add(new wxStaticText(this, wxID_ANY, _("Miscellaneous")), 0,
@@ -8473,10 +8476,13 @@ OpenGLOptionsDlg::OpenGLOptionsDlg(wxWindow* parent)
   mainSizer->Add(btnSizer, 0, wxALL | wxEXPAND, 5);
 
   Populate();
+  UpdatePrebuildStatus();
 
   SetSizer(mainSizer);
   mainSizer->SetSizeHints(this);
   Centre();
+
+  m_refreshTimer.Start(1000);
 }
 
 const bool OpenGLOptionsDlg::GetAcceleratedPanning(void) const {
@@ -8499,10 +8505,6 @@ const bool OpenGLOptionsDlg::GetTextureCompressionCaching(void) const {
   return m_cbTextureCompressionCaching->GetValue();
 }
 
-const bool OpenGLOptionsDlg::GetRebuildCache(void) const {
-  return m_brebuild_cache;
-}
-
 const int OpenGLOptionsDlg::GetTextureMemorySize(void) const {
   return m_sTextureMemorySize->GetValue();
 }
@@ -8555,16 +8557,46 @@ void OpenGLOptionsDlg::Populate(void) {
   }
 }
 
+// The cache is built in the background, this button starts and pauses it
 void OpenGLOptionsDlg::OnButtonRebuild(wxCommandEvent& event) {
-  if (g_GLOptions.m_bTextureCompressionCaching) {
-    m_brebuild_cache = TRUE;
-    EndModal(wxID_CANCEL);
+  if (!g_bopengl || !g_GLOptions.m_bTextureCompressionCaching) return;
+
+  if (g_glTextureManager->IsPrebuilding())
+    g_glTextureManager->StopPrebuild();
+  else
+    g_glTextureManager->StartPrebuild();
+  UpdatePrebuildStatus();
+}
+
+void OpenGLOptionsDlg::OnRefreshTimer(wxTimerEvent& event) {
+  UpdatePrebuildStatus();
+}
+
+void OpenGLOptionsDlg::UpdatePrebuildStatus(void) {
+  if (!g_bopengl || !g_glTextureManager) return;
+
+  PrebuildProgress p = g_glTextureManager->GetPrebuildProgress();
+  if (p.b_running) {
+    m_prebuildStatus->SetLabel(wxString::Format(
+        _("Building: %d of %d charts (%.0f%%)"), p.charts_done,
+        p.charts_total, p.fraction * 100.));
+    m_btnRebuild->SetLabel(_("Pause Texture Cache Build"));
+  } else {
+    m_prebuildStatus->SetLabel(wxEmptyString);
+    m_btnRebuild->SetLabel(_("Rebuild Texture Cache"));
   }
 }
 
 void OpenGLOptionsDlg::OnButtonClear(wxCommandEvent& event) {
   ::wxBeginBusyCursor();
-  if (g_bopengl) g_glTextureManager->ClearAllRasterTextures();
+  if (g_bopengl) {
+    g_glTextureManager->StopPrebuild();
+    g_glTextureManager->AbortAllJobs();
+    g_glTextureManager->ClearAllRasterTextures();
+  }
+
+  //  Else the next save would bring back the records of the files removed here
+  if (g_glTexCatalog) g_glTexCatalog->Clear();
 
   wxString path = g_Platform->GetPrivateDataDir() +
                   wxFileName::GetPathSeparator() + _T( "raster_texture_cache" );
@@ -3152,8 +3152,7 @@ bool UpdateSingleWaypoint( PlugIn_Waypoint *pwaypoint )
 
         SelectItem *pFind = pSelect->FindSelection( lat_save, lon_save, SELTYPE_ROUTEPOINT );
         if( pFind ) {
-            pFind->m_slat = pwaypoint->m_lat;             // update the SelectList entry
-            pFind->m_slon = pwaypoint->m_lon;
+            pSelect->ModifySelectableItem( pFind, pwaypoint->m_lat, pwaypoint->m_lon );    // update the SelectList entry
         }
 
         if(!prp->m_btemp)
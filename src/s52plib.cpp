@@ -350,6 +350,13 @@ void s52plib::DestroyLUP( LUPrec *pLUP )
         top = Rtmp;
     }
     
+    if( pLUP->ATTCMatch ) {
+        for( unsigned int i = 0; i < pLUP->ATTCArray->GetCount(); i++ )
+            free( pLUP->ATTCMatch[i].value );
+        free( pLUP->ATTCMatch );
+        pLUP->ATTCMatch = NULL;
+    }
+
     delete pLUP->ATTCArray;
     delete pLUP->INST;
 }
@@ -566,6 +573,38 @@ LUPArrayContainer *s52plib::SelectLUPArrayContainer( LUPname TNAM )
 
 extern Cond condTable[];
 
+//  Pack a six character S57 attribute acronym into an integer code
+static inline wxUint64 AttributeCode( const char *acronym )
+{
+    wxUint64 code = 0;
+    memcpy( &code, acronym, 6 );
+    return code;
+}
+
+//  Pre-parse the attribute strings of a LUP, so that FindBestLUP
+//  need not convert and scan them again for every object looked up
+static void CompileLUPAttributes( LUPrec *pLUP )
+{
+    unsigned int n = pLUP->ATTCArray->GetCount();
+    pLUP->ATTCMatch = (LUPAttrMatch *) calloc( n ? n : 1, sizeof(LUPAttrMatch) );
+
+    for( unsigned int i = 0; i < n; i++ ) {
+        LUPAttrMatch *pmatch = &pLUP->ATTCMatch[i];
+
+        wxCharBuffer buffer = pLUP->ATTCArray->Item( i ).ToUTF8();
+        const char *slatc = buffer.data();
+
+        if( !slatc || ( strlen( slatc ) < 6 ) )
+            continue;           // LUP attribute value not UTF8 convertible (never seen in PLIB 3.x)
+
+        pmatch->code = AttributeCode( slatc );
+        pmatch->value = strdup( slatc + 6 );
+        pmatch->ival = atoi( pmatch->value );
+        pmatch->fval = atof( pmatch->value );
+        pmatch->bvalid = true;
+    }
+}
+
 LUPrec *s52plib::FindBestLUP( wxArrayOfLUPrec *LUPArray, unsigned int startIndex, unsigned int count, S57Obj *pObj, bool bStrict )
 {
     //  Check the parameters
@@ -581,133 +620,119 @@ LUPrec *s52plib::FindBestLUP( wxArrayOfLUPrec *LUPArray, unsigned int startIndex
     int countATT = 0;
     bool bmatch_found = false;
 
+    wxUint64 obj_codes_local[64];
+    wxUint64 *obj_codes = obj_codes_local;
+
     if( pObj->att_array == NULL )
         goto check_LUP;       // object has no attributes to compare, so return "best" LUP
-        
+
+    //  The object attribute acronyms, as integer codes
+    if( pObj->n_attr > 64 )
+        obj_codes = (wxUint64 *) malloc( pObj->n_attr * sizeof(wxUint64) );
+    for( int iatt = 0; iatt < pObj->n_attr; iatt++ )
+        obj_codes[iatt] = AttributeCode( pObj->att_array + ( iatt * 6 ) );
+
     for( unsigned int i = 0; i < count; ++i ) {
         LUPrec *LUPCandidate = LUPArray->Item( startIndex + i );
         
         if( !LUPCandidate->ATTCArray )
             continue;        // this LUP has no attributes coded
 
+        if( !LUPCandidate->ATTCMatch )
+            CompileLUPAttributes( LUPCandidate );
+
         countATT = 0;
-        char *currATT = pObj->att_array;
-        int attIdx = 0;
+        unsigned int nattrs_on_candidate = LUPCandidate->ATTCArray->GetCount();
+
+        for( unsigned int iLUPAtt = 0; iLUPAtt < nattrs_on_candidate; iLUPAtt++ ) {
+            LUPAttrMatch *pmatch = &LUPCandidate->ATTCMatch[iLUPAtt];
+            if( !pmatch->bvalid )
+                continue;
+
+            //  Find the first object attribute with this name
+            int attIdx = 0;
+            while( ( attIdx < pObj->n_attr ) && ( obj_codes[attIdx] != pmatch->code ) )
+                ++attIdx;
+            if( attIdx == pObj->n_attr )
+                continue;
+
+            //OK we have an attribute name match
+            char *slatv = pmatch->value;
+            bool attValMatch = false;
+
+            // special case (i)
+            if( slatv[0] == ' ' ) {        // any object value will match wild card (S52 para 8.3.3.4)
+                ++countATT;
+                continue;
+            }
 
-        for( unsigned int iLUPAtt = 0; iLUPAtt < LUPCandidate->ATTCArray->GetCount(); iLUPAtt++ ) {
+            // special case (ii)
+            //TODO  Find an ENC with "UNKNOWN" DRVAL1 or DRVAL2 and debug this code
+            if( slatv[0] == '?' ){          // if LUP attribute value is "undefined"
 
-            // Get the LUP attribute name
-            wxString LATTC = LUPCandidate->ATTCArray->Item( iLUPAtt );
-            char *slatc = NULL;
-            wxCharBuffer buffer=LATTC.ToUTF8();
-            slatc = buffer.data();
-            //  Get the LUP attribute value as a string
-                        
-            if( slatc && (strlen(slatc) < 6) )
-                goto next_LUP_Attr;         // LUP attribute value not UTF8 convertible (never seen in PLIB 3.x)
-
-            if( slatc ){
-                char *slatv = slatc + 6;
-                while( attIdx < pObj->n_attr ) {
-                    if( 0 == strncmp( slatc, currATT, 6 ) ) {
-                        //OK we have an attribute name match
-                        
-                        
-                        bool attValMatch = false;
-                        
-                        // special case (i)
-                        if( !strncmp( slatv, " ", 1 ) ) {        // any object value will match wild card (S52 para 8.3.3.4)
-                            ++countATT;
-                            goto next_LUP_Attr;
-                        }
-                        
-                        // special case (ii)
-                        //TODO  Find an ENC with "UNKNOWN" DRVAL1 or DRVAL2 and debug this code
-                        if( !strncmp( slatv, "?", 1) ){          // if LUP attribute value is "undefined"
+            //  Match if the object does NOT contain this attribute
+                continue;
+            }
 
-                        //  Match if the object does NOT contain this attribute
-                            goto next_LUP_Attr;
-                        }
-                        
-                        
-                        //checking against object attribute value
-                        S57attVal *v = ( pObj->attVal->Item( attIdx ) );
-                        
-                        switch( v->valType ){
-                            case OGR_INT: // S57 attribute type 'E' enumerated, 'I' integer
-                            {
-                                int LUP_att_val = atoi( slatv );
-                                if( LUP_att_val == *(int*) ( v->value ) )
-                                    attValMatch = true;
-                                break;
-                            }
-                            
-                            case OGR_INT_LST: // S57 attribute type 'L' list: comma separated integer
-                            {
-                                int a;
-                                char ss[41];
-                                strncpy( ss, slatv, 39 );
-                                ss[40] = '\0';
-                                char *s = &ss[0];
-                                
-                                int *b = (int*) v->value;
-                                sscanf( s, "%d", &a );
-                                
-                                while( *s != '\0' ) {
-                                    if( a == *b ) {
-                                        sscanf( ++s, "%d", &a );
-                                        b++;
-                                        attValMatch = true;
-                                        
-                                    } else
-                                        attValMatch = false;
-                                }
-                                break;
-                            }
-                            case OGR_REAL: // S57 attribute type'F' float
-                            {
-                                double obj_val = *(double*) ( v->value );
-                                float att_val = atof( slatv );
-                                if( fabs( obj_val - att_val ) < 1e-6 )
-                                    if( obj_val == att_val  )
-                                        attValMatch = true;
-                                break;
-                            }
-                            
-                            case OGR_STR: // S57 attribute type'A' code string, 'S' free text
-                            {
-                                //    Strings must be exact match
-                                //    n.b. OGR_STR is used for S-57 attribute type 'L', comma-separated list
-                                
-                                //wxString cs( (char *) v->value, wxConvUTF8 ); // Attribute from object
-                                //if( LATTC.Mid( 6 ) == cs )
-                                if( !strcmp((char *) v->value, slatv))
-                                    attValMatch = true;
-                                break;
-                            }
-                            
-                            default:
-                                break;
-                        } //switch
-                        
-                        // value match
-                        if( attValMatch )
-                            ++countATT;
-                                                
-                        goto next_LUP_Attr;
-                    } // if attribute name match
-                    
-                    //  Advance to the next S57obj attribute
-                    currATT += 6;
-                    ++attIdx;
-                    
-                } //while
-            } //if
-            
-next_LUP_Attr:
-         
-            currATT = pObj->att_array; // restart the object attribute list
-            attIdx = 0;
+            //checking against object attribute value
+            S57attVal *v = ( pObj->attVal->Item( attIdx ) );
+
+            switch( v->valType ){
+                case OGR_INT: // S57 attribute type 'E' enumerated, 'I' integer
+                {
+                    if( pmatch->ival == *(int*) ( v->value ) )
+                        attValMatch = true;
+                    break;
+                }
+
+                case OGR_INT_LST: // S57 attribute type 'L' list: comma separated integer
+                {
+                    int a;
+                    char ss[41];
+                    strncpy( ss, slatv, 39 );
+                    ss[40] = '\0';
+                    char *s = &ss[0];
+
+                    int *b = (int*) v->value;
+                    sscanf( s, "%d", &a );
+
+                    while( *s != '\0' ) {
+                        if( a == *b ) {
+                            sscanf( ++s, "%d", &a );
+                            b++;
+                            attValMatch = true;
+
+                        } else
+                            attValMatch = false;
+                    }
+                    break;
+                }
+                case OGR_REAL: // S57 attribute type'F' float
+                {
+                    double obj_val = *(double*) ( v->value );
+                    float att_val = pmatch->fval;
+                    if( fabs( obj_val - att_val ) < 1e-6 )
+                        if( obj_val == att_val  )
+                            attValMatch = true;
+                    break;
+                }
+
+                case OGR_STR: // S57 attribute type'A' code string, 'S' free text
+                {
+                    //    Strings must be exact match
+                    //    n.b. OGR_STR is used for S-57 attribute type 'L', comma-separated list
+                    if( !strcmp((char *) v->value, slatv))
+                        attValMatch = true;
+                    break;
+                }
+
+                default:
+                    break;
+            } //switch
+
+            // value match
+            if( attValMatch )
+                ++countATT;
         } // for iLUPAtt
         
         //      Create a "match score", defined as fraction of candidate LUP attributes
@@ -715,7 +740,6 @@ next_LUP_Attr:
         //      Used later for resolving "ties"
         
         int nattr_matching_on_candidate = countATT;
-        int nattrs_on_candidate = LUPCandidate->ATTCArray->GetCount();
         double candidate_score = ( 1. * nattr_matching_on_candidate )
         / ( 1. * nattrs_on_candidate );
         
@@ -729,6 +753,8 @@ next_LUP_Attr:
         
     } //for loop
     
+    if( obj_codes != obj_codes_local )
+        free( obj_codes );
 
 check_LUP:
 //  In strict mode, we require at least one attribute to match exactly
@@ -2083,18 +2109,71 @@ bool s52plib::RenderText( wxDC *pdc, S52_TextC *ptext, int x, int y, wxRect *pRe
 
 }
 
+//    Text declutter rectangles are bucketed into a uniform screen space grid,
+//    so that the overlap check only visits texts placed near the test rectangle.
+#define TEXT_CELL_SHIFT 6                       // 64 pixel cells
+
+static inline int TextCellKey( int cx, int cy )
+{
+    return ( ( cy & 0xffff ) << 16 ) | ( cx & 0xffff );
+}
+
+//    Register ptext in every grid cell touched by its current rText.
+//    A text whose rText changes while listed is simply registered again;
+//    cells left over from an older rect are harmless since the overlap test
+//    always uses the live rText.
+void s52plib::AddTextRectCells( S52_TextC *ptext )
+{
+    const wxRect &r = ptext->rText;
+    if( ( r.width <= 0 ) || ( r.height <= 0 ) )
+        return;                                 // can never intersect anything
+
+    int cx0 = r.x >> TEXT_CELL_SHIFT;
+    int cx1 = r.GetRight() >> TEXT_CELL_SHIFT;
+    int cy0 = r.y >> TEXT_CELL_SHIFT;
+    int cy1 = r.GetBottom() >> TEXT_CELL_SHIFT;
+
+    for( int cy = cy0; cy <= cy1; cy++ ) {
+        for( int cx = cx0; cx <= cx1; cx++ ) {
+            TextCellArray &cell = m_textCells[TextCellKey( cx, cy )];
+            if( cell.empty() || cell.back() != ptext )
+                cell.push_back( ptext );
+        }
+    }
+}
+
+void s52plib::ClearTextRectCells( void )
+{
+    m_textCells.clear();
+    m_textObjMember.clear();
+}
+
 //    Return true if test_rect overlaps any rect in the current text rectangle list, except itself
 bool s52plib::CheckTextRectList( const wxRect &test_rect, S52_TextC *ptext )
 {
-    //    Iterate over the current object list, looking at rText
+    if( ( test_rect.width <= 0 ) || ( test_rect.height <= 0 ) )
+        return false;
+
+    //    Iterate over the grid cells covered by test_rect, looking at rText
 
-    for( TextObjList::Node *node = m_textObjList.GetFirst(); node; node = node->GetNext() ) {
-        wxRect *pcurrent_rect = &( node->GetData()->rText );
+    int cx0 = test_rect.x >> TEXT_CELL_SHIFT;
+    int cx1 = test_rect.GetRight() >> TEXT_CELL_SHIFT;
+    int cy0 = test_rect.y >> TEXT_CELL_SHIFT;
+    int cy1 = test_rect.GetBottom() >> TEXT_CELL_SHIFT;
 
-        if( pcurrent_rect->Intersects( test_rect ) ) {
-            if( node->GetData() != ptext )
-                return true;
+    for( int cy = cy0; cy <= cy1; cy++ ) {
+        for( int cx = cx0; cx <= cx1; cx++ ) {
+            TextCellHash::iterator it = m_textCells.find( TextCellKey( cx, cy ) );
+            if( it == m_textCells.end() )
+                continue;
 
+            TextCellArray &cell = it->second;
+            for( size_t i = 0; i < cell.size(); i++ ) {
+                if( cell[i] == ptext )
+                    continue;
+                if( cell[i]->rText.Intersects( test_rect ) )
+                    return true;
+            }
         }
     }
     return false;
@@ -2277,20 +2356,17 @@ int s52plib::RenderT_All( ObjRazRules *rzRules, Rules *rules, ViewPort *vp, bool
         
         //      If this text was actually drawn, add a pointer to its rect to the de-clutter list if it doesn't already exist
         if( m_bDeClutterText ) {
+            bool b_listed = m_textObjMember.find( text ) != m_textObjMember.end();
             if( bwas_drawn ) {
-                bool b_found = false;
-                for( TextObjList::Node *node = m_textObjList.GetFirst(); node; node =  node->GetNext() ) {
-                    S52_TextC *oc = node->GetData();
-
-                    if( oc == text ) {
-                        if(!b_dupok)
-                            b_found = true;
-                        break;
-                    }
-                }
-                if( !b_found )
+                if( !b_listed || b_dupok ) {
                     m_textObjList.Append( text );
+                    m_textObjMember[text] = 1;
+                }
             }
+
+            //  rText may have moved or grown, so keep the declutter grid current
+            if( bwas_drawn || b_listed )
+                AddTextRectCells( text );
         }
 
         //  Update the object Bounding box
@@ -4911,6 +4987,7 @@ int s52plib::RenderMPS( ObjRazRules *rzRules, Rules *rules, ViewPort *vp )
         }
 
         DestroyRulesChain( ru_cs );
+        rzRules->obj->CSdeps |= point_obj.CSdeps;
         rzRules->obj->bCS_Added = 1; // mark the object
     }
    
@@ -5859,6 +5936,8 @@ char *s52plib::RenderCS( ObjRazRules *rzRules, Rules *rules )
 
     void *g = (void *) rules->razRule;
 
+    S52_clearMarinerParamUsage();
+
 #ifdef FIX_FOR_MSVC  //__WXMSW__
 //#warning Fix this cast, somehow...
 //      dsr             sigh... can't get the cast right
@@ -5875,6 +5954,9 @@ char *s52plib::RenderCS( ObjRazRules *rzRules, Rules *rules )
 
 #endif
 
+    //  Remember which mariner parameters this result depends on
+    rzRules->obj->CSdeps |= S52_getMarinerParamUsage();
+
     return (char *) ret;
 }
 
@@ -8844,6 +8926,7 @@ void s52plib::ClearTextList( void )
 {
     //      Clear the current text rectangle list
     m_textObjList.Clear();
+    ClearTextRectCells();
 
 }
 
@@ -8854,26 +8937,10 @@ bool s52plib::EnableGLLS(bool b_enable)
     return return_val;
 }
     
+//  Text declutter rectangles are not carried across a pan; the list is
+//  rebuilt by the next full render, so there is nothing to adjust here.
 void s52plib::AdjustTextList( int dx, int dy, int screenw, int screenh )
 {
-    return;
-    wxRect rScreen( 0, 0, screenw, screenh );
-    //    Iterate over the text rectangle list
-    //        1.  Apply the specified offset to the list elements
-    //        2.. Remove any list elements that are off screen after applied offset
-
-    TextObjList::Node *node = m_textObjList.GetFirst();
-    while( node ) {
-        wxRect *pcurrent = &( node->GetData()->rText );
-        pcurrent->Offset( dx, dy );
-
-        if( !pcurrent->Intersects( rScreen ) ) {
-            m_textObjList.DeleteNode( node );
-
-            node = m_textObjList.GetFirst();
-        } else
-            node = node->GetNext();
-    }
 }
 
 bool s52plib::GetPointPixArray( ObjRazRules *rzRules, wxPoint2DDouble* pd, wxPoint *pp, int nv, ViewPort *vp )
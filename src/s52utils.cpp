@@ -161,12 +161,16 @@ static double _MARparamVal[] = {
 };
 
 
+//  Parameters read since the last clear, so that the CS procedures' dependencies can be recorded
+static unsigned int _MARparamUsage = 0;
+
 double S52_getMarinerParam(S52_MAR_param_t param)
 // return Mariner parameter or '0.0' if fail
 // FIXME: check mariner param against groups selection
 {
 
 //      DSR
+    _MARparamUsage |= 1 << param;
     return _MARparamVal[param];
 }
 
@@ -179,3 +183,13 @@ int    S52_setMarinerParam(S52_MAR_param_t param, double val)
 
     return TRUE;
 }
+
+unsigned int S52_getMarinerParamUsage(void)
+{
+    return _MARparamUsage;
+}
+
+void   S52_clearMarinerParamUsage(void)
+{
+    _MARparamUsage = 0;
+}
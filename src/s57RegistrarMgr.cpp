@@ -58,6 +58,7 @@ static int s57_initialize( const wxString& csv_dir, FILE *flog )
 
 s57RegistrarMgr::s57RegistrarMgr( const wxString& csv_dir, FILE *flog )
 {
+    m_csv_dir = csv_dir;
     s57_initialize( csv_dir, flog );
     
     //  Create and initialize the S57 Attribute helpers
@@ -72,6 +73,22 @@ s57RegistrarMgr::~s57RegistrarMgr()
     g_poRegistrar = NULL;
 }
 
+S57ClassRegistrar *s57RegistrarMgr::CreateRegistrar()
+{
+    S57ClassRegistrar *poRegistrar = new S57ClassRegistrar();
+
+    if( !poRegistrar->LoadInfo( m_csv_dir.mb_str(), FALSE ) ) {
+        wxString msg( _T("   Error: Could not load S57 ClassInfo from ") );
+        msg.Append( m_csv_dir );
+        wxLogMessage( msg );
+
+        delete poRegistrar;
+        return NULL;
+    }
+
+    return poRegistrar;
+}
+
 bool s57RegistrarMgr::s57_attr_init( const wxString& csv_dir ){
     
     //  Find, open, and read the file {csv_dir}/s57attributes.csv
@@ -75,6 +75,8 @@
 
 #include <algorithm>          // for std::sort
 #include <map>
+#include <set>
+#include <new>
 
 #include "ssl/sha1.h"
 
@@ -111,6 +113,8 @@ extern PlugInManager     *g_pi_manager;
 extern bool              g_b_overzoom_x;
 extern bool              g_b_EnableVBO;
 
+extern wxFont *GetOCPNScaledFont( wxString item, int default_size );
+
 int                      g_SENC_LOD_pixels;
 
 static jmp_buf env_ogrf;                    // the context saved by setjmp();
@@ -131,6 +135,9 @@ WX_DEFINE_OBJARRAY(ArrayOfVC_Elements);
 
 static int              s_bInS57;         // Exclusion flag to prvent recursion in this class init call.
                                           // Init() is not reentrant due to static wxProgressDialog callback....
+
+static wxCriticalSection  s_SENCCellCritSect;
+static std::set<wxString> s_SENCCellsBusy;  // cell names with a SENC being built or read
 int s_cnt;
 
 static bool s_ProgressCallBack( void )
@@ -1241,6 +1248,12 @@ s57chart::s57chart()
     for( int i = 0; i < PRIO_NUM; i++ )
         for( int j = 0; j < LUPNAME_NUM; j++ )
             razRules[i][j] = NULL;
+    m_bPickIndexValid = false;
+    m_bRenderIndexValid = false;
+    m_bRenderListsValid = false;
+    m_render_point_list = 0;
+    m_render_point_reach_lat = 0.;
+    m_render_point_reach_lon = 0.;
 
     m_Chart_Scale = 1;                              // Will be fetched during Init()
     m_Chart_Skew = 0.0;
@@ -1274,6 +1287,7 @@ s57chart::s57chart()
 
     m_bLinePrioritySet = false;
     m_plib_state_hash = 0;
+    m_bCSParamsValid = false;
 
     m_btex_mem = false;
 
@@ -1284,6 +1298,8 @@ s57chart::s57chart()
     m_b2lineLUPS = false;
 
     m_next_safe_cnt = 1e6;
+    m_pSENCRegistrar = NULL;
+    m_bVEPointsInPlace = false;
     m_LineVBO_name = -1;
     m_line_vertex_buffer = 0;
     m_this_chart_context =  0;
@@ -1324,7 +1340,8 @@ s57chart::~s57chart()
     for( VE_Hash::iterator it = m_ve_hash.begin(); it != m_ve_hash.end(); ++it ) {
         VE_Element *pedge = it->second;
         if(pedge){
-            free(pedge->pPoints);
+            if(!m_bVEPointsInPlace)
+                free(pedge->pPoints);
             delete pedge;
         }
     }
@@ -1478,6 +1495,21 @@ static void free_mps(mps_container *mps)
 
 void s57chart::FreeObjectsAndRules()
 {
+    m_pick_index.Clear();
+    m_pick_items.clear();
+    m_bPickIndexValid = false;
+
+    m_render_index.Clear();
+    m_render_point_index.Clear();
+    m_render_items.clear();
+    m_render_loose.clear();
+    m_render_visited.clear();
+    for( int i = 0; i < PRIO_NUM; i++ )
+        for( int j = 0; j < LUPNAME_NUM; j++ )
+            m_render_list[i][j].clear();
+    m_bRenderIndexValid = false;
+    m_bRenderListsValid = false;
+
 //      Delete the created ObjRazRules, including the S57Objs
 //      and any child lists
 //      The LUPs of base elements are deleted elsewhere ( void s52plib::DestroyLUPArray ( wxArrayOfLUPrec *pLUPArray ))
@@ -1492,7 +1524,7 @@ void s57chart::FreeObjectsAndRules()
             while( top != NULL ) {
                 top->obj->nRef--;
                 if( 0 == top->obj->nRef )
-                    delete top->obj;
+                    S57Obj::Destroy( top->obj );
 
                 if( top->child ) {
                     ObjRazRules *ctop = top->child;
@@ -1510,11 +1542,21 @@ void s57chart::FreeObjectsAndRules()
                 free_mps( top->mps );
 
                 nxx = top->next;
-                free( top );
-                top = nxx;
+                top = nxx;                      // the rules themselves are in m_arena
             }
         }
     }
+
+    m_arena.Clear();
+}
+
+int s57chart::GetMemoryUsageKB( void )
+{
+    size_t bytes = m_arena.GetReservedBytes();
+    if( m_line_vertex_buffer )
+        bytes += m_vbo_byte_length;
+
+    return bytes / 1024;
 }
 
 void s57chart::ClearRenderedTextCache()
@@ -1998,6 +2040,14 @@ typedef struct segment_pair{
 }_segment_pair;
 
 
+//  The line segments of an arena object are placed in its arena, and go with it
+static line_segment_element *NewLineSegment( S57Obj *obj )
+{
+    if( obj->m_arena )
+        return new( obj->m_arena->Alloc( sizeof(line_segment_element) ) ) line_segment_element;
+    return new line_segment_element;
+}
+
 void s57chart::AssembleLineGeometry( void )
 {
     // Walk the hash tables to get the required buffer size
@@ -2129,7 +2179,7 @@ void s57chart::AssembleLineGeometry( void )
                                 pcs = csit->second;
 
 
-                            line_segment_element *pls = new line_segment_element;
+                            line_segment_element *pls = NewLineSegment( obj );
                             pls->next = 0;
                             //                            pls->n_points = 2;
                             pls->priority = 0;
@@ -2143,7 +2193,7 @@ void s57chart::AssembleLineGeometry( void )
                     }
 
                     if(pedge && pedge->nCount){
-                        line_segment_element *pls = new line_segment_element;
+                        line_segment_element *pls = NewLineSegment( obj );
                         pls->next = 0;
                         //                        pls->n_points = pedge->nCount;
                         pls->priority = 0;
@@ -2205,7 +2255,7 @@ void s57chart::AssembleLineGeometry( void )
                                 else
                                     pcs = csit->second;
 
-                                line_segment_element *pls = new line_segment_element;
+                                line_segment_element *pls = NewLineSegment( obj );
                                 pls->next = 0;
                                 pls->priority = 0;
                                 pls->pcs = pcs;
@@ -2251,7 +2301,7 @@ void s57chart::AssembleLineGeometry( void )
                                 else
                                     pcs = csit->second;
 
-                                line_segment_element *pls = new line_segment_element;
+                                line_segment_element *pls = NewLineSegment( obj );
                                 pls->next = 0;
                                 pls->priority = 0;
                                 pls->pcs = pcs;
@@ -2367,7 +2417,9 @@ void s57chart::AssembleLineGeometry( void )
         VE_Element *pedge = it->second;
         if(pedge){
             m_pve_vector.push_back(pedge);
-            free(pedge->pPoints);
+            if(!m_bVEPointsInPlace)
+                free(pedge->pPoints);
+            pedge->pPoints = NULL;
         }
     }
     m_ve_hash.clear();
@@ -2573,20 +2625,21 @@ bool s57chart::DoRenderOnGL( const wxGLContext &glc, const ViewPort& VPoint )
 #ifdef ocpnUSE_GL
 
     int i;
-    ObjRazRules *top;
+    std::vector<ObjRazRules *> *plist;
     ObjRazRules *crnt;
     ViewPort tvp = VPoint;                    // undo const  TODO fix this in PLIB
 
+    PrepareRenderLists( tvp );
+
     //      Render the areas quickly
     for( i = 0; i < PRIO_NUM; ++i ) {
         if( ps52plib->m_nBoundaryStyle == SYMBOLIZED_BOUNDARIES ) 
-            top = razRules[i][4]; // Area Symbolized Boundaries
+            plist = &m_render_list[i][4]; // Area Symbolized Boundaries
         else
-            top = razRules[i][3]; // Area Plain Boundaries
+            plist = &m_render_list[i][3]; // Area Plain Boundaries
 
-        while( top != NULL ) {
-            crnt = top;
-            top = top->next;               // next object
+        for( size_t k = 0; k < plist->size(); k++ ) {
+            crnt = (*plist)[k];
             crnt->sm_transform_parms = &vp_transform;
             ps52plib->RenderAreaToGL( glc, crnt, &tvp );
         }
@@ -2595,32 +2648,29 @@ bool s57chart::DoRenderOnGL( const wxGLContext &glc, const ViewPort& VPoint )
     //    Render the lines and points
     for( i = 0; i < PRIO_NUM; ++i ) {
         if( ps52plib->m_nBoundaryStyle == SYMBOLIZED_BOUNDARIES ) 
-            top = razRules[i][4]; // Area Symbolized Boundaries
+            plist = &m_render_list[i][4]; // Area Symbolized Boundaries
         else
-            top = razRules[i][3]; // Area Plain Boundaries
-        while( top != NULL ) {
-            crnt = top;
-            top = top->next;               // next object
+            plist = &m_render_list[i][3]; // Area Plain Boundaries
+        for( size_t k = 0; k < plist->size(); k++ ) {
+            crnt = (*plist)[k];
             crnt->sm_transform_parms = &vp_transform;
             ps52plib->RenderObjectToGL( glc, crnt, &tvp );
         }
 
-        top = razRules[i][2];           //LINES
-        while( top != NULL ) {
-            crnt = top;
-            top = top->next;
+        plist = &m_render_list[i][2];           //LINES
+        for( size_t k = 0; k < plist->size(); k++ ) {
+            crnt = (*plist)[k];
             crnt->sm_transform_parms = &vp_transform;
             ps52plib->RenderObjectToGL( glc, crnt, &tvp );
         }
 
         if( ps52plib->m_nSymbolStyle == SIMPLIFIED ) 
-            top = razRules[i][0];       //SIMPLIFIED Points
+            plist = &m_render_list[i][0];       //SIMPLIFIED Points
         else
-            top = razRules[i][1];           //Paper Chart Points Points
+            plist = &m_render_list[i][1];           //Paper Chart Points Points
 
-        while( top != NULL ) {
-            crnt = top;
-            top = top->next;
+        for( size_t k = 0; k < plist->size(); k++ ) {
+            crnt = (*plist)[k];
             crnt->sm_transform_parms = &vp_transform;
             ps52plib->RenderObjectToGL( glc, crnt, &tvp );
         }
@@ -2637,21 +2687,22 @@ bool s57chart::DoRenderOnGLText( const wxGLContext &glc, const ViewPort& VPoint
 #ifdef ocpnUSE_GL
     
     int i;
-    ObjRazRules *top;
+    std::vector<ObjRazRules *> *plist;
     ObjRazRules *crnt;
     ViewPort tvp = VPoint;                    // undo const  TODO fix this in PLIB
 
+    PrepareRenderLists( tvp );
+
 #if 0    
     //      Render the areas quickly
     for( i = 0; i < PRIO_NUM; ++i ) {
         if( ps52plib->m_nBoundaryStyle == SYMBOLIZED_BOUNDARIES )
-            top = razRules[i][4]; // Area Symbolized Boundaries
+            plist = &m_render_list[i][4]; // Area Symbolized Boundaries
         else
-            top = razRules[i][3];           // Area Plain Boundaries
+            plist = &m_render_list[i][3];           // Area Plain Boundaries
             
-            while( top != NULL ) {
-                crnt = top;
-                top = top->next;               // next object
+            for( size_t k = 0; k < plist->size(); k++ ) {
+                crnt = (*plist)[k];
                 crnt->sm_transform_parms = &vp_transform;
 ///                ps52plib->RenderAreaToGL( glc, crnt, &tvp );
             }
@@ -2661,33 +2712,30 @@ bool s57chart::DoRenderOnGLText( const wxGLContext &glc, const ViewPort& VPoint
     //    Render the lines and points
     for( i = 0; i < PRIO_NUM; ++i ) {
         if( ps52plib->m_nBoundaryStyle == SYMBOLIZED_BOUNDARIES ) 
-            top = razRules[i][4]; // Area Symbolized Boundaries
+            plist = &m_render_list[i][4]; // Area Symbolized Boundaries
         else
-            top = razRules[i][3]; // Area Plain Boundaries
+            plist = &m_render_list[i][3]; // Area Plain Boundaries
 
-        while( top != NULL ) {
-                crnt = top;
-                top = top->next;               // next object
+        for( size_t k = 0; k < plist->size(); k++ ) {
+                crnt = (*plist)[k];
                 crnt->sm_transform_parms = &vp_transform;
                 ps52plib->RenderObjectToGLText( glc, crnt, &tvp );
         }
             
-        top = razRules[i][2];           //LINES
-        while( top != NULL ) {
-                crnt = top;
-                top = top->next;
+        plist = &m_render_list[i][2];           //LINES
+        for( size_t k = 0; k < plist->size(); k++ ) {
+                crnt = (*plist)[k];
                 crnt->sm_transform_parms = &vp_transform;
                 ps52plib->RenderObjectToGLText( glc, crnt, &tvp );
         }
             
         if( ps52plib->m_nSymbolStyle == SIMPLIFIED ) 
-            top = razRules[i][0];       //SIMPLIFIED Points
+            plist = &m_render_list[i][0];       //SIMPLIFIED Points
         else
-            top = razRules[i][1];           //Paper Chart Points Points
+            plist = &m_render_list[i][1];           //Paper Chart Points Points
             
-        while( top != NULL ) {
-                crnt = top;
-                top = top->next;
+        for( size_t k = 0; k < plist->size(); k++ ) {
+                crnt = (*plist)[k];
                 crnt->sm_transform_parms = &vp_transform;
                 ps52plib->RenderObjectToGLText( glc, crnt, &tvp );
         }
@@ -3093,12 +3141,14 @@ int s57chart::DCRenderRect( wxMemoryDC& dcinput, const ViewPort& vp, wxRect* rec
 {
 
     int i;
-    ObjRazRules *top;
+    std::vector<ObjRazRules *> *plist;
     ObjRazRules *crnt;
 
     wxASSERT(rect);
     ViewPort tvp = vp;                    // undo const  TODO fix this in PLIB
 
+    PrepareRenderLists( tvp );
+
 //    This does not work due to some issue with ref data of allocated buffer.....
 //    render_canvas_parms pb_spec( rect->x, rect->y, rect->width, rect->height,  GetGlobalColor ( _T ( "NODTA" ) ));
 
@@ -3153,13 +3203,12 @@ int s57chart::DCRenderRect( wxMemoryDC& dcinput, const ViewPort& vp, wxRect* rec
 //      Render the areas quickly
     for( i = 0; i < PRIO_NUM; ++i ) {
         if( ps52plib->m_nBoundaryStyle == SYMBOLIZED_BOUNDARIES ) 
-            top = razRules[i][4]; // Area Symbolized Boundaries
+            plist = &m_render_list[i][4]; // Area Symbolized Boundaries
         else
-            top = razRules[i][3]; // Area Plain Boundaries
+            plist = &m_render_list[i][3]; // Area Plain Boundaries
 
-        while( top != NULL ) {
-            crnt = top;
-            top = top->next;               // next object
+        for( size_t k = 0; k < plist->size(); k++ ) {
+            crnt = (*plist)[k];
             crnt->sm_transform_parms = &vp_transform;
             ps52plib->RenderAreaToDC( &dcinput, crnt, &tvp, &pb_spec );
         }
@@ -3204,10 +3253,12 @@ int s57chart::DCRenderRect( wxMemoryDC& dcinput, const ViewPort& vp, wxRect* rec
 bool s57chart::DCRenderLPB( wxMemoryDC& dcinput, const ViewPort& vp, wxRect* rect )
 {
     int i;
-    ObjRazRules *top;
+    std::vector<ObjRazRules *> *plist;
     ObjRazRules *crnt;
     ViewPort tvp = vp;                    // undo const  TODO fix this in PLIB
 
+    PrepareRenderLists( tvp );
+
     for( i = 0; i < PRIO_NUM; ++i ) {
 //      Set up a Clipper for Lines
         wxDCClipper *pdcc = NULL;
@@ -3217,32 +3268,29 @@ bool s57chart::DCRenderLPB( wxMemoryDC& dcinput, const ViewPort& vp, wxRect* rec
         }
 
         if( ps52plib->m_nBoundaryStyle == SYMBOLIZED_BOUNDARIES ) 
-            top = razRules[i][4]; // Area Symbolized Boundaries
+            plist = &m_render_list[i][4]; // Area Symbolized Boundaries
         else
-            top = razRules[i][3];           // Area Plain Boundaries
-        while( top != NULL ) {
-            crnt = top;
-            top = top->next;               // next object
+            plist = &m_render_list[i][3];           // Area Plain Boundaries
+        for( size_t k = 0; k < plist->size(); k++ ) {
+            crnt = (*plist)[k];
             crnt->sm_transform_parms = &vp_transform;
             ps52plib->RenderObjectToDC( &dcinput, crnt, &tvp );
         }
 
-        top = razRules[i][2];           //LINES
-        while( top != NULL ) {
-            crnt = top;
-            top = top->next;
+        plist = &m_render_list[i][2];           //LINES
+        for( size_t k = 0; k < plist->size(); k++ ) {
+            crnt = (*plist)[k];
             crnt->sm_transform_parms = &vp_transform;
             ps52plib->RenderObjectToDC( &dcinput, crnt, &tvp );
         }
 
         if( ps52plib->m_nSymbolStyle == SIMPLIFIED ) 
-            top = razRules[i][0];       //SIMPLIFIED Points
+            plist = &m_render_list[i][0];       //SIMPLIFIED Points
         else
-            top = razRules[i][1];           //Paper Chart Points Points
+            plist = &m_render_list[i][1];           //Paper Chart Points Points
 
-        while( top != NULL ) {
-            crnt = top;
-            top = top->next;
+        for( size_t k = 0; k < plist->size(); k++ ) {
+            crnt = (*plist)[k];
             crnt->sm_transform_parms = &vp_transform;
             ps52plib->RenderObjectToDC( &dcinput, crnt, &tvp );
         }
@@ -3264,40 +3312,39 @@ bool s57chart::DCRenderLPB( wxMemoryDC& dcinput, const ViewPort& vp, wxRect* rec
 bool s57chart::DCRenderText( wxMemoryDC& dcinput, const ViewPort& vp )
 {
     int i;
-    ObjRazRules *top;
+    std::vector<ObjRazRules *> *plist;
     ObjRazRules *crnt;
     ViewPort tvp = vp;                    // undo const  TODO fix this in PLIB
+
+    PrepareRenderLists( tvp );
     
     for( i = 0; i < PRIO_NUM; ++i ) {
         
         if( ps52plib->m_nBoundaryStyle == SYMBOLIZED_BOUNDARIES ) 
-            top = razRules[i][4]; // Area Symbolized Boundaries
+            plist = &m_render_list[i][4]; // Area Symbolized Boundaries
         else
-            top = razRules[i][3]; // Area Plain Boundaries
+            plist = &m_render_list[i][3]; // Area Plain Boundaries
 
-        while( top != NULL ) {
-                crnt = top;
-                top = top->next;               // next object
+        for( size_t k = 0; k < plist->size(); k++ ) {
+                crnt = (*plist)[k];
                 crnt->sm_transform_parms = &vp_transform;
                 ps52plib->RenderObjectToDCText( &dcinput, crnt, &tvp );
         }
             
-        top = razRules[i][2];           //LINES
-        while( top != NULL ) {
-                crnt = top;
-                top = top->next;
+        plist = &m_render_list[i][2];           //LINES
+        for( size_t k = 0; k < plist->size(); k++ ) {
+                crnt = (*plist)[k];
                 crnt->sm_transform_parms = &vp_transform;
                 ps52plib->RenderObjectToDCText( &dcinput, crnt, &tvp );
         }
             
         if( ps52plib->m_nSymbolStyle == SIMPLIFIED ) 
-            top = razRules[i][0];       //SIMPLIFIED Points
+            plist = &m_render_list[i][0];       //SIMPLIFIED Points
         else
-            top = razRules[i][1];           //Paper Chart Points Points
+            plist = &m_render_list[i][1];           //Paper Chart Points Points
             
-        while( top != NULL ) {
-                crnt = top;
-                top = top->next;
+        for( size_t k = 0; k < plist->size(); k++ ) {
+                crnt = (*plist)[k];
                 crnt->sm_transform_parms = &vp_transform;
                 ps52plib->RenderObjectToDCText( &dcinput, crnt, &tvp );
         }
@@ -3309,7 +3356,7 @@ bool s57chart::DCRenderText( wxMemoryDC& dcinput, const ViewPort& vp )
 
 
 
-bool s57chart::IsCellOverlayType( char *pFullPath )
+bool s57chart::IsCellOverlayType( const char *pFullPath )
 {
     wxFileName fn( wxString( pFullPath, wxConvUTF8 ) );
     //      Get the "Usage" character
@@ -3427,6 +3474,9 @@ InitReturn s57chart::Init( const wxString& name, ChartInitFlag flags )
     if( ext == _T("000") ) {
         if( m_bbase_file_attr_known ) {
 
+            //  A batch builder may be working on this cell right now
+            LockSENCCell( m_FullPath );
+
             int sret = FindOrCreateSenc( m_FullPath );
             if( sret != BUILD_SENC_OK ) {
                 if( sret == BUILD_SENC_NOK_RETRY ) ret_value = INIT_FAIL_RETRY;
@@ -3435,6 +3485,8 @@ InitReturn s57chart::Init( const wxString& name, ChartInitFlag flags )
             } else
                 ret_value = PostInit( flags, m_global_color_scheme );
 
+            UnlockSENCCell( m_FullPath );
+
         }
 
     }
@@ -3486,6 +3538,67 @@ wxString s57chart::buildSENCName( const wxString& name)
     return tsfn.GetFullPath();
 }
 
+static wxString SENCCellKey( const wxString& name )
+{
+    wxString key = wxFileName( name ).GetFullName().BeforeFirst( '.' ).Upper();
+    return wxString( key.c_str() );
+}
+
+bool s57chart::TryLockSENCCell( const wxString& name )
+{
+    wxString key = SENCCellKey( name );
+
+    wxCriticalSectionLocker locker( s_SENCCellCritSect );
+    return s_SENCCellsBusy.insert( key ).second;
+}
+
+void s57chart::LockSENCCell( const wxString& name )
+{
+    if( TryLockSENCCell( name ) )
+        return;
+
+    if( !wxThread::IsMain() ) {
+        while( !TryLockSENCCell( name ) )
+            wxThread::Sleep( 20 );
+        return;
+    }
+
+    //  A background builder holds the cell.  Keep the GUI alive while it finishes;
+    //  the SENC it writes is then picked up by FindOrCreateSenc() as up to date.
+    //  Recursion into Init() from the yield is blocked by s_bInS57.
+    wxStopWatch sw;
+    wxGenericProgressDialog *prog = NULL;
+
+    while( !TryLockSENCCell( name ) ) {
+#if wxUSE_PROGRESSDLG
+        if( !prog && sw.Time() > 500 ) {
+            wxString msg = _("Waiting for background SENC build of ");
+            msg += wxFileName( name ).GetFullName();
+
+            prog = new wxGenericProgressDialog();
+            wxFont *qFont = GetOCPNScaledFont(_("Dialog"));
+            prog->SetFont( *qFont );
+            prog->Create( _("OpenCPN S57 SENC File Create..."), msg, 100, NULL,
+                          wxPD_AUTO_HIDE | wxPD_SMOOTH );
+        }
+        if( prog )
+            prog->Pulse();
+#endif
+        wxYieldIfNeeded();
+        wxThread::Sleep( 20 );
+    }
+
+    delete prog;
+}
+
+void s57chart::UnlockSENCCell( const wxString& name )
+{
+    wxString key = SENCCellKey( name );
+
+    wxCriticalSectionLocker locker( s_SENCCellCritSect );
+    s_SENCCellsBusy.erase( key );
+}
+
 //-----------------------------------------------------------------------------------------------
 //    Find or Create a relevent SENC file from a given .000 ENC file
 //    Returns with error code, and associated SENC file name in m_S57FileName
@@ -3524,6 +3637,7 @@ InitReturn s57chart::FindOrCreateSenc( const wxString& name, bool b_progress )
     int build_ret_val = 1;
 
     bool bbuild_new_senc = false;
+    bool b_updates_only = false;                // the existing SENC lacks only some newer updates
     m_bneed_new_thumbnail = false;
 
     wxFileName FileName000( m_TempFilePath );
@@ -3595,6 +3709,7 @@ InitReturn s57chart::FindOrCreateSenc( const wxString& name, bool b_progress )
                     if( ifile_edition == isenc_edition ){
                         if( most_recent_update_file > last_update ){
                             bbuild_new_senc = true;
+                            b_updates_only = true;
                             wxLogMessage(_T("    Rebuilding SENC due to incremental cell update."));
                             wxString msg;
                             msg.Printf(_T("    Last update recorded in SENC: %d   most recent update file: %d"), last_update, most_recent_update_file);
@@ -3611,10 +3726,12 @@ InitReturn s57chart::FindOrCreateSenc( const wxString& name, bool b_progress )
                         if( OModTime000.IsLaterThan( SENCCreateDate ) ){
                             wxLogMessage(_T("    Rebuilding SENC due to Senc vs cell file time check."));
                             bbuild_new_senc = true;
+                            b_updates_only = false;
                         }
                     }
                     else{
                         bbuild_new_senc = true;
+                        b_updates_only = false;
                         wxLogMessage(_T("    Rebuilding SENC due to SENC create time invalid."));
                     }
 
@@ -3628,8 +3745,10 @@ InitReturn s57chart::FindOrCreateSenc( const wxString& name, bool b_progress )
 
                 }
 
-                if( force_make_senc )
+                if( force_make_senc ){
                     bbuild_new_senc = true;
+                    b_updates_only = false;
+                }
 
             }
         }
@@ -3642,7 +3761,7 @@ InitReturn s57chart::FindOrCreateSenc( const wxString& name, bool b_progress )
 
     if( bbuild_new_senc ) {
         m_bneed_new_thumbnail = true; // force a new thumbnail to be built in PostInit()
-        build_ret_val = BuildSENCFile( m_TempFilePath, m_SENCFileName, b_progress );
+        build_ret_val = BuildSENCFile( m_TempFilePath, m_SENCFileName, b_progress, b_updates_only );
         if( BUILD_SENC_NOK_PERMANENT == build_ret_val ) 
             return INIT_FAIL_REMOVE;
         if( BUILD_SENC_NOK_RETRY == build_ret_val )
@@ -4804,9 +4923,12 @@ bool s57chart::GetBaseFileAttr( const wxString& file000 )
     return true;
 }
 
-int s57chart::BuildSENCFile( const wxString& FullPath000, const wxString& SENCFileName, bool b_progress )
+int s57chart::BuildSENCFile( const wxString& FullPath000, const wxString& SENCFileName, bool b_progress,
+                             bool b_updates_only )
 {
-    OCPNPlatform::ShowBusySpinner();
+    bool b_main = wxThread::IsMain();
+    if( b_main )
+        OCPNPlatform::ShowBusySpinner();
     
     //  LOD calculation
     double display_ppm = 1 / .00025;     // nominal for most LCD displays
@@ -4819,13 +4941,18 @@ int s57chart::BuildSENCFile( const wxString& FullPath000, const wxString& SENCFi
     
     Osenc senc;
 
-    senc.setRegistrar( g_poRegistrar );
+    senc.setRegistrar( m_pSENCRegistrar ? m_pSENCRegistrar : g_poRegistrar );
     senc.setRefLocn(ref_lat, ref_lon);
     senc.SetLODMeters(m_LOD_meters);
 
+    //  Only newer updates are missing, so the existing SENC can supply the unchanged features
+    if( b_updates_only )
+        senc.setPriorSENC( SENCFileName );
+
     int ret = senc.createSenc200( FullPath000, SENCFileName, b_progress );
 
-    OCPNPlatform::HideBusySpinner();
+    if( b_main )
+        OCPNPlatform::HideBusySpinner();
     
     if(ret == ERROR_INGESTING000)
         return BUILD_SENC_NOK_PERMANENT;
@@ -4849,7 +4976,10 @@ int s57chart::BuildRAZFromSENCFile( const wxString& FullPath )
     VC_ElementVector VCs;
 
     sencfile.setRefLocn(ref_lat, ref_lon);
+    sencfile.setObjectArena( &m_arena );
 
+    //  The edge points may point into the mapped SENC, which sencfile holds until
+    //  we return, so AssembleLineGeometry() must consume them before then.
     int srv = sencfile.ingest200(FullPath, &Objects, &VEs, &VCs);
 
     if(srv != SENC_NO_ERROR){
@@ -4858,6 +4988,8 @@ int s57chart::BuildRAZFromSENCFile( const wxString& FullPath )
         return 1;
     }
 
+    m_bVEPointsInPlace = sencfile.isPayloadInPlace();
+
     //  Get the cell Ref point as recorded in the SENC
     Extent ext = sencfile.getReadExtent();
 
@@ -4968,7 +5100,7 @@ int s57chart::BuildRAZFromSENCFile( const wxString& FullPath )
                 msg.Prepend( _T("   Could not find LUP for ") );
                 LogMessageOnce( msg );
             }
-            delete obj;
+            S57Obj::Destroy( obj );
             obj = NULL;
             Objects[i] = NULL;
         } else {
@@ -5159,7 +5291,7 @@ int s57chart::_insertRules( S57Obj *obj, LUPrec *LUP, s57chart *pOwner )
     }
 
     // insert rules
-    rzRules = (ObjRazRules *) malloc( sizeof(ObjRazRules) );
+    rzRules = (ObjRazRules *) m_arena.Alloc( sizeof(ObjRazRules) );
     rzRules->obj = obj;
     obj->nRef++;                         // Increment reference counter for delete check;
     rzRules->LUP = LUP;
@@ -5167,8 +5299,12 @@ int s57chart::_insertRules( S57Obj *obj, LUPrec *LUP, s57chart *pOwner )
     rzRules->next = razRules[disPrioIdx][LUPtypeIdx];
     rzRules->child = NULL;
     rzRules->mps = NULL;
+    rzRules->sm_transform_parms = &vp_transform;
     razRules[disPrioIdx][LUPtypeIdx] = rzRules;
 
+    m_bPickIndexValid = false;                  // rebuilt on the next pick
+    m_bRenderIndexValid = false;                // and on the next render
+
     return 1;
 }
 
@@ -5228,6 +5364,28 @@ void s57chart::UpdateLUPs( s57chart *pOwner )
     ObjRazRules *top;
     ObjRazRules *nxx;
     LUPrec *LUP;
+
+    //  Find the mariner parameters changed since the last update.
+    //  Only objects whose CS actually read one of them need re-evaluation.
+    //  Symbol/boundary style and depth units change the LUPs or the CS output
+    //  of everything, so re-evaluate all objects then.
+    unsigned int cs_changed = 0;
+    if( !m_bCSParamsValid || ( m_CSSymbolStyle != ps52plib->m_nSymbolStyle )
+            || ( m_CSBoundaryStyle != ps52plib->m_nBoundaryStyle )
+            || ( m_CSDepthUnit != ps52plib->m_nDepthUnitDisplay ) )
+        cs_changed = ~0u;
+
+    for( int i = 0; i < S52_MAR_NUM; i++ ) {
+        double val = S52_getMarinerParam( (S52_MAR_param_t) i );
+        if( val != m_CSMarinerParams[i] )
+            cs_changed |= 1 << i;
+        m_CSMarinerParams[i] = val;
+    }
+    m_CSSymbolStyle = ps52plib->m_nSymbolStyle;
+    m_CSBoundaryStyle = ps52plib->m_nBoundaryStyle;
+    m_CSDepthUnit = ps52plib->m_nDepthUnitDisplay;
+    m_bCSParamsValid = true;
+
     for( int i = 0; i < PRIO_NUM; ++i ) {
         //  SIMPLIFIED is set, PAPER_CHART is bare
         if( ( razRules[i][0] ) && ( NULL == razRules[i][1] ) ) {
@@ -5309,17 +5467,20 @@ void s57chart::UpdateLUPs( s57chart *pOwner )
         }
 
         //  Traverse this priority level again,
-        //  clearing any object CS rules and flags,
+        //  clearing any stale object CS rules and flags,
         //  so that the next render operation will re-evaluate the CS
 
         for( int j = 0; j < LUPNAME_NUM; j++ ) {
             top = razRules[i][j];
             while( top != NULL ) {
-                top->obj->bCS_Added = 0;
-                free_mps( top->mps );
-                top->mps = 0;
-                if (top->LUP)
-                    top->obj->m_DisplayCat = top->LUP->DISC;
+                if( !top->obj->bCS_Added || ( top->obj->CSdeps & cs_changed ) ) {
+                    top->obj->bCS_Added = 0;
+                    top->obj->CSdeps = 0;
+                    free_mps( top->mps );
+                    top->mps = 0;
+                    if (top->LUP)
+                        top->obj->m_DisplayCat = top->LUP->DISC;
+                }
 
                 nxx = top->next;
                 top = nxx;
@@ -5327,7 +5488,7 @@ void s57chart::UpdateLUPs( s57chart *pOwner )
         }
 
         //  Traverse this priority level again,
-        //  clearing any object CS rules and flags of any child list,
+        //  clearing any stale object CS rules and flags of any child list,
         //  so that the next render operation will re-evaluate the CS
 
         for( int j = 0; j < LUPNAME_NUM; j++ ) {
@@ -5336,12 +5497,15 @@ void s57chart::UpdateLUPs( s57chart *pOwner )
                 if( top->child ) {
                     ObjRazRules *ctop = top->child;
                     while( NULL != ctop ) {
-                        ctop->obj->bCS_Added = 0;
-                        free_mps( ctop->mps );
-                        ctop->mps = 0;
-
-                        if (ctop->LUP)
-                            ctop->obj->m_DisplayCat = ctop->LUP->DISC;
+                        if( !ctop->obj->bCS_Added || ( ctop->obj->CSdeps & cs_changed ) ) {
+                            ctop->obj->bCS_Added = 0;
+                            ctop->obj->CSdeps = 0;
+                            free_mps( ctop->mps );
+                            ctop->mps = 0;
+
+                            if (ctop->LUP)
+                                ctop->obj->m_DisplayCat = ctop->LUP->DISC;
+                        }
                         ctop = ctop->next;
                     }
                 }
@@ -5364,6 +5528,23 @@ ListOfObjRazRules *s57chart::GetObjRuleListAtLatLon( float lat, float lon, float
 
     ListOfObjRazRules *ret_ptr = new ListOfObjRazRules;
 
+    //  Gather the area and line candidates from the pick index, in razRules order.
+    //  Boxes may cross the IDL, and lie beyond +-180, so look there too.
+    if( !m_bPickIndexValid )
+        BuildPickIndex();
+
+    std::vector<int> candidates;
+    if( selection_mask & ( MASK_AREA | MASK_LINE ) ) {
+        float marge = select_radius + 1e-4;            // allow for the float boxes in the index
+        for( int iw = -1; iw <= 1; iw++ ) {
+            float qlon = lon + iw * 360.;
+            m_pick_index.Query( qlon - marge, lat - marge, qlon + marge, lat + marge, candidates );
+        }
+        std::sort( candidates.begin(), candidates.end() );
+        candidates.erase( std::unique( candidates.begin(), candidates.end() ), candidates.end() );
+    }
+    size_t icand = 0;
+
 //    Iterate thru the razRules array, by object/rule type
 
     ObjRazRules *top;
@@ -5403,37 +5584,246 @@ ListOfObjRazRules *s57chart::GetObjRuleListAtLatLon( float lat, float lon, float
             }
         }
 
-        if(selection_mask & MASK_AREA){
-                // Areas by boundary type, array indices [3..4]
+        //  Then areas, by boundary type, array indices [3..4], and finally lines, [2].
+        //  Only those whose bounding box is near enough are tested in full.
+        int area_boundary_type = ( ps52plib->m_nBoundaryStyle == PLAIN_BOUNDARIES ) ? 3 : 4;
+        for( ; icand < candidates.size(); icand++ ) {
+            const PickIndexItem &item = m_pick_items[candidates[icand]];
+            if( item.prio != i )
+                break;
 
-            int area_boundary_type = ( ps52plib->m_nBoundaryStyle == PLAIN_BOUNDARIES ) ? 3 : 4;
-            top = razRules[i][area_boundary_type];           // Area nnn Boundaries
-            while( top != NULL ) {
-                if( ps52plib->ObjectRenderCheck( top, VPoint ) ) {
-                    if( DoesLatLonSelectObject( lat, lon, select_radius, top->obj ) ) ret_ptr->Append(
-                            top );
-                }
+            if( item.lup_type == 2 ) {
+                if( !(selection_mask & MASK_LINE) )
+                    continue;
+            }
+            else if( !(selection_mask & MASK_AREA) || ( item.lup_type != area_boundary_type ) )
+                continue;
+
+            top = item.rules;
+            if( ps52plib->ObjectRenderCheck( top, VPoint ) ) {
+                if( DoesLatLonSelectObject( lat, lon, select_radius, top->obj ) ) ret_ptr->Append(
+                        top );
+            }
+        }
+    }
 
+    return ret_ptr;
+}
+
+//  Index the area and line rules by object bounding box, for picking.
+//  These boxes come from the object geometry and only ever grow with rendered text,
+//  unlike point boxes, which are resized with the display scale; so points are not indexed.
+void s57chart::BuildPickIndex( void )
+{
+    m_pick_index.Clear();
+    m_pick_items.clear();
+
+    //  Areas of both boundary styles, then lines, per display priority, as picked
+    static const int lup_types[3] = { 3, 4, 2 };
+
+    for( int i = 0; i < PRIO_NUM; ++i ) {
+        for( int k = 0; k < 3; k++ ) {
+            ObjRazRules *top = razRules[i][lup_types[k]];
+            while( top != NULL ) {
+                PickIndexItem item;
+                item.rules = top;
+                item.prio = i;
+                item.lup_type = lup_types[k];
+
+                const LLBBox &box = top->obj->BBObj;
+                if( box.GetValid() )
+                    m_pick_index.Add( (int)m_pick_items.size(), box.GetMinLon(), box.GetMinLat(),
+                                      box.GetMaxLon(), box.GetMaxLat() );
+                else                                    // no box yet, so always a candidate
+                    m_pick_index.Add( (int)m_pick_items.size(), -1000., -1000., 1000., 1000. );
+
+                m_pick_items.push_back( item );
                 top = top->next;
-            }         // while
+            }
         }
+    }
+
+    m_pick_index.Build();
+    m_bPickIndexValid = true;
+}
 
-        if(selection_mask & MASK_LINE){
-                // Finally, lines
-            top = razRules[i][2];           // Lines
+//  Index the rules lists for render pass culling.
+//  Ids follow the order of the razRules lists, so sorting them restores render order.
+//  Line, area and multipoint rules are indexed by object bounding box.  Single point
+//  boxes are resized on every change of display scale, so these are indexed by their
+//  fixed anchor instead, and looked for with a margin as wide as any point box reaches.
+void s57chart::BuildRenderIndex( void )
+{
+    m_render_index.Clear();
+    m_render_point_index.Clear();
+    m_render_items.clear();
+    m_render_loose.clear();
+    m_render_visited.clear();
+    m_render_point_reach_lat = 0.;
+    m_render_point_reach_lon = 0.;
+    m_bRenderListsValid = false;
 
+    for( int i = 0; i < PRIO_NUM; ++i ) {
+        for( int j = 0; j < LUPNAME_NUM; j++ ) {
+            ObjRazRules *top = razRules[i][j];
             while( top != NULL ) {
-                if( ps52plib->ObjectRenderCheck( top, VPoint ) ) {
-                    if( DoesLatLonSelectObject( lat, lon, select_radius, top->obj ) ) ret_ptr->Append(
-                            top );
+                S57Obj *obj = top->obj;
+                const LLBBox &box = obj->BBObj;
+
+                RenderIndexItem item;
+                item.rules = top;
+                item.prio = i;
+                item.lup_type = j;
+                item.minlat = box.GetMinLat();
+                item.minlon = box.GetMinLon();
+                item.maxlat = box.GetMaxLat();
+                item.maxlon = box.GetMaxLon();
+                item.bloose = false;
+                item.bpoint = ( j < 2 ) && !obj->geoPtMulti;
+
+                //  s52plib::ObjectRenderCheckPos() tests the box extents whether valid or not,
+                //  so index those; only a box which is not a box at all is always a candidate
+                int id = (int)m_render_items.size();
+                if( item.bpoint )
+                    m_render_point_index.Add( id, obj->m_lon, obj->m_lat, obj->m_lon, obj->m_lat );
+                else if( ( item.minlat <= item.maxlat ) && ( item.minlon <= item.maxlon ) )
+                    m_render_index.Add( id, item.minlon, item.minlat, item.maxlon, item.maxlat );
+                else {
+                    item.bloose = true;
+                    m_render_loose.push_back( id );
                 }
 
+                m_render_items.push_back( item );
                 top = top->next;
             }
         }
     }
 
-    return ret_ptr;
+    m_render_index.Build();
+    m_render_point_index.Build();
+    m_bRenderIndexValid = true;
+}
+
+//  Widen the point search margin to cover this point's box, as last seen.
+//  The margin is kept in degrees at a display scale of 1 pixel per meter, as
+//  ResetPointBBoxes() scales the point boxes inversely with the display scale.
+void s57chart::ExtendPointReach( const RenderIndexItem &item, double view_scale_ppm )
+{
+    if( ( item.minlat > item.maxlat ) || ( item.minlon > item.maxlon ) )
+        return;
+
+    const S57Obj *obj = item.rules->obj;
+    double dlat = wxMax( item.maxlat - obj->m_lat, obj->m_lat - item.minlat );
+    double dlon = wxMax( item.maxlon - obj->m_lon, obj->m_lon - item.minlon );
+
+    m_render_point_reach_lat = wxMax( m_render_point_reach_lat, dlat * view_scale_ppm );
+    m_render_point_reach_lon = wxMax( m_render_point_reach_lon, dlon * view_scale_ppm );
+}
+
+#define RENDER_POINT_REACH_SLACK        1.5     // for symbols measured at other latitudes
+#define RENDER_POINT_MIN_REACH_PIX      64      // for symbols not drawn yet
+
+//  Gather the rules whose objects may intersect the viewport into m_render_list,
+//  keeping razRules order.  The renderer still makes its own position check,
+//  so these lists need only be a superset of what it will draw.
+void s57chart::PrepareRenderLists( ViewPort &vp )
+{
+    const LLBBox &vpBox = vp.GetBBox();
+    int point_list = ( ps52plib->m_nSymbolStyle == SIMPLIFIED ) ? 0 : 1;
+
+    //  The lists depend on the view only, so the passes over one view share them.
+    //  Only the objects in them are drawn, so only their boxes can have changed.
+    if( m_bRenderIndexValid && m_bRenderListsValid && ( point_list == m_render_point_list )
+            && ( vp.view_scale_ppm == m_render_vp_ppm )
+            && ( vpBox.GetMinLat() == m_render_vp_minlat ) && ( vpBox.GetMinLon() == m_render_vp_minlon )
+            && ( vpBox.GetMaxLat() == m_render_vp_maxlat ) && ( vpBox.GetMaxLon() == m_render_vp_maxlon ) )
+        return;
+
+    bool b_rebuilt = false;
+    if( !m_bRenderIndexValid ) {
+        BuildRenderIndex();
+        b_rebuilt = true;
+    }
+
+    //  Only objects offered to the last pass can have had their boxes changed since.
+    //  Point boxes have been rescaled to this view by now.
+    for( size_t k = 0; k < m_render_visited.size(); k++ ) {
+        RenderIndexItem &item = m_render_items[m_render_visited[k]];
+        if( item.bloose )
+            continue;
+
+        const LLBBox &box = item.rules->obj->BBObj;
+        if( ( box.GetMinLat() != item.minlat ) || ( box.GetMinLon() != item.minlon )
+                || ( box.GetMaxLat() != item.maxlat ) || ( box.GetMaxLon() != item.maxlon ) ) {
+            if( item.bpoint ) {
+                item.minlat = box.GetMinLat();
+                item.minlon = box.GetMinLon();
+                item.maxlat = box.GetMaxLat();
+                item.maxlon = box.GetMaxLon();
+                ExtendPointReach( item, vp.view_scale_ppm );
+            }
+            else {
+                item.bloose = true;
+                m_render_loose.push_back( m_render_visited[k] );
+            }
+        }
+    }
+
+    if( !b_rebuilt && ( m_render_loose.size() > 64 ) && ( m_render_loose.size() > m_render_items.size() / 8 ) ) {
+        BuildRenderIndex();
+        b_rebuilt = true;
+    }
+
+    if( b_rebuilt ) {
+        for( size_t k = 0; k < m_render_items.size(); k++ ) {
+            if( m_render_items[k].bpoint )
+                ExtendPointReach( m_render_items[k], vp.view_scale_ppm );
+        }
+    }
+
+    //  Point anchors are looked for as far out as any point box reaches
+    double ppm = wxMax( vp.view_scale_ppm, 1e-9 );
+    double min_reach = RENDER_POINT_MIN_REACH_PIX / ( 1852. * 60. );
+    double min_reach_lon = min_reach / wxMax( cos( vp.clat * PI / 180. ), 0.05 );
+    double plat = wxMax( RENDER_POINT_REACH_SLACK * m_render_point_reach_lat, min_reach ) / ppm;
+    double plon = wxMax( RENDER_POINT_REACH_SLACK * m_render_point_reach_lon, min_reach_lon ) / ppm;
+
+    //  The object may also be drawn at lon +- 360, so look there too
+    const float marge = 1e-4;
+    std::vector<int> &candidates = m_render_visited;
+    candidates.clear();
+    for( int k = -1; k <= 1; k++ ) {
+        m_render_index.Query( vpBox.GetMinLon() + ( k * 360. ) - marge, vpBox.GetMinLat() - marge,
+                              vpBox.GetMaxLon() + ( k * 360. ) + marge, vpBox.GetMaxLat() + marge,
+                              candidates );
+        m_render_point_index.Query( vpBox.GetMinLon() + ( k * 360. ) - marge - plon, vpBox.GetMinLat() - marge - plat,
+                                    vpBox.GetMaxLon() + ( k * 360. ) + marge + plon, vpBox.GetMaxLat() + marge + plat,
+                                    candidates );
+    }
+    candidates.insert( candidates.end(), m_render_loose.begin(), m_render_loose.end() );
+
+    std::sort( candidates.begin(), candidates.end() );
+    candidates.erase( std::unique( candidates.begin(), candidates.end() ), candidates.end() );
+
+    for( int i = 0; i < PRIO_NUM; i++ )
+        for( int j = 0; j < LUPNAME_NUM; j++ )
+            m_render_list[i][j].clear();
+
+    //  Of the two point symbolizations, only the one in use is drawn
+    for( size_t k = 0; k < candidates.size(); k++ ) {
+        const RenderIndexItem &item = m_render_items[candidates[k]];
+        if( ( item.lup_type < 2 ) && ( item.lup_type != point_list ) )
+            continue;
+        m_render_list[item.prio][item.lup_type].push_back( item.rules );
+    }
+
+    m_render_point_list = point_list;
+    m_render_vp_ppm = vp.view_scale_ppm;
+    m_render_vp_minlat = vpBox.GetMinLat();
+    m_render_vp_minlon = vpBox.GetMinLon();
+    m_render_vp_maxlat = vpBox.GetMaxLat();
+    m_render_vp_maxlon = vpBox.GetMaxLon();
+    m_bRenderListsValid = true;
 }
 
 bool s57chart::DoesLatLonSelectObject( float lat, float lon, float select_radius, S57Obj *obj )
@@ -59,6 +59,7 @@
 #include "pluginmanager.h"                      // for S57 lights overlay
 
 #include "Osenc.h"
+#include "ChartArena.h"
 
 #ifdef __MSVC__
 #define _CRTDBG_MAP_ALLOC
@@ -107,11 +108,13 @@ S57Obj::~S57Obj()
     //  Don't delete any allocated records of simple copy clones
     if( !bIsClone ) {
         if( attVal ) {
-            for( unsigned int iv = 0; iv < attVal->GetCount(); iv++ ) {
-                S57attVal *vv = attVal->Item( iv );
-                void *v2 = vv->value;
-                free( v2 );
-                delete vv;
+            if( !m_arena ) {                    // else released with the chart arena
+                for( unsigned int iv = 0; iv < attVal->GetCount(); iv++ ) {
+                    S57attVal *vv = attVal->Item( iv );
+                    void *v2 = vv->value;
+                    free( v2 );
+                    delete vv;
+                }
             }
             delete attVal;
         }
@@ -137,7 +140,7 @@ S57Obj::~S57Obj()
 
         if( m_lsindex_array ) free( m_lsindex_array );
 
-        if(m_ls_list){
+        if(m_ls_list && !m_arena){
             line_segment_element *element = m_ls_list;
             while(element){
                 line_segment_element *next = element->next;
@@ -160,6 +163,8 @@ void S57Obj::Init()
 
     bCS_Added = 0;
     CSrules = NULL;
+    CSdeps = 0;
+    m_arena = NULL;
     FText = NULL;
     bFText_Added = 0;
     geoPtMulti = NULL;
@@ -210,11 +215,38 @@ S57Obj::S57Obj( const char* featureName )
 }
 
 
+//  Objects placed in a chart arena are only destructed; their memory goes with the arena
+void S57Obj::Destroy( S57Obj *obj )
+{
+    if( !obj )
+        return;
+
+    if( obj->m_arena )
+        obj->~S57Obj();
+    else
+        delete obj;
+}
+
+//  Attribute records come from the owning chart's arena, if there is one
+void *S57Obj::AllocAttr( size_t size )
+{
+    if( m_arena )
+        return m_arena->Alloc( size );
+    return malloc( size );
+}
+
+S57attVal *S57Obj::NewAttVal( void )
+{
+    if( m_arena )
+        return (S57attVal *) m_arena->Alloc( sizeof(S57attVal) );
+    return new S57attVal;
+}
+
 bool S57Obj::AddIntegerAttribute( const char *acronym, int val ){
 
-    S57attVal *pattValTmp = new S57attVal;
+    S57attVal *pattValTmp = NewAttVal();
 
-    int *pAVI = (int *) malloc( sizeof(int) );         //new int;
+    int *pAVI = (int *) AllocAttr( sizeof(int) );         //new int;
     *pAVI = val;
 
     pattValTmp->valType = OGR_INT;
@@ -239,9 +271,9 @@ bool S57Obj::AddIntegerListAttribute( const char *acronym, int *pval, int nValue
 
 bool S57Obj::AddDoubleAttribute( const char *acronym, double val ){
 
-    S57attVal *pattValTmp = new S57attVal;
+    S57attVal *pattValTmp = NewAttVal();
 
-    double *pAVI = (double *) malloc( sizeof(double) );         //new double;
+    double *pAVI = (double *) AllocAttr( sizeof(double) );         //new double;
     *pAVI = val;
 
     pattValTmp->valType = OGR_REAL;
@@ -263,9 +295,9 @@ bool S57Obj::AddDoubleListAttribute( const char *acronym, double *pval, int nVal
 
 bool S57Obj::AddStringAttribute( const char *acronym, char *val ){
 
-    S57attVal *pattValTmp = new S57attVal;
+    S57attVal *pattValTmp = NewAttVal();
 
-    char *pAVS = (char *)malloc(strlen(val) + 1);   //new string
+    char *pAVS = (char *)AllocAttr(strlen(val) + 1);   //new string
     strcpy(pAVS, val);
 
     pattValTmp->valType = OGR_STR;
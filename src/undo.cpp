@@ -107,8 +107,7 @@ void doUndoMoveWaypoint( UndoAction* action ) {
     lastPoint->y = lat;
     lastPoint->x = lon;
     SelectItem* selectable = (SelectItem*) action->selectable[0];
-    selectable->m_slat = currentPoint->m_lat;
-    selectable->m_slon = currentPoint->m_lon;
+    pSelect->ModifySelectableItem( selectable, currentPoint->m_lat, currentPoint->m_lon );
 
     if( ( NULL != pMarkPropDialog ) && ( pMarkPropDialog->IsShown() ) ){
        if( currentPoint == pMarkPropDialog->GetRoutePoint() ) pMarkPropDialog->UpdateProperties(true);